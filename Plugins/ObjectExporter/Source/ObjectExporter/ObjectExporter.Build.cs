@@ -1,5 +1,6 @@
 // Some copyright should be here...
 
+using System.IO;
 using UnrealBuildTool;
 
 public class ObjectExporter : ModuleRules
@@ -17,6 +18,7 @@ public class ObjectExporter : ModuleRules
 		
 		PrivateIncludePaths.AddRange(
 			new string[] {
+				Path.Combine(ModuleDirectory, "..", "ThirdParty", "REngineFormat"),
 				// ... add other private include paths required here ...
 			}
 			);
@@ -36,6 +38,7 @@ public class ObjectExporter : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"DeveloperSettings",
 				"Slate",
 				"SlateCore",
                 "Json",
@@ -43,6 +46,7 @@ public class ObjectExporter : ModuleRules
 				"RenderCore",
 				"Renderer",
 				"RHI",
+				"ImageCore",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,481 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimCompression.h"
+
+// The first uint16 of a key holds its frame in the low 14 bits, rotations keep the index of their largest component in the top two
+#define MAX_COMPRESSED_FRAMES 16384
+#define KEY_FRAME_MASK 0x3fff
+#define KEY_COMPONENTS 4
+#define KEY_MAX 65535.0f
+// Range of the three smallest components of a unit quaternion
+#define SMALLEST_THREE_RANGE 0.70710678f
+// Times the channel tolerance is halved when the measured error is still above the tolerance
+#define TOLERANCE_REFINE_STEPS 4
+
+/** Write the three smallest components to OutKey[1..3] and the index of the largest to the top bits of OutKey[0], keeping its frame bits */
+static void EncodeRotation(const FQuat4f& Rotation, uint16* OutKey)
+{
+    const FQuat4f Normalized = Rotation.GetNormalized();
+    const float Components[4] = { Normalized.X, Normalized.Y, Normalized.Z, Normalized.W };
+
+    int32 Largest = 0;
+    for (int32 iComponent = 1; iComponent < 4; iComponent++)
+    {
+        if (FMath::Abs(Components[iComponent]) > FMath::Abs(Components[Largest]))
+        {
+            Largest = iComponent;
+        }
+    }
+
+    // q and -q are the same rotation, the dropped component is made positive
+    const float Sign = Components[Largest] < 0.0f ? -1.0f : 1.0f;
+    int32 iKey = 0;
+    for (int32 iComponent = 0; iComponent < 4; iComponent++)
+    {
+        if (iComponent != Largest)
+        {
+            const float Value = FMath::Clamp(Components[iComponent] * Sign / SMALLEST_THREE_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+            OutKey[++iKey] = uint16(FMath::RoundToInt(Value * KEY_MAX));
+        }
+    }
+
+    OutKey[0] = uint16((OutKey[0] & KEY_FRAME_MASK) | (Largest << 14));
+}
+
+static FQuat4f DecodeRotation(const uint16* Key)
+{
+    const int32 Largest = Key[0] >> 14;
+
+    float Components[4];
+    float SumSquares = 0.0f;
+    int32 iKey = 0;
+    for (int32 iComponent = 0; iComponent < 4; iComponent++)
+    {
+        if (iComponent != Largest)
+        {
+            const float Value = (Key[++iKey] / KEY_MAX * 2.0f - 1.0f) * SMALLEST_THREE_RANGE;
+            Components[iComponent] = Value;
+            SumSquares += Value * Value;
+        }
+    }
+    Components[Largest] = FMath::Sqrt(FMath::Max(1.0f - SumSquares, 0.0f));
+
+    return FQuat4f(Components[0], Components[1], Components[2], Components[3]);
+}
+
+static void EncodeRange(const FVector3f& Value, const float* Min, const float* Extent, uint16* OutKey)
+{
+    for (int32 iComponent = 0; iComponent < 3; iComponent++)
+    {
+        const float Normalized = Extent[iComponent] > 0.0f ? FMath::Clamp((Value[iComponent] - Min[iComponent]) / Extent[iComponent], 0.0f, 1.0f) : 0.0f;
+        OutKey[iComponent + 1] = uint16(FMath::RoundToInt(Normalized * KEY_MAX));
+    }
+}
+
+static FVector3f DecodeRange(const uint16* Key, const float* Min, const float* Extent)
+{
+    return FVector3f(Min[0] + Key[1] / KEY_MAX * Extent[0], Min[1] + Key[2] / KEY_MAX * Extent[1], Min[2] + Key[3] / KEY_MAX * Extent[2]);
+}
+
+static FQuat4f InterpolateRotation(const FQuat4f& A, const FQuat4f& B, float Alpha)
+{
+    // Normalized lerp along the shortest path
+    return FQuat4f::FastLerp(A, B, Alpha).GetNormalized();
+}
+
+static FVector3f InterpolateVector(const FVector3f& A, const FVector3f& B, float Alpha)
+{
+    return A + (B - A) * Alpha;
+}
+
+/** The raw keys of a channel expanded to one per frame, empty when the track has none */
+template<typename ValueType>
+static void ExpandRawKeys(const TArray<ValueType>& Keys, int32 NumFrames, TArray<ValueType>& OutValues)
+{
+    OutValues.Reset(NumFrames);
+    if (Keys.Num() > 0)
+    {
+        for (int32 Frame = 0; Frame < NumFrames; Frame++)
+        {
+            OutValues.Add(Keys[FMath::Min(Frame, Keys.Num() - 1)]);
+        }
+    }
+}
+
+/**
+*   Frames a channel keeps: none when every frame is within Tolerance of the reference pose, one when every frame is within
+*   Tolerance of the first, otherwise the fewest frames whose interpolated decoded keys stay within Tolerance of every raw frame.
+*/
+template<typename ValueType, typename InterpolateType, typename ErrorType>
+static void SelectKeyFrames(const TArray<ValueType>& Raw, const TArray<ValueType>& Decoded, const ValueType& RefValue, float Tolerance,
+    InterpolateType Interpolate, ErrorType GetError, TArray<int32>& OutFrames)
+{
+    OutFrames.Reset();
+    if (Raw.Num() == 0)
+    {
+        return;
+    }
+
+    bool bReference = true;
+    bool bConstant = true;
+    for (int32 Frame = 0; Frame < Raw.Num() && (bReference || bConstant); Frame++)
+    {
+        bReference = bReference && GetError(Raw[Frame], RefValue) <= Tolerance;
+        bConstant = bConstant && GetError(Raw[Frame], Decoded[0]) <= Tolerance;
+    }
+
+    if (bReference)
+    {
+        return;
+    }
+
+    OutFrames.Add(0);
+    if (bConstant)
+    {
+        return;
+    }
+
+    // Greedy, every key reaches as far as the interpolation holds
+    int32 KeyFrame = 0;
+    while (KeyFrame < Raw.Num() - 1)
+    {
+        int32 NextKeyFrame = KeyFrame + 1;
+        for (int32 Candidate = NextKeyFrame + 1; Candidate < Raw.Num(); Candidate++)
+        {
+            bool bWithinTolerance = true;
+            for (int32 Frame = KeyFrame + 1; Frame < Candidate && bWithinTolerance; Frame++)
+            {
+                const float Alpha = float(Frame - KeyFrame) / float(Candidate - KeyFrame);
+                bWithinTolerance = GetError(Interpolate(Decoded[KeyFrame], Decoded[Candidate], Alpha), Raw[Frame]) <= Tolerance;
+            }
+
+            if (!bWithinTolerance)
+            {
+                break;
+            }
+            NextKeyFrame = Candidate;
+        }
+
+        OutFrames.Add(NextKeyFrame);
+        KeyFrame = NextKeyFrame;
+    }
+}
+
+/** Min and extent of the values of a vector channel */
+static void GetRange(const TArray<FVector3f>& Values, float* OutMin, float* OutExtent)
+{
+    FVector3f Min = Values[0];
+    FVector3f Max = Values[0];
+    for (const FVector3f& Value : Values)
+    {
+        Min = FVector3f::Min(Min, Value);
+        Max = FVector3f::Max(Max, Value);
+    }
+
+    for (int32 iComponent = 0; iComponent < 3; iComponent++)
+    {
+        OutMin[iComponent] = Min[iComponent];
+        OutExtent[iComponent] = Max[iComponent] - Min[iComponent];
+    }
+}
+
+/** Component space reference pose distance from every bone to its farthest descendant, plus the shell */
+static void GetEffectorDistances(const FAnimSkeleton& Skeleton, float ShellDistance, TArray<float>& OutDistances)
+{
+    const int32 NumBones = Skeleton.RefPose.Num();
+
+    TArray<FTransform3f> ComponentPose;
+    ComponentPose.SetNum(NumBones);
+    for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+    {
+        const int32 ParentIndex = Skeleton.Parents[BoneIndex];
+        ComponentPose[BoneIndex] = ParentIndex != INDEX_NONE ? Skeleton.RefPose[BoneIndex] * ComponentPose[ParentIndex] : Skeleton.RefPose[BoneIndex];
+    }
+
+    OutDistances.Init(0.0f, NumBones);
+    for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+    {
+        const FVector3f Location = ComponentPose[BoneIndex].GetLocation();
+        for (int32 Ancestor = BoneIndex; Ancestor != INDEX_NONE; Ancestor = Skeleton.Parents[Ancestor])
+        {
+            OutDistances[Ancestor] = FMath::Max(OutDistances[Ancestor], (Location - ComponentPose[Ancestor].GetLocation()).Size());
+        }
+    }
+
+    for (float& Distance : OutDistances)
+    {
+        Distance += ShellDistance;
+    }
+}
+
+/** Quantize the channels of every track and keep the frames each needs within ToleranceScale times the tolerance */
+static void BuildCompressedAnimation(const TArray<FRawAnimTrack>& Tracks, int32 NumFrames, const FAnimSkeleton& Skeleton, const FAnimCompressionSettings& Settings,
+    const TArray<float>& EffectorDistances, float ToleranceScale, FCompressedAnimation& OutAnimation, FAnimCompressionReport& OutReport)
+{
+    OutAnimation.NumFrames = NumFrames;
+    OutAnimation.Tracks.Reset();
+    OutAnimation.RotKeys.Reset();
+    OutAnimation.PosKeys.Reset();
+    OutAnimation.ScaleKeys.Reset();
+    OutReport.NumKeys = 0;
+    OutReport.NumStrippedTracks = 0;
+    OutReport.NumConstantChannels = 0;
+
+    const float Tolerance = Settings.ErrorTolerance * ToleranceScale;
+
+    TArray<FQuat4f> RawRotations, DecodedRotations;
+    TArray<FVector3f> RawVectors, DecodedVectors;
+    TArray<uint16> EncodedKeys;
+    TArray<int32> KeyFrames;
+
+    auto AddKeys = [&](TArray<uint16>& Stream, uint32& OutFirstKey, uint32& OutNumKeys)
+    {
+        OutFirstKey = uint32(Stream.Num() / KEY_COMPONENTS);
+        OutNumKeys = uint32(KeyFrames.Num());
+        for (int32 Frame : KeyFrames)
+        {
+            EncodedKeys[Frame * KEY_COMPONENTS] |= uint16(Frame);
+            Stream.Append(&EncodedKeys[Frame * KEY_COMPONENTS], KEY_COMPONENTS);
+        }
+
+        OutReport.NumKeys += KeyFrames.Num();
+        OutReport.NumConstantChannels += KeyFrames.Num() == 1 ? 1 : 0;
+    };
+
+    for (const FRawAnimTrack& Track : Tracks)
+    {
+        if (!Skeleton.RefPose.IsValidIndex(Track.BoneIndex))
+        {
+            continue;
+        }
+
+        const FTransform3f& RefPose = Skeleton.RefPose[Track.BoneIndex];
+        const float EffectorDistance = EffectorDistances[Track.BoneIndex];
+
+        REngineFormat::CompressedAnimTrack CompressedTrack = {};
+        CompressedTrack.BoneIndex = Track.BoneIndex;
+
+        // Rotation, the angle that moves the farthest virtual vertex by the tolerance
+        const float MaxAngle = 2.0f * FMath::Asin(FMath::Min(Tolerance / (2.0f * EffectorDistance), 1.0f));
+        ExpandRawKeys(Track.RotKeys, NumFrames, RawRotations);
+        EncodedKeys.SetNumZeroed(RawRotations.Num() * KEY_COMPONENTS);
+        DecodedRotations.SetNumUninitialized(RawRotations.Num());
+        for (int32 Frame = 0; Frame < RawRotations.Num(); Frame++)
+        {
+            EncodeRotation(RawRotations[Frame], &EncodedKeys[Frame * KEY_COMPONENTS]);
+            DecodedRotations[Frame] = DecodeRotation(&EncodedKeys[Frame * KEY_COMPONENTS]);
+        }
+        SelectKeyFrames(RawRotations, DecodedRotations, RefPose.GetRotation(), MaxAngle, InterpolateRotation,
+            [](const FQuat4f& A, const FQuat4f& B) { return A.AngularDistance(B); }, KeyFrames);
+        AddKeys(OutAnimation.RotKeys, CompressedTrack.FirstRotKey, CompressedTrack.NumRotKeys);
+
+        // Translation
+        ExpandRawKeys(Track.PosKeys, NumFrames, RawVectors);
+        if (RawVectors.Num() > 0)
+        {
+            GetRange(RawVectors, CompressedTrack.PosMin, CompressedTrack.PosExtent);
+        }
+        EncodedKeys.SetNumZeroed(RawVectors.Num() * KEY_COMPONENTS);
+        DecodedVectors.SetNumUninitialized(RawVectors.Num());
+        for (int32 Frame = 0; Frame < RawVectors.Num(); Frame++)
+        {
+            EncodeRange(RawVectors[Frame], CompressedTrack.PosMin, CompressedTrack.PosExtent, &EncodedKeys[Frame * KEY_COMPONENTS]);
+            DecodedVectors[Frame] = DecodeRange(&EncodedKeys[Frame * KEY_COMPONENTS], CompressedTrack.PosMin, CompressedTrack.PosExtent);
+        }
+        SelectKeyFrames(RawVectors, DecodedVectors, RefPose.GetTranslation(), Tolerance, InterpolateVector,
+            [](const FVector3f& A, const FVector3f& B) { return (A - B).Size(); }, KeyFrames);
+        AddKeys(OutAnimation.PosKeys, CompressedTrack.FirstPosKey, CompressedTrack.NumPosKeys);
+
+        // Scale, scaling by s moves the farthest virtual vertex by s times its distance
+        ExpandRawKeys(Track.ScaleKeys, NumFrames, RawVectors);
+        if (RawVectors.Num() > 0)
+        {
+            GetRange(RawVectors, CompressedTrack.ScaleMin, CompressedTrack.ScaleExtent);
+        }
+        EncodedKeys.SetNumZeroed(RawVectors.Num() * KEY_COMPONENTS);
+        DecodedVectors.SetNumUninitialized(RawVectors.Num());
+        for (int32 Frame = 0; Frame < RawVectors.Num(); Frame++)
+        {
+            EncodeRange(RawVectors[Frame], CompressedTrack.ScaleMin, CompressedTrack.ScaleExtent, &EncodedKeys[Frame * KEY_COMPONENTS]);
+            DecodedVectors[Frame] = DecodeRange(&EncodedKeys[Frame * KEY_COMPONENTS], CompressedTrack.ScaleMin, CompressedTrack.ScaleExtent);
+        }
+        SelectKeyFrames(RawVectors, DecodedVectors, RefPose.GetScale3D(), Tolerance / EffectorDistance, InterpolateVector,
+            [](const FVector3f& A, const FVector3f& B) { return (A - B).Size(); }, KeyFrames);
+        AddKeys(OutAnimation.ScaleKeys, CompressedTrack.FirstScaleKey, CompressedTrack.NumScaleKeys);
+
+        if (CompressedTrack.NumRotKeys + CompressedTrack.NumPosKeys + CompressedTrack.NumScaleKeys == 0)
+        {
+            OutReport.NumStrippedTracks++;
+            continue;
+        }
+
+        OutAnimation.Tracks.Add(CompressedTrack);
+    }
+
+    OutReport.CompressedSize = OutAnimation.GetDataSize();
+}
+
+static void GetComponentPose(const FAnimSkeleton& Skeleton, const TArray<FTransform3f>& LocalPose, TArray<FTransform3f>& OutComponentPose)
+{
+    OutComponentPose.SetNum(LocalPose.Num());
+    for (int32 BoneIndex = 0; BoneIndex < LocalPose.Num(); BoneIndex++)
+    {
+        const int32 ParentIndex = Skeleton.Parents[BoneIndex];
+        OutComponentPose[BoneIndex] = ParentIndex != INDEX_NONE ? LocalPose[BoneIndex] * OutComponentPose[ParentIndex] : LocalPose[BoneIndex];
+    }
+}
+
+/** Largest displacement of the bone origins and the virtual vertices on their axes between the raw and the compressed poses */
+static void MeasureError(const TArray<FRawAnimTrack>& Tracks, int32 NumFrames, const FAnimSkeleton& Skeleton, const FAnimCompressionSettings& Settings,
+    const FCompressedAnimation& Animation, FAnimCompressionReport& OutReport)
+{
+    OutReport.MaxError = 0.0f;
+    OutReport.MaxErrorBone = INDEX_NONE;
+    OutReport.MaxErrorFrame = 0;
+
+    const FVector3f ShellVertices[4] = { FVector3f::ZeroVector, FVector3f(Settings.ShellDistance, 0.0f, 0.0f),
+        FVector3f(0.0f, Settings.ShellDistance, 0.0f), FVector3f(0.0f, 0.0f, Settings.ShellDistance) };
+
+    TArray<FTransform3f> RawPose, CompressedPose, RawComponentPose, CompressedComponentPose;
+    for (int32 Frame = 0; Frame < NumFrames; Frame++)
+    {
+        RawPose = Skeleton.RefPose;
+        for (const FRawAnimTrack& Track : Tracks)
+        {
+            if (RawPose.IsValidIndex(Track.BoneIndex))
+            {
+                FTransform3f& Local = RawPose[Track.BoneIndex];
+                if (Track.RotKeys.Num() > 0)
+                {
+                    Local.SetRotation(Track.RotKeys[FMath::Min(Frame, Track.RotKeys.Num() - 1)].GetNormalized());
+                }
+                if (Track.PosKeys.Num() > 0)
+                {
+                    Local.SetTranslation(Track.PosKeys[FMath::Min(Frame, Track.PosKeys.Num() - 1)]);
+                }
+                if (Track.ScaleKeys.Num() > 0)
+                {
+                    Local.SetScale3D(Track.ScaleKeys[FMath::Min(Frame, Track.ScaleKeys.Num() - 1)]);
+                }
+            }
+        }
+        SampleCompressedAnimation(Animation, Skeleton, float(Frame), CompressedPose);
+
+        GetComponentPose(Skeleton, RawPose, RawComponentPose);
+        GetComponentPose(Skeleton, CompressedPose, CompressedComponentPose);
+
+        for (int32 BoneIndex = 0; BoneIndex < RawComponentPose.Num(); BoneIndex++)
+        {
+            for (const FVector3f& ShellVertex : ShellVertices)
+            {
+                const float Error = (RawComponentPose[BoneIndex].TransformPosition(ShellVertex) - CompressedComponentPose[BoneIndex].TransformPosition(ShellVertex)).Size();
+                if (Error > OutReport.MaxError)
+                {
+                    OutReport.MaxError = Error;
+                    OutReport.MaxErrorBone = BoneIndex;
+                    OutReport.MaxErrorFrame = Frame;
+                }
+            }
+        }
+    }
+}
+
+bool CompressAnimation(const TArray<FRawAnimTrack>& Tracks, int32 NumFrames, const FAnimSkeleton& Skeleton, const FAnimCompressionSettings& Settings,
+    FCompressedAnimation& OutAnimation, FAnimCompressionReport& OutReport)
+{
+    check(Skeleton.Parents.Num() == Skeleton.RefPose.Num());
+
+    OutReport = FAnimCompressionReport();
+    if (NumFrames > MAX_COMPRESSED_FRAMES)
+    {
+        return false;
+    }
+    NumFrames = FMath::Max(NumFrames, 1);
+
+    OutReport.RawSize = Tracks.Num() * sizeof(REngineFormat::AnimTrack);
+    for (const FRawAnimTrack& Track : Tracks)
+    {
+        OutReport.RawSize += Track.PosKeys.Num() * sizeof(FVector3f) + Track.RotKeys.Num() * sizeof(FQuat4f) + Track.ScaleKeys.Num() * sizeof(FVector3f);
+        OutReport.NumRawKeys += Track.PosKeys.Num() + Track.RotKeys.Num() + Track.ScaleKeys.Num();
+    }
+
+    TArray<float> EffectorDistances;
+    GetEffectorDistances(Skeleton, FMath::Max(Settings.ShellDistance, KINDA_SMALL_NUMBER), EffectorDistances);
+
+    // The channel tolerances hold each bone to the tolerance alone, errors along a chain can add up so they are tightened until the whole pose holds
+    float ToleranceScale = 1.0f;
+    for (int32 Step = 0; Step <= TOLERANCE_REFINE_STEPS; Step++)
+    {
+        BuildCompressedAnimation(Tracks, NumFrames, Skeleton, Settings, EffectorDistances, ToleranceScale, OutAnimation, OutReport);
+        MeasureError(Tracks, NumFrames, Skeleton, Settings, OutAnimation, OutReport);
+
+        if (OutReport.MaxError <= Settings.ErrorTolerance)
+        {
+            break;
+        }
+        ToleranceScale *= 0.5f;
+    }
+
+    return true;
+}
+
+/** Keys around a frame of a channel, four uint16 per key starting with its frame */
+static void FindKeys(const uint16* Keys, uint32 NumKeys, float Frame, const uint16*& OutKey0, const uint16*& OutKey1, float& OutAlpha)
+{
+    // Last key at or before the frame
+    int32 Low = 0;
+    int32 High = int32(NumKeys) - 1;
+    while (Low < High)
+    {
+        const int32 Middle = (Low + High + 1) / 2;
+        if ((Keys[Middle * KEY_COMPONENTS] & KEY_FRAME_MASK) <= Frame)
+        {
+            Low = Middle;
+        }
+        else
+        {
+            High = Middle - 1;
+        }
+    }
+
+    const int32 Next = FMath::Min(Low + 1, int32(NumKeys) - 1);
+    OutKey0 = Keys + Low * KEY_COMPONENTS;
+    OutKey1 = Keys + Next * KEY_COMPONENTS;
+
+    const float Frame0 = OutKey0[0] & KEY_FRAME_MASK;
+    const float Frame1 = OutKey1[0] & KEY_FRAME_MASK;
+    OutAlpha = Frame1 > Frame0 ? FMath::Clamp((Frame - Frame0) / (Frame1 - Frame0), 0.0f, 1.0f) : 0.0f;
+}
+
+void SampleCompressedAnimation(const FCompressedAnimation& Animation, const FAnimSkeleton& Skeleton, float Frame, TArray<FTransform3f>& OutLocalPose)
+{
+    OutLocalPose = Skeleton.RefPose;
+
+    const uint16* Key0;
+    const uint16* Key1;
+    float Alpha;
+    for (const REngineFormat::CompressedAnimTrack& Track : Animation.Tracks)
+    {
+        if (!OutLocalPose.IsValidIndex(Track.BoneIndex))
+        {
+            continue;
+        }
+
+        FTransform3f& Local = OutLocalPose[Track.BoneIndex];
+        if (Track.NumRotKeys > 0)
+        {
+            FindKeys(&Animation.RotKeys[Track.FirstRotKey * KEY_COMPONENTS], Track.NumRotKeys, Frame, Key0, Key1, Alpha);
+            Local.SetRotation(InterpolateRotation(DecodeRotation(Key0), DecodeRotation(Key1), Alpha));
+        }
+        if (Track.NumPosKeys > 0)
+        {
+            FindKeys(&Animation.PosKeys[Track.FirstPosKey * KEY_COMPONENTS], Track.NumPosKeys, Frame, Key0, Key1, Alpha);
+            Local.SetTranslation(InterpolateVector(DecodeRange(Key0, Track.PosMin, Track.PosExtent), DecodeRange(Key1, Track.PosMin, Track.PosExtent), Alpha));
+        }
+        if (Track.NumScaleKeys > 0)
+        {
+            FindKeys(&Animation.ScaleKeys[Track.FirstScaleKey * KEY_COMPONENTS], Track.NumScaleKeys, Frame, Key0, Key1, Alpha);
+            Local.SetScale3D(InterpolateVector(DecodeRange(Key0, Track.ScaleMin, Track.ScaleExtent), DecodeRange(Key1, Track.ScaleMin, Track.ScaleExtent), Alpha));
+        }
+    }
+}
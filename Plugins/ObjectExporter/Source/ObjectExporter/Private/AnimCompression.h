@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Raw keys of one bone, one key per frame or a single key for the whole sequence */
+struct FRawAnimTrack
+{
+    int32 BoneIndex;
+    TArray<FVector3f> PosKeys;
+    TArray<FQuat4f> RotKeys;
+    TArray<FVector3f> ScaleKeys;
+};
+
+/** Reference skeleton the tracks animate, parents come before their children */
+struct FAnimSkeleton
+{
+    TArray<int32> Parents;
+    TArray<FTransform3f> RefPose;
+};
+
+struct FAnimCompressionSettings
+{
+    /** Largest distance a point of the skinned mesh may move, in cm */
+    float ErrorTolerance = 0.1f;
+    /** Distance of the virtual vertices around every bone the error is measured on, in cm */
+    float ShellDistance = 3.0f;
+};
+
+/** Tracks and key streams of the compressed chunks, see REngineFormat::CompressedAnimTrack */
+struct FCompressedAnimation
+{
+    int32 NumFrames = 0;
+    TArray<REngineFormat::CompressedAnimTrack> Tracks;
+    TArray<uint16> RotKeys;
+    TArray<uint16> PosKeys;
+    TArray<uint16> ScaleKeys;
+
+    int64 GetDataSize() const
+    {
+        return Tracks.Num() * sizeof(REngineFormat::CompressedAnimTrack) + (RotKeys.Num() + PosKeys.Num() + ScaleKeys.Num()) * sizeof(uint16);
+    }
+};
+
+struct FAnimCompressionReport
+{
+    int64 RawSize = 0;
+    int64 CompressedSize = 0;
+    /** Largest displacement of a virtual vertex over all frames, in cm */
+    float MaxError = 0.0f;
+    int32 MaxErrorBone = INDEX_NONE;
+    int32 MaxErrorFrame = 0;
+    int32 NumRawKeys = 0;
+    int32 NumKeys = 0;
+    int32 NumStrippedTracks = 0;
+    int32 NumConstantChannels = 0;
+};
+
+/**
+*   Compress the tracks of a sequence. Channels matching the reference pose are dropped and constant ones keep a single key,
+*   the others keep the fewest keys that interpolate to the raw pose within the tolerance. The error is measured in component space
+*   on virtual vertices around every bone, so a bone far up a chain is held tighter than a finger tip.
+*   False when the sequence has more frames than a key can address.
+*/
+bool CompressAnimation(const TArray<FRawAnimTrack>& Tracks, int32 NumFrames, const FAnimSkeleton& Skeleton, const FAnimCompressionSettings& Settings,
+    FCompressedAnimation& OutAnimation, FAnimCompressionReport& OutReport);
+
+/** Local pose of every skeleton bone at a frame, fractional frames interpolate. Bones without a track keep the reference pose */
+void SampleCompressedAnimation(const FCompressedAnimation& Animation, const FAnimSkeleton& Skeleton, float Frame, TArray<FTransform3f>& OutLocalPose);
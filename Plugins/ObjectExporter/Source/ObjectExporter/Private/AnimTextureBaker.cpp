@@ -0,0 +1,258 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "AnimTextureBaker.h"
+#include "Async/ParallelFor.h"
+
+// Largest width and height of a 2D texture on D3D11 class hardware
+#define MAX_ANIM_TEXTURE_SIZE 16384
+#define BONE_MATRIX_TEXELS 3
+#define TEXEL_COMPONENTS 4
+
+int64 FAnimTextureSource::GetAllocatedSize() const
+{
+    int64 Size = Skeleton.Parents.GetAllocatedSize() + Skeleton.RefPose.GetAllocatedSize() + Tracks.GetAllocatedSize()
+        + Vertices.GetAllocatedSize() + Influences.GetAllocatedSize();
+    for (const FRawAnimTrack& Track : Tracks)
+    {
+        Size += Track.PosKeys.GetAllocatedSize() + Track.RotKeys.GetAllocatedSize() + Track.ScaleKeys.GetAllocatedSize();
+    }
+
+    return Size;
+}
+
+/** Keys around a frame of a channel with one key per frame, or its only key */
+static float FindKeys(int32 NumKeys, float Frame, int32& OutKey0, int32& OutKey1)
+{
+    const float Clamped = FMath::Clamp(Frame, 0.0f, float(NumKeys - 1));
+    OutKey0 = FMath::Min(FMath::FloorToInt32(Clamped), NumKeys - 1);
+    OutKey1 = FMath::Min(OutKey0 + 1, NumKeys - 1);
+
+    return Clamped - float(OutKey0);
+}
+
+static void GetLocalPose(const FAnimTextureSource& Source, float Frame, TArray<FTransform3f>& OutLocalPose)
+{
+    OutLocalPose = Source.Skeleton.RefPose;
+
+    int32 Key0, Key1;
+    for (const FRawAnimTrack& Track : Source.Tracks)
+    {
+        if (!OutLocalPose.IsValidIndex(Track.BoneIndex))
+        {
+            continue;
+        }
+
+        FTransform3f& Local = OutLocalPose[Track.BoneIndex];
+        if (Track.RotKeys.Num() > 0)
+        {
+            const float Alpha = FindKeys(Track.RotKeys.Num(), Frame, Key0, Key1);
+            Local.SetRotation(FQuat4f::FastLerp(Track.RotKeys[Key0], Track.RotKeys[Key1], Alpha).GetNormalized());
+        }
+        if (Track.PosKeys.Num() > 0)
+        {
+            const float Alpha = FindKeys(Track.PosKeys.Num(), Frame, Key0, Key1);
+            Local.SetTranslation(FMath::Lerp(Track.PosKeys[Key0], Track.PosKeys[Key1], Alpha));
+        }
+        if (Track.ScaleKeys.Num() > 0)
+        {
+            const float Alpha = FindKeys(Track.ScaleKeys.Num(), Frame, Key0, Key1);
+            Local.SetScale3D(FMath::Lerp(Track.ScaleKeys[Key0], Track.ScaleKeys[Key1], Alpha));
+        }
+    }
+}
+
+/** Component space pose, parents come before their children */
+static void GetComponentPose(const FAnimSkeleton& Skeleton, TArray<FTransform3f>& InOutPose)
+{
+    for (int32 BoneIndex = 0; BoneIndex < InOutPose.Num(); BoneIndex++)
+    {
+        const int32 ParentIndex = Skeleton.Parents[BoneIndex];
+        if (ParentIndex != INDEX_NONE)
+        {
+            InOutPose[BoneIndex] = InOutPose[BoneIndex] * InOutPose[ParentIndex];
+        }
+    }
+}
+
+static void WriteTexel(FAnimTexture& Texture, int64 Texel, const FVector4f& Value)
+{
+    for (int32 Component = 0; Component < TEXEL_COMPONENTS; Component++)
+    {
+        if (Texture.HalfTexels.Num() > 0)
+        {
+            Texture.HalfTexels[Texel * TEXEL_COMPONENTS + Component] = FFloat16(Value[Component]).Encoded;
+        }
+        else
+        {
+            Texture.FloatTexels[Texel * TEXEL_COMPONENTS + Component] = Value[Component];
+        }
+    }
+}
+
+static FVector4f ReadTexel(const FAnimTexture& Texture, int64 Texel)
+{
+    FVector4f Value;
+    for (int32 Component = 0; Component < TEXEL_COMPONENTS; Component++)
+    {
+        if (Texture.HalfTexels.Num() > 0)
+        {
+            FFloat16 Half;
+            Half.Encoded = Texture.HalfTexels[Texel * TEXEL_COMPONENTS + Component];
+            Value[Component] = Half.GetFloat();
+        }
+        else
+        {
+            Value[Component] = Texture.FloatTexels[Texel * TEXEL_COMPONENTS + Component];
+        }
+    }
+
+    return Value;
+}
+
+static float Dot4(const FVector4f& Row, const FVector3f& Position)
+{
+    return Row.X * Position.X + Row.Y * Position.Y + Row.Z * Position.Z + Row.W;
+}
+
+bool BakeAnimTexture(const FAnimTextureSource& Source, const FAnimTextureSettings& Settings, FAnimTexture& OutTexture)
+{
+    using namespace REngineFormat;
+
+    check(Source.Skeleton.Parents.Num() == Source.Skeleton.RefPose.Num());
+
+    const int32 NumBones = Source.Skeleton.RefPose.Num();
+    const bool bBoneMatrices = Settings.Mode == EAnimTextureMode::BoneMatrices;
+    const float FrameRate = FMath::Max(Settings.FrameRate, 1.0f);
+
+    // The first sample at 0, the last at the sequence length
+    const int32 NumSamples = Source.SequenceLength > 0.0f && Source.NumFrames > 1 ? FMath::CeilToInt32(Source.SequenceLength * FrameRate - KINDA_SMALL_NUMBER) + 1 : 1;
+
+    AnimTextureInfo& Info = OutTexture.Info;
+    Info = {};
+    Info.Mode = uint32(Settings.Mode);
+    Info.Format = uint32(Settings.Format);
+    Info.NumFrames = uint32(NumSamples);
+    Info.FrameRate = FrameRate;
+    Info.SequenceLength = Source.SequenceLength;
+    Info.NumElements = uint32(bBoneMatrices ? NumBones : Source.Vertices.Num());
+    Info.TexelsPerElement = bBoneMatrices ? BONE_MATRIX_TEXELS : (Settings.bNormals ? 2 : 1);
+    Info.TexelsPerFrame = Info.NumElements * Info.TexelsPerElement;
+
+    // A frame per row while it fits, so the shader addresses texels by element and frame
+    const int64 NumTexels = int64(Info.TexelsPerFrame) * NumSamples;
+    const int32 MaxWidth = FMath::Clamp(Settings.MaxWidth, 1, MAX_ANIM_TEXTURE_SIZE);
+    Info.Width = FMath::Min(Info.TexelsPerFrame, uint32(MaxWidth));
+    if (Info.Width == 0 || (!bBoneMatrices && Source.Influences.Num() != Source.Vertices.Num()))
+    {
+        return false;
+    }
+    const int64 Height = (NumTexels + Info.Width - 1) / Info.Width;
+    if (Height > MAX_ANIM_TEXTURE_SIZE)
+    {
+        return false;
+    }
+    Info.Height = uint32(Height);
+
+    const int64 NumComponents = int64(Info.Width) * Info.Height * TEXEL_COMPONENTS;
+    OutTexture.HalfTexels.Reset();
+    OutTexture.FloatTexels.Reset();
+    if (Settings.Format == EAnimTextureFormat::Float16x4)
+    {
+        OutTexture.HalfTexels.SetNumZeroed(int32(NumComponents));
+    }
+    else
+    {
+        OutTexture.FloatTexels.SetNumZeroed(int32(NumComponents));
+    }
+
+    // Skinning matrices take bind pose positions back to bone space first
+    TArray<FTransform3f> BindPose = Source.Skeleton.RefPose;
+    GetComponentPose(Source.Skeleton, BindPose);
+    TArray<FMatrix44f> InvBindMatrices;
+    InvBindMatrices.SetNumUninitialized(NumBones);
+    for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+    {
+        InvBindMatrices[BoneIndex] = BindPose[BoneIndex].ToMatrixWithScale().Inverse();
+    }
+
+    TArray<float> SampleErrors;
+    SampleErrors.SetNumZeroed(NumSamples);
+    ParallelFor(NumSamples, [&](int32 Sample)
+    {
+        const float Time = FMath::Min(Sample / FrameRate, Source.SequenceLength);
+        const float Frame = Source.SequenceLength > 0.0f ? Time / Source.SequenceLength * float(Source.NumFrames - 1) : 0.0f;
+
+        TArray<FTransform3f> Pose;
+        GetLocalPose(Source, Frame, Pose);
+        GetComponentPose(Source.Skeleton, Pose);
+
+        TArray<FMatrix44f> SkinMatrices;
+        SkinMatrices.SetNumUninitialized(NumBones);
+        for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+        {
+            SkinMatrices[BoneIndex] = InvBindMatrices[BoneIndex] * Pose[BoneIndex].ToMatrixWithScale();
+        }
+
+        const int64 FirstTexel = int64(Sample) * Info.TexelsPerFrame;
+        float MaxError = 0.0f;
+        if (bBoneMatrices)
+        {
+            for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+            {
+                const FMatrix44f& Matrix = SkinMatrices[BoneIndex];
+                const int64 Texel = FirstTexel + int64(BoneIndex) * BONE_MATRIX_TEXELS;
+                for (int32 Row = 0; Row < BONE_MATRIX_TEXELS; Row++)
+                {
+                    WriteTexel(OutTexture, Texel + Row, FVector4f(Matrix.M[0][Row], Matrix.M[1][Row], Matrix.M[2][Row], Matrix.M[3][Row]));
+                }
+
+                // Error at the bone, where the vertices it weighs most are
+                const FVector3f BindPosition = BindPose[BoneIndex].GetTranslation();
+                const FVector3f Stored(Dot4(ReadTexel(OutTexture, Texel), BindPosition), Dot4(ReadTexel(OutTexture, Texel + 1), BindPosition),
+                    Dot4(ReadTexel(OutTexture, Texel + 2), BindPosition));
+                MaxError = FMath::Max(MaxError, (Stored - Matrix.TransformPosition(BindPosition)).Size());
+            }
+        }
+        else
+        {
+            for (int32 VertexIndex = 0; VertexIndex < Source.Vertices.Num(); VertexIndex++)
+            {
+                const StaticMeshVertex& Vertex = Source.Vertices[VertexIndex];
+                const FVertexInfluences& Influences = Source.Influences[VertexIndex];
+
+                // Linear blend skinning, as the runtime skins the mesh
+                FMatrix44f Matrix(ForceInitToZero);
+                for (int32 Influence = 0; Influence < Influences.NumInfluences; Influence++)
+                {
+                    if (SkinMatrices.IsValidIndex(Influences.Bones[Influence]))
+                    {
+                        Matrix += SkinMatrices[Influences.Bones[Influence]] * (Influences.Weights[Influence] / 255.0f);
+                    }
+                }
+
+                const FVector3f BindPosition(Vertex.Position[0], Vertex.Position[1], Vertex.Position[2]);
+                const FVector3f Offset = Matrix.TransformPosition(BindPosition) - BindPosition;
+                const int64 Texel = FirstTexel + int64(VertexIndex) * Info.TexelsPerElement;
+                WriteTexel(OutTexture, Texel, FVector4f(Offset.X, Offset.Y, Offset.Z, 0.0f));
+                if (Settings.bNormals)
+                {
+                    const FVector3f Normal = Matrix.TransformVector(FVector3f(Vertex.Normal[0], Vertex.Normal[1], Vertex.Normal[2])).GetSafeNormal();
+                    WriteTexel(OutTexture, Texel + 1, FVector4f(Normal.X, Normal.Y, Normal.Z, 0.0f));
+                }
+
+                const FVector4f Stored = ReadTexel(OutTexture, Texel);
+                MaxError = FMath::Max(MaxError, (FVector3f(Stored.X, Stored.Y, Stored.Z) - Offset).Size());
+            }
+        }
+
+        SampleErrors[Sample] = MaxError;
+    });
+
+    OutTexture.MaxError = 0.0f;
+    for (float Error : SampleErrors)
+    {
+        OutTexture.MaxError = FMath::Max(OutTexture.MaxError, Error);
+    }
+
+    return true;
+}
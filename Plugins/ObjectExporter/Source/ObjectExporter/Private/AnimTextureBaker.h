@@ -0,0 +1,57 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimCompression.h"
+#include "REngineFormat.h"
+#include "SkinPalette.h"
+
+/** Sequence and mesh an animation texture is baked from, copied on the game thread */
+struct FAnimTextureSource
+{
+    /** Reference skeleton of the mesh, the tracks animate its bones */
+    FAnimSkeleton Skeleton;
+    TArray<FRawAnimTrack> Tracks;
+    int32 NumFrames = 0;
+    float SequenceLength = 0.0f;
+    /** Bind pose vertices and their influences with reference skeleton bones, for vertex animation textures only */
+    TArray<REngineFormat::StaticMeshVertex> Vertices;
+    TArray<FVertexInfluences> Influences;
+
+    int64 GetAllocatedSize() const;
+};
+
+struct FAnimTextureSettings
+{
+    REngineFormat::EAnimTextureMode Mode = REngineFormat::EAnimTextureMode::BoneMatrices;
+    REngineFormat::EAnimTextureFormat Format = REngineFormat::EAnimTextureFormat::Float16x4;
+    float FrameRate = 30.0f;
+    /** Vertex animation textures keep a normal texel per vertex */
+    bool bNormals = true;
+    /** Widest row, a frame wraps to the next rows when it has more texels */
+    int32 MaxWidth = 2048;
+};
+
+struct FAnimTexture
+{
+    REngineFormat::AnimTextureInfo Info = {};
+    /** Texels of a Float16x4 texture */
+    TArray<uint16> HalfTexels;
+    /** Texels of a Float32x4 texture */
+    TArray<float> FloatTexels;
+    /** Largest distance a skinned point moves because of the texel precision, in cm */
+    float MaxError = 0.0f;
+
+    int64 GetDataSize() const
+    {
+        return HalfTexels.Num() * sizeof(uint16) + FloatTexels.Num() * sizeof(float);
+    }
+};
+
+/**
+*   Sample the sequence at Settings.FrameRate and write the skinning matrix of every bone, or the skinned position and normal of
+*   every vertex, of every frame to a texture. Frames are baked in parallel.
+*   False when the texture would be larger than a GPU texture may be.
+*/
+bool BakeAnimTexture(const FAnimTextureSource& Source, const FAnimTextureSettings& Settings, FAnimTexture& OutTexture);
@@ -0,0 +1,658 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BCEncoder.h"
+
+#define BC_REFINE_ITERATIONS 2
+#define BC_POWER_ITERATIONS 8
+#define BC6H_MAX_HALF 0x7bff
+
+// Interpolation weights of the 4 bit index modes of BC6H and BC7
+static const int32 BC_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/** Writes fields LSB first, the bit order of BC6H and BC7 blocks */
+class FBlockBitWriter
+{
+public:
+    explicit FBlockBitWriter(uint8 InBlock[16])
+        : Block(InBlock)
+        , BitOffset(0)
+    {
+        FMemory::Memzero(Block, 16);
+    }
+
+    void Write(uint32 Value, int32 NumBits)
+    {
+        for (int32 iBit = 0; iBit < NumBits; iBit++, BitOffset++)
+        {
+            Block[BitOffset >> 3] |= uint8(((Value >> iBit) & 1) << (BitOffset & 7));
+        }
+    }
+
+private:
+    uint8* Block;
+    int32 BitOffset;
+};
+
+/** Mean and principal axis of the texels, the axis is zero for a flat block */
+template<int32 NumChannels>
+static void ComputePrincipalAxis(const float Points[16][NumChannels], float OutMean[NumChannels], float OutAxis[NumChannels])
+{
+    float Min[NumChannels];
+    float Max[NumChannels];
+    for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+    {
+        OutMean[iChannel] = 0.0f;
+        Min[iChannel] = Points[0][iChannel];
+        Max[iChannel] = Points[0][iChannel];
+    }
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+        {
+            OutMean[iChannel] += Points[iTexel][iChannel] / 16.0f;
+            Min[iChannel] = FMath::Min(Min[iChannel], Points[iTexel][iChannel]);
+            Max[iChannel] = FMath::Max(Max[iChannel], Points[iTexel][iChannel]);
+        }
+    }
+
+    float Covariance[NumChannels][NumChannels] = {};
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        for (int32 Row = 0; Row < NumChannels; Row++)
+        {
+            for (int32 Column = 0; Column < NumChannels; Column++)
+            {
+                Covariance[Row][Column] += (Points[iTexel][Row] - OutMean[Row]) * (Points[iTexel][Column] - OutMean[Column]);
+            }
+        }
+    }
+
+    // Power iteration from the bounding box diagonal
+    for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+    {
+        OutAxis[iChannel] = Max[iChannel] - Min[iChannel];
+    }
+    for (int32 Iteration = 0; Iteration < BC_POWER_ITERATIONS; Iteration++)
+    {
+        float Next[NumChannels] = {};
+        float LengthSquared = 0.0f;
+        for (int32 Row = 0; Row < NumChannels; Row++)
+        {
+            for (int32 Column = 0; Column < NumChannels; Column++)
+            {
+                Next[Row] += Covariance[Row][Column] * OutAxis[Column];
+            }
+            LengthSquared += Next[Row] * Next[Row];
+        }
+
+        if (LengthSquared < 1e-12f)
+        {
+            break;
+        }
+
+        const float InvLength = 1.0f / FMath::Sqrt(LengthSquared);
+        for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+        {
+            OutAxis[iChannel] = Next[iChannel] * InvLength;
+        }
+    }
+}
+
+/** Endpoints at the extreme projections of the texels on the principal axis */
+template<int32 NumChannels>
+static void FitEndpoints(const float Points[16][NumChannels], float OutEndpoints[2][NumChannels])
+{
+    float Mean[NumChannels];
+    float Axis[NumChannels];
+    ComputePrincipalAxis<NumChannels>(Points, Mean, Axis);
+
+    float MinT = 0.0f;
+    float MaxT = 0.0f;
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        float T = 0.0f;
+        for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+        {
+            T += (Points[iTexel][iChannel] - Mean[iChannel]) * Axis[iChannel];
+        }
+        MinT = FMath::Min(MinT, T);
+        MaxT = FMath::Max(MaxT, T);
+    }
+
+    for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+    {
+        OutEndpoints[0][iChannel] = Mean[iChannel] + Axis[iChannel] * MinT;
+        OutEndpoints[1][iChannel] = Mean[iChannel] + Axis[iChannel] * MaxT;
+    }
+}
+
+/** Least squares endpoints for fixed interpolation weights in [0, 1] towards the second endpoint, false if the system is singular */
+template<int32 NumChannels>
+static bool RefineEndpoints(const float Points[16][NumChannels], const float Weights[16], float OutEndpoints[2][NumChannels])
+{
+    float AA = 0.0f;
+    float AB = 0.0f;
+    float BB = 0.0f;
+    float AX[NumChannels] = {};
+    float BX[NumChannels] = {};
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        const float B = Weights[iTexel];
+        const float A = 1.0f - B;
+        AA += A * A;
+        AB += A * B;
+        BB += B * B;
+        for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+        {
+            AX[iChannel] += A * Points[iTexel][iChannel];
+            BX[iChannel] += B * Points[iTexel][iChannel];
+        }
+    }
+
+    const float Determinant = AA * BB - AB * AB;
+    if (FMath::Abs(Determinant) < 1e-6f)
+    {
+        return false;
+    }
+
+    const float InvDeterminant = 1.0f / Determinant;
+    for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+    {
+        OutEndpoints[0][iChannel] = (BB * AX[iChannel] - AB * BX[iChannel]) * InvDeterminant;
+        OutEndpoints[1][iChannel] = (AA * BX[iChannel] - AB * AX[iChannel]) * InvDeterminant;
+    }
+
+    return true;
+}
+
+template<int32 NumChannels>
+static void GetTexelPoints(const uint8 Texels[16][4], float OutPoints[16][NumChannels])
+{
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        for (int32 iChannel = 0; iChannel < NumChannels; iChannel++)
+        {
+            OutPoints[iTexel][iChannel] = Texels[iTexel][iChannel];
+        }
+    }
+}
+
+// BC1
+
+struct FBC1Candidate
+{
+    uint16 Colors[2];
+    uint32 Indices;
+    float Error;
+};
+
+static uint16 QuantizeColor565(const float Color[3])
+{
+    const int32 R = FMath::Clamp(FMath::RoundToInt(Color[0] * 31.0f / 255.0f), 0, 31);
+    const int32 G = FMath::Clamp(FMath::RoundToInt(Color[1] * 63.0f / 255.0f), 0, 63);
+    const int32 B = FMath::Clamp(FMath::RoundToInt(Color[2] * 31.0f / 255.0f), 0, 31);
+
+    return uint16((R << 11) | (G << 5) | B);
+}
+
+static void ExpandColor565(uint16 Color, int32 OutColor[3])
+{
+    const int32 R = (Color >> 11) & 31;
+    const int32 G = (Color >> 5) & 63;
+    const int32 B = Color & 31;
+    OutColor[0] = (R << 3) | (R >> 2);
+    OutColor[1] = (G << 2) | (G >> 4);
+    OutColor[2] = (B << 3) | (B >> 2);
+}
+
+/** Quantize the endpoints and choose the nearest of the four palette colors for every texel */
+static FBC1Candidate EvaluateBC1(const float Points[16][3], const float Endpoints[2][3])
+{
+    FBC1Candidate Candidate;
+    Candidate.Colors[0] = QuantizeColor565(Endpoints[0]);
+    Candidate.Colors[1] = QuantizeColor565(Endpoints[1]);
+    Candidate.Indices = 0;
+    Candidate.Error = 0.0f;
+
+    // Four color mode needs the first color to be larger
+    if (Candidate.Colors[0] < Candidate.Colors[1])
+    {
+        Swap(Candidate.Colors[0], Candidate.Colors[1]);
+    }
+
+    int32 Palette[4][3];
+    ExpandColor565(Candidate.Colors[0], Palette[0]);
+    ExpandColor565(Candidate.Colors[1], Palette[1]);
+    for (int32 iChannel = 0; iChannel < 3; iChannel++)
+    {
+        Palette[2][iChannel] = (2 * Palette[0][iChannel] + Palette[1][iChannel] + 1) / 3;
+        Palette[3][iChannel] = (Palette[0][iChannel] + 2 * Palette[1][iChannel] + 1) / 3;
+    }
+
+    // Equal colors select the three color mode, where only index 0 is the same color
+    const int32 NumColors = Candidate.Colors[0] == Candidate.Colors[1] ? 1 : 4;
+
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        int32 BestIndex = 0;
+        float BestError = MAX_flt;
+        for (int32 iColor = 0; iColor < NumColors; iColor++)
+        {
+            float Error = 0.0f;
+            for (int32 iChannel = 0; iChannel < 3; iChannel++)
+            {
+                Error += FMath::Square(Points[iTexel][iChannel] - float(Palette[iColor][iChannel]));
+            }
+            if (Error < BestError)
+            {
+                BestError = Error;
+                BestIndex = iColor;
+            }
+        }
+
+        Candidate.Indices |= uint32(BestIndex) << (iTexel * 2);
+        Candidate.Error += BestError;
+    }
+
+    return Candidate;
+}
+
+void EncodeBC1Block(const uint8 Texels[16][4], uint8 OutBlock[8])
+{
+    float Points[16][3];
+    GetTexelPoints<3>(Texels, Points);
+
+    float Endpoints[2][3];
+    FitEndpoints<3>(Points, Endpoints);
+    FBC1Candidate Best = EvaluateBC1(Points, Endpoints);
+
+    // Fraction of the second color in each palette entry
+    static const float IndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    for (int32 Iteration = 0; Iteration < BC_REFINE_ITERATIONS && Best.Error > 0.0f; Iteration++)
+    {
+        float Weights[16];
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            Weights[iTexel] = IndexWeights[(Best.Indices >> (iTexel * 2)) & 3];
+        }
+
+        if (!RefineEndpoints<3>(Points, Weights, Endpoints))
+        {
+            break;
+        }
+
+        const FBC1Candidate Candidate = EvaluateBC1(Points, Endpoints);
+        if (Candidate.Error >= Best.Error)
+        {
+            break;
+        }
+        Best = Candidate;
+    }
+
+    OutBlock[0] = uint8(Best.Colors[0]);
+    OutBlock[1] = uint8(Best.Colors[0] >> 8);
+    OutBlock[2] = uint8(Best.Colors[1]);
+    OutBlock[3] = uint8(Best.Colors[1] >> 8);
+    OutBlock[4] = uint8(Best.Indices);
+    OutBlock[5] = uint8(Best.Indices >> 8);
+    OutBlock[6] = uint8(Best.Indices >> 16);
+    OutBlock[7] = uint8(Best.Indices >> 24);
+}
+
+// BC4
+
+void EncodeBC4Block(const uint8 Texels[16][4], int32 Channel, uint8 OutBlock[8])
+{
+    int32 Min = 255;
+    int32 Max = 0;
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        Min = FMath::Min(Min, int32(Texels[iTexel][Channel]));
+        Max = FMath::Max(Max, int32(Texels[iTexel][Channel]));
+    }
+
+    // Eight value mode, the first endpoint is the larger one
+    int32 Palette[8];
+    Palette[0] = Max;
+    Palette[1] = Min;
+    for (int32 iValue = 2; iValue < 8; iValue++)
+    {
+        Palette[iValue] = ((8 - iValue) * Max + (iValue - 1) * Min + 3) / 7;
+    }
+
+    uint64 Indices = 0;
+    if (Max > Min)
+    {
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            const int32 Value = Texels[iTexel][Channel];
+
+            int32 BestIndex = 0;
+            int32 BestError = MAX_int32;
+            for (int32 iValue = 0; iValue < 8; iValue++)
+            {
+                const int32 Error = FMath::Abs(Value - Palette[iValue]);
+                if (Error < BestError)
+                {
+                    BestError = Error;
+                    BestIndex = iValue;
+                }
+            }
+
+            Indices |= uint64(BestIndex) << (iTexel * 3);
+        }
+    }
+
+    OutBlock[0] = uint8(Max);
+    OutBlock[1] = uint8(Min);
+    for (int32 iByte = 0; iByte < 6; iByte++)
+    {
+        OutBlock[2 + iByte] = uint8(Indices >> (iByte * 8));
+    }
+}
+
+void EncodeBC3Block(const uint8 Texels[16][4], uint8 OutBlock[16])
+{
+    EncodeBC4Block(Texels, 3, OutBlock);
+    EncodeBC1Block(Texels, OutBlock + 8);
+}
+
+void EncodeBC5Block(const uint8 Texels[16][4], uint8 OutBlock[16])
+{
+    EncodeBC4Block(Texels, 0, OutBlock);
+    EncodeBC4Block(Texels, 1, OutBlock + 8);
+}
+
+// BC7
+
+struct FBC7Candidate
+{
+    int32 Endpoints[2][4];
+    int32 PBits[2];
+    uint8 Indices[16];
+    float Error;
+};
+
+/** 7 bit endpoint and p-bit closest to an 8 bit color */
+static void QuantizeBC7Endpoint(const float Endpoint[4], int32 OutEndpoint[4], int32& OutPBit)
+{
+    float BestError = MAX_flt;
+    for (int32 PBit = 0; PBit < 2; PBit++)
+    {
+        int32 Quantized[4];
+        float Error = 0.0f;
+        for (int32 iChannel = 0; iChannel < 4; iChannel++)
+        {
+            Quantized[iChannel] = FMath::Clamp(FMath::RoundToInt((Endpoint[iChannel] - PBit) * 0.5f), 0, 127);
+            Error += FMath::Square(Endpoint[iChannel] - float((Quantized[iChannel] << 1) | PBit));
+        }
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            OutPBit = PBit;
+            FMemory::Memcpy(OutEndpoint, Quantized, sizeof(Quantized));
+        }
+    }
+}
+
+static FBC7Candidate EvaluateBC7(const float Points[16][4], const float Endpoints[2][4])
+{
+    FBC7Candidate Candidate;
+    QuantizeBC7Endpoint(Endpoints[0], Candidate.Endpoints[0], Candidate.PBits[0]);
+    QuantizeBC7Endpoint(Endpoints[1], Candidate.Endpoints[1], Candidate.PBits[1]);
+
+    int32 Palette[16][4];
+    for (int32 iChannel = 0; iChannel < 4; iChannel++)
+    {
+        const int32 Value0 = (Candidate.Endpoints[0][iChannel] << 1) | Candidate.PBits[0];
+        const int32 Value1 = (Candidate.Endpoints[1][iChannel] << 1) | Candidate.PBits[1];
+        for (int32 iValue = 0; iValue < 16; iValue++)
+        {
+            Palette[iValue][iChannel] = ((64 - BC_WEIGHTS4[iValue]) * Value0 + BC_WEIGHTS4[iValue] * Value1 + 32) >> 6;
+        }
+    }
+
+    Candidate.Error = 0.0f;
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        int32 BestIndex = 0;
+        float BestError = MAX_flt;
+        for (int32 iValue = 0; iValue < 16; iValue++)
+        {
+            float Error = 0.0f;
+            for (int32 iChannel = 0; iChannel < 4; iChannel++)
+            {
+                Error += FMath::Square(Points[iTexel][iChannel] - float(Palette[iValue][iChannel]));
+            }
+            if (Error < BestError)
+            {
+                BestError = Error;
+                BestIndex = iValue;
+            }
+        }
+
+        Candidate.Indices[iTexel] = uint8(BestIndex);
+        Candidate.Error += BestError;
+    }
+
+    return Candidate;
+}
+
+void EncodeBC7Block(const uint8 Texels[16][4], uint8 OutBlock[16])
+{
+    float Points[16][4];
+    GetTexelPoints<4>(Texels, Points);
+
+    float Endpoints[2][4];
+    FitEndpoints<4>(Points, Endpoints);
+    FBC7Candidate Best = EvaluateBC7(Points, Endpoints);
+
+    for (int32 Iteration = 0; Iteration < BC_REFINE_ITERATIONS && Best.Error > 0.0f; Iteration++)
+    {
+        float Weights[16];
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            Weights[iTexel] = BC_WEIGHTS4[Best.Indices[iTexel]] / 64.0f;
+        }
+
+        if (!RefineEndpoints<4>(Points, Weights, Endpoints))
+        {
+            break;
+        }
+
+        const FBC7Candidate Candidate = EvaluateBC7(Points, Endpoints);
+        if (Candidate.Error >= Best.Error)
+        {
+            break;
+        }
+        Best = Candidate;
+    }
+
+    // The most significant index bit of the first texel is implicit zero
+    if (Best.Indices[0] >= 8)
+    {
+        for (int32 iChannel = 0; iChannel < 4; iChannel++)
+        {
+            Swap(Best.Endpoints[0][iChannel], Best.Endpoints[1][iChannel]);
+        }
+        Swap(Best.PBits[0], Best.PBits[1]);
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            Best.Indices[iTexel] = uint8(15 - Best.Indices[iTexel]);
+        }
+    }
+
+    FBlockBitWriter Writer(OutBlock);
+    Writer.Write(1 << 6, 7);
+    for (int32 iChannel = 0; iChannel < 4; iChannel++)
+    {
+        Writer.Write(Best.Endpoints[0][iChannel], 7);
+        Writer.Write(Best.Endpoints[1][iChannel], 7);
+    }
+    Writer.Write(Best.PBits[0], 1);
+    Writer.Write(Best.PBits[1], 1);
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        Writer.Write(Best.Indices[iTexel], iTexel == 0 ? 3 : 4);
+    }
+}
+
+// BC6H
+
+struct FBC6HCandidate
+{
+    int32 Endpoints[2][3];
+    uint8 Indices[16];
+    float Error;
+};
+
+/** Decoder side value of a 10 bit unsigned endpoint before interpolation */
+static int32 UnquantizeBC6HEndpoint(int32 Value)
+{
+    if (Value == 0)
+    {
+        return 0;
+    }
+    if (Value == 1023)
+    {
+        return 0xffff;
+    }
+
+    return ((Value << 16) + 0x8000) >> 10;
+}
+
+/** Half float bits the decoder produces from an interpolated value */
+static int32 FinishBC6HValue(int32 Value)
+{
+    return (Value * 31) >> 6;
+}
+
+static int32 QuantizeBC6HEndpoint(float HalfValue)
+{
+    const int32 Estimate = FMath::Clamp(FMath::RoundToInt(HalfValue / 31.0f), 0, 1023);
+
+    int32 Best = Estimate;
+    float BestError = MAX_flt;
+    for (int32 Candidate = FMath::Max(Estimate - 1, 0); Candidate <= FMath::Min(Estimate + 1, 1023); Candidate++)
+    {
+        const float Error = FMath::Abs(float(FinishBC6HValue(UnquantizeBC6HEndpoint(Candidate))) - HalfValue);
+        if (Error < BestError)
+        {
+            BestError = Error;
+            Best = Candidate;
+        }
+    }
+
+    return Best;
+}
+
+static FBC6HCandidate EvaluateBC6H(const float Points[16][3], const float Endpoints[2][3])
+{
+    FBC6HCandidate Candidate;
+
+    int32 Palette[16][3];
+    for (int32 iChannel = 0; iChannel < 3; iChannel++)
+    {
+        Candidate.Endpoints[0][iChannel] = QuantizeBC6HEndpoint(Endpoints[0][iChannel]);
+        Candidate.Endpoints[1][iChannel] = QuantizeBC6HEndpoint(Endpoints[1][iChannel]);
+
+        const int32 Value0 = UnquantizeBC6HEndpoint(Candidate.Endpoints[0][iChannel]);
+        const int32 Value1 = UnquantizeBC6HEndpoint(Candidate.Endpoints[1][iChannel]);
+        for (int32 iValue = 0; iValue < 16; iValue++)
+        {
+            Palette[iValue][iChannel] = FinishBC6HValue(((64 - BC_WEIGHTS4[iValue]) * Value0 + BC_WEIGHTS4[iValue] * Value1 + 32) >> 6);
+        }
+    }
+
+    Candidate.Error = 0.0f;
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        int32 BestIndex = 0;
+        float BestError = MAX_flt;
+        for (int32 iValue = 0; iValue < 16; iValue++)
+        {
+            float Error = 0.0f;
+            for (int32 iChannel = 0; iChannel < 3; iChannel++)
+            {
+                Error += FMath::Square(Points[iTexel][iChannel] - float(Palette[iValue][iChannel]));
+            }
+            if (Error < BestError)
+            {
+                BestError = Error;
+                BestIndex = iValue;
+            }
+        }
+
+        Candidate.Indices[iTexel] = uint8(BestIndex);
+        Candidate.Error += BestError;
+    }
+
+    return Candidate;
+}
+
+void EncodeBC6HBlock(const uint16 HalfTexels[16][3], uint8 OutBlock[16])
+{
+    // Half float bits grow monotonically with the value, so fitting them directly gives roughly logarithmic error
+    float Points[16][3];
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        for (int32 iChannel = 0; iChannel < 3; iChannel++)
+        {
+            const uint16 Half = HalfTexels[iTexel][iChannel];
+            Points[iTexel][iChannel] = (Half & 0x8000) != 0 ? 0.0f : float(FMath::Min(int32(Half), BC6H_MAX_HALF));
+        }
+    }
+
+    float Endpoints[2][3];
+    FitEndpoints<3>(Points, Endpoints);
+    FBC6HCandidate Best = EvaluateBC6H(Points, Endpoints);
+
+    for (int32 Iteration = 0; Iteration < BC_REFINE_ITERATIONS && Best.Error > 0.0f; Iteration++)
+    {
+        float Weights[16];
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            Weights[iTexel] = BC_WEIGHTS4[Best.Indices[iTexel]] / 64.0f;
+        }
+
+        if (!RefineEndpoints<3>(Points, Weights, Endpoints))
+        {
+            break;
+        }
+
+        const FBC6HCandidate Candidate = EvaluateBC6H(Points, Endpoints);
+        if (Candidate.Error >= Best.Error)
+        {
+            break;
+        }
+        Best = Candidate;
+    }
+
+    if (Best.Indices[0] >= 8)
+    {
+        for (int32 iChannel = 0; iChannel < 3; iChannel++)
+        {
+            Swap(Best.Endpoints[0][iChannel], Best.Endpoints[1][iChannel]);
+        }
+        for (int32 iTexel = 0; iTexel < 16; iTexel++)
+        {
+            Best.Indices[iTexel] = uint8(15 - Best.Indices[iTexel]);
+        }
+    }
+
+    // Mode 11: 5 mode bits, then the first endpoint and the second endpoint at 10 bits per channel
+    FBlockBitWriter Writer(OutBlock);
+    Writer.Write(0x03, 5);
+    for (int32 iEndpoint = 0; iEndpoint < 2; iEndpoint++)
+    {
+        for (int32 iChannel = 0; iChannel < 3; iChannel++)
+        {
+            Writer.Write(Best.Endpoints[iEndpoint][iChannel], 10);
+        }
+    }
+    for (int32 iTexel = 0; iTexel < 16; iTexel++)
+    {
+        Writer.Write(Best.Indices[iTexel], iTexel == 0 ? 3 : 4);
+    }
+}
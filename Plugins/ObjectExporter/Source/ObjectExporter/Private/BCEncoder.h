@@ -0,0 +1,46 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Block compressed formats of the exported textures */
+enum class EBCFormat : uint8
+{
+    BC1,
+    BC3,
+    BC4,
+    BC5,
+    BC6H,
+    BC7,
+};
+
+/** Bytes of one 4x4 block */
+inline int32 GetBCBlockSize(EBCFormat Format)
+{
+    return Format == EBCFormat::BC1 || Format == EBCFormat::BC4 ? 8 : 16;
+}
+
+/*
+*   Encoders of single 4x4 blocks, texels are in row order.
+*   LDR blocks are RGBA8, HDR blocks are the raw bits of RGB half floats. Each encoder fits endpoints along the
+*   principal axis of the block and refines them by least squares on the chosen indices.
+*/
+
+/** Opaque four color block */
+void EncodeBC1Block(const uint8 Texels[16][4], uint8 OutBlock[8]);
+
+/** BC1 color and BC4 alpha */
+void EncodeBC3Block(const uint8 Texels[16][4], uint8 OutBlock[16]);
+
+/** One channel of the texels */
+void EncodeBC4Block(const uint8 Texels[16][4], int32 Channel, uint8 OutBlock[8]);
+
+/** Red and green as two BC4 blocks */
+void EncodeBC5Block(const uint8 Texels[16][4], uint8 OutBlock[16]);
+
+/** Unsigned HDR, single region mode 11 with 10 bit endpoints, negative values are clamped to zero */
+void EncodeBC6HBlock(const uint16 HalfTexels[16][3], uint8 OutBlock[16]);
+
+/** RGBA, mode 6 with 7 bit endpoints, per endpoint p-bits and 16 interpolation steps */
+void EncodeBC7Block(const uint8 Texels[16][4], uint8 OutBlock[16]);
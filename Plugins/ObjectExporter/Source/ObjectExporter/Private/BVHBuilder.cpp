@@ -0,0 +1,202 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "BVHBuilder.h"
+
+// Centroid bins the split candidates are evaluated at
+#define BVH_SPLIT_BINS 16
+// Deeper nodes split at the object median, which halves the items and bounds the depth of unbalanced scenes
+#define BVH_MAX_SAH_DEPTH 48
+// Relative cost of testing a node and an item
+#define BVH_NODE_COST 1.0f
+#define BVH_ITEM_COST 1.0f
+
+struct FBVHBuildContext
+{
+    TArray<FBox3f> Boxes;
+    TArray<uint32>& Items;
+    TArray<REngineFormat::MapBVHNode>& Nodes;
+    int32 MaxLeafItems;
+    FBVHBuildReport& Report;
+    /** Sum of the half surface area of every node and leaf item, weighted by its cost */
+    double Cost = 0.0;
+};
+
+static float GetHalfArea(const FBox3f& Box)
+{
+    if (!Box.IsValid)
+    {
+        return 0.0f;
+    }
+
+    const FVector3f Size = Box.GetSize();
+    return Size.X * Size.Y + Size.Y * Size.Z + Size.Z * Size.X;
+}
+
+REngineFormat::MapActorBounds MakeActorBounds(const FBox3f& Box, float SphereRadius)
+{
+    const FVector3f Center = Box.GetCenter();
+    const FVector3f Extent = Box.GetExtent();
+
+    REngineFormat::MapActorBounds Bounds = {};
+    Bounds.Center[0] = Center.X;
+    Bounds.Center[1] = Center.Y;
+    Bounds.Center[2] = Center.Z;
+    Bounds.Radius = SphereRadius;
+    Bounds.Extent[0] = Extent.X;
+    Bounds.Extent[1] = Extent.Y;
+    Bounds.Extent[2] = Extent.Z;
+
+    return Bounds;
+}
+
+/** Items of the range going to the first child, the range is partitioned in place */
+static int32 PartitionItems(FBVHBuildContext& Context, int32 FirstItem, int32 NumItems, const FBox3f& CenterBox, int32 Depth)
+{
+    uint32* Items = Context.Items.GetData() + FirstItem;
+    const FVector3f CenterSize = CenterBox.GetSize();
+    const int32 Axis = CenterSize.X >= CenterSize.Y && CenterSize.X >= CenterSize.Z ? 0 : (CenterSize.Y >= CenterSize.Z ? 1 : 2);
+    const float AxisMin = CenterBox.Min[Axis];
+    const float AxisSize = CenterSize[Axis];
+
+    // All centers in one point, any split is as good
+    if (AxisSize <= KINDA_SMALL_NUMBER)
+    {
+        return NumItems / 2;
+    }
+
+    if (Depth >= BVH_MAX_SAH_DEPTH)
+    {
+        Sort(Items, NumItems, [&Context, Axis](uint32 A, uint32 B) { return Context.Boxes[A].GetCenter()[Axis] < Context.Boxes[B].GetCenter()[Axis]; });
+
+        return NumItems / 2;
+    }
+
+    auto GetBin = [&Context, Axis, AxisMin, AxisSize](uint32 Item)
+    {
+        return FMath::Min(int32((Context.Boxes[Item].GetCenter()[Axis] - AxisMin) / AxisSize * BVH_SPLIT_BINS), BVH_SPLIT_BINS - 1);
+    };
+
+    FBox3f BinBoxes[BVH_SPLIT_BINS];
+    int32 BinCounts[BVH_SPLIT_BINS] = {};
+    for (int32 Bin = 0; Bin < BVH_SPLIT_BINS; Bin++)
+    {
+        BinBoxes[Bin] = FBox3f(ForceInit);
+    }
+    for (int32 ItemIndex = 0; ItemIndex < NumItems; ItemIndex++)
+    {
+        const int32 Bin = GetBin(Items[ItemIndex]);
+        BinBoxes[Bin] += Context.Boxes[Items[ItemIndex]];
+        BinCounts[Bin]++;
+    }
+
+    // Surface area heuristic cost of splitting after every bin, the areas of the right side are swept from the back
+    float RightCosts[BVH_SPLIT_BINS] = {};
+    FBox3f RightBox(ForceInit);
+    int32 RightCount = 0;
+    for (int32 Bin = BVH_SPLIT_BINS - 1; Bin > 0; Bin--)
+    {
+        RightBox += BinBoxes[Bin];
+        RightCount += BinCounts[Bin];
+        RightCosts[Bin - 1] = GetHalfArea(RightBox) * RightCount;
+    }
+
+    int32 BestBin = 0;
+    float BestCost = MAX_flt;
+    FBox3f LeftBox(ForceInit);
+    int32 LeftCount = 0;
+    for (int32 Bin = 0; Bin < BVH_SPLIT_BINS - 1; Bin++)
+    {
+        LeftBox += BinBoxes[Bin];
+        LeftCount += BinCounts[Bin];
+        const float Cost = GetHalfArea(LeftBox) * LeftCount + RightCosts[Bin];
+        if (LeftCount > 0 && LeftCount < NumItems && Cost < BestCost)
+        {
+            BestCost = Cost;
+            BestBin = Bin;
+        }
+    }
+
+    int32 Left = 0;
+    int32 Right = NumItems - 1;
+    while (Left <= Right)
+    {
+        if (GetBin(Items[Left]) <= BestBin)
+        {
+            Left++;
+        }
+        else
+        {
+            Swap(Items[Left], Items[Right]);
+            Right--;
+        }
+    }
+
+    return Left;
+}
+
+static void BuildNode(FBVHBuildContext& Context, int32 FirstItem, int32 NumItems, int32 Depth)
+{
+    FBox3f Box(ForceInit);
+    FBox3f CenterBox(ForceInit);
+    for (int32 ItemIndex = FirstItem; ItemIndex < FirstItem + NumItems; ItemIndex++)
+    {
+        const FBox3f& ItemBox = Context.Boxes[Context.Items[ItemIndex]];
+        Box += ItemBox;
+        CenterBox += ItemBox.GetCenter();
+    }
+
+    // Children are added after the node, it is addressed by index from here on
+    const int32 NodeIndex = Context.Nodes.Num();
+    const REngineFormat::MapActorBounds NodeBounds = MakeActorBounds(Box, 0.0f);
+    REngineFormat::MapBVHNode& Node = Context.Nodes.AddZeroed_GetRef();
+    FMemory::Memcpy(Node.Center, NodeBounds.Center, sizeof(Node.Center));
+    FMemory::Memcpy(Node.Extent, NodeBounds.Extent, sizeof(Node.Extent));
+    Node.FirstItem = uint32(FirstItem);
+
+    Context.Report.MaxDepth = FMath::Max(Context.Report.MaxDepth, Depth);
+    Context.Cost += GetHalfArea(Box) * BVH_NODE_COST;
+
+    if (NumItems <= Context.MaxLeafItems)
+    {
+        Node.Skip = uint32(NodeIndex + 1);
+        Context.Report.NumLeaves++;
+        Context.Cost += GetHalfArea(Box) * NumItems * BVH_ITEM_COST;
+
+        return;
+    }
+
+    const int32 NumFirstItems = PartitionItems(Context, FirstItem, NumItems, CenterBox, Depth);
+    BuildNode(Context, FirstItem, NumFirstItems, Depth + 1);
+    BuildNode(Context, FirstItem + NumFirstItems, NumItems - NumFirstItems, Depth + 1);
+
+    Context.Nodes[NodeIndex].Skip = uint32(Context.Nodes.Num());
+}
+
+void BuildBVH(const TArray<REngineFormat::MapActorBounds>& Bounds, int32 MaxLeafItems, TArray<REngineFormat::MapBVHNode>& OutNodes, TArray<uint32>& OutItems,
+    FBVHBuildReport& OutReport)
+{
+    OutNodes.Reset();
+    OutItems.Reset();
+    OutReport = FBVHBuildReport();
+    if (Bounds.Num() == 0)
+    {
+        return;
+    }
+
+    FBVHBuildContext Context{ {}, OutItems, OutNodes, FMath::Max(MaxLeafItems, 1), OutReport };
+    FBox3f RootBox(ForceInit);
+    Context.Boxes.Reserve(Bounds.Num());
+    for (int32 ItemIndex = 0; ItemIndex < Bounds.Num(); ItemIndex++)
+    {
+        const FVector3f Center(Bounds[ItemIndex].Center[0], Bounds[ItemIndex].Center[1], Bounds[ItemIndex].Center[2]);
+        const FVector3f Extent(Bounds[ItemIndex].Extent[0], Bounds[ItemIndex].Extent[1], Bounds[ItemIndex].Extent[2]);
+        RootBox += Context.Boxes.Add_GetRef(FBox3f(Center - Extent, Center + Extent));
+        OutItems.Add(uint32(ItemIndex));
+    }
+
+    BuildNode(Context, 0, Bounds.Num(), 0);
+
+    // A query box hits a node with a probability proportional to its area
+    const double BruteForceCost = double(GetHalfArea(RootBox)) * Bounds.Num() * BVH_ITEM_COST;
+    OutReport.RelativeCost = BruteForceCost > 0.0 ? float(Context.Cost / BruteForceCost) : 1.0f;
+}
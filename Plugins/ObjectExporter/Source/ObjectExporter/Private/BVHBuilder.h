@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+struct FBVHBuildReport
+{
+    int32 NumLeaves = 0;
+    int32 MaxDepth = 0;
+    /** Expected node and item tests of a query hitting a random point of the root box, relative to testing every item */
+    float RelativeCost = 0.0f;
+};
+
+REngineFormat::MapActorBounds MakeActorBounds(const FBox3f& Box, float SphereRadius);
+
+/**
+*   Build a bounding volume hierarchy over the boxes with binned surface area heuristic splits, leaves keep at most MaxLeafItems.
+*   The nodes are written depth first as REngineFormat::MapBVHNode, OutItems holds the box indices of the leaves in node order.
+*/
+void BuildBVH(const TArray<REngineFormat::MapActorBounds>& Bounds, int32 MaxLeafItems, TArray<REngineFormat::MapBVHNode>& OutNodes, TArray<uint32>& OutItems,
+    FBVHBuildReport& OutReport);
@@ -0,0 +1,241 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ExportCache.h"
+#include "ExportJsonWriter.h"
+#include "ObjectExporterSettings.h"
+#include "REngineFormat.h"
+#include "Dom/JsonObject.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "IO/IoHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+#include "UObject/UnrealType.h"
+
+// Bump when the exporter writes different files from the same assets and settings
+#define EXPORT_CACHE_VERSION 4
+#define MANIFEST_FILE_VERSION 1
+
+DECLARE_LOG_CATEGORY_CLASS(ExportCacheLog, Log, All);
+
+static uint64 HashBytes(const void* Data, int32 Size, uint64 Seed)
+{
+    return CityHash64WithSeed(static_cast<const char*>(Data), uint32(Size), Seed);
+}
+
+static uint64 HashString(const FString& String, uint64 Seed)
+{
+    return HashBytes(*String, String.Len() * sizeof(TCHAR), Seed);
+}
+
+/** Hash of everything besides the assets that changes the exported files */
+static uint64 GetEnvironmentHash()
+{
+    uint64 Hash = EXPORT_CACHE_VERSION;
+    const uint32 FormatVersion[2] = { REngineFormat::VersionMajor, REngineFormat::VersionMinor };
+    Hash = HashBytes(FormatVersion, sizeof(FormatVersion), Hash);
+
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+    for (TFieldIterator<FProperty> It(UObjectExporterSettings::StaticClass(), EFieldIteratorFlags::ExcludeSuper); It; ++It)
+    {
+        FString Value;
+        It->ExportTextItem_Direct(Value, It->ContainerPtrToValuePtr<void>(Settings), nullptr, nullptr, PPF_None);
+        Hash = HashString(It->GetName() + TEXT("=") + Value, Hash);
+    }
+
+    return Hash;
+}
+
+/** Hash of the saved package of an object, false if the package has unsaved changes or was never saved */
+static bool HashSavedPackage(const UObject* Object, uint64& InOutHash)
+{
+    const UPackage* Package = Object->GetPackage();
+    if (Package == nullptr || Package->IsDirty())
+    {
+        return false;
+    }
+
+    const FIoHash& SavedHash = Package->GetSavedHash();
+    if (SavedHash == FIoHash::Zero)
+    {
+        return false;
+    }
+
+    InOutHash = HashString(Object->GetPathName(), InOutHash);
+    InOutHash = HashBytes(SavedHash.GetBytes(), sizeof(FIoHash::ByteArray), InOutHash);
+
+    return true;
+}
+
+FExportCache::FExportCache(const FString& InManifestFilePathName)
+    : ManifestFilePathName(InManifestFilePathName)
+    , EnvironmentHash(GetEnvironmentHash())
+    , RunHits(0)
+    , ManifestHits(0)
+    , Misses(0)
+    , Failures(0)
+{
+
+}
+
+void FExportCache::Load()
+{
+    Entries.Reset();
+
+    FString JsonContent;
+    if (!FFileHelper::LoadFileToString(JsonContent, *ManifestFilePathName))
+    {
+        return;
+    }
+
+    TSharedPtr<FJsonObject> JsonRootObject;
+    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(JsonContent);
+    if (!FJsonSerializer::Deserialize(JsonReader, JsonRootObject) || !JsonRootObject.IsValid()
+        || JsonRootObject->GetIntegerField(TEXT("FileVersion")) != MANIFEST_FILE_VERSION)
+    {
+        UE_LOG(ExportCacheLog, Warning, TEXT("Load: ignoring unreadable manifest %s"), *ManifestFilePathName);
+
+        return;
+    }
+
+    for (const TSharedPtr<FJsonValue>& JsonValue : JsonRootObject->GetArrayField(TEXT("Entries")))
+    {
+        const TSharedPtr<FJsonObject>* JsonEntry = nullptr;
+        if (JsonValue->TryGetObject(JsonEntry))
+        {
+            FEntry Entry;
+            Entry.AssetPathName = (*JsonEntry)->GetStringField(TEXT("Asset"));
+            Entry.ContentHash = FParse::HexNumber64(*(*JsonEntry)->GetStringField(TEXT("Hash")));
+            Entries.Add((*JsonEntry)->GetStringField(TEXT("File")), Entry);
+        }
+    }
+
+    UE_LOG(ExportCacheLog, Log, TEXT("Load: %d entries from %s"), Entries.Num(), *ManifestFilePathName);
+}
+
+bool FExportCache::Save()
+{
+    FExportJsonWriter JsonFile(ManifestFilePathName);
+    if (!JsonFile.IsValid())
+    {
+        return false;
+    }
+
+    // Sorted so that the manifest diffs cleanly between runs
+    Entries.KeySort(TLess<FString>());
+
+    FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+    JsonWriter.WriteObjectStart();
+    JsonWriter.WriteValue(TEXT("FileVersion"), MANIFEST_FILE_VERSION);
+    JsonWriter.WriteArrayStart(TEXT("Entries"));
+    for (const TPair<FString, FEntry>& Entry : Entries)
+    {
+        JsonWriter.WriteObjectStart();
+        JsonWriter.WriteValue(TEXT("File"), Entry.Key);
+        JsonWriter.WriteValue(TEXT("Asset"), Entry.Value.AssetPathName);
+        JsonWriter.WriteValue(TEXT("Hash"), FString::Printf(TEXT("%016llx"), Entry.Value.ContentHash));
+        JsonWriter.WriteObjectEnd();
+    }
+    JsonWriter.WriteArrayEnd();
+    JsonWriter.WriteObjectEnd();
+
+    return JsonFile.Commit();
+}
+
+uint64 FExportCache::GetContentHash(const UObject* Asset, TArrayView<const UObject* const> Dependencies) const
+{
+    if (Asset == nullptr)
+    {
+        return 0;
+    }
+
+    uint64 Hash = EnvironmentHash;
+    if (!HashSavedPackage(Asset, Hash))
+    {
+        return 0;
+    }
+
+    for (const UObject* Dependency : Dependencies)
+    {
+        if (Dependency != nullptr && !HashSavedPackage(Dependency, Hash))
+        {
+            return 0;
+        }
+    }
+
+    // 0 means unhashable
+    return Hash != 0 ? Hash : 1;
+}
+
+bool FExportCache::IsUpToDate(const FString& FullFilePathName, uint64 ContentHash)
+{
+    const FString Key = GetKey(FullFilePathName);
+
+    if (ExportedThisRun.Contains(Key))
+    {
+        RunHits++;
+
+        return true;
+    }
+
+    const FEntry* Entry = Entries.Find(Key);
+    if (ContentHash != 0 && Entry != nullptr && Entry->ContentHash == ContentHash && IFileManager::Get().FileExists(*FullFilePathName))
+    {
+        ExportedThisRun.Add(Key);
+        ManifestHits++;
+
+        return true;
+    }
+
+    // Claimed by the caller, later requests in this run are hits even before the export finishes
+    ExportedThisRun.Add(Key);
+    Misses++;
+
+    return false;
+}
+
+void FExportCache::MarkExported(const FString& FullFilePathName, const FString& AssetPathName, uint64 ContentHash, bool bSucceeded)
+{
+    const FString Key = GetKey(FullFilePathName);
+
+    if (bSucceeded)
+    {
+        // Unhashable assets are exported again on the next run
+        if (ContentHash != 0)
+        {
+            Entries.Add(Key, { AssetPathName, ContentHash });
+        }
+        else
+        {
+            Entries.Remove(Key);
+        }
+    }
+    else
+    {
+        UE_LOG(ExportCacheLog, Warning, TEXT("MarkExported: export of %s to %s failed."), *AssetPathName, *FullFilePathName);
+
+        Failures++;
+        Entries.Remove(Key);
+    }
+}
+
+void FExportCache::LogStats(const TCHAR* Context) const
+{
+    const int32 Hits = RunHits + ManifestHits;
+    const int32 Requests = Hits + Misses;
+
+    UE_LOG(ExportCacheLog, Log, TEXT("%s: %d export requests, %d hits (%d exported earlier in this run, %d unchanged since the last run), %d misses (%d failed), hit rate %.1f%%."),
+        Context, Requests, Hits, RunHits, ManifestHits, Misses, Failures, Requests > 0 ? 100.0f * Hits / Requests : 0.0f);
+}
+
+FString FExportCache::GetKey(const FString& FullFilePathName)
+{
+    // Relative to the saved dir, so the manifest survives moving the project
+    FString Key = FPaths::ConvertRelativePathToFull(FullFilePathName);
+    FPaths::MakePathRelativeTo(Key, *FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir()));
+
+    return Key;
+}
@@ -0,0 +1,53 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+*   Persistent manifest of exported files, keyed by output file.
+*   Each entry stores the content hash of the asset the file was exported from. The hash covers the saved package
+*   of the asset and of its dependencies, the exporter settings and the file format version, so a file is only
+*   rewritten when one of them changed. Within one run every file is exported at most once.
+*/
+class FExportCache
+{
+public:
+    explicit FExportCache(const FString& InManifestFilePathName);
+
+    /** Read the manifest of the last run, a missing or unreadable manifest starts an empty cache */
+    void Load();
+
+    /** Write the manifest with the entries of this and earlier runs */
+    bool Save();
+
+    /** Content hash of an asset and the assets its export reads, 0 when an unsaved package makes the asset unhashable */
+    uint64 GetContentHash(const UObject* Asset, TArrayView<const UObject* const> Dependencies = TArrayView<const UObject* const>()) const;
+
+    /** True when the file was exported earlier in this run, or is on disk and unchanged since the last run; counts a hit or a miss, a miss must be exported by the caller */
+    bool IsUpToDate(const FString& FullFilePathName, uint64 ContentHash);
+
+    /** Record a finished export, a failed export is forgotten so the next run retries it */
+    void MarkExported(const FString& FullFilePathName, const FString& AssetPathName, uint64 ContentHash, bool bSucceeded);
+
+    /** Log the hit and miss counts of this run */
+    void LogStats(const TCHAR* Context) const;
+
+private:
+    struct FEntry
+    {
+        FString AssetPathName;
+        uint64 ContentHash = 0;
+    };
+
+    static FString GetKey(const FString& FullFilePathName);
+
+    FString ManifestFilePathName;
+    uint64 EnvironmentHash;
+    TMap<FString, FEntry> Entries;
+    TSet<FString> ExportedThisRun;
+    int32 RunHits;
+    int32 ManifestHits;
+    int32 Misses;
+    int32 Failures;
+};
@@ -0,0 +1,253 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ExportFileWriter.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+#include "REngineCodec.h"
+
+#define TEMP_FILE_POSTFIX ".tmp"
+// Smaller chunks are not worth a decode call
+#define COMPRESSION_MIN_CHUNK_SIZE 256
+
+DECLARE_LOG_CATEGORY_CLASS(ExportFileWriterLog, Log, All);
+
+FExportFileWriter::FExportFileWriter(const FString& InFullFilePathName, REngineFormat::EFileType InFileType)
+    : FullFilePathName(InFullFilePathName)
+    , FileType(InFileType)
+    , bCompress(false)
+    , bChunkTooLarge(false)
+    , StartTime(FPlatformTime::Seconds())
+    , EncodeSeconds(0.0)
+    , WriteSeconds(0.0)
+{
+
+}
+
+void FExportFileWriter::AddChunkData(uint32 ChunkId, uint32 ChunkIndex, REngineFormat::EElementFormat Format, uint32 ElementSize, int64 ElementCount, const void* Data, uint32 Alignment)
+{
+    check(FMath::IsPowerOfTwo(Alignment));
+
+    // Payloads live in TArray<uint8>, a larger chunk fails the whole file on Commit instead of being truncated
+    const uint64 Size = uint64(ElementSize) * ElementCount;
+    if (ElementCount < 0 || Size > uint64(MAX_int32))
+    {
+        UE_LOG(ExportFileWriterLog, Warning, TEXT("AddChunkData: chunk %08x index %u is %llu bytes, more than a chunk can hold. %s"),
+            ChunkId, ChunkIndex, Size, *FullFilePathName);
+        bChunkTooLarge = true;
+
+        return;
+    }
+
+    FChunk& Chunk = Chunks.AddDefaulted_GetRef();
+    FMemory::Memzero(Chunk.Entry);
+    Chunk.Entry.Id = ChunkId;
+    Chunk.Entry.Index = ChunkIndex;
+    Chunk.Entry.Format = uint32(Format);
+    Chunk.Entry.ElementSize = ElementSize;
+    Chunk.Entry.Size = Size;
+    Chunk.Entry.ElementCount = ElementCount;
+    Chunk.Entry.Alignment = Alignment;
+
+    Chunk.Data.SetNumUninitialized(int32(Size));
+    if (Chunk.Entry.Size > 0)
+    {
+        FMemory::Memcpy(Chunk.Data.GetData(), Data, Chunk.Entry.Size);
+    }
+}
+
+void FExportFileWriter::AddStringChunk(uint32 ChunkId, uint32 ChunkIndex, const FString& String)
+{
+    FTCHARToUTF8 Utf8String(*String);
+    AddChunkData(ChunkId, ChunkIndex, REngineFormat::EElementFormat::String, 1, Utf8String.Length(), Utf8String.Get(), REngineFormat::DefaultAlignment);
+}
+
+void FExportFileWriter::AddStringTableChunk(uint32 ChunkId, uint32 ChunkIndex, const TArray<FString>& Strings)
+{
+    // Count, offsets of every string plus the end offset, then the text
+    TArray<uint32> Header;
+    Header.Reserve(Strings.Num() + 2);
+    Header.Add(Strings.Num());
+
+    TArray<ANSICHAR> Text;
+    for (const FString& String : Strings)
+    {
+        Header.Add(Text.Num());
+
+        FTCHARToUTF8 Utf8String(*String);
+        Text.Append(Utf8String.Get(), Utf8String.Length());
+    }
+    Header.Add(Text.Num());
+
+    TArray<uint8> Data;
+    Data.SetNumUninitialized(Header.Num() * sizeof(uint32) + Text.Num());
+    FMemory::Memcpy(Data.GetData(), Header.GetData(), Header.Num() * sizeof(uint32));
+    if (Text.Num() > 0)
+    {
+        FMemory::Memcpy(Data.GetData() + Header.Num() * sizeof(uint32), Text.GetData(), Text.Num());
+    }
+
+    AddChunkData(ChunkId, ChunkIndex, REngineFormat::EElementFormat::StringTable, 1, Data.Num(), Data.GetData(), REngineFormat::DefaultAlignment);
+}
+
+bool FExportFileWriter::CompressChunk(REngineFormat::ChunkEntry& Entry, TArray<uint8>& Data)
+{
+    using namespace REngineFormat;
+
+    EChunkFilter Filter;
+    switch (EElementFormat(Entry.Format))
+    {
+    case EElementFormat::UInt16:
+    case EElementFormat::UInt32:
+    case EElementFormat::Int32:
+        Filter = EChunkFilter::IndexDelta;
+        break;
+    case EElementFormat::UInt8:
+        Filter = EChunkFilter::None;
+        break;
+    case EElementFormat::Float:
+    case EElementFormat::Float2:
+    case EElementFormat::Float3:
+    case EElementFormat::Float4:
+    case EElementFormat::Struct:
+        Filter = EChunkFilter::BytePlaneDelta;
+        break;
+    default:
+        return false;
+    }
+
+    if (IsChunkCompressed(Entry) || Data.Num() < COMPRESSION_MIN_CHUNK_SIZE || !IsChunkFilterSupported(Filter, Entry.ElementSize))
+    {
+        return false;
+    }
+
+    TArray<uint8> FilteredData;
+    FilteredData.SetNumUninitialized(Data.Num());
+    EncodeChunkFilter(Filter, Data.GetData(), FilteredData.GetData(), Entry.ElementCount, Entry.ElementSize);
+
+    // FCompression writes LZ4 as a bare block, which is what the reader decodes
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_LZ4, FilteredData.Num());
+    TArray<uint8> CompressedData;
+    CompressedData.SetNumUninitialized(CompressedSize);
+    if (!FCompression::CompressMemory(NAME_LZ4, CompressedData.GetData(), CompressedSize, FilteredData.GetData(), FilteredData.Num()))
+    {
+        return false;
+    }
+
+    // Keep the raw payload unless compression saves at least 1/16 of it
+    if (CompressedSize >= Data.Num() - Data.Num() / 16)
+    {
+        return false;
+    }
+
+    CompressedData.SetNum(CompressedSize);
+    Data = MoveTemp(CompressedData);
+    Entry.Size = CompressedSize;
+    Entry.Flags |= ChunkFlags::Compressed | (uint32(Filter) << ChunkFlags::FilterShift);
+
+    return true;
+}
+
+bool FExportFileWriter::Commit()
+{
+    if (bChunkTooLarge)
+    {
+        UE_LOG(ExportFileWriterLog, Warning, TEXT("Commit: a chunk was too large, nothing written. %s"), *FullFilePathName);
+
+        return false;
+    }
+
+    uint64 RawSize = 0;
+    for (const FChunk& Chunk : Chunks)
+    {
+        RawSize += Chunk.Entry.Size;
+    }
+
+    if (bCompress)
+    {
+        ParallelFor(Chunks.Num(), [this](int32 ChunkIndex)
+        {
+            CompressChunk(Chunks[ChunkIndex].Entry, Chunks[ChunkIndex].Data);
+        });
+    }
+
+    const double WriteStartTime = FPlatformTime::Seconds();
+    EncodeSeconds = WriteStartTime - StartTime;
+
+    // Layout: header, chunk table, aligned payloads
+    REngineFormat::FileHeader Header;
+    FMemory::Memzero(Header);
+    Header.Magic = REngineFormat::FileMagic;
+    Header.VersionMajor = REngineFormat::VersionMajor;
+    Header.VersionMinor = REngineFormat::VersionMinor;
+    Header.FileType = uint32(FileType);
+    Header.ChunkCount = Chunks.Num();
+    Header.ChunkTableOffset = sizeof(REngineFormat::FileHeader);
+
+    uint64 Offset = Header.ChunkTableOffset + Chunks.Num() * sizeof(REngineFormat::ChunkEntry);
+    TArray<REngineFormat::ChunkEntry> ChunkTable;
+    ChunkTable.Reserve(Chunks.Num());
+    for (FChunk& Chunk : Chunks)
+    {
+        Offset = Align(Offset, uint64(Chunk.Entry.Alignment));
+        Chunk.Entry.Offset = Offset;
+        Offset += Chunk.Entry.Size;
+
+        ChunkTable.Add(Chunk.Entry);
+    }
+    Header.FileSize = Offset;
+
+    IFileManager& FileManager = IFileManager::Get();
+    const FString TempFilePathName = FullFilePathName + TEMP_FILE_POSTFIX;
+
+    FArchive* FileWriter = FileManager.CreateFileWriter(*TempFilePathName);
+    if (nullptr == FileWriter)
+    {
+        UE_LOG(ExportFileWriterLog, Warning, TEXT("Commit: CreateFileWriter failed. %s"), *TempFilePathName);
+
+        return false;
+    }
+
+    static const uint8 Padding[REngineFormat::StreamAlignment] = {};
+
+    FileWriter->Serialize(&Header, sizeof(Header));
+    FileWriter->Serialize(ChunkTable.GetData(), ChunkTable.Num() * sizeof(REngineFormat::ChunkEntry));
+    for (FChunk& Chunk : Chunks)
+    {
+        const int64 PaddingSize = int64(Chunk.Entry.Offset) - FileWriter->Tell();
+        check(PaddingSize >= 0 && PaddingSize < REngineFormat::StreamAlignment);
+        FileWriter->Serialize((void*)Padding, PaddingSize);
+        FileWriter->Serialize(Chunk.Data.GetData(), Chunk.Data.Num());
+    }
+
+    const bool bWriteSucceeded = FileWriter->Close();
+    delete FileWriter;
+    FileWriter = nullptr;
+
+    if (!bWriteSucceeded)
+    {
+        UE_LOG(ExportFileWriterLog, Warning, TEXT("Commit: write failed. %s"), *TempFilePathName);
+        FileManager.Delete(*TempFilePathName, false, true, true);
+
+        return false;
+    }
+
+    if (!FileManager.Move(*FullFilePathName, *TempFilePathName, true, true))
+    {
+        UE_LOG(ExportFileWriterLog, Warning, TEXT("Commit: rename failed. %s"), *FullFilePathName);
+        FileManager.Delete(*TempFilePathName, false, true, true);
+
+        return false;
+    }
+
+    WriteSeconds = FPlatformTime::Seconds() - WriteStartTime;
+
+    const double SizeMB = Header.FileSize / (1024.0 * 1024.0);
+    const double RawSizeMB = RawSize / (1024.0 * 1024.0);
+    const double TotalSeconds = FMath::Max(EncodeSeconds + WriteSeconds, SMALL_NUMBER);
+    UE_LOG(ExportFileWriterLog, Log, TEXT("Commit: %s %d chunks, %.2f MB (%.2f MB payload before compression), encode %.2f ms, write %.2f ms, %.1f MB/s."),
+        *FPaths::GetCleanFilename(FullFilePathName), Chunks.Num(), SizeMB, RawSizeMB, EncodeSeconds * 1000.0, WriteSeconds * 1000.0, SizeMB / TotalSeconds);
+
+    return true;
+}
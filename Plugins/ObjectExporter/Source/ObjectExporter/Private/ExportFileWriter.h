@@ -0,0 +1,95 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+#include <type_traits>
+
+/*
+*   Buffered writer for the chunked REngine container (see REngineFormat.h).
+*   Each chunk is built as one contiguous, preallocated array and added with a single copy. Commit lays out
+*   the header, chunk table and aligned payloads, writes them to a temp file with a few large writes and
+*   atomically renames it over the target, so a failed export never leaves a truncated file behind.
+*/
+class FExportFileWriter
+{
+public:
+    FExportFileWriter(const FString& InFullFilePathName, REngineFormat::EFileType InFileType);
+
+    /** Add an array of packed elements as one chunk */
+    template<typename ElementType>
+    void AddChunk(uint32 ChunkId, uint32 ChunkIndex, REngineFormat::EElementFormat Format, const TArray<ElementType>& Elements, uint32 Alignment = REngineFormat::DefaultAlignment)
+    {
+        static_assert(std::is_trivially_copyable_v<ElementType>, "Chunks only accept packed POD elements.");
+        AddChunkData(ChunkId, ChunkIndex, Format, sizeof(ElementType), Elements.Num(), Elements.GetData(), Alignment);
+    }
+
+    /** Add a single struct as one chunk */
+    template<typename ElementType>
+    void AddStructChunk(uint32 ChunkId, uint32 ChunkIndex, const ElementType& Element)
+    {
+        static_assert(std::is_trivially_copyable_v<ElementType>, "Chunks only accept packed POD elements.");
+        AddChunkData(ChunkId, ChunkIndex, REngineFormat::EElementFormat::Struct, sizeof(ElementType), 1, &Element, REngineFormat::DefaultAlignment);
+    }
+
+    void AddStringChunk(uint32 ChunkId, uint32 ChunkIndex, const FString& String);
+    void AddStringTableChunk(uint32 ChunkId, uint32 ChunkIndex, const TArray<FString>& Strings);
+
+    /** Compress the numeric chunks on Commit, chunks that do not shrink are stored raw */
+    void SetCompression(bool bInCompress) { bCompress = bInCompress; }
+
+    /** Filter and LZ4 compress one payload in place, false if the chunk is left raw */
+    static bool CompressChunk(REngineFormat::ChunkEntry& Entry, TArray<uint8>& Data);
+
+    /** Write header, chunk table and payloads to a temp file and rename it to the target file, false if a chunk was too large to add */
+    bool Commit();
+
+    const FString& GetFullFilePathName() const { return FullFilePathName; }
+
+    /** Seconds spent in encoding (construction to Commit) and in file io (inside Commit) */
+    double GetEncodeSeconds() const { return EncodeSeconds; }
+    double GetWriteSeconds() const { return WriteSeconds; }
+
+private:
+    struct FChunk
+    {
+        REngineFormat::ChunkEntry Entry;
+        TArray<uint8> Data;
+    };
+
+    void AddChunkData(uint32 ChunkId, uint32 ChunkIndex, REngineFormat::EElementFormat Format, uint32 ElementSize, int64 ElementCount, const void* Data, uint32 Alignment);
+
+    FString FullFilePathName;
+    REngineFormat::EFileType FileType;
+    TArray<FChunk> Chunks;
+    bool bCompress;
+    bool bChunkTooLarge;
+    double StartTime;
+    double EncodeSeconds;
+    double WriteSeconds;
+};
+
+/** Deduplicated string list, written with AddStringTableChunk and referenced by index */
+class FExportStringTable
+{
+public:
+    uint32 Add(const FString& String)
+    {
+        if (const uint32* Index = Indices.Find(String))
+        {
+            return *Index;
+        }
+
+        const uint32 Index = Strings.Add(String);
+        Indices.Add(String, Index);
+
+        return Index;
+    }
+
+    const TArray<FString>& GetStrings() const { return Strings; }
+
+private:
+    TArray<FString> Strings;
+    TMap<FString, uint32> Indices;
+};
@@ -0,0 +1,70 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ExportJsonWriter.h"
+#include "HAL/FileManager.h"
+
+#define TEMP_FILE_POSTFIX ".tmp"
+
+DECLARE_LOG_CATEGORY_CLASS(ExportJsonWriterLog, Log, All);
+
+FExportJsonWriter::FExportJsonWriter(const FString& InFullFilePathName)
+    : FullFilePathName(InFullFilePathName)
+    , TempFilePathName(InFullFilePathName + TEMP_FILE_POSTFIX)
+    , FileArchive(IFileManager::Get().CreateFileWriter(*TempFilePathName))
+{
+    if (nullptr == FileArchive)
+    {
+        UE_LOG(ExportJsonWriterLog, Warning, TEXT("FExportJsonWriter: CreateFileWriter failed. %s"), *TempFilePathName);
+
+        return;
+    }
+
+    Writer = TJsonWriterFactory<UTF8CHAR, FExportJsonPrintPolicy>::Create(FileArchive);
+}
+
+FExportJsonWriter::~FExportJsonWriter()
+{
+    // Not committed, drop the partial file
+    if (FileArchive != nullptr)
+    {
+        Writer.Reset();
+        delete FileArchive;
+        FileArchive = nullptr;
+
+        IFileManager::Get().Delete(*TempFilePathName, false, true, true);
+    }
+}
+
+bool FExportJsonWriter::Commit()
+{
+    if (nullptr == FileArchive)
+    {
+        return false;
+    }
+
+    const bool bClosed = Writer->Close();
+    Writer.Reset();
+
+    const bool bWriteSucceeded = FileArchive->Close() && bClosed;
+    delete FileArchive;
+    FileArchive = nullptr;
+
+    IFileManager& FileManager = IFileManager::Get();
+    if (!bWriteSucceeded)
+    {
+        UE_LOG(ExportJsonWriterLog, Warning, TEXT("Commit: write failed. %s"), *TempFilePathName);
+        FileManager.Delete(*TempFilePathName, false, true, true);
+
+        return false;
+    }
+
+    if (!FileManager.Move(*FullFilePathName, *TempFilePathName, true, true))
+    {
+        UE_LOG(ExportJsonWriterLog, Warning, TEXT("Commit: rename failed. %s"), *FullFilePathName);
+        FileManager.Delete(*TempFilePathName, false, true, true);
+
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,89 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include <type_traits>
+
+/** Condensed utf8 output, floats with the nine significant digits that round trip every float */
+struct FExportJsonPrintPolicy : public TCondensedJsonPrintPolicy<UTF8CHAR>
+{
+    static inline void WriteFloat(FArchive* Stream, float Value)
+    {
+        WriteString(Stream, FString::Printf(TEXT("%.9g"), Value));
+    }
+};
+
+/*
+*   Streaming writer for the .json exports.
+*   Values go through a TJsonWriter straight into a temp file, no json object is built in memory, and numeric
+*   data is written as flat arrays. Commit renames the temp file over the target like FExportFileWriter.
+*/
+class FExportJsonWriter
+{
+public:
+    typedef TJsonWriter<UTF8CHAR, FExportJsonPrintPolicy> FWriter;
+
+    explicit FExportJsonWriter(const FString& InFullFilePathName);
+    ~FExportJsonWriter();
+
+    bool IsValid() const { return Writer.IsValid(); }
+    FWriter& Get() { return *Writer; }
+
+    /** Flat array of numbers */
+    template<typename ValueType>
+    void WriteArray(const FString& Identifier, const ValueType* Values, int32 Count)
+    {
+        Writer->WriteArrayStart(Identifier);
+        for (int32 iValue = 0; iValue < Count; iValue++)
+        {
+            WriteNumber(Values[iValue]);
+        }
+        Writer->WriteArrayEnd();
+    }
+
+    template<typename ValueType>
+    void WriteArray(const FString& Identifier, const TArray<ValueType>& Values)
+    {
+        WriteArray(Identifier, Values.GetData(), Values.Num());
+    }
+
+    /** Flat array of one array member of every element, for example all vertex positions as x, y, z, x, y, z... */
+    template<typename ElementType, typename ComponentType, int32 NumComponents>
+    void WriteMemberArray(const FString& Identifier, const TArray<ElementType>& Elements, ComponentType (ElementType::*Member)[NumComponents])
+    {
+        Writer->WriteArrayStart(Identifier);
+        for (const ElementType& Element : Elements)
+        {
+            for (int32 iComponent = 0; iComponent < NumComponents; iComponent++)
+            {
+                WriteNumber((Element.*Member)[iComponent]);
+            }
+        }
+        Writer->WriteArrayEnd();
+    }
+
+    /** Close the json and rename the temp file to the target file */
+    bool Commit();
+
+private:
+    template<typename ValueType>
+    void WriteNumber(ValueType Value)
+    {
+        if constexpr (std::is_floating_point_v<ValueType>)
+        {
+            Writer->WriteValue(float(Value));
+        }
+        else
+        {
+            Writer->WriteValue(int64(Value));
+        }
+    }
+
+    FString FullFilePathName;
+    FString TempFilePathName;
+    FArchive* FileArchive;
+    TSharedPtr<FWriter> Writer;
+};
@@ -0,0 +1,91 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ExportTaskQueue.h"
+#include "HAL/PlatformProcess.h"
+
+FExportTaskQueue::FExportTaskQueue(int64 InMemoryBudget)
+    : MemoryBudget(InMemoryBudget)
+    , SnapshotSizeInFlight(0)
+    , TaskFinishedEvent(FPlatformProcess::GetSynchEventFromPool(false))
+{
+
+}
+
+FExportTaskQueue::~FExportTaskQueue()
+{
+    Flush();
+
+    FPlatformProcess::ReturnSynchEventToPool(TaskFinishedEvent);
+}
+
+void FExportTaskQueue::Add(FExportTask&& Task, int64 SnapshotSize, TUniqueFunction<void(bool)>&& OnCompleted)
+{
+    if (MemoryBudget <= 0)
+    {
+        const bool bSucceeded = Task();
+        OnCompleted(bSucceeded);
+
+        return;
+    }
+
+    RetireCompleted();
+
+    // A snapshot larger than the whole budget still runs, alone. The event is auto reset, a task finishing
+    // between RetireCompleted and Wait leaves it triggered
+    while (SnapshotSizeInFlight > 0 && SnapshotSizeInFlight + SnapshotSize > MemoryBudget)
+    {
+        TaskFinishedEvent->Wait();
+        RetireCompleted();
+    }
+
+    TSharedRef<FTaskState, ESPMode::ThreadSafe> State = MakeShared<FTaskState, ESPMode::ThreadSafe>();
+    FGraphEventRef Event = FFunctionGraphTask::CreateAndDispatchWhenReady(
+        [Task = MoveTemp(Task), State, TaskFinishedEvent = TaskFinishedEvent]() mutable
+        {
+            State->bSucceeded = Task();
+
+            // Release the snapshot as soon as the file is written
+            Task = nullptr;
+
+            State->bFinished.store(true, std::memory_order_release);
+            TaskFinishedEvent->Trigger();
+        },
+        TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+
+    PendingTasks.Add({ Event, State, SnapshotSize, MoveTemp(OnCompleted) });
+    SnapshotSizeInFlight += SnapshotSize;
+}
+
+void FExportTaskQueue::Flush()
+{
+    for (const FPendingTask& PendingTask : PendingTasks)
+    {
+        FTaskGraphInterface::Get().WaitUntilTaskCompletes(PendingTask.Event);
+    }
+
+    RetireCompleted();
+}
+
+void FExportTaskQueue::RetireCompleted()
+{
+    for (FPendingTask& PendingTask : PendingTasks)
+    {
+        if (PendingTask.SnapshotSize != 0 && PendingTask.State->bFinished.load(std::memory_order_acquire))
+        {
+            SnapshotSizeInFlight -= PendingTask.SnapshotSize;
+            PendingTask.SnapshotSize = 0;
+        }
+    }
+
+    // Callbacks keep the add order, a task that finished early waits for the ones before it. The graph event
+    // completes after the task triggered TaskFinishedEvent, so no retired task still touches it
+    int32 NumRetired = 0;
+    while (NumRetired < PendingTasks.Num() && PendingTasks[NumRetired].Event->IsComplete())
+    {
+        FPendingTask& PendingTask = PendingTasks[NumRetired++];
+        SnapshotSizeInFlight -= PendingTask.SnapshotSize;
+        PendingTask.OnCompleted(PendingTask.State->bSucceeded);
+    }
+
+    PendingTasks.RemoveAt(0, NumRetired);
+}
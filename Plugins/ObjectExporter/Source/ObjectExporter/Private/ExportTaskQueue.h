@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "HAL/Event.h"
+
+#include <atomic>
+
+/** Encodes and writes one snapshotted asset, runs on any thread, true on success */
+typedef TUniqueFunction<bool()> FExportTask;
+
+/*
+*   Runs export tasks on the task graph workers.
+*   The snapshots held by tasks in flight are bounded by a memory budget, Add blocks the calling thread until
+*   enough tasks finish, in any order. Completion callbacks run on the calling thread in the order the tasks
+*   were added, so everything built from them is deterministic.
+*/
+class FExportTaskQueue
+{
+public:
+    /** A budget of 0 runs every task inline in Add */
+    explicit FExportTaskQueue(int64 InMemoryBudget);
+    ~FExportTaskQueue();
+
+    void Add(FExportTask&& Task, int64 SnapshotSize, TUniqueFunction<void(bool)>&& OnCompleted);
+
+    /** Wait for every task and run the remaining callbacks */
+    void Flush();
+
+private:
+    struct FTaskState
+    {
+        bool bSucceeded = false;
+        // Set once the task released its snapshot
+        std::atomic<bool> bFinished { false };
+    };
+
+    struct FPendingTask
+    {
+        FGraphEventRef Event;
+        TSharedRef<FTaskState, ESPMode::ThreadSafe> State;
+        // 0 once the snapshot is released from the budget
+        int64 SnapshotSize;
+        TUniqueFunction<void(bool)> OnCompleted;
+    };
+
+    /** Release the budget of every finished task and retire the completed tasks at the front, never blocks */
+    void RetireCompleted();
+
+    int64 MemoryBudget;
+    int64 SnapshotSizeInFlight;
+    // Tasks not retired yet, in add order
+    TArray<FPendingTask> PendingTasks;
+    // Triggered by every task when it finishes
+    FEvent* TaskFinishedEvent;
+};
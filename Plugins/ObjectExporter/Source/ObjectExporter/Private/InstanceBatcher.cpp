@@ -0,0 +1,137 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InstanceBatcher.h"
+#include "BVHBuilder.h"
+
+/** Order of actors by everything a batch shares, equal actors may be drawn as instances of one batch */
+static int32 CompareBatchState(const REngineFormat::MapStaticMeshActor& A, const REngineFormat::MapActorLOD& ALOD, const REngineFormat::MapStaticMeshActor& B,
+    const REngineFormat::MapActorLOD& BLOD, const TArray<uint32>& ActorMaterials)
+{
+    const int64 Fields[4][2] = { { A.MeshName, B.MeshName }, { ALOD.ForcedLOD, BLOD.ForcedLOD }, { ALOD.MinLOD, BLOD.MinLOD }, { A.NumMaterials, B.NumMaterials } };
+    for (const int64* Field : Fields)
+    {
+        if (Field[0] != Field[1])
+        {
+            return Field[0] < Field[1] ? -1 : 1;
+        }
+    }
+
+    for (uint32 MaterialIndex = 0; MaterialIndex < A.NumMaterials; MaterialIndex++)
+    {
+        const uint32 AMaterial = ActorMaterials[A.FirstMaterial + MaterialIndex];
+        const uint32 BMaterial = ActorMaterials[B.FirstMaterial + MaterialIndex];
+        if (AMaterial != BMaterial)
+        {
+            return AMaterial < BMaterial ? -1 : 1;
+        }
+    }
+
+    return 0;
+}
+
+static REngineFormat::InstanceTransform GetInstanceTransform(const REngineFormat::MapStaticMeshActor& Actor)
+{
+    const FTransform3f Transform(FQuat4f(Actor.Rotation[0], Actor.Rotation[1], Actor.Rotation[2], Actor.Rotation[3]),
+        FVector3f(Actor.Location[0], Actor.Location[1], Actor.Location[2]), FVector3f(Actor.Scale[0], Actor.Scale[1], Actor.Scale[2]));
+    const FMatrix44f Matrix = Transform.ToMatrixWithScale();
+
+    REngineFormat::InstanceTransform InstanceTransform;
+    for (int32 Row = 0; Row < 3; Row++)
+    {
+        for (int32 Column = 0; Column < 4; Column++)
+        {
+            InstanceTransform.Rows[Row][Column] = Matrix.M[Column][Row];
+        }
+    }
+
+    return InstanceTransform;
+}
+
+/** Split one group of equal actors at the leaves of a bounding volume hierarchy over them and add a batch per leaf */
+static void AddGroupBatches(const TArray<REngineFormat::MapStaticMeshActor>& Actors, const TArray<REngineFormat::MapActorLOD>& ActorLODs,
+    const TArray<REngineFormat::MapActorBounds>& ActorBounds, TArrayView<const int32> Group, int32 MaxInstancesPerBatch, FInstanceBatches& OutBatches)
+{
+    TArray<REngineFormat::MapActorBounds> GroupBounds;
+    for (int32 ActorIndex : Group)
+    {
+        GroupBounds.Add(ActorBounds[ActorIndex]);
+    }
+
+    TArray<REngineFormat::MapBVHNode> Nodes;
+    TArray<uint32> Items;
+    FBVHBuildReport Report;
+    BuildBVH(GroupBounds, MaxInstancesPerBatch, Nodes, Items, Report);
+
+    const REngineFormat::MapStaticMeshActor& FirstActor = Actors[Group[0]];
+    for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+    {
+        const REngineFormat::MapBVHNode& Node = Nodes[NodeIndex];
+        if (Node.Skip != uint32(NodeIndex + 1))
+        {
+            continue;
+        }
+
+        REngineFormat::MapInstanceBatch& Batch = OutBatches.Batches.AddZeroed_GetRef();
+        Batch.MeshName = FirstActor.MeshName;
+        Batch.FirstMaterial = FirstActor.FirstMaterial;
+        Batch.NumMaterials = FirstActor.NumMaterials;
+        Batch.ForcedLOD = ActorLODs[Group[0]].ForcedLOD;
+        Batch.MinLOD = ActorLODs[Group[0]].MinLOD;
+        Batch.FirstInstance = uint32(OutBatches.Actors.Num());
+        FMemory::Memcpy(Batch.Bounds.Center, Node.Center, sizeof(Node.Center));
+        FMemory::Memcpy(Batch.Bounds.Extent, Node.Extent, sizeof(Node.Extent));
+        Batch.Bounds.Radius = FVector3f(Node.Extent[0], Node.Extent[1], Node.Extent[2]).Size();
+
+        const uint32 EndItem = Node.Skip < uint32(Nodes.Num()) ? Nodes[Node.Skip].FirstItem : uint32(Items.Num());
+        for (uint32 ItemIndex = Node.FirstItem; ItemIndex < EndItem; ItemIndex++)
+        {
+            const int32 ActorIndex = Group[Items[ItemIndex]];
+            OutBatches.Transforms.Add(GetInstanceTransform(Actors[ActorIndex]));
+            OutBatches.Bounds.Add(ActorBounds[ActorIndex]);
+            OutBatches.Actors.Add(uint32(ActorIndex));
+        }
+
+        Batch.NumInstances = uint32(OutBatches.Actors.Num()) - Batch.FirstInstance;
+    }
+}
+
+void BuildInstanceBatches(const TArray<REngineFormat::MapStaticMeshActor>& Actors, const TArray<REngineFormat::MapActorLOD>& ActorLODs,
+    const TArray<REngineFormat::MapActorBounds>& ActorBounds, const TArray<uint32>& ActorMaterials, const TBitArray<>& ExcludedActors, int32 MaxInstancesPerBatch,
+    FInstanceBatches& OutBatches)
+{
+    check(Actors.Num() == ActorLODs.Num() && Actors.Num() == ActorBounds.Num() && Actors.Num() == ExcludedActors.Num());
+
+    OutBatches = FInstanceBatches();
+
+    TArray<int32> Order;
+    for (int32 ActorIndex = 0; ActorIndex < Actors.Num(); ActorIndex++)
+    {
+        if (!ExcludedActors[ActorIndex])
+        {
+            Order.Add(ActorIndex);
+        }
+    }
+    Order.StableSort([&](int32 A, int32 B) { return CompareBatchState(Actors[A], ActorLODs[A], Actors[B], ActorLODs[B], ActorMaterials) < 0; });
+
+    uint32 PreviousMeshName = MAX_uint32;
+    for (int32 GroupStart = 0; GroupStart < Order.Num(); )
+    {
+        int32 GroupEnd = GroupStart + 1;
+        while (GroupEnd < Order.Num()
+            && CompareBatchState(Actors[Order[GroupStart]], ActorLODs[Order[GroupStart]], Actors[Order[GroupEnd]], ActorLODs[Order[GroupEnd]], ActorMaterials) == 0)
+        {
+            GroupEnd++;
+        }
+
+        AddGroupBatches(Actors, ActorLODs, ActorBounds, TArrayView<const int32>(Order.GetData() + GroupStart, GroupEnd - GroupStart), MaxInstancesPerBatch, OutBatches);
+
+        // Groups of a mesh are next to each other in the order
+        if (Actors[Order[GroupStart]].MeshName != PreviousMeshName)
+        {
+            PreviousMeshName = Actors[Order[GroupStart]].MeshName;
+            OutBatches.NumMeshes++;
+        }
+
+        GroupStart = GroupEnd;
+    }
+}
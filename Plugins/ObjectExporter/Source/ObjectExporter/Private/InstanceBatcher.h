@@ -0,0 +1,26 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Instance batches of a map and their instances, written as the InstanceBatches, InstanceTransforms, InstanceBounds and InstanceActors chunks */
+struct FInstanceBatches
+{
+    TArray<REngineFormat::MapInstanceBatch> Batches;
+    TArray<REngineFormat::InstanceTransform> Transforms;
+    TArray<REngineFormat::MapActorBounds> Bounds;
+    TArray<uint32> Actors;
+    /** Meshes with at least one batch */
+    int32 NumMeshes = 0;
+};
+
+/**
+*   Group the static mesh actors by mesh, material list and LOD settings, then split every group into spatially coherent batches
+*   of at most MaxInstancesPerBatch instances, so the runtime still culls them. Materials are the ActorMaterials ranges of the actors.
+*   Actors set in ExcludedActors, such as merged ones, get no batch.
+*/
+void BuildInstanceBatches(const TArray<REngineFormat::MapStaticMeshActor>& Actors, const TArray<REngineFormat::MapActorLOD>& ActorLODs,
+    const TArray<REngineFormat::MapActorBounds>& ActorBounds, const TArray<uint32>& ActorMaterials, const TBitArray<>& ExcludedActors, int32 MaxInstancesPerBatch,
+    FInstanceBatches& OutBatches);
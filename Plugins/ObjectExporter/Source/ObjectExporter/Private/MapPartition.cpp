@@ -0,0 +1,138 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MapPartition.h"
+
+struct FPartitionItem
+{
+    FVector2f Center;
+    FBox3f Box;
+    int32 ActorIndex;
+    bool bSkeletal;
+};
+
+static void AddCellItem(FMapPartitionCell& Cell, const FPartitionItem& Item)
+{
+    Cell.Box += Item.Box;
+    (Item.bSkeletal ? Cell.SkeletalMeshActors : Cell.StaticMeshActors).Add(Item.ActorIndex);
+}
+
+static void PartitionUniform(const TArray<FPartitionItem>& Items, float CellSize, TArray<FMapPartitionCell>& OutCells)
+{
+    TMap<FIntPoint, int32> CellIndices;
+    TArray<FIntPoint> CellKeys;
+    TArray<FMapPartitionCell> Cells;
+    for (const FPartitionItem& Item : Items)
+    {
+        const FIntPoint Key(FMath::FloorToInt32(Item.Center.X / CellSize), FMath::FloorToInt32(Item.Center.Y / CellSize));
+        int32& CellIndex = CellIndices.FindOrAdd(Key, Cells.Num());
+        if (CellIndex == Cells.Num())
+        {
+            Cells.AddDefaulted_GetRef().Box = FBox3f(ForceInit);
+            CellKeys.Add(Key);
+        }
+
+        AddCellItem(Cells[CellIndex], Item);
+    }
+
+    TArray<int32> Order;
+    for (int32 CellIndex = 0; CellIndex < Cells.Num(); CellIndex++)
+    {
+        Order.Add(CellIndex);
+    }
+    Order.Sort([&CellKeys](int32 A, int32 B) { return CellKeys[A].Y != CellKeys[B].Y ? CellKeys[A].Y < CellKeys[B].Y : CellKeys[A].X < CellKeys[B].X; });
+
+    for (int32 CellIndex : Order)
+    {
+        OutCells.Add(MoveTemp(Cells[CellIndex]));
+    }
+}
+
+/** Split the items of the square at Min with edge Size into quadrants, the items of the range are reordered in place */
+static void PartitionQuadtree(TArray<FPartitionItem>& Items, int32 FirstItem, int32 NumItems, const FVector2f& Min, float Size, float CellSize,
+    int32 MaxActorsPerCell, TArray<FMapPartitionCell>& OutCells)
+{
+    if (NumItems == 0)
+    {
+        return;
+    }
+
+    if (NumItems <= MaxActorsPerCell || Size * 0.5f < CellSize)
+    {
+        FMapPartitionCell& Cell = OutCells.AddDefaulted_GetRef();
+        Cell.Box = FBox3f(ForceInit);
+        for (int32 ItemIndex = FirstItem; ItemIndex < FirstItem + NumItems; ItemIndex++)
+        {
+            AddCellItem(Cell, Items[ItemIndex]);
+        }
+
+        return;
+    }
+
+    const float HalfSize = Size * 0.5f;
+    const FVector2f Middle = Min + FVector2f(HalfSize, HalfSize);
+    auto GetQuadrant = [&Middle](const FPartitionItem& Item) { return (Item.Center.X >= Middle.X ? 1 : 0) + (Item.Center.Y >= Middle.Y ? 2 : 0); };
+
+    // Stable so actors keep their map order inside a cell
+    TArrayView<FPartitionItem> Range(Items.GetData() + FirstItem, NumItems);
+    TArray<FPartitionItem> Sorted;
+    int32 QuadrantStarts[5] = {};
+    for (int32 Quadrant = 0; Quadrant < 4; Quadrant++)
+    {
+        QuadrantStarts[Quadrant] = Sorted.Num();
+        for (const FPartitionItem& Item : Range)
+        {
+            if (GetQuadrant(Item) == Quadrant)
+            {
+                Sorted.Add(Item);
+            }
+        }
+    }
+    QuadrantStarts[4] = Sorted.Num();
+    FMemory::Memcpy(Range.GetData(), Sorted.GetData(), NumItems * sizeof(FPartitionItem));
+
+    for (int32 Quadrant = 0; Quadrant < 4; Quadrant++)
+    {
+        const FVector2f QuadrantMin(Quadrant & 1 ? Middle.X : Min.X, Quadrant & 2 ? Middle.Y : Min.Y);
+        PartitionQuadtree(Items, FirstItem + QuadrantStarts[Quadrant], QuadrantStarts[Quadrant + 1] - QuadrantStarts[Quadrant], QuadrantMin, HalfSize,
+            CellSize, MaxActorsPerCell, OutCells);
+    }
+}
+
+void PartitionMap(const TArray<REngineFormat::MapActorBounds>& StaticMeshActorBounds, const TArray<REngineFormat::MapActorBounds>& SkeletalMeshActorBounds,
+    bool bQuadtree, float CellSize, int32 MaxActorsPerCell, TArray<FMapPartitionCell>& OutCells)
+{
+    OutCells.Reset();
+    CellSize = FMath::Max(CellSize, 1.0f);
+
+    TArray<FPartitionItem> Items;
+    FBox2f CenterBox(ForceInit);
+    const TArray<REngineFormat::MapActorBounds>* const BoundsLists[2] = { &StaticMeshActorBounds, &SkeletalMeshActorBounds };
+    for (int32 ListIndex = 0; ListIndex < 2; ListIndex++)
+    {
+        for (int32 ActorIndex = 0; ActorIndex < BoundsLists[ListIndex]->Num(); ActorIndex++)
+        {
+            const REngineFormat::MapActorBounds& Bounds = (*BoundsLists[ListIndex])[ActorIndex];
+            const FVector3f Center(Bounds.Center[0], Bounds.Center[1], Bounds.Center[2]);
+            const FVector3f Extent(Bounds.Extent[0], Bounds.Extent[1], Bounds.Extent[2]);
+            Items.Add({ FVector2f(Center.X, Center.Y), FBox3f(Center - Extent, Center + Extent), ActorIndex, ListIndex == 1 });
+            CenterBox += Items.Last().Center;
+        }
+    }
+
+    if (Items.Num() == 0)
+    {
+        return;
+    }
+
+    if (bQuadtree)
+    {
+        const FVector2f Size = CenterBox.GetSize();
+        // Slightly larger than the centers so the ones on the far edge stay inside
+        const float RootSize = FMath::Max(FMath::Max(Size.X, Size.Y) * 1.001f, CellSize);
+        PartitionQuadtree(Items, 0, Items.Num(), CenterBox.Min, RootSize, CellSize, FMath::Max(MaxActorsPerCell, 1), OutCells);
+    }
+    else
+    {
+        PartitionUniform(Items, CellSize, OutCells);
+    }
+}
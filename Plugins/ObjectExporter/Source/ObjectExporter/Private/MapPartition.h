@@ -0,0 +1,23 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Actors of one streaming cell of a map */
+struct FMapPartitionCell
+{
+    /** Bounds of the actors of the cell, they may reach past its square */
+    FBox3f Box;
+    TArray<int32> StaticMeshActors;
+    TArray<int32> SkeletalMeshActors;
+};
+
+/**
+*   Assign every actor to the cell holding its bounds center on the ground plane. A uniform grid uses squares of CellSize, a
+*   quadtree splits the square around all actors until a cell keeps at most MaxActorsPerCell actors or its quadrants would be below CellSize.
+*   Empty cells are left out, the cells are ordered row by row or depth first so neighbours are mostly close in the list.
+*/
+void PartitionMap(const TArray<REngineFormat::MapActorBounds>& StaticMeshActorBounds, const TArray<REngineFormat::MapActorBounds>& SkeletalMeshActorBounds,
+    bool bQuadtree, float CellSize, int32 MaxActorsPerCell, TArray<FMapPartitionCell>& OutCells);
@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MaterialParameterTable.h"
+#include "Hash/CityHash.h"
+
+DECLARE_LOG_CATEGORY_CLASS(MaterialParameterTableLog, Log, All);
+
+// Bits of the fields of a material sort key, from the top bit down
+#define SORT_KEY_BLEND_MODE_BITS 4
+#define SORT_KEY_SHADING_MODEL_BITS 6
+#define SORT_KEY_TWO_SIDED_BITS 1
+#define SORT_KEY_BASE_MATERIAL_BITS 21
+#define SORT_KEY_TEXTURE_SET_BITS 32
+
+uint32 HashMaterialParameterName(const FString& Name)
+{
+    return REngineFormat::HashParameterName(TCHAR_TO_UTF8(*Name));
+}
+
+bool FMaterialParameterTable::AddParameter(const FString& Name, REngineFormat::EMaterialParameterType Type, uint32 ValueIndex)
+{
+    const uint32 NameHash = HashMaterialParameterName(Name);
+    for (int32 ParameterIndex = 0; ParameterIndex < Parameters.Num(); ParameterIndex++)
+    {
+        if (Parameters[ParameterIndex].NameHash == NameHash)
+        {
+            UE_LOG(MaterialParameterTableLog, Warning, TEXT("Material parameter %s has the name hash of %s, it is left out."), *Name, *Names[ParameterIndex]);
+
+            return false;
+        }
+    }
+
+    Parameters.Add({ NameHash, uint32(Type), ValueIndex, 0 });
+    Names.Add(Name);
+
+    return true;
+}
+
+bool FMaterialParameterTable::AddScalar(const FString& Name, float Value)
+{
+    if (!AddParameter(Name, REngineFormat::EMaterialParameterType::Scalar, Values.Num()))
+    {
+        return false;
+    }
+
+    Values.Add(Value);
+
+    return true;
+}
+
+bool FMaterialParameterTable::AddVector(const FString& Name, const FLinearColor& Value)
+{
+    if (!AddParameter(Name, REngineFormat::EMaterialParameterType::Vector, Values.Num()))
+    {
+        return false;
+    }
+
+    Values.Append({ Value.R, Value.G, Value.B, Value.A });
+
+    return true;
+}
+
+bool FMaterialParameterTable::AddTexture(const FString& Name, uint64 TextureId)
+{
+    if (!AddParameter(Name, REngineFormat::EMaterialParameterType::Texture, TextureIds.Num()))
+    {
+        return false;
+    }
+
+    TextureIds.Add(TextureId);
+
+    return true;
+}
+
+void FMaterialParameterTable::Sort()
+{
+    TArray<int32> Order;
+    for (int32 ParameterIndex = 0; ParameterIndex < Parameters.Num(); ParameterIndex++)
+    {
+        Order.Add(ParameterIndex);
+    }
+    Order.Sort([this](int32 A, int32 B) { return Parameters[A].NameHash < Parameters[B].NameHash; });
+
+    // The values stay where they are, the parameters address them
+    TArray<REngineFormat::MaterialParameter> SortedParameters;
+    TArray<FString> SortedNames;
+    for (int32 ParameterIndex : Order)
+    {
+        SortedParameters.Add(Parameters[ParameterIndex]);
+        SortedNames.Add(MoveTemp(Names[ParameterIndex]));
+    }
+
+    Parameters = MoveTemp(SortedParameters);
+    Names = MoveTemp(SortedNames);
+}
+
+uint32 FMaterialParameterTable::GetTextureSetHash() const
+{
+    uint64 Hash = 0;
+    for (const REngineFormat::MaterialParameter& Parameter : Parameters)
+    {
+        if (Parameter.Type == uint32(REngineFormat::EMaterialParameterType::Texture))
+        {
+            const uint64 Binding[2] = { Parameter.NameHash, TextureIds[Parameter.ValueIndex] };
+            Hash = CityHash64WithSeed(reinterpret_cast<const char*>(Binding), sizeof(Binding), Hash);
+        }
+    }
+
+    return uint32(Hash ^ (Hash >> 32));
+}
+
+uint64 MakeMaterialSortKey(int32 BlendMode, int32 ShadingModel, bool bTwoSided, uint32 BaseMaterialHash, uint32 TextureSetHash)
+{
+    uint64 SortKey = uint64(FMath::Clamp(BlendMode, 0, (1 << SORT_KEY_BLEND_MODE_BITS) - 1));
+    SortKey = (SortKey << SORT_KEY_SHADING_MODEL_BITS) | uint64(FMath::Clamp(ShadingModel, 0, (1 << SORT_KEY_SHADING_MODEL_BITS) - 1));
+    SortKey = (SortKey << SORT_KEY_TWO_SIDED_BITS) | uint64(bTwoSided ? 1 : 0);
+    SortKey = (SortKey << SORT_KEY_BASE_MATERIAL_BITS) | uint64(BaseMaterialHash >> (32 - SORT_KEY_BASE_MATERIAL_BITS));
+    SortKey = (SortKey << SORT_KEY_TEXTURE_SET_BITS) | uint64(TextureSetHash);
+
+    return SortKey;
+}
@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Tagged parameters of a material, written as the ParameterTable, ParameterNames, ParameterValues and ParameterTextureIds chunks */
+struct FMaterialParameterTable
+{
+    TArray<REngineFormat::MaterialParameter> Parameters;
+    TArray<FString> Names;
+    TArray<float> Values;
+    TArray<uint64> TextureIds;
+
+    /** False when the name hashes like a parameter already in the table, the parameter is then left out */
+    bool AddScalar(const FString& Name, float Value);
+    bool AddVector(const FString& Name, const FLinearColor& Value);
+    bool AddTexture(const FString& Name, uint64 TextureId);
+
+    /** Order the parameters by name hash so the runtime finds them with a binary search */
+    void Sort();
+
+    /** Hash of the texture ids by parameter, the table must be sorted */
+    uint32 GetTextureSetHash() const;
+
+    int64 GetAllocatedSize() const
+    {
+        return Parameters.GetAllocatedSize() + Names.GetAllocatedSize() + Values.GetAllocatedSize() + TextureIds.GetAllocatedSize();
+    }
+
+private:
+    bool AddParameter(const FString& Name, REngineFormat::EMaterialParameterType Type, uint32 ValueIndex);
+};
+
+uint32 HashMaterialParameterName(const FString& Name);
+
+/** Draw order key of a material, see REngineFormat::MaterialState */
+uint64 MakeMaterialSortKey(int32 BlendMode, int32 ShadingModel, bool bTwoSided, uint32 BaseMaterialHash, uint32 TextureSetHash);
@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MeshBounds.h"
+
+static REngineFormat::MeshBounds MakeMeshBounds(const FBox3f& Box, float Radius)
+{
+    REngineFormat::MeshBounds Bounds = {};
+    if (!Box.IsValid)
+    {
+        Bounds.Radius = -1.0f;
+        return Bounds;
+    }
+
+    const FVector3f Center = Box.GetCenter();
+    const FVector3f Extent = Box.GetExtent();
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        Bounds.Center[Axis] = Center[Axis];
+        Bounds.Extent[Axis] = Extent[Axis];
+    }
+    Bounds.Radius = Radius;
+
+    return Bounds;
+}
+
+REngineFormat::MeshBounds BuildMeshBounds(TArrayView<const FVector3f> Positions)
+{
+    FBox3f Box(ForceInit);
+    for (const FVector3f& Position : Positions)
+    {
+        Box += Position;
+    }
+
+    const FVector3f Center = Box.GetCenter();
+    float RadiusSquared = 0.0f;
+    for (const FVector3f& Position : Positions)
+    {
+        RadiusSquared = FMath::Max(RadiusSquared, FVector3f::DistSquared(Position, Center));
+    }
+
+    return MakeMeshBounds(Box, FMath::Sqrt(RadiusSquared));
+}
+
+REngineFormat::MeshBounds BuildIndexedBounds(TArrayView<const FVector3f> Positions, const TArray<uint32>& Indices, uint32 FirstIndex, uint32 NumIndices)
+{
+    FBox3f Box(ForceInit);
+    for (uint32 IndexIndex = FirstIndex; IndexIndex < FirstIndex + NumIndices; IndexIndex++)
+    {
+        Box += Positions[Indices[IndexIndex]];
+    }
+
+    const FVector3f Center = Box.GetCenter();
+    float RadiusSquared = 0.0f;
+    for (uint32 IndexIndex = FirstIndex; IndexIndex < FirstIndex + NumIndices; IndexIndex++)
+    {
+        RadiusSquared = FMath::Max(RadiusSquared, FVector3f::DistSquared(Positions[Indices[IndexIndex]], Center));
+    }
+
+    return MakeMeshBounds(Box, FMath::Sqrt(RadiusSquared));
+}
+
+void BuildBoneBounds(TArrayView<const FVector3f> Positions, const TArray<FVertexInfluences>& Influences, const TArray<int32>& InfluenceBones,
+    const TArray<FMatrix44f>& InverseBindMatrices, TArray<REngineFormat::MeshBounds>& OutBounds)
+{
+    check(Positions.Num() == Influences.Num());
+
+    // Boxes in the first pass, the spheres around their centers in the second
+    TArray<FBox3f> Boxes;
+    Boxes.Init(FBox3f(ForceInit), InverseBindMatrices.Num());
+    TArray<float> RadiiSquared;
+    RadiiSquared.Init(0.0f, InverseBindMatrices.Num());
+
+    for (int32 Pass = 0; Pass < 2; Pass++)
+    {
+        for (int32 VertexIndex = 0; VertexIndex < Positions.Num(); VertexIndex++)
+        {
+            const FVertexInfluences& VertexInfluences = Influences[VertexIndex];
+            for (int32 Influence = 0; Influence < VertexInfluences.NumInfluences; Influence++)
+            {
+                const int32 InfluenceBone = VertexInfluences.Bones[Influence];
+                const int32 Bone = InfluenceBones.IsValidIndex(InfluenceBone) ? InfluenceBones[InfluenceBone] : INDEX_NONE;
+                if (Bone == INDEX_NONE || VertexInfluences.Weights[Influence] == 0)
+                {
+                    continue;
+                }
+
+                const FVector3f BonePosition = InverseBindMatrices[Bone].TransformPosition(Positions[VertexIndex]);
+                if (Pass == 0)
+                {
+                    Boxes[Bone] += BonePosition;
+                }
+                else
+                {
+                    RadiiSquared[Bone] = FMath::Max(RadiiSquared[Bone], FVector3f::DistSquared(BonePosition, Boxes[Bone].GetCenter()));
+                }
+            }
+        }
+    }
+
+    OutBounds.SetNumUninitialized(InverseBindMatrices.Num());
+    for (int32 Bone = 0; Bone < InverseBindMatrices.Num(); Bone++)
+    {
+        OutBounds[Bone] = MakeMeshBounds(Boxes[Bone], FMath::Sqrt(RadiiSquared[Bone]));
+    }
+}
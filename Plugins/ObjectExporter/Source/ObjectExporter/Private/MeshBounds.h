@@ -0,0 +1,22 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+#include "SkinPalette.h"
+
+/** Box around the positions and the smallest sphere around its center holding them, an empty range has a negative Radius */
+REngineFormat::MeshBounds BuildMeshBounds(TArrayView<const FVector3f> Positions);
+
+/** Bounds of the positions the indices FirstIndex to FirstIndex + NumIndices address */
+REngineFormat::MeshBounds BuildIndexedBounds(TArrayView<const FVector3f> Positions, const TArray<uint32>& Indices, uint32 FirstIndex, uint32 NumIndices);
+
+/**
+*   Bounds of the vertices every bone weights, in the space of the bone. InfluenceBones maps the bones of the influences to
+*   exported bones, INDEX_NONE drops them. InverseBindMatrices are those the mesh skins with, one per exported bone.
+*   A skinned vertex is a weighted average of its positions moved by each of its bones, so the box around all bounds
+*   moved by the current bone matrices always contains it.
+*/
+void BuildBoneBounds(TArrayView<const FVector3f> Positions, const TArray<FVertexInfluences>& Influences, const TArray<int32>& InfluenceBones,
+    const TArray<FMatrix44f>& InverseBindMatrices, TArray<REngineFormat::MeshBounds>& OutBounds);
@@ -0,0 +1,466 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MeshOptimization.h"
+
+#define ANALYZE_CACHE_SIZE 16
+#define FORSYTH_CACHE_SIZE 32
+#define FORSYTH_CACHE_DECAY_POWER 1.5f
+#define FORSYTH_LAST_TRIANGLE_SCORE 0.75f
+#define FORSYTH_VALENCE_BOOST_SCALE 2.0f
+#define FORSYTH_VALENCE_BOOST_POWER 0.5f
+
+FVertexCacheStats AnalyzeVertexCache(const TArray<uint32>& Indices, int32 NumVertices)
+{
+    FVertexCacheStats Stats;
+    if (Indices.Num() < 3 || NumVertices <= 0)
+    {
+        return Stats;
+    }
+
+    // FIFO cache, a vertex is cached while its insertion stamp is within the last ANALYZE_CACHE_SIZE misses
+    TArray<uint32> CacheStamps;
+    CacheStamps.SetNumZeroed(NumVertices);
+    TArray<bool> Referenced;
+    Referenced.SetNumZeroed(NumVertices);
+
+    uint32 Timestamp = ANALYZE_CACHE_SIZE + 1;
+    int32 NumMisses = 0;
+    int32 NumReferenced = 0;
+    for (uint32 Index : Indices)
+    {
+        if (Timestamp - CacheStamps[Index] > ANALYZE_CACHE_SIZE)
+        {
+            CacheStamps[Index] = Timestamp++;
+            NumMisses++;
+        }
+
+        if (!Referenced[Index])
+        {
+            Referenced[Index] = true;
+            NumReferenced++;
+        }
+    }
+
+    Stats.ACMR = float(NumMisses) / (Indices.Num() / 3);
+    Stats.ATVR = float(NumMisses) / FMath::Max(NumReferenced, 1);
+
+    return Stats;
+}
+
+static float GetForsythVertexScore(int32 CachePosition, int32 NumActiveTriangles)
+{
+    if (NumActiveTriangles == 0)
+    {
+        // No triangle needs this vertex
+        return -1.0f;
+    }
+
+    float Score = 0.0f;
+    if (CachePosition >= 0)
+    {
+        if (CachePosition < 3)
+        {
+            // Used by the last triangle, a fixed score avoids favouring any of its edges
+            Score = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            const float Scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            Score = FMath::Pow(1.0f - (CachePosition - 3) * Scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost vertices with few triangles left so lone triangles are not left behind
+    Score += FORSYTH_VALENCE_BOOST_SCALE * FMath::Pow(float(NumActiveTriangles), -FORSYTH_VALENCE_BOOST_POWER);
+
+    return Score;
+}
+
+void OptimizeVertexCache(TArrayView<uint32> SectionIndices)
+{
+    const int32 NumTriangles = SectionIndices.Num() / 3;
+    if (NumTriangles < 2)
+    {
+        return;
+    }
+
+    // Work on local vertex indices of the section range
+    uint32 MinIndex = MAX_uint32;
+    uint32 MaxIndex = 0;
+    for (uint32 Index : SectionIndices)
+    {
+        MinIndex = FMath::Min(MinIndex, Index);
+        MaxIndex = FMath::Max(MaxIndex, Index);
+    }
+    const int32 NumVertices = MaxIndex - MinIndex + 1;
+
+    // Vertex to triangle adjacency, the first NumActiveTriangles entries of a vertex are its pending triangles
+    TArray<int32> NumActiveTriangles;
+    NumActiveTriangles.SetNumZeroed(NumVertices);
+    for (uint32 Index : SectionIndices)
+    {
+        NumActiveTriangles[Index - MinIndex]++;
+    }
+
+    TArray<int32> AdjacencyOffsets;
+    AdjacencyOffsets.SetNumUninitialized(NumVertices + 1);
+    AdjacencyOffsets[0] = 0;
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        AdjacencyOffsets[iVertex + 1] = AdjacencyOffsets[iVertex] + NumActiveTriangles[iVertex];
+    }
+
+    TArray<int32> AdjacencyFill;
+    AdjacencyFill.SetNumZeroed(NumVertices);
+    TArray<int32> Adjacency;
+    Adjacency.SetNumUninitialized(SectionIndices.Num());
+    for (int32 iTriangle = 0; iTriangle < NumTriangles; iTriangle++)
+    {
+        for (int32 iCorner = 0; iCorner < 3; iCorner++)
+        {
+            const int32 LocalVertex = SectionIndices[iTriangle * 3 + iCorner] - MinIndex;
+            Adjacency[AdjacencyOffsets[LocalVertex] + AdjacencyFill[LocalVertex]++] = iTriangle;
+        }
+    }
+
+    TArray<int32> CachePositions;
+    CachePositions.Init(-1, NumVertices);
+    TArray<float> VertexScores;
+    VertexScores.SetNumUninitialized(NumVertices);
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        VertexScores[iVertex] = GetForsythVertexScore(-1, NumActiveTriangles[iVertex]);
+    }
+
+    TArray<float> TriangleScores;
+    TriangleScores.SetNumUninitialized(NumTriangles);
+    TArray<bool> TriangleEmitted;
+    TriangleEmitted.SetNumZeroed(NumTriangles);
+
+    int32 BestTriangle = -1;
+    float BestScore = -1.0f;
+    for (int32 iTriangle = 0; iTriangle < NumTriangles; iTriangle++)
+    {
+        TriangleScores[iTriangle] = VertexScores[SectionIndices[iTriangle * 3 + 0] - MinIndex]
+            + VertexScores[SectionIndices[iTriangle * 3 + 1] - MinIndex]
+            + VertexScores[SectionIndices[iTriangle * 3 + 2] - MinIndex];
+
+        if (TriangleScores[iTriangle] > BestScore)
+        {
+            BestScore = TriangleScores[iTriangle];
+            BestTriangle = iTriangle;
+        }
+    }
+
+    TArray<uint32> OutIndices;
+    OutIndices.Reserve(SectionIndices.Num());
+
+    // LRU cache with room for the three vertices pushed by each new triangle
+    TArray<int32> Cache;
+    TArray<int32> NewCache;
+    Cache.Reserve(FORSYTH_CACHE_SIZE + 3);
+    NewCache.Reserve(FORSYTH_CACHE_SIZE + 3);
+
+    int32 ScanCursor = 0;
+    for (int32 NumEmitted = 0; NumEmitted < NumTriangles; NumEmitted++)
+    {
+        if (BestTriangle < 0)
+        {
+            // Nothing in the cache touches a pending triangle, take the next pending one in input order
+            while (TriangleEmitted[ScanCursor])
+            {
+                ScanCursor++;
+            }
+            BestTriangle = ScanCursor;
+        }
+
+        TriangleEmitted[BestTriangle] = true;
+
+        NewCache.Reset();
+        for (int32 iCorner = 0; iCorner < 3; iCorner++)
+        {
+            const uint32 Index = SectionIndices[BestTriangle * 3 + iCorner];
+            const int32 LocalVertex = Index - MinIndex;
+            OutIndices.Add(Index);
+            NewCache.Add(LocalVertex);
+
+            // Remove the triangle from the pending list of the vertex
+            const int32 AdjacencyOffset = AdjacencyOffsets[LocalVertex];
+            const int32 LastActive = AdjacencyOffset + NumActiveTriangles[LocalVertex] - 1;
+            for (int32 iAdjacency = AdjacencyOffset; iAdjacency <= LastActive; iAdjacency++)
+            {
+                if (Adjacency[iAdjacency] == BestTriangle)
+                {
+                    Swap(Adjacency[iAdjacency], Adjacency[LastActive]);
+                    break;
+                }
+            }
+            NumActiveTriangles[LocalVertex]--;
+        }
+
+        for (int32 LocalVertex : Cache)
+        {
+            if (!NewCache.Contains(LocalVertex))
+            {
+                NewCache.Add(LocalVertex);
+            }
+        }
+        Swap(Cache, NewCache);
+
+        // Rescore the cached vertices and the triangles around them, vertices past the cache size drop out
+        for (int32 CachePosition = 0; CachePosition < Cache.Num(); CachePosition++)
+        {
+            const int32 LocalVertex = Cache[CachePosition];
+            CachePositions[LocalVertex] = CachePosition < FORSYTH_CACHE_SIZE ? CachePosition : -1;
+
+            const float NewScore = GetForsythVertexScore(CachePositions[LocalVertex], NumActiveTriangles[LocalVertex]);
+            const float ScoreDelta = NewScore - VertexScores[LocalVertex];
+            VertexScores[LocalVertex] = NewScore;
+
+            const int32 AdjacencyOffset = AdjacencyOffsets[LocalVertex];
+            for (int32 iAdjacency = AdjacencyOffset; iAdjacency < AdjacencyOffset + NumActiveTriangles[LocalVertex]; iAdjacency++)
+            {
+                TriangleScores[Adjacency[iAdjacency]] += ScoreDelta;
+            }
+        }
+
+        // The next triangle is the best pending one around the cache
+        BestTriangle = -1;
+        BestScore = -1.0f;
+        for (int32 CachePosition = 0; CachePosition < FMath::Min(Cache.Num(), FORSYTH_CACHE_SIZE); CachePosition++)
+        {
+            const int32 LocalVertex = Cache[CachePosition];
+            const int32 AdjacencyOffset = AdjacencyOffsets[LocalVertex];
+            for (int32 iAdjacency = AdjacencyOffset; iAdjacency < AdjacencyOffset + NumActiveTriangles[LocalVertex]; iAdjacency++)
+            {
+                const int32 Triangle = Adjacency[iAdjacency];
+                if (TriangleScores[Triangle] > BestScore)
+                {
+                    BestScore = TriangleScores[Triangle];
+                    BestTriangle = Triangle;
+                }
+            }
+        }
+
+        if (Cache.Num() > FORSYTH_CACHE_SIZE)
+        {
+            Cache.SetNum(FORSYTH_CACHE_SIZE);
+        }
+    }
+
+    FMemory::Memcpy(SectionIndices.GetData(), OutIndices.GetData(), OutIndices.Num() * sizeof(uint32));
+}
+
+void OptimizeOverdraw(TArrayView<uint32> SectionIndices, const TArray<FVector3f>& Positions, float Threshold)
+{
+    const int32 NumTriangles = SectionIndices.Num() / 3;
+    if (NumTriangles < 2)
+    {
+        return;
+    }
+
+    // Simulated FIFO cache, bumping the timestamp past the cache size empties it
+    TMap<uint32, uint32> CacheStamps;
+    uint32 Timestamp = ANALYZE_CACHE_SIZE + 1;
+    auto SimulateTriangle = [&](int32 iTriangle)
+    {
+        int32 Misses = 0;
+        for (int32 iCorner = 0; iCorner < 3; iCorner++)
+        {
+            uint32& Stamp = CacheStamps.FindOrAdd(SectionIndices[iTriangle * 3 + iCorner], 0);
+            if (Timestamp - Stamp > ANALYZE_CACHE_SIZE)
+            {
+                Stamp = Timestamp++;
+                Misses++;
+            }
+        }
+        return Misses;
+    };
+    auto ResetCache = [&Timestamp]()
+    {
+        Timestamp += ANALYZE_CACHE_SIZE + 1;
+    };
+
+    // Hard cluster boundaries where the cache restarts anyway, every vertex of the triangle misses
+    TArray<int32> HardClusters;
+    for (int32 iTriangle = 0; iTriangle < NumTriangles; iTriangle++)
+    {
+        if (SimulateTriangle(iTriangle) == 3)
+        {
+            HardClusters.Add(iTriangle);
+        }
+    }
+    HardClusters.Add(NumTriangles);
+
+    // Soft boundaries, split a hard cluster as soon as the ACMR from the last split, starting cold, is within Threshold of the whole cluster
+    TArray<int32> Clusters;
+    for (int32 iCluster = 0; iCluster + 1 < HardClusters.Num(); iCluster++)
+    {
+        const int32 Start = HardClusters[iCluster];
+        const int32 End = HardClusters[iCluster + 1];
+
+        ResetCache();
+        int32 ClusterMisses = 0;
+        for (int32 iTriangle = Start; iTriangle < End; iTriangle++)
+        {
+            ClusterMisses += SimulateTriangle(iTriangle);
+        }
+        const float ClusterThreshold = Threshold * ClusterMisses / (End - Start);
+
+        ResetCache();
+        Clusters.Add(Start);
+        int32 RunningStart = Start;
+        int32 RunningMisses = 0;
+        for (int32 iTriangle = Start; iTriangle + 1 < End; iTriangle++)
+        {
+            RunningMisses += SimulateTriangle(iTriangle);
+            if (float(RunningMisses) / (iTriangle + 1 - RunningStart) <= ClusterThreshold)
+            {
+                Clusters.Add(iTriangle + 1);
+                ResetCache();
+                RunningStart = iTriangle + 1;
+                RunningMisses = 0;
+            }
+        }
+    }
+    Clusters.Add(NumTriangles);
+
+    // Sort clusters by how much they face away from the mesh center, outer clusters occlude inner ones
+    FVector3f MeshCentroid = FVector3f::ZeroVector;
+    float MeshArea = 0.0f;
+    TArray<FVector3f> ClusterCentroids;
+    TArray<FVector3f> ClusterNormals;
+    for (int32 iCluster = 0; iCluster + 1 < Clusters.Num(); iCluster++)
+    {
+        FVector3f Centroid = FVector3f::ZeroVector;
+        FVector3f Normal = FVector3f::ZeroVector;
+        float Area = 0.0f;
+        for (int32 iTriangle = Clusters[iCluster]; iTriangle < Clusters[iCluster + 1]; iTriangle++)
+        {
+            const FVector3f& P0 = Positions[SectionIndices[iTriangle * 3 + 0]];
+            const FVector3f& P1 = Positions[SectionIndices[iTriangle * 3 + 1]];
+            const FVector3f& P2 = Positions[SectionIndices[iTriangle * 3 + 2]];
+            const FVector3f AreaNormal = FVector3f::CrossProduct(P1 - P0, P2 - P0);
+            const float TriangleArea = AreaNormal.Size();
+
+            Centroid += (P0 + P1 + P2) * (TriangleArea / 3.0f);
+            Normal += AreaNormal;
+            Area += TriangleArea;
+        }
+
+        MeshCentroid += Centroid;
+        MeshArea += Area;
+        ClusterCentroids.Add(Area > 0.0f ? Centroid / Area : Positions[SectionIndices[Clusters[iCluster] * 3]]);
+        ClusterNormals.Add(Normal.GetSafeNormal());
+    }
+    MeshCentroid = MeshArea > 0.0f ? MeshCentroid / MeshArea : FVector3f::ZeroVector;
+
+    TArray<int32> ClusterOrder;
+    TArray<float> ClusterSortKeys;
+    for (int32 iCluster = 0; iCluster < ClusterCentroids.Num(); iCluster++)
+    {
+        ClusterOrder.Add(iCluster);
+        ClusterSortKeys.Add(FVector3f::DotProduct(ClusterCentroids[iCluster] - MeshCentroid, ClusterNormals[iCluster]));
+    }
+    ClusterOrder.StableSort([&ClusterSortKeys](int32 A, int32 B)
+    {
+        return ClusterSortKeys[A] > ClusterSortKeys[B];
+    });
+
+    TArray<uint32> OutIndices;
+    OutIndices.Reserve(SectionIndices.Num());
+    for (int32 iCluster : ClusterOrder)
+    {
+        for (int32 iIndex = Clusters[iCluster] * 3; iIndex < Clusters[iCluster + 1] * 3; iIndex++)
+        {
+            OutIndices.Add(SectionIndices[iIndex]);
+        }
+    }
+
+    FMemory::Memcpy(SectionIndices.GetData(), OutIndices.GetData(), OutIndices.Num() * sizeof(uint32));
+}
+
+void OptimizeVertexFetch(TArray<uint32>& Indices, const TArray<FMeshOptimizationSection>& Sections, int32 NumVertices, TArray<uint32>& OutVertexRemap)
+{
+    // Merge overlapping section vertex ranges, vertices only move inside their merged range
+    TArray<FMeshOptimizationSection> Ranges = Sections;
+    Ranges.Sort([](const FMeshOptimizationSection& A, const FMeshOptimizationSection& B)
+    {
+        return A.FirstVertex < B.FirstVertex;
+    });
+
+    TArray<int32> RangeOfVertex;
+    RangeOfVertex.Init(INDEX_NONE, NumVertices);
+    TArray<uint32> RangeStarts;
+    TArray<uint32> RangeEnds;
+    for (const FMeshOptimizationSection& Range : Ranges)
+    {
+        const uint32 End = FMath::Min<uint32>(Range.FirstVertex + Range.NumVertices, NumVertices);
+        if (RangeEnds.Num() > 0 && Range.FirstVertex < RangeEnds.Last())
+        {
+            RangeEnds.Last() = FMath::Max(RangeEnds.Last(), End);
+        }
+        else
+        {
+            RangeStarts.Add(Range.FirstVertex);
+            RangeEnds.Add(End);
+        }
+    }
+    for (int32 iRange = 0; iRange < RangeStarts.Num(); iRange++)
+    {
+        for (uint32 iVertex = RangeStarts[iRange]; iVertex < RangeEnds[iRange]; iVertex++)
+        {
+            RangeOfVertex[iVertex] = iRange;
+        }
+    }
+
+    OutVertexRemap.Init(MAX_uint32, NumVertices);
+    TArray<uint32> NextVertex = RangeStarts;
+
+    for (uint32& Index : Indices)
+    {
+        const int32 iRange = RangeOfVertex[Index];
+        if (iRange == INDEX_NONE)
+        {
+            continue;
+        }
+
+        if (OutVertexRemap[Index] == MAX_uint32)
+        {
+            OutVertexRemap[Index] = NextVertex[iRange]++;
+        }
+    }
+
+    // Unreferenced vertices go to the end of their range, vertices outside every range stay in place
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        if (OutVertexRemap[iVertex] == MAX_uint32)
+        {
+            const int32 iRange = RangeOfVertex[iVertex];
+            OutVertexRemap[iVertex] = iRange == INDEX_NONE ? iVertex : NextVertex[iRange]++;
+        }
+    }
+
+    for (uint32& Index : Indices)
+    {
+        Index = OutVertexRemap[Index];
+    }
+}
+
+void OptimizeMesh(TArray<uint32>& Indices, const TArray<FVector3f>& Positions, const TArray<FMeshOptimizationSection>& Sections,
+    TArray<uint32>& OutVertexRemap, FMeshOptimizationReport& OutReport)
+{
+    OutReport.Before = AnalyzeVertexCache(Indices, Positions.Num());
+
+    for (const FMeshOptimizationSection& Section : Sections)
+    {
+        TArrayView<uint32> SectionIndices(Indices.GetData() + Section.FirstIndex, Section.NumTriangles * 3);
+
+        OptimizeVertexCache(SectionIndices);
+        OptimizeOverdraw(SectionIndices, Positions);
+    }
+
+    OptimizeVertexFetch(Indices, Sections, Positions.Num(), OutVertexRemap);
+
+    OutReport.After = AnalyzeVertexCache(Indices, Positions.Num());
+}
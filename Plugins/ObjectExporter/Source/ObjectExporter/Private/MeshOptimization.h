@@ -0,0 +1,58 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Index and vertex range of one mesh section, vertices of different sections may share a range */
+struct FMeshOptimizationSection
+{
+    uint32 FirstIndex;
+    uint32 NumTriangles;
+    uint32 FirstVertex;
+    uint32 NumVertices;
+};
+
+/** Average cache miss ratio per triangle (ACMR) and per vertex (ATVR) of a simulated 16 entry FIFO post transform cache */
+struct FVertexCacheStats
+{
+    float ACMR = 0.0f;
+    float ATVR = 0.0f;
+};
+
+struct FMeshOptimizationReport
+{
+    FVertexCacheStats Before;
+    FVertexCacheStats After;
+};
+
+FVertexCacheStats AnalyzeVertexCache(const TArray<uint32>& Indices, int32 NumVertices);
+
+/** Reorder the triangles of a section for post transform cache locality (Forsyth) */
+void OptimizeVertexCache(TArrayView<uint32> SectionIndices);
+
+/** Reorder cache optimized clusters of a section front to back from the outside, keeping the cache efficiency within Threshold of the input */
+void OptimizeOverdraw(TArrayView<uint32> SectionIndices, const TArray<FVector3f>& Positions, float Threshold = 1.05f);
+
+/** Renumber the vertices of each section range in order of first use, OutVertexRemap maps an old vertex index to its new index */
+void OptimizeVertexFetch(TArray<uint32>& Indices, const TArray<FMeshOptimizationSection>& Sections, int32 NumVertices, TArray<uint32>& OutVertexRemap);
+
+/** Run all passes above on one LOD, the caller applies OutVertexRemap to its vertex streams */
+void OptimizeMesh(TArray<uint32>& Indices, const TArray<FVector3f>& Positions, const TArray<FMeshOptimizationSection>& Sections,
+    TArray<uint32>& OutVertexRemap, FMeshOptimizationReport& OutReport);
+
+/** Move every vertex to its new index */
+template<typename VertexType>
+void RemapVertices(TArray<VertexType>& Vertices, const TArray<uint32>& VertexRemap)
+{
+    check(Vertices.Num() == VertexRemap.Num());
+
+    TArray<VertexType> RemappedVertices;
+    RemappedVertices.SetNumUninitialized(Vertices.Num());
+    for (int32 iVertex = 0; iVertex < Vertices.Num(); iVertex++)
+    {
+        RemappedVertices[VertexRemap[iVertex]] = Vertices[iVertex];
+    }
+
+    Vertices = MoveTemp(RemappedVertices);
+}
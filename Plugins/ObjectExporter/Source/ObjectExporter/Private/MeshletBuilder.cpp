@@ -0,0 +1,268 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MeshletBuilder.h"
+
+// Weight of normal deviation against distance, in average edge lengths, when growing a meshlet
+#define MESHLET_CONE_WEIGHT 2.0f
+// Below this the normals are too spread out for a useful cone
+#define MESHLET_MIN_CONE_DOT 0.1f
+
+static void FinishMeshlet(REngineFormat::Meshlet& Meshlet, const TArray<FVector3f>& Positions, FMeshletBuildOutput& Output)
+{
+    if (Meshlet.TriangleCount > 0)
+    {
+        ComputeMeshletBounds(Meshlet, Output.MeshletVertices, Output.MeshletTriangles, Positions);
+        Output.Meshlets.Add(Meshlet);
+    }
+
+    const uint32 SectionIndex = Meshlet.SectionIndex;
+    Meshlet = {};
+    Meshlet.VertexOffset = Output.MeshletVertices.Num();
+    Meshlet.TriangleOffset = Output.MeshletTriangles.Num();
+    Meshlet.SectionIndex = SectionIndex;
+}
+
+void BuildSectionMeshlets(const TArray<uint32>& Indices, const TArray<FVector3f>& Positions, uint32 FirstIndex, uint32 NumTriangles, uint32 SectionIndex,
+    FMeshletBuildOutput& Output)
+{
+    using namespace REngineFormat;
+
+    if (NumTriangles == 0)
+    {
+        return;
+    }
+
+    const uint32* SectionIndices = Indices.GetData() + FirstIndex;
+    const int32 NumIndices = NumTriangles * 3;
+
+    // Work on local vertex indices of the section range
+    uint32 MinIndex = MAX_uint32;
+    uint32 MaxIndex = 0;
+    for (int32 iIndex = 0; iIndex < NumIndices; iIndex++)
+    {
+        MinIndex = FMath::Min(MinIndex, SectionIndices[iIndex]);
+        MaxIndex = FMath::Max(MaxIndex, SectionIndices[iIndex]);
+    }
+    const int32 NumVertices = MaxIndex - MinIndex + 1;
+
+    // Vertex to triangle adjacency
+    TArray<int32> AdjacencyOffsets;
+    AdjacencyOffsets.SetNumZeroed(NumVertices + 1);
+    for (int32 iIndex = 0; iIndex < NumIndices; iIndex++)
+    {
+        AdjacencyOffsets[SectionIndices[iIndex] - MinIndex + 1]++;
+    }
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        AdjacencyOffsets[iVertex + 1] += AdjacencyOffsets[iVertex];
+    }
+
+    TArray<int32> AdjacencyFill;
+    AdjacencyFill.SetNumZeroed(NumVertices);
+    TArray<int32> Adjacency;
+    Adjacency.SetNumUninitialized(NumIndices);
+    for (int32 iIndex = 0; iIndex < NumIndices; iIndex++)
+    {
+        const int32 LocalVertex = SectionIndices[iIndex] - MinIndex;
+        Adjacency[AdjacencyOffsets[LocalVertex] + AdjacencyFill[LocalVertex]++] = iIndex / 3;
+    }
+
+    // Triangle centroids and unit normals, distances are measured in average edge lengths
+    TArray<FVector3f> TriangleCentroids;
+    TArray<FVector3f> TriangleNormals;
+    TriangleCentroids.SetNumUninitialized(NumTriangles);
+    TriangleNormals.SetNumUninitialized(NumTriangles);
+    double EdgeLengthSum = 0.0;
+    for (uint32 iTriangle = 0; iTriangle < NumTriangles; iTriangle++)
+    {
+        const FVector3f& P0 = Positions[SectionIndices[iTriangle * 3 + 0]];
+        const FVector3f& P1 = Positions[SectionIndices[iTriangle * 3 + 1]];
+        const FVector3f& P2 = Positions[SectionIndices[iTriangle * 3 + 2]];
+
+        TriangleCentroids[iTriangle] = (P0 + P1 + P2) / 3.0f;
+        TriangleNormals[iTriangle] = FVector3f::CrossProduct(P1 - P0, P2 - P0).GetSafeNormal();
+        EdgeLengthSum += FVector3f::Distance(P0, P1) + FVector3f::Distance(P1, P2) + FVector3f::Distance(P2, P0);
+    }
+    const float InvEdgeLength = 1.0f / FMath::Max(float(EdgeLengthSum / (NumTriangles * 3)), SMALL_NUMBER);
+
+    // A vertex belongs to the current meshlet when its stamp is the meshlet id
+    TArray<int32> VertexStamps;
+    VertexStamps.Init(INDEX_NONE, NumVertices);
+    TArray<uint8> VertexLocalIndices;
+    VertexLocalIndices.SetNumZeroed(NumVertices);
+    TArray<bool> TriangleEmitted;
+    TriangleEmitted.SetNumZeroed(NumTriangles);
+
+    Meshlet Current = {};
+    Current.SectionIndex = SectionIndex;
+    FinishMeshlet(Current, Positions, Output);
+
+    int32 MeshletId = 0;
+    FVector3f CentroidSum = FVector3f::ZeroVector;
+    FVector3f NormalSum = FVector3f::ZeroVector;
+    uint32 ScanCursor = 0;
+
+    for (uint32 NumEmitted = 0; NumEmitted < NumTriangles; NumEmitted++)
+    {
+        int32 BestTriangle = INDEX_NONE;
+
+        if (Current.TriangleCount > 0 && Current.TriangleCount < MaxMeshletTriangles)
+        {
+            // Grow into the pending triangle around the meshlet that adds the fewest vertices, then the closest and flattest one
+            const FVector3f Center = CentroidSum / float(Current.TriangleCount);
+            const FVector3f Normal = NormalSum.GetSafeNormal();
+
+            int32 BestNewVertices = 4;
+            float BestSpread = MAX_flt;
+            for (uint32 iMeshletVertex = 0; iMeshletVertex < Current.VertexCount; iMeshletVertex++)
+            {
+                const int32 LocalVertex = Output.MeshletVertices[Current.VertexOffset + iMeshletVertex] - MinIndex;
+                for (int32 iAdjacency = AdjacencyOffsets[LocalVertex]; iAdjacency < AdjacencyOffsets[LocalVertex + 1]; iAdjacency++)
+                {
+                    const int32 Triangle = Adjacency[iAdjacency];
+                    if (TriangleEmitted[Triangle])
+                    {
+                        continue;
+                    }
+
+                    int32 NewVertices = 0;
+                    for (int32 iCorner = 0; iCorner < 3; iCorner++)
+                    {
+                        NewVertices += VertexStamps[SectionIndices[Triangle * 3 + iCorner] - MinIndex] != MeshletId ? 1 : 0;
+                    }
+                    if (Current.VertexCount + NewVertices > MaxMeshletVertices || NewVertices > BestNewVertices)
+                    {
+                        continue;
+                    }
+
+                    const float Spread = FVector3f::Distance(TriangleCentroids[Triangle], Center) * InvEdgeLength
+                        + MESHLET_CONE_WEIGHT * (1.0f - FVector3f::DotProduct(TriangleNormals[Triangle], Normal));
+                    if (NewVertices < BestNewVertices || Spread < BestSpread)
+                    {
+                        BestNewVertices = NewVertices;
+                        BestSpread = Spread;
+                        BestTriangle = Triangle;
+                    }
+                }
+            }
+        }
+
+        if (BestTriangle == INDEX_NONE)
+        {
+            // The meshlet is full or has no pending neighbours, start the next one from the first pending triangle in index order
+            if (Current.TriangleCount > 0)
+            {
+                FinishMeshlet(Current, Positions, Output);
+                MeshletId++;
+                CentroidSum = FVector3f::ZeroVector;
+                NormalSum = FVector3f::ZeroVector;
+            }
+
+            while (TriangleEmitted[ScanCursor])
+            {
+                ScanCursor++;
+            }
+            BestTriangle = ScanCursor;
+        }
+
+        for (int32 iCorner = 0; iCorner < 3; iCorner++)
+        {
+            const uint32 Index = SectionIndices[BestTriangle * 3 + iCorner];
+            const int32 LocalVertex = Index - MinIndex;
+            if (VertexStamps[LocalVertex] != MeshletId)
+            {
+                VertexStamps[LocalVertex] = MeshletId;
+                VertexLocalIndices[LocalVertex] = uint8(Current.VertexCount++);
+                Output.MeshletVertices.Add(Index);
+            }
+
+            Output.MeshletTriangles.Add(VertexLocalIndices[LocalVertex]);
+        }
+
+        TriangleEmitted[BestTriangle] = true;
+        Current.TriangleCount++;
+        CentroidSum += TriangleCentroids[BestTriangle];
+        NormalSum += TriangleNormals[BestTriangle];
+    }
+
+    FinishMeshlet(Current, Positions, Output);
+}
+
+void ComputeMeshletBounds(REngineFormat::Meshlet& Meshlet, const TArray<uint32>& MeshletVertices, const TArray<uint8>& MeshletTriangles, const TArray<FVector3f>& Positions)
+{
+    // Bounding sphere around the box center
+    FBox3f Bounds(ForceInit);
+    for (uint32 iVertex = 0; iVertex < Meshlet.VertexCount; iVertex++)
+    {
+        Bounds += Positions[MeshletVertices[Meshlet.VertexOffset + iVertex]];
+    }
+
+    const FVector3f Center = Bounds.GetCenter();
+    float RadiusSquared = 0.0f;
+    for (uint32 iVertex = 0; iVertex < Meshlet.VertexCount; iVertex++)
+    {
+        RadiusSquared = FMath::Max(RadiusSquared, FVector3f::DistSquared(Center, Positions[MeshletVertices[Meshlet.VertexOffset + iVertex]]));
+    }
+
+    Meshlet.Center[0] = Center.X;
+    Meshlet.Center[1] = Center.Y;
+    Meshlet.Center[2] = Center.Z;
+    Meshlet.Radius = FMath::Sqrt(RadiusSquared);
+
+    // Normal cone, the axis is the average normal and the cutoff the sine of the widest normal deviation
+    TArray<FVector3f, TInlineAllocator<REngineFormat::MaxMeshletTriangles>> Normals;
+    TArray<FVector3f, TInlineAllocator<REngineFormat::MaxMeshletTriangles>> Corners;
+    FVector3f Axis = FVector3f::ZeroVector;
+    for (uint32 iTriangle = 0; iTriangle < Meshlet.TriangleCount; iTriangle++)
+    {
+        const uint32 TriangleIndex = Meshlet.TriangleOffset + iTriangle * 3;
+        const FVector3f& P0 = Positions[MeshletVertices[Meshlet.VertexOffset + MeshletTriangles[TriangleIndex + 0]]];
+        const FVector3f& P1 = Positions[MeshletVertices[Meshlet.VertexOffset + MeshletTriangles[TriangleIndex + 1]]];
+        const FVector3f& P2 = Positions[MeshletVertices[Meshlet.VertexOffset + MeshletTriangles[TriangleIndex + 2]]];
+
+        // Degenerate triangles are never visible and do not widen the cone
+        const FVector3f Normal = FVector3f::CrossProduct(P1 - P0, P2 - P0).GetSafeNormal();
+        if (!Normal.IsNearlyZero())
+        {
+            Normals.Add(Normal);
+            Corners.Add(P0);
+            Axis += Normal;
+        }
+    }
+    Axis = Axis.GetSafeNormal();
+
+    float MinDot = 1.0f;
+    for (const FVector3f& Normal : Normals)
+    {
+        MinDot = FMath::Min(MinDot, FVector3f::DotProduct(Normal, Axis));
+    }
+
+    Meshlet.ConeAxis[0] = Axis.X;
+    Meshlet.ConeAxis[1] = Axis.Y;
+    Meshlet.ConeAxis[2] = Axis.Z;
+
+    if (Normals.Num() == 0 || MinDot <= MESHLET_MIN_CONE_DOT)
+    {
+        Meshlet.ConeApex[0] = Center.X;
+        Meshlet.ConeApex[1] = Center.Y;
+        Meshlet.ConeApex[2] = Center.Z;
+        Meshlet.ConeCutoff = 1.0f;
+
+        return;
+    }
+
+    // Move the apex back along the axis until every triangle plane is behind it
+    float MaxT = 0.0f;
+    for (int32 iNormal = 0; iNormal < Normals.Num(); iNormal++)
+    {
+        const float DistanceToPlane = FVector3f::DotProduct(Center - Corners[iNormal], Normals[iNormal]);
+        const float AxisDot = FVector3f::DotProduct(Axis, Normals[iNormal]);
+        MaxT = FMath::Max(MaxT, DistanceToPlane / AxisDot);
+    }
+
+    const FVector3f Apex = Center - Axis * MaxT;
+    Meshlet.ConeApex[0] = Apex.X;
+    Meshlet.ConeApex[1] = Apex.Y;
+    Meshlet.ConeApex[2] = Apex.Z;
+    Meshlet.ConeCutoff = FMath::Sqrt(1.0f - MinDot * MinDot);
+}
@@ -0,0 +1,21 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Meshlets of one LOD, the vertex and triangle arrays are shared by all meshlets */
+struct FMeshletBuildOutput
+{
+    TArray<REngineFormat::Meshlet> Meshlets;
+    TArray<uint32> MeshletVertices;
+    TArray<uint8> MeshletTriangles;
+};
+
+/** Partition the triangles of one section into meshlets of connected, spatially close triangles and append them to Output */
+void BuildSectionMeshlets(const TArray<uint32>& Indices, const TArray<FVector3f>& Positions, uint32 FirstIndex, uint32 NumTriangles, uint32 SectionIndex,
+    FMeshletBuildOutput& Output);
+
+/** Bounding sphere and normal cone of a meshlet from its vertices and triangles */
+void ComputeMeshletBounds(REngineFormat::Meshlet& Meshlet, const TArray<uint32>& MeshletVertices, const TArray<uint8>& MeshletTriangles, const TArray<FVector3f>& Positions);
@@ -2,6 +2,9 @@
 
 #include "ObjectExporterBPLibrary.h"
 #include "ObjectExporter.h"
+#include "AnimCompression.h"
+#include "AnimTextureBaker.h"
+#include "BVHBuilder.h"
 #include "Camera/CameraComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "LevelEditor.h"
@@ -15,14 +18,30 @@
 #include "Components/StaticMeshComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Camera/CameraComponent.h"
-#include "IAssetTools.h"
-#include "AssetToolsModule.h"
 #include "Engine/SkeletalMesh.h"
 #include "Animation/SkeletalMeshActor.h"
 #include "Rendering/SkeletalMeshModel.h"
 #include "Rendering/SkeletalMeshRenderData.h"
 #include "Rendering/SkeletalMeshLODRenderData.h"
-#include "EditorFramework/AssetImportData.h"
+#include "HAL/FileManager.h"
+#include "ExportCache.h"
+#include "ExportFileWriter.h"
+#include "ExportJsonWriter.h"
+#include "ExportTaskQueue.h"
+#include "InstanceBatcher.h"
+#include "MeshBounds.h"
+#include "MeshOptimization.h"
+#include "MapPartition.h"
+#include "MaterialParameterTable.h"
+#include "MeshletBuilder.h"
+#include "ObjectExporterSettings.h"
+#include "REngineAnimSampler.h"
+#include "SkeletonBuilder.h"
+#include "SkinPalette.h"
+#include "StaticMeshMerger.h"
+#include "TextureExporter.h"
+#include "TextureRegistry.h"
+#include "VertexQuantization.h"
 
 
 #define ROOT_PATH "REngine/"
@@ -32,17 +51,1449 @@
 #define SKELETALMESH_PATH "REngine/SkeletalMesh/"
 #define SKELETON_PATH "REngine/SkeletalMesh/Skeleton/"
 #define ANIMATION_PATH "REngine/SkeletalMesh/Animation/"
+#define ANIMTEXTURE_PATH "REngine/SkeletalMesh/AnimTexture/"
 
 #define JSON_FILE_POSTFIX ".json"
+#define JSON_FILE_VERSION 3
 #define STATIC_MESH_BINARY_FILE_POSTFIX ".stm"
 #define SKELETAL_MESH_BINARY_FILE_POSTFIX ".skm"
 #define SKELETON_BINARY_FILE_POSTFIX ".skt"
 #define ANIMSEQUENCE_BINARY_FILE_POSTFIX ".anm"
+#define ANIMTEXTURE_BINARY_FILE_POSTFIX ".vat"
 #define MATERIAL_BINARY_FILE_POSTFIX ".mtl"
 #define MAP_BINARY_FILE_POSTFIX ".map"
+#define MAP_CELL_BINARY_FILE_POSTFIX ".mcl"
+#define EXPORT_MANIFEST_FILE_NAME "ExportManifest.json"
+#define TEXTURE_REGISTRY_FILE_NAME "TextureRegistry.json"
+// Static mesh actors per leaf of the map BVH
+#define MAP_BVH_LEAF_ACTORS 4
 
 DECLARE_LOG_CATEGORY_CLASS(ObjectExporterBPLibraryLog, Log, All);
 
+template<typename ExportVertexType>
+static void GetExportVertex(const FPositionVertexBuffer& PositionVertexBuffer, const FStaticMeshVertexBuffer& StaticMeshVertexBuffer, int32 VertexIndex, ExportVertexType& OutVertex)
+{
+    const FVector3f& Position = PositionVertexBuffer.VertexPosition(VertexIndex);
+    const FVector4f TangentZ = StaticMeshVertexBuffer.VertexTangentZ(VertexIndex);
+    const FVector4f TangentX = StaticMeshVertexBuffer.VertexTangentX(VertexIndex);
+    const FVector2f UV = StaticMeshVertexBuffer.GetVertexUV(VertexIndex, 0);
+
+    OutVertex.Position[0] = Position.X;
+    OutVertex.Position[1] = Position.Y;
+    OutVertex.Position[2] = Position.Z;
+    OutVertex.Normal[0] = TangentZ.X;
+    OutVertex.Normal[1] = TangentZ.Y;
+    OutVertex.Normal[2] = TangentZ.Z;
+    OutVertex.Normal[3] = TangentZ.W;
+    OutVertex.Tangent[0] = TangentX.X;
+    OutVertex.Tangent[1] = TangentX.Y;
+    OutVertex.Tangent[2] = TangentX.Z;
+    OutVertex.UV[0] = UV.X;
+    OutVertex.UV[1] = UV.Y;
+}
+
+static void CopyVector(const FVector3f& Vector, float OutVector[3])
+{
+    OutVector[0] = Vector.X;
+    OutVector[1] = Vector.Y;
+    OutVector[2] = Vector.Z;
+}
+
+static void CopyColor(const FLinearColor& Color, float OutColor[4])
+{
+    OutColor[0] = Color.R;
+    OutColor[1] = Color.G;
+    OutColor[2] = Color.B;
+    OutColor[3] = Color.A;
+}
+
+static void CopyTransform(const FTransform& Transform, float OutRotation[4], float OutLocation[3], float OutScale[3])
+{
+    const FQuat4f Rotation = FQuat4f(Transform.GetRotation());
+    OutRotation[0] = Rotation.X;
+    OutRotation[1] = Rotation.Y;
+    OutRotation[2] = Rotation.Z;
+    OutRotation[3] = Rotation.W;
+    CopyVector(FVector3f(Transform.GetLocation()), OutLocation);
+    CopyVector(FVector3f(Transform.GetScale3D()), OutScale);
+}
+
+static REngineFormat::BoneTransform GetExportBoneTransform(const FTransform& Transform)
+{
+    REngineFormat::BoneTransform BoneTransform;
+    CopyTransform(Transform, BoneTransform.Rotation, BoneTransform.Translation, BoneTransform.Scale);
+
+    return BoneTransform;
+}
+
+/** Bones of a skeleton in export order with their names and bind pose */
+static void GetExportSkeleton(const USkeleton* Skeleton, TArray<FString>& OutBoneNames, FExportSkeleton& OutSkeleton)
+{
+    const FReferenceSkeleton& ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+
+    TArray<int32> Parents;
+    for (const FMeshBoneInfo& BoneInfo : ReferenceSkeleton.GetRawRefBoneInfo())
+    {
+        Parents.Add(BoneInfo.ParentIndex);
+    }
+
+    TArray<FTransform3f> LocalPose;
+    for (const FTransform& BoneTransform : ReferenceSkeleton.GetRawRefBonePose())
+    {
+        LocalPose.Add(FTransform3f(BoneTransform));
+    }
+
+    BuildExportSkeleton(Parents, LocalPose, OutSkeleton);
+
+    OutBoneNames.Reset(OutSkeleton.SourceBones.Num());
+    for (int32 SourceBone : OutSkeleton.SourceBones)
+    {
+        OutBoneNames.Add(ReferenceSkeleton.GetBoneName(SourceBone).ToString());
+    }
+}
+
+static void GetExportBoneTransforms(const TArray<FTransform3f>& Pose, TArray<REngineFormat::BoneTransform>& OutBoneTransforms)
+{
+    OutBoneTransforms.Reset(Pose.Num());
+    for (const FTransform3f& Transform : Pose)
+    {
+        OutBoneTransforms.Add(GetExportBoneTransform(FTransform(Transform)));
+    }
+}
+
+static void GetExportBoneMatrices(const TArray<FMatrix44f>& Matrices, TArray<REngineFormat::BoneMatrix>& OutBoneMatrices)
+{
+    OutBoneMatrices.SetNumUninitialized(Matrices.Num());
+    for (int32 BoneIndex = 0; BoneIndex < Matrices.Num(); BoneIndex++)
+    {
+        FMemory::Memcpy(OutBoneMatrices[BoneIndex].M, Matrices[BoneIndex].M, sizeof(REngineFormat::BoneMatrix));
+    }
+}
+
+static void GetStaticMeshLOD(const FStaticMeshLODResources& CurLOD, TArray<REngineFormat::StaticMeshVertex>& OutVertices, TArray<uint32>& OutIndices,
+    TArray<REngineFormat::StaticMeshSection>& OutSections)
+{
+    // Vertex data
+    const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.VertexBuffers.PositionVertexBuffer;
+    const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.VertexBuffers.StaticMeshVertexBuffer;
+    const int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+
+    OutVertices.SetNumUninitialized(NumVertices);
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        GetExportVertex(PositionVertexBuffer, StaticMeshVertexBuffer, iVertex, OutVertices[iVertex]);
+    }
+
+    // Index data
+    CurLOD.IndexBuffer.GetCopy(OutIndices);
+
+    // Section data
+    OutSections.Reset(CurLOD.Sections.Num());
+    for (const FStaticMeshSection& Section : CurLOD.Sections)
+    {
+        OutSections.Add({ int32(Section.MaterialIndex), uint32(Section.FirstIndex), uint32(Section.NumTriangles), uint32(Section.MinVertexIndex), uint32(Section.MaxVertexIndex) });
+    }
+}
+
+/** Vertices without bone indices, up to MaxInfluences influences with reference skeleton bones, and the render sections, see BuildSkinSections for the palettes */
+static void GetSkeletalMeshLOD(const FSkeletalMeshLODRenderData& CurLOD, int32 MaxInfluences, TArray<REngineFormat::SkeletalMeshVertex>& OutVertices,
+    TArray<FVertexInfluences>& OutInfluences, TArray<uint32>& OutIndices, TArray<REngineFormat::SkeletalMeshSection>& OutSections)
+{
+    // Vertex data
+    const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.StaticVertexBuffers.PositionVertexBuffer;
+    const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.StaticVertexBuffers.StaticMeshVertexBuffer;
+    TArray<FSkinWeightInfo> WeightInfos;
+    CurLOD.SkinWeightVertexBuffer.GetSkinWeights(WeightInfos);
+
+    const int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+
+    OutVertices.SetNumZeroed(NumVertices);
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        GetExportVertex(PositionVertexBuffer, StaticMeshVertexBuffer, iVertex, OutVertices[iVertex]);
+    }
+
+    // Influence bones index the bone map of the section owning the vertex
+    OutInfluences.SetNumZeroed(NumVertices);
+    for (const FSkelMeshRenderSection& Section : CurLOD.RenderSections)
+    {
+        const int32 LastVertex = FMath::Min(int32(Section.BaseVertexIndex + Section.NumVertices), NumVertices);
+        for (int32 iVertex = int32(Section.BaseVertexIndex); iVertex < LastVertex; iVertex++)
+        {
+            const FSkinWeightInfo& WeightInfo = WeightInfos[iVertex];
+
+            uint16 Bones[MAX_TOTAL_INFLUENCES];
+            float Weights[MAX_TOTAL_INFLUENCES];
+            for (int32 iInfluence = 0; iInfluence < MAX_TOTAL_INFLUENCES; iInfluence++)
+            {
+                const int32 SectionBone = WeightInfo.InfluenceBones[iInfluence];
+                Weights[iInfluence] = Section.BoneMap.IsValidIndex(SectionBone) ? float(WeightInfo.InfluenceWeights[iInfluence]) : 0.0f;
+                Bones[iInfluence] = Section.BoneMap.IsValidIndex(SectionBone) ? Section.BoneMap[SectionBone] : 0;
+            }
+
+            QuantizeInfluences(Bones, Weights, MAX_TOTAL_INFLUENCES, MaxInfluences, OutInfluences[iVertex]);
+        }
+    }
+
+    // Index data
+    CurLOD.MultiSizeIndexContainer.GetIndexBuffer(OutIndices);
+
+    // Section data
+    OutSections.Reset(CurLOD.RenderSections.Num());
+    for (const FSkelMeshRenderSection& Section : CurLOD.RenderSections)
+    {
+        OutSections.Add({ int32(Section.MaterialIndex), uint32(Section.BaseIndex), uint32(Section.NumTriangles), uint32(Section.BaseVertexIndex), uint32(Section.NumVertices), 0, 0 });
+    }
+}
+
+template<typename ExportVertexType>
+static void GetExportPositions(const TArray<ExportVertexType>& Vertices, TArray<FVector3f>& OutPositions)
+{
+    OutPositions.SetNumUninitialized(Vertices.Num());
+    for (int32 iVertex = 0; iVertex < Vertices.Num(); iVertex++)
+    {
+        OutPositions[iVertex] = FVector3f(Vertices[iVertex].Position[0], Vertices[iVertex].Position[1], Vertices[iVertex].Position[2]);
+    }
+}
+
+/** OutVertexRemap, when given, receives the new index of every vertex for the streams kept beside Vertices */
+template<typename ExportVertexType>
+static void OptimizeExportMesh(const FString& MeshName, int32 LODIndex, TArray<ExportVertexType>& Vertices, TArray<uint32>& Indices, const TArray<FMeshOptimizationSection>& Sections,
+    TArray<uint32>* OutVertexRemap = nullptr)
+{
+    TArray<FVector3f> Positions;
+    GetExportPositions(Vertices, Positions);
+
+    TArray<uint32> VertexRemap;
+    FMeshOptimizationReport Report;
+    OptimizeMesh(Indices, Positions, Sections, VertexRemap, Report);
+    RemapVertices(Vertices, VertexRemap);
+
+    if (OutVertexRemap != nullptr)
+    {
+        *OutVertexRemap = MoveTemp(VertexRemap);
+    }
+
+    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("OptimizeExportMesh: %s LOD %d ACMR %.3f -> %.3f, ATVR %.3f -> %.3f."),
+        *MeshName, LODIndex, Report.Before.ACMR, Report.After.ACMR, Report.Before.ATVR, Report.After.ATVR);
+}
+
+/** Vertex count and one flat array per vertex attribute */
+template<typename ExportVertexType>
+static void WriteJsonVertices(FExportJsonWriter& JsonFile, const TArray<ExportVertexType>& Vertices)
+{
+    JsonFile.Get().WriteValue(TEXT("VertexCount"), Vertices.Num());
+    JsonFile.WriteMemberArray(TEXT("Positions"), Vertices, &ExportVertexType::Position);
+    JsonFile.WriteMemberArray(TEXT("Normals"), Vertices, &ExportVertexType::Normal);
+    JsonFile.WriteMemberArray(TEXT("Tangents"), Vertices, &ExportVertexType::Tangent);
+    JsonFile.WriteMemberArray(TEXT("UVs"), Vertices, &ExportVertexType::UV);
+}
+
+/** Settings a mesh export reads, copied on the game thread for the export tasks */
+struct FMeshExportOptions
+{
+    bool bCompactVertexFormat;
+    bool bOptimizeMeshes;
+    bool bExportMeshlets;
+    bool bCompressGeometry;
+    int32 MaxBonesPerSection;
+    int32 MaxBoneInfluences;
+};
+
+static FMeshExportOptions GetMeshExportOptions()
+{
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+
+    FMeshExportOptions Options;
+    Options.bCompactVertexFormat = Settings->bCompactVertexFormat;
+    Options.bOptimizeMeshes = Settings->bOptimizeMeshes;
+    Options.bExportMeshlets = Settings->bExportMeshlets;
+    Options.bCompressGeometry = Settings->bCompressGeometry;
+    Options.MaxBonesPerSection = Settings->MaxBonesPerSection;
+    Options.MaxBoneInfluences = FMath::Clamp(Settings->MaxBoneInfluences, VERTEX_BONE_INFLUENCES, MAX_EXPORT_BONE_INFLUENCES);
+
+    return Options;
+}
+
+/** Render data of one LOD copied out of the mesh */
+template<typename ExportVertexType, typename ExportSectionType>
+struct FMeshLODSnapshot
+{
+    TArray<ExportVertexType> Vertices;
+    TArray<uint32> Indices;
+    TArray<ExportSectionType> Sections;
+    float ScreenSize = 0.0f;
+
+    int64 GetAllocatedSize() const
+    {
+        return Vertices.GetAllocatedSize() + Indices.GetAllocatedSize() + Sections.GetAllocatedSize();
+    }
+};
+
+typedef FMeshLODSnapshot<REngineFormat::StaticMeshVertex, REngineFormat::StaticMeshSection> FStaticMeshLODSnapshot;
+
+/** Skeletal mesh LOD with its influences, bones of the reference skeleton until the bone palettes are built and palette slots after */
+struct FSkeletalMeshLODSnapshot : public FMeshLODSnapshot<REngineFormat::SkeletalMeshVertex, REngineFormat::SkeletalMeshSection>
+{
+    TArray<FVertexInfluences> Influences;
+    /** Skeleton bones the LOD needs, bits of the exported skeleton bones */
+    TArray<uint32> BoneMask;
+
+    int64 GetAllocatedSize() const
+    {
+        return FMeshLODSnapshot::GetAllocatedSize() + Influences.GetAllocatedSize() + BoneMask.GetAllocatedSize();
+    }
+};
+
+/** Skeleton bone of every bone of the mesh reference skeleton, matched by name. Meshes sharing a skeleton may have fewer bones or another order */
+static void GetMeshSkeletonBones(const USkeletalMesh* SkeletalMesh, TArray<int32>& OutSkeletonBones)
+{
+    const FReferenceSkeleton& MeshSkeleton = SkeletalMesh->GetRefSkeleton();
+    const FReferenceSkeleton& SkeletonBones = SkeletalMesh->GetSkeleton()->GetReferenceSkeleton();
+
+    OutSkeletonBones.SetNumUninitialized(MeshSkeleton.GetRawBoneNum());
+    for (int32 MeshBoneIndex = 0; MeshBoneIndex < MeshSkeleton.GetRawBoneNum(); MeshBoneIndex++)
+    {
+        OutSkeletonBones[MeshBoneIndex] = SkeletonBones.FindRawBoneIndex(MeshSkeleton.GetBoneName(MeshBoneIndex));
+    }
+}
+
+/**
+*   Split the sections of a skeletal mesh LOD to palettes of at most MaxBonesPerSection bones, the vertices then carry palette slots.
+*   The palettes hold skeleton bones like the animation tracks, MeshSkeletonBones maps the mesh bones of the influences to them.
+*/
+static void BuildSkeletalMeshLODPalettes(const FString& MeshName, int32 LODIndex, int32 MaxBonesPerSection, const TArray<int32>& MeshSkeletonBones,
+    FSkeletalMeshLODSnapshot& LOD, TArray<uint16>& OutBonePalette)
+{
+    TArray<REngineFormat::SkeletalMeshVertex> Vertices;
+    TArray<FVertexInfluences> Influences;
+    TArray<uint32> Indices;
+    TArray<REngineFormat::SkeletalMeshSection> Sections;
+    FSkinSectionReport Report;
+    BuildSkinSections(LOD.Vertices, LOD.Influences, LOD.Indices, LOD.Sections, MaxBonesPerSection, Vertices, Influences, Indices, Sections, OutBonePalette, Report);
+
+    int32 NumUnmatchedBones = 0;
+    for (uint16& Bone : OutBonePalette)
+    {
+        const int32 SkeletonBone = MeshSkeletonBones.IsValidIndex(Bone) ? MeshSkeletonBones[Bone] : INDEX_NONE;
+        NumUnmatchedBones += SkeletonBone == INDEX_NONE ? 1 : 0;
+        Bone = uint16(SkeletonBone != INDEX_NONE ? SkeletonBone : 0);
+    }
+
+    if (NumUnmatchedBones > 0)
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("BuildSkeletalMeshLODPalettes: %s LOD %d weights %d bones the skeleton does not have, they follow the root."),
+            *MeshName, LODIndex, NumUnmatchedBones);
+    }
+
+    if (Report.NumSections != Report.NumSourceSections)
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("BuildSkeletalMeshLODPalettes: %s LOD %d split %d sections into %d for %d bones per section, %d vertices duplicated."),
+            *MeshName, LODIndex, Report.NumSourceSections, Report.NumSections, MaxBonesPerSection, Report.NumDuplicatedVertices);
+    }
+
+    LOD.Vertices = MoveTemp(Vertices);
+    LOD.Influences = MoveTemp(Influences);
+    LOD.Indices = MoveTemp(Indices);
+    LOD.Sections = MoveTemp(Sections);
+}
+
+/** Sort the vertices of every section by influence count when they keep more than the vertex stream holds, nothing to write otherwise */
+static void BuildSkeletalMeshLODBuckets(const FString& MeshName, int32 LODIndex, int32 MaxBoneInfluences, FSkeletalMeshLODSnapshot& LOD,
+    TArray<REngineFormat::SkinInfluenceBucket>& OutBuckets, TArray<uint8>& OutExtraInfluences)
+{
+    OutBuckets.Reset();
+    OutExtraInfluences.Reset();
+    if (MaxBoneInfluences <= VERTEX_BONE_INFLUENCES)
+    {
+        return;
+    }
+
+    SortSkinVerticesByInfluences(LOD.Vertices, LOD.Influences, LOD.Indices, LOD.Sections, OutBuckets, OutExtraInfluences);
+
+    int32 NumBucketVertices[MAX_EXPORT_BONE_INFLUENCES + 1] = {};
+    for (const REngineFormat::SkinInfluenceBucket& Bucket : OutBuckets)
+    {
+        NumBucketVertices[Bucket.NumInfluences] += int32(Bucket.NumVertices);
+    }
+
+    FString BucketCounts;
+    for (int32 NumInfluences = 1; NumInfluences <= MAX_EXPORT_BONE_INFLUENCES; NumInfluences++)
+    {
+        if (NumBucketVertices[NumInfluences] > 0)
+        {
+            BucketCounts += FString::Printf(TEXT(" %d:%d"), NumInfluences, NumBucketVertices[NumInfluences]);
+        }
+    }
+
+    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("BuildSkeletalMeshLODBuckets: %s LOD %d vertices per influence count%s, %d extra influence bytes."),
+        *MeshName, LODIndex, *BucketCounts, OutExtraInfluences.Num());
+}
+
+/*
+*   The Prepare functions below are the two phases of a binary export.
+*   They read the UObject on the game thread and copy what the file needs, the returned task encodes and
+*   writes the file on any thread without touching the UObject again.
+*/
+
+static FExportTask PrepareStaticMeshExport(const UStaticMesh* StaticMesh, const FString& FullFilePathName, int64& OutSnapshotSize)
+{
+    const FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData();
+
+    TArray<FStaticMeshLODSnapshot> LODSnapshots;
+    LODSnapshots.SetNum(RenderData->LODResources.Num());
+    OutSnapshotSize = 0;
+    for (int32 LODIndex = 0; LODIndex < LODSnapshots.Num(); LODIndex++)
+    {
+        FStaticMeshLODSnapshot& LODSnapshot = LODSnapshots[LODIndex];
+        GetStaticMeshLOD(RenderData->LODResources[LODIndex], LODSnapshot.Vertices, LODSnapshot.Indices, LODSnapshot.Sections);
+        LODSnapshot.ScreenSize = RenderData->ScreenSize[LODIndex].Default;
+        OutSnapshotSize += LODSnapshot.GetAllocatedSize();
+    }
+
+    return [MeshName = StaticMesh->GetName(), FullFilePathName, Options = GetMeshExportOptions(), LODSnapshots = MoveTemp(LODSnapshots)]() mutable
+    {
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::StaticMesh);
+        FileWriter.SetCompression(Options.bCompressGeometry);
+
+        REngineFormat::MeshInfo MeshInfo = {};
+        MeshInfo.LODCount = LODSnapshots.Num();
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::MeshInfo, 0, MeshInfo);
+
+        TArray<REngineFormat::MeshLOD> LODs;
+        for (int32 LODIndex = 0; LODIndex < LODSnapshots.Num(); LODIndex++)
+        {
+            TArray<REngineFormat::StaticMeshVertex>& Vertices = LODSnapshots[LODIndex].Vertices;
+            TArray<uint32>& Indices = LODSnapshots[LODIndex].Indices;
+            TArray<REngineFormat::StaticMeshSection>& Sections = LODSnapshots[LODIndex].Sections;
+            const int32 NumVertices = Vertices.Num();
+
+            if (Options.bOptimizeMeshes)
+            {
+                TArray<FMeshOptimizationSection> OptimizationSections;
+                for (const REngineFormat::StaticMeshSection& Section : Sections)
+                {
+                    OptimizationSections.Add({ Section.FirstIndex, Section.NumTriangles, Section.MinVertexIndex, Section.MaxVertexIndex - Section.MinVertexIndex + 1 });
+                }
+
+                OptimizeExportMesh(MeshName, LODIndex, Vertices, Indices, OptimizationSections);
+
+                // Vertices only move inside the merged section ranges, refit each range to the vertices it still uses
+                for (REngineFormat::StaticMeshSection& Section : Sections)
+                {
+                    if (Section.NumTriangles > 0)
+                    {
+                        Section.MinVertexIndex = MAX_uint32;
+                        Section.MaxVertexIndex = 0;
+                        for (uint32 iIndex = Section.FirstIndex; iIndex < Section.FirstIndex + Section.NumTriangles * 3; iIndex++)
+                        {
+                            Section.MinVertexIndex = FMath::Min(Section.MinVertexIndex, Indices[iIndex]);
+                            Section.MaxVertexIndex = FMath::Max(Section.MaxVertexIndex, Indices[iIndex]);
+                        }
+                    }
+                }
+            }
+
+            if (Options.bExportMeshlets)
+            {
+                TArray<FVector3f> Positions;
+                GetExportPositions(Vertices, Positions);
+
+                FMeshletBuildOutput MeshletOutput;
+                for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+                {
+                    BuildSectionMeshlets(Indices, Positions, Sections[SectionIndex].FirstIndex, Sections[SectionIndex].NumTriangles, SectionIndex, MeshletOutput);
+                }
+
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: %s LOD %d %d meshlets, %.1f vertices and %.1f triangles on average."),
+                    *MeshName, LODIndex, MeshletOutput.Meshlets.Num(),
+                    float(MeshletOutput.MeshletVertices.Num()) / FMath::Max(MeshletOutput.Meshlets.Num(), 1),
+                    float(MeshletOutput.MeshletTriangles.Num() / 3) / FMath::Max(MeshletOutput.Meshlets.Num(), 1));
+
+                FileWriter.AddChunk(REngineFormat::ChunkId::Meshlets, LODIndex, REngineFormat::EElementFormat::Struct, MeshletOutput.Meshlets);
+                FileWriter.AddChunk(REngineFormat::ChunkId::MeshletVertices, LODIndex, REngineFormat::EElementFormat::UInt32, MeshletOutput.MeshletVertices, REngineFormat::StreamAlignment);
+                FileWriter.AddChunk(REngineFormat::ChunkId::MeshletTriangles, LODIndex, REngineFormat::EElementFormat::UInt8, MeshletOutput.MeshletTriangles, REngineFormat::StreamAlignment);
+            }
+
+            if (Options.bCompactVertexFormat)
+            {
+                TArray<REngineFormat::CompactStaticMeshVertex> CompactVertices;
+                REngineFormat::VertexFormat VertexFormat;
+                FVertexQuantizationReport QuantizationReport;
+                CompactStaticMeshVertices(Vertices, CompactVertices, VertexFormat, QuantizationReport);
+
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: %s LOD %d quantization error, position %f, normal %.3f deg, tangent %.3f deg, uv %f."),
+                    *MeshName, LODIndex, QuantizationReport.MaxPositionError, QuantizationReport.MaxNormalErrorDegrees,
+                    QuantizationReport.MaxTangentErrorDegrees, QuantizationReport.MaxUVError);
+
+                FileWriter.AddStructChunk(REngineFormat::ChunkId::VertexFormat, LODIndex, VertexFormat);
+                FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, LODIndex, REngineFormat::EElementFormat::Struct, CompactVertices, REngineFormat::StreamAlignment);
+            }
+            else
+            {
+                FileWriter.AddStructChunk(REngineFormat::ChunkId::VertexFormat, LODIndex, GetStaticMeshVertexFormat());
+                FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, LODIndex, REngineFormat::EElementFormat::Struct, Vertices, REngineFormat::StreamAlignment);
+            }
+
+            if (Options.bCompactVertexFormat && NumVertices <= MAX_uint16 + 1)
+            {
+                TArray<uint16> CompactIndices;
+                CompactIndices.SetNumUninitialized(Indices.Num());
+                for (int32 iIndex = 0; iIndex < Indices.Num(); iIndex++)
+                {
+                    CompactIndices[iIndex] = (uint16)Indices[iIndex];
+                }
+
+                FileWriter.AddChunk(REngineFormat::ChunkId::Indices, LODIndex, REngineFormat::EElementFormat::UInt16, CompactIndices, REngineFormat::StreamAlignment);
+            }
+            else
+            {
+                FileWriter.AddChunk(REngineFormat::ChunkId::Indices, LODIndex, REngineFormat::EElementFormat::UInt32, Indices, REngineFormat::StreamAlignment);
+            }
+
+            FileWriter.AddChunk(REngineFormat::ChunkId::Sections, LODIndex, REngineFormat::EElementFormat::Struct, Sections);
+
+            // From the float positions, compact vertices are quantized inside the same box
+            TArray<FVector3f> Positions;
+            GetExportPositions(Vertices, Positions);
+            TArray<REngineFormat::MeshBounds> SectionBounds;
+            for (const REngineFormat::StaticMeshSection& Section : Sections)
+            {
+                SectionBounds.Add(BuildIndexedBounds(Positions, Indices, Section.FirstIndex, Section.NumTriangles * 3));
+            }
+
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::LODBounds, LODIndex, BuildMeshBounds(Positions));
+            FileWriter.AddChunk(REngineFormat::ChunkId::SectionBounds, LODIndex, REngineFormat::EElementFormat::Struct, SectionBounds);
+
+            LODs.Add({ LODSnapshots[LODIndex].ScreenSize, uint32(Vertices.Num()), uint32(Indices.Num()), uint32(Sections.Num()) });
+        }
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::LODs, 0, REngineFormat::EElementFormat::Struct, LODs);
+
+        return FileWriter.Commit();
+    };
+}
+
+static FExportTask PrepareSkeletalMeshExport(const USkeletalMesh* SkeletalMesh, const FString& FullFilePathName, int64& OutSnapshotSize)
+{
+    const FSkeletalMeshRenderData* RenderData = SkeletalMesh->GetResourceForRendering();
+
+    const FMeshExportOptions Options = GetMeshExportOptions();
+
+    // Bone masks address the bones of the exported skeleton, mesh bones are matched to them by name
+    TArray<FString> BoneNames;
+    FExportSkeleton ExportSkeleton;
+    GetExportSkeleton(SkeletalMesh->GetSkeleton(), BoneNames, ExportSkeleton);
+    TArray<int32> MeshSkeletonBones;
+    GetMeshSkeletonBones(SkeletalMesh, MeshSkeletonBones);
+
+    TArray<int32> MeshExportBones;
+    for (int32 SkeletonBoneIndex : MeshSkeletonBones)
+    {
+        MeshExportBones.Add(SkeletonBoneIndex != INDEX_NONE ? ExportSkeleton.ExportBones[SkeletonBoneIndex] : INDEX_NONE);
+    }
+
+    TArray<FSkeletalMeshLODSnapshot> LODSnapshots;
+    LODSnapshots.SetNum(RenderData->LODRenderData.Num());
+    OutSnapshotSize = 0;
+    for (int32 LODIndex = 0; LODIndex < LODSnapshots.Num(); LODIndex++)
+    {
+        FSkeletalMeshLODSnapshot& LODSnapshot = LODSnapshots[LODIndex];
+        GetSkeletalMeshLOD(RenderData->LODRenderData[LODIndex], Options.MaxBoneInfluences, LODSnapshot.Vertices, LODSnapshot.Influences, LODSnapshot.Indices, LODSnapshot.Sections);
+
+        TArray<int32> RequiredBones;
+        for (FBoneIndexType MeshBoneIndex : RenderData->LODRenderData[LODIndex].RequiredBones)
+        {
+            if (MeshExportBones.IsValidIndex(MeshBoneIndex) && MeshExportBones[MeshBoneIndex] != INDEX_NONE)
+            {
+                RequiredBones.Add(MeshExportBones[MeshBoneIndex]);
+            }
+        }
+        BuildBoneLODMask(ExportSkeleton.Parents, RequiredBones, LODSnapshot.BoneMask);
+
+        const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(LODIndex);
+        LODSnapshot.ScreenSize = LODInfo != nullptr ? LODInfo->ScreenSize.Default : 0.0f;
+        OutSnapshotSize += LODSnapshot.GetAllocatedSize();
+    }
+
+    // The vertices are in the bind pose of the mesh, which may differ from the skeleton reference pose. Bone bounds take them to bone
+    // space with the inverse bind matrices the mesh skins with, stored per exported bone
+    TArray<FMatrix44f> InverseBindMatrices = MoveTemp(ExportSkeleton.InverseBindMatrices);
+    const TArray<FMatrix44f>& MeshInverseBindMatrices = SkeletalMesh->GetRefBasesInvMatrix();
+    for (int32 MeshBoneIndex = 0; MeshBoneIndex < MeshExportBones.Num(); MeshBoneIndex++)
+    {
+        if (MeshExportBones[MeshBoneIndex] != INDEX_NONE && MeshInverseBindMatrices.IsValidIndex(MeshBoneIndex))
+        {
+            InverseBindMatrices[MeshExportBones[MeshBoneIndex]] = MeshInverseBindMatrices[MeshBoneIndex];
+        }
+    }
+
+    FString ResourcePath, SkeletonName;
+    SkeletalMesh->GetSkeleton()->GetPathName().Split(FString("."), &ResourcePath, &SkeletonName);
+
+    return [MeshName = SkeletalMesh->GetName(), SkeletonName, FullFilePathName, Options, LODSnapshots = MoveTemp(LODSnapshots), MeshSkeletonBones = MoveTemp(MeshSkeletonBones),
+        MeshExportBones = MoveTemp(MeshExportBones), InverseBindMatrices = MoveTemp(InverseBindMatrices)]() mutable
+    {
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::SkeletalMesh);
+        FileWriter.SetCompression(Options.bCompressGeometry);
+
+        REngineFormat::MeshInfo MeshInfo = {};
+        MeshInfo.LODCount = LODSnapshots.Num();
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::MeshInfo, 0, MeshInfo);
+
+        TArray<REngineFormat::MeshLOD> LODs;
+        for (int32 LODIndex = 0; LODIndex < LODSnapshots.Num(); LODIndex++)
+        {
+            // Bone bounds need the influences with reference skeleton bones, the palettes replace them with slots
+            TArray<FVector3f> Positions;
+            GetExportPositions(LODSnapshots[LODIndex].Vertices, Positions);
+            TArray<REngineFormat::MeshBounds> BoneBounds;
+            BuildBoneBounds(Positions, LODSnapshots[LODIndex].Influences, MeshExportBones, InverseBindMatrices, BoneBounds);
+
+            TArray<uint16> BonePalette;
+            BuildSkeletalMeshLODPalettes(MeshName, LODIndex, Options.MaxBonesPerSection, MeshSkeletonBones, LODSnapshots[LODIndex], BonePalette);
+
+            TArray<REngineFormat::SkeletalMeshVertex>& Vertices = LODSnapshots[LODIndex].Vertices;
+            TArray<uint32>& Indices = LODSnapshots[LODIndex].Indices;
+            TArray<REngineFormat::SkeletalMeshSection>& Sections = LODSnapshots[LODIndex].Sections;
+
+            if (Options.bOptimizeMeshes)
+            {
+                // BuildSkinSections gives every section its own vertex range, so the ranges stay valid after the remap
+                TArray<FMeshOptimizationSection> OptimizationSections;
+                for (const REngineFormat::SkeletalMeshSection& Section : Sections)
+                {
+                    OptimizationSections.Add({ Section.BaseIndex, Section.NumTriangles, Section.BaseVertexIndex, Section.NumVertices });
+                }
+
+                TArray<uint32> VertexRemap;
+                OptimizeExportMesh(MeshName, LODIndex, Vertices, Indices, OptimizationSections, &VertexRemap);
+                RemapVertices(LODSnapshots[LODIndex].Influences, VertexRemap);
+            }
+
+            // After the optimization, which orders vertices by first use
+            TArray<REngineFormat::SkinInfluenceBucket> InfluenceBuckets;
+            TArray<uint8> ExtraInfluences;
+            BuildSkeletalMeshLODBuckets(MeshName, LODIndex, Options.MaxBoneInfluences, LODSnapshots[LODIndex], InfluenceBuckets, ExtraInfluences);
+
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::VertexFormat, LODIndex, GetSkeletalMeshVertexFormat());
+            FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, LODIndex, REngineFormat::EElementFormat::Struct, Vertices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Indices, LODIndex, REngineFormat::EElementFormat::UInt32, Indices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Sections, LODIndex, REngineFormat::EElementFormat::Struct, Sections);
+            FileWriter.AddChunk(REngineFormat::ChunkId::BonePalette, LODIndex, REngineFormat::EElementFormat::UInt16, BonePalette);
+            FileWriter.AddChunk(REngineFormat::ChunkId::BoneLODMask, LODIndex, REngineFormat::EElementFormat::UInt32, LODSnapshots[LODIndex].BoneMask);
+
+            GetExportPositions(Vertices, Positions);
+            TArray<REngineFormat::MeshBounds> SectionBounds;
+            for (const REngineFormat::SkeletalMeshSection& Section : Sections)
+            {
+                SectionBounds.Add(BuildIndexedBounds(Positions, Indices, Section.BaseIndex, Section.NumTriangles * 3));
+            }
+
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::LODBounds, LODIndex, BuildMeshBounds(Positions));
+            FileWriter.AddChunk(REngineFormat::ChunkId::SectionBounds, LODIndex, REngineFormat::EElementFormat::Struct, SectionBounds);
+            FileWriter.AddChunk(REngineFormat::ChunkId::BoneBounds, LODIndex, REngineFormat::EElementFormat::Struct, BoneBounds);
+
+            if (InfluenceBuckets.Num() > 0)
+            {
+                FileWriter.AddChunk(REngineFormat::ChunkId::InfluenceBuckets, LODIndex, REngineFormat::EElementFormat::Struct, InfluenceBuckets);
+                FileWriter.AddChunk(REngineFormat::ChunkId::ExtraInfluences, LODIndex, REngineFormat::EElementFormat::UInt8, ExtraInfluences, REngineFormat::StreamAlignment);
+            }
+
+            LODs.Add({ LODSnapshots[LODIndex].ScreenSize, uint32(Vertices.Num()), uint32(Indices.Num()), uint32(Sections.Num()) });
+        }
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::LODs, 0, REngineFormat::EElementFormat::Struct, LODs);
+        FileWriter.AddStringChunk(REngineFormat::ChunkId::SkeletonName, 0, SkeletonName);
+
+        return FileWriter.Commit();
+    };
+}
+
+static FExportTask PrepareSkeletonExport(const USkeleton* Skeleton, const FString& FullFilePathName, int64& OutSnapshotSize)
+{
+    TArray<FString> BoneNames;
+    FExportSkeleton ExportSkeleton;
+    GetExportSkeleton(Skeleton, BoneNames, ExportSkeleton);
+
+    OutSnapshotSize = BoneNames.GetAllocatedSize() + ExportSkeleton.SourceBones.GetAllocatedSize() + ExportSkeleton.ExportBones.GetAllocatedSize()
+        + ExportSkeleton.Parents.GetAllocatedSize() + ExportSkeleton.LocalPose.GetAllocatedSize() + ExportSkeleton.BindPose.GetAllocatedSize()
+        + ExportSkeleton.InverseBindMatrices.GetAllocatedSize();
+
+    return [FullFilePathName, bCompressGeometry = GetDefault<UObjectExporterSettings>()->bCompressGeometry, BoneNames = MoveTemp(BoneNames),
+        ExportSkeleton = MoveTemp(ExportSkeleton)]()
+    {
+        TArray<REngineFormat::BoneTransform> BoneTransforms;
+        TArray<REngineFormat::BoneTransform> BindTransforms;
+        TArray<REngineFormat::BoneMatrix> InverseBindMatrices;
+        GetExportBoneTransforms(ExportSkeleton.LocalPose, BoneTransforms);
+        GetExportBoneTransforms(ExportSkeleton.BindPose, BindTransforms);
+        GetExportBoneMatrices(ExportSkeleton.InverseBindMatrices, InverseBindMatrices);
+
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::Skeleton);
+        FileWriter.SetCompression(bCompressGeometry);
+
+        FileWriter.AddStringTableChunk(REngineFormat::ChunkId::BoneNames, 0, BoneNames);
+        FileWriter.AddChunk(REngineFormat::ChunkId::BoneParents, 0, REngineFormat::EElementFormat::Int32, ExportSkeleton.Parents);
+        FileWriter.AddChunk(REngineFormat::ChunkId::BoneRefPose, 0, REngineFormat::EElementFormat::Struct, BoneTransforms);
+        FileWriter.AddChunk(REngineFormat::ChunkId::BoneSourceIndices, 0, REngineFormat::EElementFormat::Int32, ExportSkeleton.SourceBones);
+        FileWriter.AddChunk(REngineFormat::ChunkId::BoneBindPose, 0, REngineFormat::EElementFormat::Struct, BindTransforms);
+        FileWriter.AddChunk(REngineFormat::ChunkId::BoneInverseBindMatrices, 0, REngineFormat::EElementFormat::Struct, InverseBindMatrices, REngineFormat::StreamAlignment);
+
+        return FileWriter.Commit();
+    };
+}
+
+/** Write the compressed tracks of a sequence, false when it cannot be compressed */
+static bool AddCompressedAnimChunks(FExportFileWriter& FileWriter, const FString& AnimName, const TArray<FRawAnimTrack>& RawTracks, const FAnimSkeleton& Skeleton,
+    const FAnimCompressionSettings& Settings, REngineFormat::AnimSequenceInfo AnimInfo)
+{
+    FCompressedAnimation Animation;
+    FAnimCompressionReport Report;
+    if (!CompressAnimation(RawTracks, int32(AnimInfo.NumFrames), Skeleton, Settings, Animation, Report))
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimSequence: %s has %u frames, too many to compress, writing raw keys."), *AnimName, AnimInfo.NumFrames);
+
+        return false;
+    }
+
+    const bool bWithinTolerance = Report.MaxError <= Settings.ErrorTolerance;
+    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimSequence: %s %lld -> %lld bytes (%.1f%%), max error %.4f cm at bone %d frame %d, %d of %d keys, %d tracks stripped, %d constant channels."),
+        *AnimName, Report.RawSize, Report.CompressedSize, Report.RawSize > 0 ? 100.0 * Report.CompressedSize / Report.RawSize : 0.0, Report.MaxError, Report.MaxErrorBone,
+        Report.MaxErrorFrame, Report.NumKeys, Report.NumRawKeys, Report.NumStrippedTracks, Report.NumConstantChannels);
+    if (!bWithinTolerance)
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimSequence: %s max error %.4f cm is above the %.4f cm tolerance, the key precision limits it."),
+            *AnimName, Report.MaxError, Settings.ErrorTolerance);
+    }
+
+    AnimInfo.NumTracks = Animation.Tracks.Num();
+    FileWriter.AddStructChunk(REngineFormat::ChunkId::AnimInfo, 0, AnimInfo);
+    FileWriter.AddChunk(REngineFormat::ChunkId::CompressedAnimTracks, 0, REngineFormat::EElementFormat::Struct, Animation.Tracks);
+    FileWriter.AddChunk(REngineFormat::ChunkId::CompressedPosKeys, 0, REngineFormat::EElementFormat::UInt16, Animation.PosKeys, REngineFormat::StreamAlignment);
+    FileWriter.AddChunk(REngineFormat::ChunkId::CompressedRotKeys, 0, REngineFormat::EElementFormat::UInt16, Animation.RotKeys, REngineFormat::StreamAlignment);
+    FileWriter.AddChunk(REngineFormat::ChunkId::CompressedScaleKeys, 0, REngineFormat::EElementFormat::UInt16, Animation.ScaleKeys, REngineFormat::StreamAlignment);
+
+    return true;
+}
+
+static FExportTask PrepareAnimSequenceExport(const UAnimSequence* AnimSequence, const FString& FullFilePathName, int64& OutSnapshotSize)
+{
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+    const IAnimationDataModel* ParentDataModel = AnimSequence->GetDataModel();
+    const TArray<FBoneAnimationTrack>& BoneAnimationTracks = ParentDataModel->GetBoneAnimationTracks();
+
+    REngineFormat::AnimSequenceInfo AnimInfo = {};
+    AnimInfo.NumFrames = AnimSequence->GetNumberOfSampledKeys();
+    AnimInfo.SequenceLength = AnimSequence->GetPlayLength();
+    AnimInfo.NumTracks = BoneAnimationTracks.Num();
+
+    TArray<FRawAnimTrack> RawTracks;
+    OutSnapshotSize = 0;
+    for (const FBoneAnimationTrack& AnimationTrack : BoneAnimationTracks)
+    {
+        const FRawAnimSequenceTrack& AnimationData = AnimationTrack.InternalTrackData;
+
+        FRawAnimTrack& RawTrack = RawTracks.AddDefaulted_GetRef();
+        RawTrack.BoneIndex = AnimationTrack.BoneTreeIndex;
+        RawTrack.PosKeys = AnimationData.PosKeys;
+        RawTrack.RotKeys = AnimationData.RotKeys;
+        RawTrack.ScaleKeys = AnimationData.ScaleKeys;
+
+        OutSnapshotSize += RawTrack.PosKeys.GetAllocatedSize() + RawTrack.RotKeys.GetAllocatedSize() + RawTrack.ScaleKeys.GetAllocatedSize();
+    }
+
+    // The compressor measures the error on the reference skeleton the tracks animate
+    FAnimSkeleton Skeleton;
+    const USkeleton* AnimSkeleton = AnimSequence->GetSkeleton();
+    const int32 FramesPerBlock = Settings->bFrameMajorAnimations ? Settings->AnimationFramesPerBlock : 0;
+    const bool bCompressAnimation = FramesPerBlock == 0 && Settings->bCompressAnimations && AnimSkeleton != nullptr;
+    if (bCompressAnimation)
+    {
+        const FReferenceSkeleton& ReferenceSkeleton = AnimSkeleton->GetReferenceSkeleton();
+        for (const FMeshBoneInfo& BoneInfo : ReferenceSkeleton.GetRawRefBoneInfo())
+        {
+            Skeleton.Parents.Add(BoneInfo.ParentIndex);
+        }
+        for (const FTransform& BoneTransform : ReferenceSkeleton.GetRawRefBonePose())
+        {
+            Skeleton.RefPose.Add(FTransform3f(BoneTransform));
+        }
+
+        OutSnapshotSize += Skeleton.Parents.GetAllocatedSize() + Skeleton.RefPose.GetAllocatedSize();
+    }
+
+    FAnimCompressionSettings CompressionSettings;
+    CompressionSettings.ErrorTolerance = Settings->AnimationErrorTolerance;
+    CompressionSettings.ShellDistance = Settings->AnimationShellDistance;
+
+    return [FullFilePathName, AnimName = AnimSequence->GetName(), bCompressGeometry = Settings->bCompressGeometry, FramesPerBlock, bCompressAnimation, CompressionSettings, AnimInfo,
+        RawTracks = MoveTemp(RawTracks), Skeleton = MoveTemp(Skeleton)]()
+    {
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::AnimSequence);
+        FileWriter.SetCompression(bCompressGeometry);
+
+        if (bCompressAnimation && AddCompressedAnimChunks(FileWriter, AnimName, RawTracks, Skeleton, CompressionSettings, AnimInfo))
+        {
+            return FileWriter.Commit();
+        }
+
+        TArray<REngineFormat::AnimTrack> Tracks;
+        TArray<FVector3f> PosKeys;
+        TArray<FQuat4f> RotKeys;
+        TArray<FVector3f> ScaleKeys;
+        for (const FRawAnimTrack& RawTrack : RawTracks)
+        {
+            REngineFormat::AnimTrack& Track = Tracks.AddZeroed_GetRef();
+            Track.BoneIndex = RawTrack.BoneIndex;
+            Track.FirstPosKey = PosKeys.Num();
+            Track.NumPosKeys = RawTrack.PosKeys.Num();
+            Track.FirstRotKey = RotKeys.Num();
+            Track.NumRotKeys = RawTrack.RotKeys.Num();
+            Track.FirstScaleKey = ScaleKeys.Num();
+            Track.NumScaleKeys = RawTrack.ScaleKeys.Num();
+
+            PosKeys.Append(RawTrack.PosKeys);
+            RotKeys.Append(RawTrack.RotKeys);
+            ScaleKeys.Append(RawTrack.ScaleKeys);
+        }
+
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::AnimInfo, 0, AnimInfo);
+
+        if (FramesPerBlock > 0)
+        {
+            const REngineFormat::AnimTrackKeys Keys = { Tracks.GetData(), uint32(Tracks.Num()), reinterpret_cast<const float*>(PosKeys.GetData()),
+                reinterpret_cast<const float*>(RotKeys.GetData()), reinterpret_cast<const float*>(ScaleKeys.GetData()) };
+            const REngineFormat::AnimBlockLayout Layout = REngineFormat::MakeAnimBlockLayout(AnimInfo.NumFrames, uint32(Tracks.Num()), uint32(FramesPerBlock));
+
+            TArray<int32> LaneBones;
+            TArray<float> Blocks;
+            LaneBones.SetNumUninitialized(Layout.NumLanes);
+            Blocks.SetNumUninitialized(int32(REngineFormat::GetAnimBlocksFloats(Layout)));
+            REngineFormat::BuildAnimBlocks(Layout, Keys, LaneBones.GetData(), Blocks.GetData());
+
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::AnimBlockLayout, 0, Layout);
+            FileWriter.AddChunk(REngineFormat::ChunkId::AnimLaneBones, 0, REngineFormat::EElementFormat::Int32, LaneBones);
+            FileWriter.AddChunk(REngineFormat::ChunkId::AnimBlocks, 0, REngineFormat::EElementFormat::Float, Blocks, REngineFormat::StreamAlignment);
+
+            return FileWriter.Commit();
+        }
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::AnimTracks, 0, REngineFormat::EElementFormat::Struct, Tracks);
+        FileWriter.AddChunk(REngineFormat::ChunkId::PosKeys, 0, REngineFormat::EElementFormat::Float3, PosKeys, REngineFormat::StreamAlignment);
+        FileWriter.AddChunk(REngineFormat::ChunkId::RotKeys, 0, REngineFormat::EElementFormat::Float4, RotKeys, REngineFormat::StreamAlignment);
+        FileWriter.AddChunk(REngineFormat::ChunkId::ScaleKeys, 0, REngineFormat::EElementFormat::Float3, ScaleKeys, REngineFormat::StreamAlignment);
+
+        return FileWriter.Commit();
+    };
+}
+
+static FExportTask PrepareAnimTextureExport(const USkeletalMesh* SkeletalMesh, const UAnimSequence* AnimSequence, const FString& FullFilePathName, int64& OutSnapshotSize)
+{
+    // Tracks are matched to the mesh bones through the sequence skeleton
+    if (AnimSequence->GetSkeleton() == nullptr)
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("PrepareAnimTextureExport: %s has no skeleton."), *AnimSequence->GetName());
+
+        return []() { return false; };
+    }
+
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+
+    FAnimTextureSettings BakeSettings;
+    BakeSettings.Mode = Settings->AnimationTextureMode == EAnimationTextureMode::VertexPositions ? REngineFormat::EAnimTextureMode::VertexPositions : REngineFormat::EAnimTextureMode::BoneMatrices;
+    BakeSettings.Format = Settings->bFullPrecisionAnimationTextures ? REngineFormat::EAnimTextureFormat::Float32x4 : REngineFormat::EAnimTextureFormat::Float16x4;
+    BakeSettings.FrameRate = Settings->AnimationTextureFrameRate;
+    BakeSettings.bNormals = Settings->bAnimationTextureNormals;
+    BakeSettings.MaxWidth = Settings->AnimationTextureWidth;
+
+    FAnimTextureSource Source;
+    Source.NumFrames = AnimSequence->GetNumberOfSampledKeys();
+    Source.SequenceLength = AnimSequence->GetPlayLength();
+
+    const FReferenceSkeleton& MeshSkeleton = SkeletalMesh->GetRefSkeleton();
+    for (const FMeshBoneInfo& BoneInfo : MeshSkeleton.GetRawRefBoneInfo())
+    {
+        Source.Skeleton.Parents.Add(BoneInfo.ParentIndex);
+    }
+    for (const FTransform& BoneTransform : MeshSkeleton.GetRawRefBonePose())
+    {
+        Source.Skeleton.RefPose.Add(FTransform3f(BoneTransform));
+    }
+
+    // Tracks animate the bones of the sequence skeleton, the texture holds the bones of the mesh. Matched by name so any compatible skeleton works
+    const FReferenceSkeleton& AnimSkeleton = AnimSequence->GetSkeleton()->GetReferenceSkeleton();
+    for (const FBoneAnimationTrack& AnimationTrack : AnimSequence->GetDataModel()->GetBoneAnimationTracks())
+    {
+        const int32 MeshBoneIndex = MeshSkeleton.FindRawBoneIndex(AnimSkeleton.GetBoneName(AnimationTrack.BoneTreeIndex));
+        if (MeshBoneIndex != INDEX_NONE)
+        {
+            const FRawAnimSequenceTrack& AnimationData = AnimationTrack.InternalTrackData;
+
+            FRawAnimTrack& Track = Source.Tracks.AddDefaulted_GetRef();
+            Track.BoneIndex = MeshBoneIndex;
+            Track.PosKeys = AnimationData.PosKeys;
+            Track.RotKeys = AnimationData.RotKeys;
+            Track.ScaleKeys = AnimationData.ScaleKeys;
+        }
+    }
+
+    // Vertex animation textures carry the LOD 0 mesh, its vertices are the texture elements
+    TArray<uint32> Indices;
+    TArray<REngineFormat::StaticMeshSection> Sections;
+    if (BakeSettings.Mode == REngineFormat::EAnimTextureMode::VertexPositions)
+    {
+        FSkeletalMeshLODSnapshot LOD;
+        GetSkeletalMeshLOD(SkeletalMesh->GetResourceForRendering()->LODRenderData[0], MAX_EXPORT_BONE_INFLUENCES, LOD.Vertices, LOD.Influences, LOD.Indices, LOD.Sections);
+
+        Source.Vertices.SetNumUninitialized(LOD.Vertices.Num());
+        for (int32 iVertex = 0; iVertex < LOD.Vertices.Num(); iVertex++)
+        {
+            const REngineFormat::SkeletalMeshVertex& SkinnedVertex = LOD.Vertices[iVertex];
+            REngineFormat::StaticMeshVertex& Vertex = Source.Vertices[iVertex];
+            FMemory::Memcpy(Vertex.Position, SkinnedVertex.Position, sizeof(Vertex.Position));
+            FMemory::Memcpy(Vertex.Normal, SkinnedVertex.Normal, sizeof(Vertex.Normal));
+            FMemory::Memcpy(Vertex.Tangent, SkinnedVertex.Tangent, sizeof(Vertex.Tangent));
+            FMemory::Memcpy(Vertex.UV, SkinnedVertex.UV, sizeof(Vertex.UV));
+        }
+        Source.Influences = MoveTemp(LOD.Influences);
+        Indices = MoveTemp(LOD.Indices);
+
+        for (const REngineFormat::SkeletalMeshSection& Section : LOD.Sections)
+        {
+            Sections.Add({ Section.MaterialIndex, Section.BaseIndex, Section.NumTriangles, Section.BaseVertexIndex, Section.BaseVertexIndex + FMath::Max(Section.NumVertices, 1u) - 1 });
+        }
+    }
+
+    OutSnapshotSize = Source.GetAllocatedSize() + Indices.GetAllocatedSize() + Sections.GetAllocatedSize();
+
+    return [FullFilePathName, TextureName = SkeletalMesh->GetName() + TEXT("_") + AnimSequence->GetName(), bCompressGeometry = Settings->bCompressGeometry, BakeSettings,
+        Source = MoveTemp(Source), Indices = MoveTemp(Indices), Sections = MoveTemp(Sections)]()
+    {
+        FAnimTexture Texture;
+        if (!BakeAnimTexture(Source, BakeSettings, Texture))
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimTexture: %s has no texels or does not fit in a texture %d texels wide, lower the frame rate or raise the width."),
+                *TextureName, BakeSettings.MaxWidth);
+
+            return false;
+        }
+
+        const bool bHalf = BakeSettings.Format == REngineFormat::EAnimTextureFormat::Float16x4;
+        UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimTexture: %s %s, %u frames at %.0f fps, %ux%u %s, %.2f MB, max error %.4f cm."),
+            *TextureName, BakeSettings.Mode == REngineFormat::EAnimTextureMode::BoneMatrices ? TEXT("bone matrices") : TEXT("vertex positions"), Texture.Info.NumFrames,
+            Texture.Info.FrameRate, Texture.Info.Width, Texture.Info.Height, bHalf ? TEXT("RGBA16F") : TEXT("RGBA32F"), Texture.GetDataSize() / (1024.0 * 1024.0), Texture.MaxError);
+
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::AnimTexture);
+        FileWriter.SetCompression(bCompressGeometry);
+
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::AnimTextureInfo, 0, Texture.Info);
+        if (bHalf)
+        {
+            FileWriter.AddChunk(REngineFormat::ChunkId::AnimTexels, 0, REngineFormat::EElementFormat::UInt16, Texture.HalfTexels, REngineFormat::StreamAlignment);
+        }
+        else
+        {
+            FileWriter.AddChunk(REngineFormat::ChunkId::AnimTexels, 0, REngineFormat::EElementFormat::Float, Texture.FloatTexels, REngineFormat::StreamAlignment);
+        }
+
+        if (BakeSettings.Mode == REngineFormat::EAnimTextureMode::VertexPositions)
+        {
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::VertexFormat, 0, GetStaticMeshVertexFormat());
+            FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, 0, REngineFormat::EElementFormat::Struct, Source.Vertices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Indices, 0, REngineFormat::EElementFormat::UInt32, Indices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Sections, 0, REngineFormat::EElementFormat::Struct, Sections);
+        }
+
+        return FileWriter.Commit();
+    };
+}
+
+/** Registry id of a texture. Its source is only read when the registry does not know it, and the task converting it is only added when the content is new */
+static uint64 ResolveTexture(FTextureRegistry& TextureRegistry, const FExportCache& ExportCache, const UTexture* Texture,
+    TFunctionRef<void(FExportTask&&, int64, uint64)> AddTask)
+{
+    const FString TexturePathName = Texture->GetPathName();
+    const uint64 SourceHash = ExportCache.GetContentHash(Texture);
+
+    uint64 ContentId = TextureRegistry.FindId(TexturePathName, SourceHash);
+    if (ContentId != 0)
+    {
+        return ContentId;
+    }
+
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+    FTextureExportOptions Options;
+    Options.bHighQuality = Settings->bHighQualityTextures;
+    Options.AlphaCoverageThreshold = Settings->bPreserveAlphaCoverage ? Settings->AlphaCoverageThreshold : 0.0f;
+
+    FTextureSnapshot Snapshot;
+    if (!SnapshotTexture(Texture, Options, Snapshot))
+    {
+        return 0;
+    }
+
+    ContentId = GetTextureContentId(Snapshot);
+    if (TextureRegistry.Register(TexturePathName, SourceHash, ContentId))
+    {
+        const int64 SnapshotSize = Snapshot.GetAllocatedSize();
+        AddTask([FullFilePathName = TextureRegistry.GetFilePathName(ContentId), Snapshot = MoveTemp(Snapshot)]()
+        {
+            return WriteTextureDDS(Snapshot, FullFilePathName);
+        }, SnapshotSize, ContentId);
+    }
+
+    return ContentId;
+}
+
+/** Texture parameter values of a material instance */
+static void GetMaterialTextures(const UMaterialInstance* MaterialInstance, TArray<FName>& OutParameterNames, TArray<UTexture*>& OutTextures)
+{
+    TArray<FMaterialParameterInfo> ParameterInfos;
+    TArray<FGuid> Guids;
+    MaterialInstance->GetAllTextureParameterInfo(ParameterInfos, Guids);
+    for (const FMaterialParameterInfo& ParameterInfo : ParameterInfos)
+    {
+        UTexture* Texture = nullptr;
+        MaterialInstance->GetTextureParameterValue(ParameterInfo, Texture);
+
+        if (Texture != nullptr)
+        {
+            OutParameterNames.Add(ParameterInfo.Name);
+            OutTextures.Add(Texture);
+        }
+    }
+}
+
+/** Textures are referenced by registry id, they must be resolved before */
+static FExportTask PrepareMaterialInstanceExport(const UMaterialInstance* MaterialInstace, const FString& FullFilePathName, const FTextureRegistry& TextureRegistry, int64& OutSnapshotSize)
+{
+    REngineFormat::MaterialInfo MaterialInfo = {};
+    MaterialInfo.BlendMode = (int32)MaterialInstace->BlendMode;
+
+    EMaterialShadingModel MaterialShadingModel = MaterialInstace->GetShadingModels().GetFirstShadingModel();
+    MaterialInfo.ShadingModel = (int32)MaterialShadingModel;
+
+    MaterialInfo.TwoSided = MaterialInstace->TwoSided;
+
+    TArray<float> ScalarParameters;
+    TArray<FLinearColor> VectorParameters;
+    TArray<FString> TextureParameters;
+
+    TArray<FMaterialParameterInfo> OutScalarParameterInfo;
+    TArray<FGuid> GuidsScalar;
+    MaterialInstace->GetAllScalarParameterInfo(OutScalarParameterInfo, GuidsScalar);
+
+    // Every parameter tagged with its name hash and type, the fixed chunks above are kept for older readers
+    FMaterialParameterTable ParameterTable;
+    for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+    {
+        float Value = 0.0f;
+        if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Value))
+        {
+            ParameterTable.AddScalar(ParameterInfo.Name.ToString(), Value);
+        }
+    }
+    for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("MetallicScale"))
+        {
+            float Metallic = 0.0f;
+            if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Metallic))
+            {
+                ScalarParameters.Add(Metallic);
+            }
+
+            break;
+        }
+    }
+
+    for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("SpecularScale"))
+        {
+            float Specular = 0.0f;
+            if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Specular))
+            {
+                ScalarParameters.Add(Specular);
+            }
+
+            break;
+        }
+    }
+
+    for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("RoughnessScale"))
+        {
+            float Roughness = 0.0f;
+            if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Roughness))
+            {
+                ScalarParameters.Add(Roughness);
+            }
+
+            break;
+        }
+    }
+
+    for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("OpacityScale"))
+        {
+            float Opacity = 1.0f;
+            if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Opacity))
+            {
+                ScalarParameters.Add(Opacity);
+            }
+
+            break;
+        }
+    }
+
+    TArray<FMaterialParameterInfo> OutVectorParameterInfo;
+    TArray<FGuid> GuidsVector;
+    MaterialInstace->GetAllVectorParameterInfo(OutVectorParameterInfo, GuidsVector);
+    for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+    {
+        FLinearColor Value;
+        if (MaterialInstace->GetVectorParameterValue(ParameterInfo, Value))
+        {
+            ParameterTable.AddVector(ParameterInfo.Name.ToString(), Value);
+        }
+    }
+    for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("BaseColorScale"))
+        {
+            FLinearColor BaseColor;
+            if (MaterialInstace->GetVectorParameterValue(ParameterInfo, BaseColor))
+            {
+                VectorParameters.Add(BaseColor);
+            }
+
+            break;
+        }
+    }
+
+    for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("EmissiveColorScale"))
+        {
+            FLinearColor EmissiveColor;
+            if (MaterialInstace->GetVectorParameterValue(ParameterInfo, EmissiveColor))
+            {
+                VectorParameters.Add(EmissiveColor);
+            }
+
+            break;
+        }
+    }
+
+    for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+    {
+        if (ParameterInfo.Name == FName("SubsurfaceColorScale"))
+        {
+            FLinearColor SubsurfaceColor;
+            if (MaterialInstace->GetVectorParameterValue(ParameterInfo, SubsurfaceColor))
+            {
+                VectorParameters.Add(SubsurfaceColor);
+            }
+
+            break;
+        }
+    }
+
+    TArray<FName> TextureParameterNames;
+    TArray<UTexture*> Textures;
+    GetMaterialTextures(MaterialInstace, TextureParameterNames, Textures);
+
+    for (int32 TextureIndex = 0; TextureIndex < Textures.Num(); TextureIndex++)
+    {
+        const uint64 ContentId = TextureRegistry.GetId(Textures[TextureIndex]->GetPathName());
+        if (ContentId != 0)
+        {
+            TextureParameters.Add(TextureParameterNames[TextureIndex].ToString());
+            TextureParameters.Add(TextureRegistry.GetFileName(ContentId));
+            ParameterTable.AddTexture(TextureParameterNames[TextureIndex].ToString(), ContentId);
+        }
+    }
+
+    ParameterTable.Sort();
+
+    const UMaterial* BaseMaterial = MaterialInstace->GetMaterial();
+    REngineFormat::MaterialState MaterialState = {};
+    MaterialState.TextureSetHash = ParameterTable.GetTextureSetHash();
+    MaterialState.BaseMaterialHash = BaseMaterial != nullptr ? FCrc::StrCrc32(*BaseMaterial->GetPathName()) : 0;
+    MaterialState.SortKey = MakeMaterialSortKey(MaterialInfo.BlendMode, MaterialInfo.ShadingModel, MaterialInfo.TwoSided != 0, MaterialState.BaseMaterialHash,
+        MaterialState.TextureSetHash);
+
+    OutSnapshotSize = ScalarParameters.GetAllocatedSize() + VectorParameters.GetAllocatedSize() + TextureParameters.GetAllocatedSize() + ParameterTable.GetAllocatedSize();
+
+    return [FullFilePathName, MaterialInfo, MaterialState, ScalarParameters = MoveTemp(ScalarParameters), VectorParameters = MoveTemp(VectorParameters),
+        TextureParameters = MoveTemp(TextureParameters), ParameterTable = MoveTemp(ParameterTable)]()
+    {
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::Material);
+
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::MaterialInfo, 0, MaterialInfo);
+        FileWriter.AddStructChunk(REngineFormat::ChunkId::MaterialState, 0, MaterialState);
+        FileWriter.AddChunk(REngineFormat::ChunkId::ScalarParameters, 0, REngineFormat::EElementFormat::Float, ScalarParameters);
+        FileWriter.AddChunk(REngineFormat::ChunkId::VectorParameters, 0, REngineFormat::EElementFormat::Float4, VectorParameters);
+        FileWriter.AddStringTableChunk(REngineFormat::ChunkId::TextureParameters, 0, TextureParameters);
+        FileWriter.AddChunk(REngineFormat::ChunkId::ParameterTable, 0, REngineFormat::EElementFormat::Struct, ParameterTable.Parameters);
+        FileWriter.AddStringTableChunk(REngineFormat::ChunkId::ParameterNames, 0, ParameterTable.Names);
+        FileWriter.AddChunk(REngineFormat::ChunkId::ParameterValues, 0, REngineFormat::EElementFormat::Float, ParameterTable.Values);
+        FileWriter.AddChunk(REngineFormat::ChunkId::ParameterTextureIds, 0, REngineFormat::EElementFormat::UInt64, ParameterTable.TextureIds);
+
+        return FileWriter.Commit();
+    };
+}
+
+/** Parent chain of a material instance, its parameter values fall back to them */
+static void GetMaterialParents(const UMaterialInstance* MaterialInstance, TArray<const UObject*>& OutParents)
+{
+    for (const UMaterialInterface* Parent = MaterialInstance->Parent; Parent != nullptr; )
+    {
+        OutParents.Add(Parent);
+
+        const UMaterialInstance* ParentInstance = Cast<UMaterialInstance>(Parent);
+        Parent = ParentInstance != nullptr ? ParentInstance->Parent.Get() : nullptr;
+    }
+}
+
+/** Snapshot the asset and queue its export unless the file is up to date in the cache */
+static void ExportCached(FExportCache& ExportCache, FExportTaskQueue& ExportQueue, const UObject* Asset, TArrayView<const UObject* const> Dependencies,
+    const FString& FullFilePathName, TFunctionRef<FExportTask(int64&)> Prepare)
+{
+    if (Asset == nullptr)
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportCached: no asset for %s."), *FullFilePathName);
+
+        return;
+    }
+
+    const uint64 ContentHash = ExportCache.GetContentHash(Asset, Dependencies);
+    if (!ExportCache.IsUpToDate(FullFilePathName, ContentHash))
+    {
+        int64 SnapshotSize = 0;
+        FExportTask ExportTask = Prepare(SnapshotSize);
+
+        ExportQueue.Add(MoveTemp(ExportTask), SnapshotSize, [&ExportCache, FullFilePathName, AssetPathName = Asset->GetPathName(), ContentHash](bool bSucceeded)
+        {
+            ExportCache.MarkExported(FullFilePathName, AssetPathName, ContentHash, bSucceeded);
+        });
+    }
+}
+
+/** Resolve and queue the textures of a material instance, then export the material unless it is up to date */
+static void ExportMaterialCached(FExportCache& ExportCache, FTextureRegistry& TextureRegistry, FExportTaskQueue& ExportQueue, const UMaterialInstance* Instance,
+    const FString& FullFilePathName)
+{
+    TArray<FName> TextureParameterNames;
+    TArray<UTexture*> Textures;
+    GetMaterialTextures(Instance, TextureParameterNames, Textures);
+    for (const UTexture* Texture : Textures)
+    {
+        ResolveTexture(TextureRegistry, ExportCache, Texture, [&ExportQueue, &TextureRegistry](FExportTask&& Task, int64 SnapshotSize, uint64 ContentId)
+        {
+            ExportQueue.Add(MoveTemp(Task), SnapshotSize, [&TextureRegistry, ContentId](bool bSucceeded)
+            {
+                if (!bSucceeded)
+                {
+                    TextureRegistry.MarkFailed(ContentId);
+                }
+            });
+        });
+    }
+
+    // The texture ids written into the material change with the textures
+    TArray<const UObject*> Dependencies;
+    GetMaterialParents(Instance, Dependencies);
+    Dependencies.Append(Textures);
+
+    ExportCached(ExportCache, ExportQueue, Instance, Dependencies, FullFilePathName,
+        [&](int64& OutSnapshotSize) { return PrepareMaterialInstanceExport(Instance, FullFilePathName, TextureRegistry, OutSnapshotSize); });
+}
+
+/** Path of an exported file below the export root, as streaming cells list their dependencies */
+static FString GetExportRelativePath(const FString& FullFilePathName)
+{
+    FString RelativePath = FullFilePathName;
+    FPaths::MakePathRelativeTo(RelativePath, *(FPaths::ProjectSavedDir() + ROOT_PATH));
+
+    return RelativePath;
+}
+
+/** Actors of a map or of one of its streaming cells, string indices refer to the Strings of the map */
+struct FMapActorSet
+{
+    TArray<REngineFormat::MapStaticMeshActor> StaticMeshActors;
+    TArray<REngineFormat::MapActorLOD> StaticMeshActorLODs;
+    TArray<REngineFormat::MapActorBounds> StaticMeshActorBounds;
+    TArray<REngineFormat::MapSkeletalMeshActor> SkeletalMeshActors;
+    TArray<REngineFormat::MapActorLOD> SkeletalMeshActorLODs;
+    TArray<REngineFormat::MapActorBounds> SkeletalMeshActorBounds;
+    TArray<uint32> ActorMaterials;
+    /** Static mesh actors to merge, their meshes are the LOD 0 snapshots of the whole map */
+    TArray<FMergeActor> MergeActors;
+
+    int64 GetAllocatedSize() const
+    {
+        return StaticMeshActors.GetAllocatedSize() + StaticMeshActorLODs.GetAllocatedSize() + StaticMeshActorBounds.GetAllocatedSize()
+            + SkeletalMeshActors.GetAllocatedSize() + SkeletalMeshActorLODs.GetAllocatedSize() + SkeletalMeshActorBounds.GetAllocatedSize()
+            + ActorMaterials.GetAllocatedSize() + MergeActors.GetAllocatedSize();
+    }
+};
+
+/** Settings the actor chunks are built with, copied on the game thread for the cell export tasks */
+struct FMapExportOptions
+{
+    bool bInstanceStaticMeshes;
+    int32 MaxInstancesPerBatch;
+    float MergeCellSize;
+};
+
+static FMapExportOptions GetMapExportOptions()
+{
+    const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+
+    FMapExportOptions Options;
+    Options.bInstanceStaticMeshes = Settings->bInstanceStaticMeshes;
+    Options.MaxInstancesPerBatch = Settings->MaxInstancesPerBatch;
+    Options.MergeCellSize = Settings->MergeCellSize;
+
+    return Options;
+}
+
+/** Add the actor chunks of a .map or cell file, with the culling hierarchy, merged geometry and instance batches built from them */
+static void AddMapActorChunks(FExportFileWriter& FileWriter, const FMapActorSet& Actors, const TArray<FMergeMeshSource>& MergeMeshes, const FMapExportOptions& Options,
+    const FString& LogName)
+{
+    FileWriter.AddChunk(REngineFormat::ChunkId::StaticMeshActors, 0, REngineFormat::EElementFormat::Struct, Actors.StaticMeshActors);
+    FileWriter.AddChunk(REngineFormat::ChunkId::SkeletalMeshActors, 0, REngineFormat::EElementFormat::Struct, Actors.SkeletalMeshActors);
+    FileWriter.AddChunk(REngineFormat::ChunkId::ActorMaterials, 0, REngineFormat::EElementFormat::UInt32, Actors.ActorMaterials);
+    FileWriter.AddChunk(REngineFormat::ChunkId::ActorLODs, 0, REngineFormat::EElementFormat::Struct, Actors.StaticMeshActorLODs);
+    FileWriter.AddChunk(REngineFormat::ChunkId::ActorLODs, 1, REngineFormat::EElementFormat::Struct, Actors.SkeletalMeshActorLODs);
+    FileWriter.AddChunk(REngineFormat::ChunkId::ActorBounds, 0, REngineFormat::EElementFormat::Struct, Actors.StaticMeshActorBounds);
+    FileWriter.AddChunk(REngineFormat::ChunkId::ActorBounds, 1, REngineFormat::EElementFormat::Struct, Actors.SkeletalMeshActorBounds);
+
+    // The runtime culls static mesh actors through the BVH without loading their meshes
+    TArray<REngineFormat::MapBVHNode> BVHNodes;
+    TArray<uint32> BVHItems;
+    FBVHBuildReport BVHReport;
+    BuildBVH(Actors.StaticMeshActorBounds, MAP_BVH_LEAF_ACTORS, BVHNodes, BVHItems, BVHReport);
+    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("%s: BVH of %d static mesh actors, %d nodes, %d leaves, depth %d, %.1f%% of the brute force culling cost."),
+        *LogName, Actors.StaticMeshActorBounds.Num(), BVHNodes.Num(), BVHReport.NumLeaves, BVHReport.MaxDepth, 100.0f * BVHReport.RelativeCost);
+
+    FileWriter.AddChunk(REngineFormat::ChunkId::BVHNodes, 0, REngineFormat::EElementFormat::Struct, BVHNodes, REngineFormat::StreamAlignment);
+    FileWriter.AddChunk(REngineFormat::ChunkId::BVHItems, 0, REngineFormat::EElementFormat::UInt32, BVHItems);
+
+    // Merged actors trade a copy of their mesh per actor for one draw per cell material, the cells replace them at runtime
+    TBitArray<> MergedActors(false, Actors.StaticMeshActors.Num());
+    if (Actors.MergeActors.Num() > 0)
+    {
+        TArray<FMergedCell> MergedCells;
+        FMeshMergeReport MergeReport;
+        MergeStaticMeshes(MergeMeshes, Actors.MergeActors, Options.MergeCellSize, MergedCells, MergeReport);
+        UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("%s: merged %d small static mesh actors into %d cells, %d draws instead of %d, %.2f MB of geometry instead of %.2f MB."),
+            *LogName, MergeReport.NumActors, MergedCells.Num(), MergeReport.NumMergedDraws, MergeReport.NumSourceDraws,
+            MergeReport.MergedBytes / (1024.0f * 1024.0f), MergeReport.SourceBytes / (1024.0f * 1024.0f));
+
+        TArray<REngineFormat::MapMergedCell> CellInfos;
+        TArray<uint32> CellActors;
+        for (int32 CellIndex = 0; CellIndex < MergedCells.Num(); CellIndex++)
+        {
+            const FMergedCell& Cell = MergedCells[CellIndex];
+            CellInfos.Add(Cell.Info);
+            CellActors.Append(Cell.Actors);
+            for (uint32 ActorIndex : Cell.Actors)
+            {
+                MergedActors[ActorIndex] = true;
+            }
+
+            FileWriter.AddStructChunk(REngineFormat::ChunkId::VertexFormat, CellIndex, GetStaticMeshVertexFormat());
+            FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, CellIndex, REngineFormat::EElementFormat::Struct, Cell.Vertices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Indices, CellIndex, REngineFormat::EElementFormat::UInt32, Cell.Indices, REngineFormat::StreamAlignment);
+            FileWriter.AddChunk(REngineFormat::ChunkId::Sections, CellIndex, REngineFormat::EElementFormat::Struct, Cell.Sections);
+            FileWriter.AddChunk(REngineFormat::ChunkId::MergedCellMaterials, CellIndex, REngineFormat::EElementFormat::UInt32, Cell.Materials);
+        }
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::MergedCells, 0, REngineFormat::EElementFormat::Struct, CellInfos);
+        FileWriter.AddChunk(REngineFormat::ChunkId::MergedCellActors, 0, REngineFormat::EElementFormat::UInt32, CellActors);
+    }
+
+    // The actors stay in StaticMeshActors, the batches only address them
+    if (Options.bInstanceStaticMeshes)
+    {
+        FInstanceBatches InstanceBatches;
+        BuildInstanceBatches(Actors.StaticMeshActors, Actors.StaticMeshActorLODs, Actors.StaticMeshActorBounds, Actors.ActorMaterials, MergedActors,
+            Options.MaxInstancesPerBatch, InstanceBatches);
+        UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("%s: %d static mesh actors of %d meshes in %d instance batches, %.1f instances per batch."),
+            *LogName, InstanceBatches.Actors.Num(), InstanceBatches.NumMeshes, InstanceBatches.Batches.Num(), float(InstanceBatches.Actors.Num()) / FMath::Max(InstanceBatches.Batches.Num(), 1));
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::InstanceBatches, 0, REngineFormat::EElementFormat::Struct, InstanceBatches.Batches);
+        FileWriter.AddChunk(REngineFormat::ChunkId::InstanceTransforms, 0, REngineFormat::EElementFormat::Struct, InstanceBatches.Transforms, REngineFormat::StreamAlignment);
+        FileWriter.AddChunk(REngineFormat::ChunkId::InstanceBounds, 0, REngineFormat::EElementFormat::Struct, InstanceBatches.Bounds, REngineFormat::StreamAlignment);
+        FileWriter.AddChunk(REngineFormat::ChunkId::InstanceActors, 0, REngineFormat::EElementFormat::UInt32, InstanceBatches.Actors);
+    }
+}
+
+/** The actors of one streaming cell, material ranges and merged actor indices renumbered for the cell */
+static void GetMapCellActors(const FMapActorSet& Actors, const FMapPartitionCell& Cell, FMapActorSet& OutActors)
+{
+    TArray<int32> CellStaticMeshActors;
+    CellStaticMeshActors.Init(INDEX_NONE, Actors.StaticMeshActors.Num());
+    for (int32 ActorIndex : Cell.StaticMeshActors)
+    {
+        CellStaticMeshActors[ActorIndex] = OutActors.StaticMeshActors.Num();
+
+        REngineFormat::MapStaticMeshActor& StaticMeshActor = OutActors.StaticMeshActors.Add_GetRef(Actors.StaticMeshActors[ActorIndex]);
+        StaticMeshActor.FirstMaterial = OutActors.ActorMaterials.Num();
+        OutActors.ActorMaterials.Append(Actors.ActorMaterials.GetData() + Actors.StaticMeshActors[ActorIndex].FirstMaterial, StaticMeshActor.NumMaterials);
+        OutActors.StaticMeshActorLODs.Add(Actors.StaticMeshActorLODs[ActorIndex]);
+        OutActors.StaticMeshActorBounds.Add(Actors.StaticMeshActorBounds[ActorIndex]);
+    }
+
+    for (int32 ActorIndex : Cell.SkeletalMeshActors)
+    {
+        REngineFormat::MapSkeletalMeshActor& SkeletalMeshActor = OutActors.SkeletalMeshActors.Add_GetRef(Actors.SkeletalMeshActors[ActorIndex]);
+        SkeletalMeshActor.FirstMaterial = OutActors.ActorMaterials.Num();
+        OutActors.ActorMaterials.Append(Actors.ActorMaterials.GetData() + Actors.SkeletalMeshActors[ActorIndex].FirstMaterial, SkeletalMeshActor.NumMaterials);
+        OutActors.SkeletalMeshActorLODs.Add(Actors.SkeletalMeshActorLODs[ActorIndex]);
+        OutActors.SkeletalMeshActorBounds.Add(Actors.SkeletalMeshActorBounds[ActorIndex]);
+    }
+
+    for (const FMergeActor& MergeActor : Actors.MergeActors)
+    {
+        if (CellStaticMeshActors[MergeActor.ActorIndex] != INDEX_NONE)
+        {
+            OutActors.MergeActors.Add_GetRef(MergeActor).ActorIndex = uint32(CellStaticMeshActors[MergeActor.ActorIndex]);
+        }
+    }
+}
+
+/** Delete the cell files an earlier export of the map left behind that CellFileNames no longer lists */
+static void DeleteStaleMapCells(const FString& FullFilePathName, const TArray<FString>& CellFileNames)
+{
+    const FString MapPath = FPaths::GetPath(FullFilePathName);
+    const FString CellPrefix = FPaths::GetBaseFilename(FullFilePathName) + TEXT("_");
+
+    TArray<FString> FoundFileNames;
+    IFileManager::Get().FindFiles(FoundFileNames, *(MapPath / (CellPrefix + TEXT("*") + MAP_CELL_BINARY_FILE_POSTFIX)), true, false);
+    for (const FString& FileName : FoundFileNames)
+    {
+        // Only <map>_<index>.mcl, the cells of a map named <map>_<suffix> match the wildcard too
+        if (!FPaths::GetBaseFilename(FileName).RightChop(CellPrefix.Len()).IsNumeric() || CellFileNames.Contains(FileName))
+        {
+            continue;
+        }
+
+        if (!IFileManager::Get().Delete(*(MapPath / FileName)))
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("DeleteStaleMapCells: could not delete %s."), *FileName);
+        }
+    }
+}
+
 UObjectExporterBPLibrary::UObjectExporterBPLibrary(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer)
 {
@@ -63,147 +1514,69 @@ bool UObjectExporterBPLibrary::ExportStaticMesh(const UStaticMesh* StaticMesh, c
     {
         if (FullFilePathName.EndsWith(JSON_FILE_POSTFIX))
         {
-            const int32 FileVersion = 1;
-            TSharedRef<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-            JsonRootObject->SetNumberField("FileVersion", FileVersion);
-            JsonRootObject->SetStringField("MeshName", *StaticMesh->GetName());
+            FExportJsonWriter JsonFile(FullFilePathName);
+            const FStaticMeshRenderData* RenderData = StaticMesh->GetRenderData();
 
-            if (StaticMesh->GetRenderData() != nullptr)
+            if (JsonFile.IsValid() && RenderData != nullptr)
             {
-                // Vertex format
-                TArray<TSharedPtr<FJsonValue>> JsonVertexFormat;
-                JsonRootObject->SetArrayField("VertexFormat", JsonVertexFormat);
-
-                // LODs
-                JsonRootObject->SetNumberField("LODCount", StaticMesh->GetRenderData()->LODResources.Num());
-
-                int32 LODIndex = 0;
-                TArray< TSharedPtr<FJsonValue> > JsonLODDatas;
-                for (const FStaticMeshLODResources& CurLOD : StaticMesh->GetRenderData()->LODResources)
+                FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+                JsonWriter.WriteObjectStart();
+                JsonWriter.WriteValue(TEXT("FileVersion"), JSON_FILE_VERSION);
+                JsonWriter.WriteValue(TEXT("MeshName"), StaticMesh->GetName());
+                JsonWriter.WriteValue(TEXT("VertexFormat"), TArray<FString>({ TEXT("Position"), TEXT("Normal"), TEXT("Tangent"), TEXT("UV0") }));
+                JsonWriter.WriteValue(TEXT("LODCount"), RenderData->LODResources.Num());
+
+                JsonWriter.WriteArrayStart(TEXT("LODs"));
+                for (int32 LODIndex = 0; LODIndex < RenderData->LODResources.Num(); LODIndex++)
                 {
-                    TSharedRef<FJsonObject> JsonLODSingle = MakeShareable(new FJsonObject);
-                    JsonLODSingle->SetNumberField("LOD", LODIndex);
-
-                    // Vertex data
-                    TArray<TSharedPtr<FJsonValue>> JsonVertices;
-                    const FPositionVertexBuffer& VertexBuffer = CurLOD.VertexBuffers.PositionVertexBuffer;
-
-                    JsonLODSingle->SetNumberField("VertexCount", VertexBuffer.GetNumVertices());
-
-                    for (uint32 iVertex = 0; iVertex < VertexBuffer.GetNumVertices(); iVertex++)
-                    {
-                        const FVector3f& Position = VertexBuffer.VertexPosition(iVertex);
-
-                        TSharedRef<FJsonObject> JsonVertex = MakeShareable(new FJsonObject);
-                        JsonVertex->SetNumberField("x", Position.X);
-                        JsonVertex->SetNumberField("y", Position.Y);
-                        JsonVertex->SetNumberField("z", Position.Z);
-
-                        JsonVertices.Emplace(MakeShareable(new FJsonValueObject(JsonVertex)));
-                    }
-                    JsonLODSingle->SetArrayField("Vertices", JsonVertices);
-
-                    // Index data
-                    TArray<TSharedPtr<FJsonValue>> JsonIndices;
-                    FIndexArrayView Indices = CurLOD.IndexBuffer.GetArrayView();
-
-                    JsonLODSingle->SetNumberField("IndexCount", Indices.Num());
-
-                    for (int32 iIndex = 0; iIndex < Indices.Num(); iIndex++)
+                    TArray<REngineFormat::StaticMeshVertex> Vertices;
+                    TArray<uint32> Indices;
+                    TArray<REngineFormat::StaticMeshSection> Sections;
+                    GetStaticMeshLOD(RenderData->LODResources[LODIndex], Vertices, Indices, Sections);
+
+                    JsonWriter.WriteObjectStart();
+                    JsonWriter.WriteValue(TEXT("LOD"), LODIndex);
+                    JsonWriter.WriteValue(TEXT("ScreenSize"), RenderData->ScreenSize[LODIndex].Default);
+                    WriteJsonVertices(JsonFile, Vertices);
+                    JsonWriter.WriteValue(TEXT("IndexCount"), Indices.Num());
+                    JsonFile.WriteArray(TEXT("Indices"), Indices);
+
+                    JsonWriter.WriteArrayStart(TEXT("Sections"));
+                    for (const REngineFormat::StaticMeshSection& Section : Sections)
                     {
-                        TSharedRef<FJsonObject> JsonIndex = MakeShareable(new FJsonObject);
-                        JsonIndex->SetNumberField("index", Indices[iIndex]);
-
-                        JsonIndices.Emplace(MakeShareable(new FJsonValueObject(JsonIndex)));
+                        JsonWriter.WriteObjectStart();
+                        JsonWriter.WriteValue(TEXT("MaterialIndex"), Section.MaterialIndex);
+                        JsonWriter.WriteValue(TEXT("FirstIndex"), int64(Section.FirstIndex));
+                        JsonWriter.WriteValue(TEXT("NumTriangles"), int64(Section.NumTriangles));
+                        JsonWriter.WriteValue(TEXT("MinVertexIndex"), int64(Section.MinVertexIndex));
+                        JsonWriter.WriteValue(TEXT("MaxVertexIndex"), int64(Section.MaxVertexIndex));
+                        JsonWriter.WriteObjectEnd();
                     }
-                    JsonLODSingle->SetArrayField("Indices", JsonIndices);
-
-                    JsonLODDatas.Emplace(MakeShareable(new FJsonValueObject(JsonLODSingle)));
+                    JsonWriter.WriteArrayEnd();
 
-                    LODIndex++;
+                    JsonWriter.WriteObjectEnd();
                 }
-                JsonRootObject->SetArrayField("LODs", JsonLODDatas);
+                JsonWriter.WriteArrayEnd();
+                JsonWriter.WriteObjectEnd();
 
-                FString JsonContent;
-                TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonContent, 0);
-                if (FJsonSerializer::Serialize(JsonRootObject, JsonWriter))
+                if (JsonFile.Commit())
                 {
-                    if (FFileHelper::SaveStringToFile(JsonContent, *FullFilePathName))
-                    {
-                        UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: success."));
+                    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: success."));
 
-                        return true;
-                    }
+                    return true;
                 }
             }
         }
         else if (FullFilePathName.EndsWith(STATIC_MESH_BINARY_FILE_POSTFIX))
         {
             // Save to binary file
-            IFileManager& FileManager = IFileManager::Get();
-            FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-            if (nullptr == FileWriter)
-            {
-                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: CreateFileWriter failed."));
-
-                return false;
-            }
-
-            for (const FStaticMeshLODResources& CurLOD : StaticMesh->GetRenderData()->LODResources)
+            int64 SnapshotSize = 0;
+            if (PrepareStaticMeshExport(StaticMesh, FullFilePathName, SnapshotSize)())
             {
-                // Vertex data
-                const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.VertexBuffers.PositionVertexBuffer;
-                const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.VertexBuffers.StaticMeshVertexBuffer;
-                int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportStaticMesh: success."));
 
-                *FileWriter << NumVertices;
-
-                for (uint32 iVertex = 0; iVertex < PositionVertexBuffer.GetNumVertices(); iVertex++)
-                {
-                    FVector3f Position = PositionVertexBuffer.VertexPosition(iVertex);
-                    FVector4 TangentZ = StaticMeshVertexBuffer.VertexTangentZ(iVertex);
-                    FVector4 TangentX = StaticMeshVertexBuffer.VertexTangentX(iVertex);
-                    FVector4f Normal = FVector4f(TangentZ.X, TangentZ.Y, TangentZ.Z, TangentZ.W);
-                    FVector3f Tangent = FVector3f(TangentX.X, TangentX.Y, TangentX.Z);
-
-                    FVector2f UV = StaticMeshVertexBuffer.GetVertexUV(iVertex, 0);
-
-                    *FileWriter << Position;
-                    *FileWriter << Normal;
-                    *FileWriter << Tangent;
-                    *FileWriter << UV;
-                }
-
-                // Index data
-                FIndexArrayView Indices = CurLOD.IndexBuffer.GetArrayView();
-                int32 NumIndices = Indices.Num();
-
-                *FileWriter << NumIndices;
-
-                for (int32 iIndex = 0; iIndex < Indices.Num(); iIndex++)
-                {
-                    uint32 Index = Indices[iIndex];
-                    *FileWriter << Index;
-                }
-
-                int32 NumSection = CurLOD.Sections.Num();
-                *FileWriter << NumSection;
-
-                for (const FStaticMeshSection& Section : CurLOD.Sections)
-                {
-                    *FileWriter << int32(Section.MaterialIndex);
-                    *FileWriter << uint32(Section.FirstIndex);
-                    *FileWriter << uint32(Section.NumTriangles);
-                    *FileWriter << uint32(Section.MinVertexIndex);
-                    *FileWriter << uint32(Section.MaxVertexIndex);
-                }
-                //now save only lod 0
-                break;
+                return true;
             }
-
-            FileWriter->Close();
-            delete FileWriter;
-            FileWriter = nullptr;
         }
     }
 
@@ -226,110 +1599,106 @@ bool UObjectExporterBPLibrary::ExportSkeletalMesh(const USkeletalMesh* SkeletalM
     {
         if (FullFilePathName.EndsWith(JSON_FILE_POSTFIX))
         {
-            const int32 FileVersion = 1;
-            TSharedRef<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-            JsonRootObject->SetNumberField("FileVersion", FileVersion);
-        }
-        else if (FullFilePathName.EndsWith(SKELETAL_MESH_BINARY_FILE_POSTFIX))
-        {
-            // Save to binary file
-            IFileManager& FileManager = IFileManager::Get();
-            FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-            if (nullptr == FileWriter)
-            {
-                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeletonalMesh: CreateFileWriter failed."));
+            FExportJsonWriter JsonFile(FullFilePathName);
+            const FSkeletalMeshRenderData* RenderData = SkeletalMesh->GetResourceForRendering();
 
-                return false;
-            }
-
-            for (const FSkeletalMeshLODRenderData& CurLOD : SkeletalMesh->GetResourceForRendering()->LODRenderData)
+            if (JsonFile.IsValid() && RenderData != nullptr)
             {
-                // Vertex data
-                const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.StaticVertexBuffers.PositionVertexBuffer;
-                const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.StaticVertexBuffers.StaticMeshVertexBuffer;
-                const TArray<FBoneIndexType>& BoneMap = CurLOD.RenderSections[0].BoneMap;
-                TArray<FSkinWeightInfo> WeightInfos;
-                CurLOD.SkinWeightVertexBuffer.GetSkinWeights(WeightInfos);
-
-                int32 NumVertices = PositionVertexBuffer.GetNumVertices();
-
-                *FileWriter << NumVertices;
-
-                for (uint32 iVertex = 0; iVertex < PositionVertexBuffer.GetNumVertices(); iVertex++)
+                FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+                JsonWriter.WriteObjectStart();
+                JsonWriter.WriteValue(TEXT("FileVersion"), JSON_FILE_VERSION);
+                JsonWriter.WriteValue(TEXT("MeshName"), SkeletalMesh->GetName());
+                JsonWriter.WriteValue(TEXT("SkeletonName"), SkeletalMesh->GetSkeleton()->GetName());
+                JsonWriter.WriteValue(TEXT("VertexFormat"), TArray<FString>({ TEXT("Position"), TEXT("Normal"), TEXT("Tangent"), TEXT("UV0"), TEXT("BoneIndices"), TEXT("BoneWeights") }));
+                JsonWriter.WriteValue(TEXT("LODCount"), RenderData->LODRenderData.Num());
+
+                const FMeshExportOptions Options = GetMeshExportOptions();
+                TArray<int32> MeshSkeletonBones;
+                GetMeshSkeletonBones(SkeletalMesh, MeshSkeletonBones);
+
+                JsonWriter.WriteArrayStart(TEXT("LODs"));
+                for (int32 LODIndex = 0; LODIndex < RenderData->LODRenderData.Num(); LODIndex++)
                 {
-                    FVector3f Position = PositionVertexBuffer.VertexPosition(iVertex);
-                    FVector4 TangentZ = StaticMeshVertexBuffer.VertexTangentZ(iVertex);
-                    FVector4 TangentX = StaticMeshVertexBuffer.VertexTangentX(iVertex);
-                    FVector4f Normal = FVector4f(TangentZ.X, TangentZ.Y, TangentZ.Z, TangentZ.W);
-                    FVector3f Tangent = FVector3f(TangentX.X, TangentX.Y, TangentX.Z);
-                    FVector2f UV = StaticMeshVertexBuffer.GetVertexUV(iVertex, 0);
-
-                    *FileWriter << Position;
-                    *FileWriter << Normal;
-                    *FileWriter << Tangent;
-                    *FileWriter << UV;
-
-                    FBoneIndexType BoneIndex0 = BoneMap[WeightInfos[iVertex].InfluenceBones[0]];
-                    *FileWriter << BoneIndex0;
-                    FBoneIndexType BoneIndex1 = BoneMap[WeightInfos[iVertex].InfluenceBones[1]];
-                    *FileWriter << BoneIndex1;
-                    FBoneIndexType BoneIndex2 = BoneMap[WeightInfos[iVertex].InfluenceBones[2]];
-                    *FileWriter << BoneIndex2;
-                    FBoneIndexType BoneIndex3 = BoneMap[WeightInfos[iVertex].InfluenceBones[3]];
-                    *FileWriter << BoneIndex3;
-
-                    float BoneWeight0 = WeightInfos[iVertex].InfluenceWeights[0] / 255.0f;
-                    *FileWriter << BoneWeight0;
-                    float BoneWeight1 = WeightInfos[iVertex].InfluenceWeights[1] / 255.0f;
-                    *FileWriter << BoneWeight1;
-                    float BoneWeight2 = WeightInfos[iVertex].InfluenceWeights[2] / 255.0f;
-                    *FileWriter << BoneWeight2;
-                    float BoneWeight3 = WeightInfos[iVertex].InfluenceWeights[3] / 255.0f;
-                    *FileWriter << BoneWeight3;
-
-                }
-
-                // Index data
-                TArray<uint32> Indices;
-                CurLOD.MultiSizeIndexContainer.GetIndexBuffer(Indices);
-                int32 NumIndices = Indices.Num();
+                    FSkeletalMeshLODSnapshot LOD;
+                    GetSkeletalMeshLOD(RenderData->LODRenderData[LODIndex], Options.MaxBoneInfluences, LOD.Vertices, LOD.Influences, LOD.Indices, LOD.Sections);
+
+                    TArray<uint16> BonePalette;
+                    BuildSkeletalMeshLODPalettes(SkeletalMesh->GetName(), LODIndex, Options.MaxBonesPerSection, MeshSkeletonBones, LOD, BonePalette);
+
+                    TArray<REngineFormat::SkinInfluenceBucket> InfluenceBuckets;
+                    TArray<uint8> ExtraInfluences;
+                    BuildSkeletalMeshLODBuckets(SkeletalMesh->GetName(), LODIndex, Options.MaxBoneInfluences, LOD, InfluenceBuckets, ExtraInfluences);
+                    const TArray<REngineFormat::SkeletalMeshVertex>& Vertices = LOD.Vertices;
+                    const TArray<uint32>& Indices = LOD.Indices;
+                    const TArray<REngineFormat::SkeletalMeshSection>& Sections = LOD.Sections;
+
+                    const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(LODIndex);
+
+                    JsonWriter.WriteObjectStart();
+                    JsonWriter.WriteValue(TEXT("LOD"), LODIndex);
+                    JsonWriter.WriteValue(TEXT("ScreenSize"), LODInfo != nullptr ? LODInfo->ScreenSize.Default : 0.0f);
+                    WriteJsonVertices(JsonFile, Vertices);
+                    JsonFile.WriteMemberArray(TEXT("BoneIndices"), Vertices, &REngineFormat::SkeletalMeshVertex::BoneIndices);
+                    JsonFile.WriteMemberArray(TEXT("BoneWeights"), Vertices, &REngineFormat::SkeletalMeshVertex::BoneWeights);
+                    JsonWriter.WriteValue(TEXT("IndexCount"), Indices.Num());
+                    JsonFile.WriteArray(TEXT("Indices"), Indices);
+                    JsonFile.WriteArray(TEXT("BonePalette"), BonePalette);
+
+                    JsonWriter.WriteArrayStart(TEXT("Sections"));
+                    for (const REngineFormat::SkeletalMeshSection& Section : Sections)
+                    {
+                        JsonWriter.WriteObjectStart();
+                        JsonWriter.WriteValue(TEXT("MaterialIndex"), Section.MaterialIndex);
+                        JsonWriter.WriteValue(TEXT("BaseIndex"), int64(Section.BaseIndex));
+                        JsonWriter.WriteValue(TEXT("NumTriangles"), int64(Section.NumTriangles));
+                        JsonWriter.WriteValue(TEXT("BaseVertexIndex"), int64(Section.BaseVertexIndex));
+                        JsonWriter.WriteValue(TEXT("NumVertices"), int64(Section.NumVertices));
+                        JsonWriter.WriteValue(TEXT("FirstPaletteBone"), int64(Section.FirstPaletteBone));
+                        JsonWriter.WriteValue(TEXT("NumPaletteBones"), int64(Section.NumPaletteBones));
+                        JsonWriter.WriteObjectEnd();
+                    }
+                    JsonWriter.WriteArrayEnd();
 
-                *FileWriter << NumIndices;
+                    if (InfluenceBuckets.Num() > 0)
+                    {
+                        JsonWriter.WriteArrayStart(TEXT("InfluenceBuckets"));
+                        for (const REngineFormat::SkinInfluenceBucket& Bucket : InfluenceBuckets)
+                        {
+                            JsonWriter.WriteObjectStart();
+                            JsonWriter.WriteValue(TEXT("SectionIndex"), int64(Bucket.SectionIndex));
+                            JsonWriter.WriteValue(TEXT("NumInfluences"), int64(Bucket.NumInfluences));
+                            JsonWriter.WriteValue(TEXT("FirstVertex"), int64(Bucket.FirstVertex));
+                            JsonWriter.WriteValue(TEXT("NumVertices"), int64(Bucket.NumVertices));
+                            JsonWriter.WriteValue(TEXT("FirstExtraInfluence"), int64(Bucket.FirstExtraInfluence));
+                            JsonWriter.WriteObjectEnd();
+                        }
+                        JsonWriter.WriteArrayEnd();
+                        JsonFile.WriteArray(TEXT("ExtraInfluences"), ExtraInfluences);
+                    }
 
-                for (int32 iIndex = 0; iIndex < Indices.Num(); iIndex++)
-                {
-                    uint32 Index = Indices[iIndex];
-                    *FileWriter << Index;
+                    JsonWriter.WriteObjectEnd();
                 }
-                
-                int32 NumSection = CurLOD.RenderSections.Num();
-                *FileWriter << NumSection;
+                JsonWriter.WriteArrayEnd();
+                JsonWriter.WriteObjectEnd();
 
-                for (const FSkelMeshRenderSection& Section : CurLOD.RenderSections)
+                if (JsonFile.Commit())
                 {
-                    int32 MaterialIndex = (int32)Section.MaterialIndex;
-                    *FileWriter << MaterialIndex;
-                    *FileWriter << uint32(Section.BaseIndex);
-                    *FileWriter << uint32(Section.NumTriangles);
-                    *FileWriter << uint32(Section.BaseVertexIndex);
-                    *FileWriter << uint32(Section.NumVertices);
-                }
-
-                auto ResourceFullName = SkeletalMesh->GetSkeleton()->GetPathName();
-
-                FString ResourcePath, ResourceName;
-                ResourceFullName.Split(FString("."), &ResourcePath, &ResourceName);
-
-                *FileWriter << ResourceName;
+                    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeletalMesh: success."));
 
-                //now save only lod 0
-                break;
+                    return true;
+                }
             }
+        }
+        else if (FullFilePathName.EndsWith(SKELETAL_MESH_BINARY_FILE_POSTFIX))
+        {
+            // Save to binary file
+            int64 SnapshotSize = 0;
+            if (PrepareSkeletalMeshExport(SkeletalMesh, FullFilePathName, SnapshotSize)())
+            {
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeletalMesh: success."));
 
-            FileWriter->Close();
-            delete FileWriter;
-            FileWriter = nullptr;
-
+                return true;
+            }
         }
     }
 
@@ -353,54 +1722,58 @@ bool UObjectExporterBPLibrary::ExportSkeleton(const USkeleton* Skeleton, const F
     {
         if (FullFilePathName.EndsWith(JSON_FILE_POSTFIX))
         {
-            const int32 FileVersion = 1;
-            TSharedRef<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-            JsonRootObject->SetNumberField("FileVersion", FileVersion);
+            FExportJsonWriter JsonFile(FullFilePathName);
+
+            if (JsonFile.IsValid())
+            {
+                TArray<FString> BoneNames;
+                FExportSkeleton ExportSkeleton;
+                GetExportSkeleton(Skeleton, BoneNames, ExportSkeleton);
+
+                TArray<REngineFormat::BoneTransform> BoneTransforms;
+                TArray<REngineFormat::BoneTransform> BindTransforms;
+                GetExportBoneTransforms(ExportSkeleton.LocalPose, BoneTransforms);
+                GetExportBoneTransforms(ExportSkeleton.BindPose, BindTransforms);
+
+                FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+                JsonWriter.WriteObjectStart();
+                JsonWriter.WriteValue(TEXT("FileVersion"), JSON_FILE_VERSION);
+                JsonWriter.WriteValue(TEXT("SkeletonName"), Skeleton->GetName());
+                JsonWriter.WriteValue(TEXT("BoneCount"), BoneNames.Num());
+                JsonWriter.WriteValue(TEXT("BoneNames"), BoneNames);
+                JsonFile.WriteArray(TEXT("BoneParents"), ExportSkeleton.Parents);
+                JsonFile.WriteMemberArray(TEXT("BoneRotations"), BoneTransforms, &REngineFormat::BoneTransform::Rotation);
+                JsonFile.WriteMemberArray(TEXT("BoneTranslations"), BoneTransforms, &REngineFormat::BoneTransform::Translation);
+                JsonFile.WriteMemberArray(TEXT("BoneScales"), BoneTransforms, &REngineFormat::BoneTransform::Scale);
+                JsonFile.WriteArray(TEXT("BoneSourceIndices"), ExportSkeleton.SourceBones);
+                JsonFile.WriteMemberArray(TEXT("BindRotations"), BindTransforms, &REngineFormat::BoneTransform::Rotation);
+                JsonFile.WriteMemberArray(TEXT("BindTranslations"), BindTransforms, &REngineFormat::BoneTransform::Translation);
+                JsonFile.WriteMemberArray(TEXT("BindScales"), BindTransforms, &REngineFormat::BoneTransform::Scale);
+                JsonFile.WriteArray(TEXT("InverseBindMatrices"), reinterpret_cast<const float*>(ExportSkeleton.InverseBindMatrices.GetData()), ExportSkeleton.InverseBindMatrices.Num() * 16);
+                JsonWriter.WriteObjectEnd();
+
+                if (JsonFile.Commit())
+                {
+                    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeleton: success."));
+
+                    return true;
+                }
+            }
         }
         else if (FullFilePathName.EndsWith(SKELETON_BINARY_FILE_POSTFIX))
         {
             // Save to binary file
-            IFileManager& FileManager = IFileManager::Get();
-            FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-            if (nullptr == FileWriter)
-            {
-                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeleton: CreateFileWriter failed."));
-
-                return false;
-            }
-
-            const TArray<FMeshBoneInfo>& BoneInfos = Skeleton->GetReferenceSkeleton().GetRawRefBoneInfo();
-            const TArray<FTransform>& BonePose = Skeleton->GetReferenceSkeleton().GetRawRefBonePose();
-
-            int32 NumBoneInfos = BoneInfos.Num();
-            int32 NumPosBones = BonePose.Num();
-
-            *FileWriter << NumBoneInfos;
-            for (FMeshBoneInfo Boneinfo : BoneInfos)
+            int64 SnapshotSize = 0;
+            if (PrepareSkeletonExport(Skeleton, FullFilePathName, SnapshotSize)())
             {
-                *FileWriter << Boneinfo.Name;
-                *FileWriter << Boneinfo.ParentIndex;
-            }
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportSkeleton: success."));
 
-            *FileWriter << NumPosBones;
-            for (FTransform BoneTransform : BonePose)
-            {
-                FQuat4f Rot = FQuat4f(BoneTransform.GetRotation());
-                FVector3f Tran = FVector3f(BoneTransform.GetTranslation());
-                FVector3f Scale = FVector3f(BoneTransform.GetScale3D());
-                *FileWriter << Rot;
-                *FileWriter << Tran;
-                *FileWriter << Scale;
+                return true;
             }
-
-            FileWriter->Close();
-            delete FileWriter;
-            FileWriter = nullptr;
-
         }
     }
 
-    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportStaticMesh: failed."));
+    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportSkeleton: failed."));
 
     return false;
 
@@ -421,60 +1794,92 @@ bool UObjectExporterBPLibrary::ExportAnimSequence(const UAnimSequence* AnimSeque
     {
         if (FullFilePathName.EndsWith(JSON_FILE_POSTFIX))
         {
-            const int32 FileVersion = 1;
-            TSharedRef<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-            JsonRootObject->SetNumberField("FileVersion", FileVersion);
+            FExportJsonWriter JsonFile(FullFilePathName);
+
+            if (JsonFile.IsValid())
+            {
+                const IAnimationDataModel* ParentDataModel = AnimSequence->GetDataModel();
+                const TArray<FBoneAnimationTrack>& BoneAnimationTracks = ParentDataModel->GetBoneAnimationTracks();
+
+                FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+                JsonWriter.WriteObjectStart();
+                JsonWriter.WriteValue(TEXT("FileVersion"), JSON_FILE_VERSION);
+                JsonWriter.WriteValue(TEXT("AnimName"), AnimSequence->GetName());
+                JsonWriter.WriteValue(TEXT("NumFrames"), AnimSequence->GetNumberOfSampledKeys());
+                JsonWriter.WriteValue(TEXT("SequenceLength"), AnimSequence->GetPlayLength());
+                JsonWriter.WriteValue(TEXT("NumTracks"), BoneAnimationTracks.Num());
+
+                // Keys are written track by track, nothing is gathered for the whole sequence
+                JsonWriter.WriteArrayStart(TEXT("Tracks"));
+                for (const FBoneAnimationTrack& AnimationTrack : BoneAnimationTracks)
+                {
+                    const FRawAnimSequenceTrack& AnimationData = AnimationTrack.InternalTrackData;
+
+                    JsonWriter.WriteObjectStart();
+                    JsonWriter.WriteValue(TEXT("BoneIndex"), AnimationTrack.BoneTreeIndex);
+                    JsonWriter.WriteValue(TEXT("BoneName"), AnimationTrack.Name.ToString());
+                    JsonFile.WriteArray(TEXT("PosKeys"), (const float*)AnimationData.PosKeys.GetData(), AnimationData.PosKeys.Num() * 3);
+                    JsonFile.WriteArray(TEXT("RotKeys"), (const float*)AnimationData.RotKeys.GetData(), AnimationData.RotKeys.Num() * 4);
+                    JsonFile.WriteArray(TEXT("ScaleKeys"), (const float*)AnimationData.ScaleKeys.GetData(), AnimationData.ScaleKeys.Num() * 3);
+                    JsonWriter.WriteObjectEnd();
+                }
+                JsonWriter.WriteArrayEnd();
+                JsonWriter.WriteObjectEnd();
+
+                if (JsonFile.Commit())
+                {
+                    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimSequence: success."));
+
+                    return true;
+                }
+            }
         }
         else if (FullFilePathName.EndsWith(ANIMSEQUENCE_BINARY_FILE_POSTFIX))
         {
             // Save to binary file
-            IFileManager& FileManager = IFileManager::Get();
-            FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-            if (nullptr == FileWriter)
+            int64 SnapshotSize = 0;
+            if (PrepareAnimSequenceExport(AnimSequence, FullFilePathName, SnapshotSize)())
             {
-                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimSequence: CreateFileWriter failed."));
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimSequence: success."));
 
-                return false;
+                return true;
             }
-     
-            const IAnimationDataModel* ParentDataModel = AnimSequence->GetDataModel();
-            const TArray<FBoneAnimationTrack>& BoneAnimationTracks = ParentDataModel->GetBoneAnimationTracks();
+        }
+    }
 
-            int32 NumberOfFrames = AnimSequence->GetNumberOfSampledKeys();
-            *FileWriter << NumberOfFrames;
+    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimSequence: failed."));
 
-            float SequenceLength = AnimSequence->GetPlayLength();
-            *FileWriter << SequenceLength;
+    return false;
 
-            int32 TrackIndex = 0;
-            for (FBoneAnimationTrack AnimationTrack : BoneAnimationTracks)
-            {
-                FRawAnimSequenceTrack& AnimationData = AnimationTrack.InternalTrackData;
+}
 
-                int32 BoneIndex = AnimationTrack.BoneTreeIndex;
-                *FileWriter << BoneIndex;
 
-                *FileWriter << AnimationData.PosKeys;
-                *FileWriter << AnimationData.RotKeys;
-                *FileWriter << AnimationData.ScaleKeys;
+bool UObjectExporterBPLibrary::ExportAnimTexture(const USkeletalMesh* SkeletalMesh, const UAnimSequence* AnimSequence, const FString& FullFilePathName)
+{
+    FText OutError;
+    if (!FFileHelper::IsFilenameValidForSaving(FullFilePathName, OutError))
+    {
+        UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimTexture: FullFilePathName is not valid. %s"), *OutError.ToString());
 
-                TrackIndex++;
-            }
+        return false;
+    }
 
-            FileWriter->Close();
-            delete FileWriter;
-            FileWriter = nullptr;
+    if (SkeletalMesh != nullptr && AnimSequence != nullptr && AnimSequence->GetSkeleton() != nullptr && FullFilePathName.EndsWith(ANIMTEXTURE_BINARY_FILE_POSTFIX))
+    {
+        int64 SnapshotSize = 0;
+        if (PrepareAnimTextureExport(SkeletalMesh, AnimSequence, FullFilePathName, SnapshotSize)())
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportAnimTexture: success."));
 
+            return true;
         }
     }
 
-    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportStaticMesh: failed."));
+    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportAnimTexture: failed."));
 
     return false;
-
 }
 
-
 bool UObjectExporterBPLibrary::ExportCamera(const UCameraComponent* Camera, const FString& FullFilePathName)
 {
     FText OutError;
@@ -544,194 +1949,110 @@ bool UObjectExporterBPLibrary::ExportMaterialInstance(const UMaterialInstance* M
     {
         if (FullFilePathName.EndsWith(JSON_FILE_POSTFIX))
         {
-            const int32 FileVersion = 1;
-            TSharedRef<FJsonObject> JsonRootObject = MakeShareable(new FJsonObject);
-            JsonRootObject->SetNumberField("FileVersion", FileVersion);
-        }
-        else if (FullFilePathName.EndsWith(MATERIAL_BINARY_FILE_POSTFIX))
-        {
-            // Save to binary file
-            IFileManager& FileManager = IFileManager::Get();
-            FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-            if (nullptr == FileWriter)
-            {
-                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportMaterialInstance: CreateFileWriter failed."));
-
-                return false;
-            }
-
-            FAssetToolsModule& AssetToolsModule = FModuleManager::GetModuleChecked<FAssetToolsModule>("AssetTools");
-            TArray<FMaterialParameterInfo> OutTextureParameterInfo;
-            TArray<FGuid> GuidsTexture;
-            MaterialInstace->GetAllTextureParameterInfo(OutTextureParameterInfo, GuidsTexture);
-            int32 BlendMode = (int32)MaterialInstace->BlendMode;
-            *FileWriter << BlendMode;
-
-            EMaterialShadingModel MaterialShadingModel = MaterialInstace->GetShadingModels().GetFirstShadingModel();
-            int32 ShadingModel = (int32)MaterialShadingModel;
-            *FileWriter << ShadingModel;
-
-            uint8 TwoSided = MaterialInstace->TwoSided;
-            *FileWriter << TwoSided;
+            FExportJsonWriter JsonFile(FullFilePathName);
 
-            TArray<FMaterialParameterInfo> OutScalarParameterInfo;
-            TArray<FGuid> GuidsScalar;
-            MaterialInstace->GetAllScalarParameterInfo(OutScalarParameterInfo, GuidsScalar);
-            for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
+            if (JsonFile.IsValid())
             {
-                if (ParameterInfo.Name == FName("MetallicScale"))
+                FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+                JsonWriter.WriteObjectStart();
+                JsonWriter.WriteValue(TEXT("FileVersion"), JSON_FILE_VERSION);
+                JsonWriter.WriteValue(TEXT("MaterialName"), MaterialInstace->GetName());
+                JsonWriter.WriteValue(TEXT("BlendMode"), (int32)MaterialInstace->BlendMode);
+                JsonWriter.WriteValue(TEXT("ShadingModel"), (int32)MaterialInstace->GetShadingModels().GetFirstShadingModel());
+                JsonWriter.WriteValue(TEXT("TwoSided"), (bool)MaterialInstace->TwoSided);
+
+                // Every parameter by name, the json files are for inspection so they are not limited to the parameters the renderer reads
+                TArray<FMaterialParameterInfo> ParameterInfos;
+                TArray<FGuid> Guids;
+                MaterialInstace->GetAllScalarParameterInfo(ParameterInfos, Guids);
+                JsonWriter.WriteObjectStart(TEXT("ScalarParameters"));
+                for (const FMaterialParameterInfo& ParameterInfo : ParameterInfos)
                 {
-                    float Metallic = 0.0f;
-                    if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Metallic))
+                    float Value = 0.0f;
+                    if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Value))
                     {
-                        *FileWriter << Metallic;
+                        JsonWriter.WriteValue(ParameterInfo.Name.ToString(), Value);
                     }
-
-                    break;
                 }
-            }
+                JsonWriter.WriteObjectEnd();
 
-            for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
-            {
-                if (ParameterInfo.Name == FName("SpecularScale"))
+                MaterialInstace->GetAllVectorParameterInfo(ParameterInfos, Guids);
+                JsonWriter.WriteObjectStart(TEXT("VectorParameters"));
+                for (const FMaterialParameterInfo& ParameterInfo : ParameterInfos)
                 {
-                    float Specular = 0.0f;
-                    if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Specular))
+                    FLinearColor Value;
+                    if (MaterialInstace->GetVectorParameterValue(ParameterInfo, Value))
                     {
-                        *FileWriter << Specular;
+                        float Color[4];
+                        CopyColor(Value, Color);
+                        JsonFile.WriteArray(ParameterInfo.Name.ToString(), Color, 4);
                     }
-
-                    break;
                 }
-            }
+                JsonWriter.WriteObjectEnd();
 
-            for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
-            {
-                if (ParameterInfo.Name == FName("RoughnessScale"))
+                MaterialInstace->GetAllTextureParameterInfo(ParameterInfos, Guids);
+                JsonWriter.WriteObjectStart(TEXT("TextureParameters"));
+                for (const FMaterialParameterInfo& ParameterInfo : ParameterInfos)
                 {
-                    float Roughness = 0.0f;
-                    if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Roughness))
+                    UTexture* Texture = nullptr;
+                    if (MaterialInstace->GetTextureParameterValue(ParameterInfo, Texture) && Texture != nullptr)
                     {
-                        *FileWriter << Roughness;
+                        JsonWriter.WriteValue(ParameterInfo.Name.ToString(), Texture->GetName());
                     }
-
-                    break;
                 }
-            }
+                JsonWriter.WriteObjectEnd();
+                JsonWriter.WriteObjectEnd();
 
-            for (const FMaterialParameterInfo& ParameterInfo : OutScalarParameterInfo)
-            {
-                if (ParameterInfo.Name == FName("OpacityScale"))
+                if (JsonFile.Commit())
                 {
-                    float Opacity = 1.0f;
-                    if (MaterialInstace->GetScalarParameterValue(ParameterInfo, Opacity))
-                    {
-                        *FileWriter << Opacity;
-                    }
+                    UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportMaterialInstance: success."));
 
-                    break;
+                    return true;
                 }
             }
-
-            TArray<FMaterialParameterInfo> OutVectorParameterInfo;
-            TArray<FGuid> GuidsVector;
-            MaterialInstace->GetAllVectorParameterInfo(OutVectorParameterInfo, GuidsVector);
-            for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+        }
+        else if (FullFilePathName.EndsWith(MATERIAL_BINARY_FILE_POSTFIX))
+        {
+            // Textures converted by earlier exports are reused, the cache is only asked for source hashes
+            const FExportCache ExportCache(FPaths::ProjectSavedDir() + ROOT_PATH + EXPORT_MANIFEST_FILE_NAME);
+            FTextureRegistry TextureRegistry(FPaths::ProjectSavedDir() + ROOT_PATH + TEXTURE_REGISTRY_FILE_NAME, FPaths::ProjectSavedDir() + TEXTURE_PATH);
+            if (!GetDefault<UObjectExporterSettings>()->bForceFullExport)
             {
-                if (ParameterInfo.Name == FName("BaseColorScale"))
-                {
-                    FLinearColor BaseColor;
-                    if (MaterialInstace->GetVectorParameterValue(ParameterInfo, BaseColor))
-                    {
-                        *FileWriter << BaseColor;
-                    }
-
-                    break;
-                }
+                TextureRegistry.Load();
             }
 
-            for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
-            {
-                if (ParameterInfo.Name == FName("EmissiveColorScale"))
-                {
-                    FLinearColor EmissiveColor;
-                    if (MaterialInstace->GetVectorParameterValue(ParameterInfo, EmissiveColor))
-                    {
-                        *FileWriter << EmissiveColor;
-                    }
-
-                    break;
-                }
-            }
+            TArray<FName> TextureParameterNames;
+            TArray<UTexture*> Textures;
+            GetMaterialTextures(MaterialInstace, TextureParameterNames, Textures);
 
-            for (const FMaterialParameterInfo& ParameterInfo : OutVectorParameterInfo)
+            bool bTexturesSucceeded = true;
+            for (const UTexture* Texture : Textures)
             {
-                if (ParameterInfo.Name == FName("SubsurfaceColorScale"))
+                ResolveTexture(TextureRegistry, ExportCache, Texture, [&TextureRegistry, &bTexturesSucceeded](FExportTask&& Task, int64 SnapshotSize, uint64 ContentId)
                 {
-                    FLinearColor SubsurfaceColor;
-                    if (MaterialInstace->GetVectorParameterValue(ParameterInfo, SubsurfaceColor))
+                    if (!Task())
                     {
-                        *FileWriter << SubsurfaceColor;
+                        TextureRegistry.MarkFailed(ContentId);
+                        bTexturesSucceeded = false;
                     }
-
-                    break;
-                }
+                });
             }
-            
-            int32 NumTextureParam = OutTextureParameterInfo.Num();
-            *FileWriter << NumTextureParam;
-
-            for (const FMaterialParameterInfo& ParameterInfo : OutTextureParameterInfo)
-            {
-                UTexture* Texture = nullptr;
-                MaterialInstace->GetTextureParameterValue(ParameterInfo, Texture);
 
-                if (Texture != nullptr)
-                {
-                    FString ResourceFullName = Texture->GetPathName();
-                    FString ResourcePath, ResourceName;
-                    ResourceFullName.Split(FString("."), &ResourcePath, &ResourceName);
-
-                    FString Name = ParameterInfo.Name.ToString();
-                    *FileWriter << Name;
-                    *FileWriter << ResourceName;
-
-                    FString TempSavePath = FPaths::ProjectIntermediateDir();
-                    FString SavePath = FPaths::ProjectSavedDir() + TEXTURE_PATH;
-                    TArray<UObject*> ObjectsToExport;
-                    ObjectsToExport.Add(Texture);
-                    AssetToolsModule.Get().ExportAssets(ObjectsToExport, *TempSavePath);
-
-                    FString FileExt = "PNG";
-                    if (Texture->AssetImportData->SourceData.SourceFiles.Num() > 0)
-                    {
-                        FString LeftS;
-                        FString RightS;
-                        Texture->AssetImportData->SourceData.SourceFiles[0].RelativeFilename.Split(".", &LeftS, &RightS, ESearchCase::CaseSensitive,
-                            ESearchDir::FromEnd);
+            TextureRegistry.LogStats(TEXT("ExportMaterialInstance"));
+            TextureRegistry.Save();
 
-                        if (RightS.ToLower() == "exr")
-                        {
-                            FileExt = "EXR";
-                        }
-                    }
+            // Save to binary file
+            int64 SnapshotSize = 0;
+            if (PrepareMaterialInstanceExport(MaterialInstace, FullFilePathName, TextureRegistry, SnapshotSize)() && bTexturesSucceeded)
+            {
+                UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportMaterialInstance: success."));
 
-                    // Cmd dir only \\ work
-                    IFileManager::Get().MakeDirectory(*SavePath);
-                    FString CmdString = FPaths::ProjectPluginsDir() + "ObjectExporter/texconv.exe -alpha -y -ft dds " + FPaths::ProjectIntermediateDir() + ResourcePath + "." + FileExt + " -o " + SavePath;
-                    CmdString = CmdString.Replace(TEXT("/"), TEXT("\\"));
-                    system(TCHAR_TO_ANSI(*CmdString));
-                }
+                return true;
             }
-
-            FileWriter->Close();
-            delete FileWriter;
-            FileWriter = nullptr;
-
         }
     }
 
-    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportStaticMesh: failed."));
+    UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportMaterialInstance: failed."));
 
     return false;
 }
@@ -746,23 +2067,43 @@ bool UObjectExporterBPLibrary::ExportMap(UObject* WorldContextObject, const FStr
     if (FullFilePathName.EndsWith(MAP_BINARY_FILE_POSTFIX))
     {
         // Save to binary file
-        IFileManager& FileManager = IFileManager::Get();
-        FArchive* FileWriter = FileManager.CreateFileWriter(*FullFilePathName);
-        if (nullptr == FileWriter)
+        FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::Map);
+        FExportStringTable Strings;
+        FMapActorSet MapActors;
+
+        const UObjectExporterSettings* Settings = GetDefault<UObjectExporterSettings>();
+
+        // Files every actor needs, streaming cells list them as their dependencies
+        const bool bPartitionMap = Settings->MapPartitionMode != EMapPartitionMode::Disabled;
+        bool bCellsSucceeded = true;
+        TArray<TArray<uint32>> StaticMeshActorDependencies;
+        TArray<TArray<uint32>> SkeletalMeshActorDependencies;
+        auto AddDependency = [&Strings, bPartitionMap](TArray<uint32>& ActorDependencies, const FString& DependencyFilePathName)
         {
-            UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportMap: CreateFileWriter failed."));
+            if (bPartitionMap)
+            {
+                ActorDependencies.AddUnique(Strings.Add(GetExportRelativePath(DependencyFilePathName)));
+            }
+        };
 
-            return false;
+        // Meshes and materials shared by many actors are exported once, unchanged ones not at all
+        FExportCache ExportCache(FPaths::ProjectSavedDir() + ROOT_PATH + EXPORT_MANIFEST_FILE_NAME);
+        FTextureRegistry TextureRegistry(FPaths::ProjectSavedDir() + ROOT_PATH + TEXTURE_REGISTRY_FILE_NAME, FPaths::ProjectSavedDir() + TEXTURE_PATH);
+        if (!Settings->bForceFullExport)
+        {
+            ExportCache.Load();
+            TextureRegistry.Load();
         }
 
+        // Assets are snapshotted here on the game thread, then encoded and written by worker tasks
+        FExportTaskQueue ExportQueue(int64(Settings->ExportMemoryBudgetMB) * 1024 * 1024);
+
         UWorld* World = WorldContextObject->GetWorld();
 
         TArray<AActor*> AllCameraActors;
         UGameplayStatics::GetAllActorsOfClass(World, ACameraActor::StaticClass(), AllCameraActors);
-        int32 CameraCount = AllCameraActors.Num();
-
-        *FileWriter << CameraCount;
 
+        TArray<REngineFormat::MapCamera> Cameras;
         for (AActor* Actor : AllCameraActors)
         {
             UCameraComponent* Component = Cast<UCameraComponent>(Actor->GetComponentByClass(UCameraComponent::StaticClass()));
@@ -770,101 +2111,83 @@ bool UObjectExporterBPLibrary::ExportMap(UObject* WorldContextObject, const FStr
             auto Transform = Component->GetComponentToWorld();
             auto Location = FVector3f(Transform.GetLocation());
             auto Rotation = FQuat4f(Transform.GetRotation());
-            auto Rotator = Rotation.Rotator();
             auto Direction = Rotation.Vector();
             auto Target = Location + Direction * 100.0f;
-            auto FOV = Component->FieldOfView;
-            auto AspectRatio = Component->AspectRatio;
 
-            *FileWriter << Location;
-            *FileWriter << Target;
-            *FileWriter << FOV;
-            *FileWriter << AspectRatio;
+            REngineFormat::MapCamera& Camera = Cameras.AddZeroed_GetRef();
+            CopyVector(Location, Camera.Location);
+            CopyVector(Target, Camera.Target);
+            Camera.FOV = Component->FieldOfView;
+            Camera.AspectRatio = Component->AspectRatio;
         }
 
         TArray<AActor*> AllDirectionalLightActors;
         UGameplayStatics::GetAllActorsOfClass(World, ADirectionalLight::StaticClass(), AllDirectionalLightActors);
-        int32 DirectionalLightCount = AllDirectionalLightActors.Num();
-
-        *FileWriter << DirectionalLightCount;
 
+        TArray<REngineFormat::MapDirectionalLight> DirectionalLights;
         for (AActor* Actor : AllDirectionalLightActors)
         {
             UDirectionalLightComponent* Component = Cast<UDirectionalLightComponent>(Actor->GetComponentByClass(UDirectionalLightComponent::StaticClass()));
             check(Component != nullptr);
             auto Transform = Component->GetComponentToWorld();
-            auto Location = FVector3f(Transform.GetLocation());
             auto Rotation = FQuat4f(Transform.GetRotation());
-            auto Rotator = Rotation.Rotator();
             auto Direction = Rotation.Vector();
             auto Color = FLinearColor::FromSRGBColor(Component->LightColor);
-            auto Intensity = Component->Intensity;
-            auto ShadowDistance = Component->DynamicShadowDistanceMovableLight;
-            auto ShadowBias = Component->ShadowBias;
-            
-            *FileWriter << Color;
-            *FileWriter << Direction;
-            *FileWriter << Intensity;
-            *FileWriter << ShadowDistance;
-            *FileWriter << ShadowBias;
+
+            REngineFormat::MapDirectionalLight& Light = DirectionalLights.AddZeroed_GetRef();
+            CopyColor(Color, Light.Color);
+            CopyVector(Direction, Light.Direction);
+            Light.Intensity = Component->Intensity;
+            Light.ShadowDistance = Component->DynamicShadowDistanceMovableLight;
+            Light.ShadowBias = Component->ShadowBias;
         }
 
         TArray<AActor*> AllPointLightActors;
         UGameplayStatics::GetAllActorsOfClass(World, APointLight::StaticClass(), AllPointLightActors);
-        int32 PointLightCount = AllPointLightActors.Num();
-
-        *FileWriter << PointLightCount;
 
+        TArray<REngineFormat::MapPointLight> PointLights;
         for (AActor* Actor : AllPointLightActors)
         {
             UPointLightComponent* Component = Cast<UPointLightComponent>(Actor->GetComponentByClass(UPointLightComponent::StaticClass()));
             check(Component != nullptr);
             auto Transform = Component->GetComponentToWorld();
             auto Location = FVector3f(Transform.GetLocation());
-            auto Rotation = FQuat4f(Transform.GetRotation());
-            auto AttenuationRadius = Component->AttenuationRadius;
-            auto LightFalloffExponent = Component->LightFalloffExponent;
             auto Color = FLinearColor::FromSRGBColor(Component->LightColor);
-            auto Intensity = Component->Intensity;
 
-            *FileWriter << Color;
-            *FileWriter << Location;
-            *FileWriter << Intensity;
-            *FileWriter << AttenuationRadius;
-            *FileWriter << LightFalloffExponent;
+            REngineFormat::MapPointLight& Light = PointLights.AddZeroed_GetRef();
+            CopyColor(Color, Light.Color);
+            CopyVector(Location, Light.Location);
+            Light.Intensity = Component->Intensity;
+            Light.AttenuationRadius = Component->AttenuationRadius;
+            Light.LightFalloffExponent = Component->LightFalloffExponent;
         }
 
-
         TArray<AActor*> AllStaticMeshActors;
         UGameplayStatics::GetAllActorsOfClass(World, AStaticMeshActor::StaticClass(), AllStaticMeshActors);
-        int32 StaticMeshActorCount = AllStaticMeshActors.Num();
-
-        *FileWriter << StaticMeshActorCount;
 
+        TArray<FMergeMeshSource> MergeMeshes;
+        TMap<const UStaticMesh*, int32> MergeMeshIndices;
         for (AActor* Actor : AllStaticMeshActors)
         {
             UStaticMeshComponent* Component = Cast<UStaticMeshComponent>(Actor->GetComponentByClass(UStaticMeshComponent::StaticClass()));
             check(Component != nullptr);
             auto Transform = Component->GetComponentToWorld();
-            auto Location = FVector3f(Transform.GetLocation());
-            auto Rotation = FQuat4f(Transform.GetRotation());
-            auto Scale = FVector3f(Transform.GetScale3D());
-            auto Rotator = Rotation.Rotator();
-            auto Direction = Rotation.Vector();
             auto ResourceFullName = Component->GetStaticMesh()->GetPathName();
-            auto NumMaterial = Component->GetNumMaterials();
 
             FString ResourcePath, ResourceName;
             ResourceFullName.Split(FString("."), &ResourcePath, &ResourceName);
 
-            *FileWriter << Rotation;
-            *FileWriter << Location;
-            *FileWriter << Scale;
-            *FileWriter << ResourceName;
-            *FileWriter << NumMaterial;
+            REngineFormat::MapStaticMeshActor& StaticMeshActor = MapActors.StaticMeshActors.AddZeroed_GetRef();
+            CopyTransform(Transform, StaticMeshActor.Rotation, StaticMeshActor.Location, StaticMeshActor.Scale);
+            StaticMeshActor.MeshName = Strings.Add(ResourceName);
+            StaticMeshActor.FirstMaterial = MapActors.ActorMaterials.Num();
 
             FString SaveStaticMeshPath = FPaths::ProjectSavedDir() + STATICMESH_PATH + ResourceName + STATIC_MESH_BINARY_FILE_POSTFIX;
-            ExportStaticMesh(Component->GetStaticMesh(), SaveStaticMeshPath);
+            ExportCached(ExportCache, ExportQueue, Component->GetStaticMesh(), {}, SaveStaticMeshPath,
+                [&](int64& OutSnapshotSize) { return PrepareStaticMeshExport(Component->GetStaticMesh(), SaveStaticMeshPath, OutSnapshotSize); });
+
+            TArray<uint32>& ActorDependencies = StaticMeshActorDependencies.AddDefaulted_GetRef();
+            AddDependency(ActorDependencies, SaveStaticMeshPath);
 
             TArray<UMaterialInterface*> Materials = Component->GetMaterials();
 
@@ -877,35 +2200,59 @@ bool UObjectExporterBPLibrary::ExportMap(UObject* WorldContextObject, const FStr
                     FString MaterialPath, MaterialName;
                     MaterialFullName.Split(FString("."), &MaterialPath, &MaterialName);
 
-                    *FileWriter << MaterialName;
+                    MapActors.ActorMaterials.Add(Strings.Add(MaterialName));
 
                     FString SaveMaterialPath = FPaths::ProjectSavedDir() + MATERIAL_PATH + MaterialName + MATERIAL_BINARY_FILE_POSTFIX;
 
-                    ExportMaterialInstance(Instance, SaveMaterialPath);
+                    ExportMaterialCached(ExportCache, TextureRegistry, ExportQueue, Instance, SaveMaterialPath);
+                    AddDependency(ActorDependencies, SaveMaterialPath);
+                }
+            }
+
+            StaticMeshActor.NumMaterials = MapActors.ActorMaterials.Num() - StaticMeshActor.FirstMaterial;
+
+            REngineFormat::MapActorLOD& StaticMeshActorLOD = MapActors.StaticMeshActorLODs.AddZeroed_GetRef();
+            StaticMeshActorLOD.ForcedLOD = Component->ForcedLodModel - 1;
+            StaticMeshActorLOD.MinLOD = Component->bOverrideMinLOD ? Component->MinLOD : Component->GetStaticMesh()->GetMinLOD().Default;
+
+            MapActors.StaticMeshActorBounds.Add(MakeActorBounds(FBox3f(Component->Bounds.GetBox()), float(Component->Bounds.SphereRadius)));
+
+            // Small actors with every material slot exported are merged from the LOD 0 of their mesh, snapshotted once per mesh
+            const FStaticMeshRenderData* RenderData = Component->GetStaticMesh()->GetRenderData();
+            if (Settings->bMergeSmallStaticMeshes && StaticMeshActor.NumMaterials == uint32(Materials.Num()) && RenderData != nullptr && RenderData->LODResources.Num() > 0
+                && Component->Bounds.SphereRadius <= Settings->MergeMaxActorRadius && RenderData->LODResources[0].GetNumTriangles() <= Settings->MergeMaxTriangles)
+            {
+                int32& MeshSource = MergeMeshIndices.FindOrAdd(Component->GetStaticMesh(), MergeMeshes.Num());
+                if (MeshSource == MergeMeshes.Num())
+                {
+                    FMergeMeshSource& Mesh = MergeMeshes.AddDefaulted_GetRef();
+                    GetStaticMeshLOD(RenderData->LODResources[0], Mesh.Vertices, Mesh.Indices, Mesh.Sections);
+                }
+
+                const bool bValidSlots = !MergeMeshes[MeshSource].Sections.ContainsByPredicate(
+                    [&Materials](const REngineFormat::StaticMeshSection& Section) { return !Materials.IsValidIndex(Section.MaterialIndex); });
+                if (bValidSlots)
+                {
+                    FMergeActor& MergeActor = MapActors.MergeActors.AddDefaulted_GetRef();
+                    MergeActor.ActorIndex = uint32(MapActors.StaticMeshActors.Num() - 1);
+                    MergeActor.MeshSource = MeshSource;
+                    MergeActor.Transform = FTransform3f(Transform);
+                    MergeActor.SlotMaterials = TArray<uint32>(MapActors.ActorMaterials.GetData() + StaticMeshActor.FirstMaterial, StaticMeshActor.NumMaterials);
+                    MergeActor.Center = FVector3f(Component->Bounds.Origin);
                 }
             }
-                
         }
 
         TArray<AActor*> AllSkeletalMeshActors;
         UGameplayStatics::GetAllActorsOfClass(World, ASkeletalMeshActor::StaticClass(), AllSkeletalMeshActors);
-        int32 SkeletalMeshActorCount = AllSkeletalMeshActors.Num();
-
-        *FileWriter << SkeletalMeshActorCount;
 
         for (AActor* Actor : AllSkeletalMeshActors)
         {
             USkeletalMeshComponent* Component = Cast<USkeletalMeshComponent>(Actor->GetComponentByClass(USkeletalMeshComponent::StaticClass()));
             check(Component != nullptr);
             auto Transform = Component->GetComponentToWorld();
-            auto Location = FVector3f(Transform.GetLocation());
-            auto Rotation = FQuat4f(Transform.GetRotation());
-            auto Scale = FVector3f(Transform.GetScale3D());
-            auto Rotator = Rotation.Rotator();
-            auto Direction = Rotation.Vector();
             auto ResourceFullName = Component->GetSkeletalMeshAsset()->GetPathName();
             auto AnimationFullName = Component->AnimationData.AnimToPlay->GetPathName();
-            auto NumMaterial = Component->GetNumMaterials();
 
             FString ResourcePath, ResourceName;
             ResourceFullName.Split(FString("."), &ResourcePath, &ResourceName);
@@ -913,15 +2260,20 @@ bool UObjectExporterBPLibrary::ExportMap(UObject* WorldContextObject, const FStr
             FString AnimationPath, AnimationName;
             AnimationFullName.Split(FString("."), &AnimationPath, &AnimationName);
 
-            *FileWriter << Rotation;
-            *FileWriter << Location;
-            *FileWriter << Scale;
-            *FileWriter << ResourceName;
-            *FileWriter << AnimationName;
-            *FileWriter << NumMaterial;
+            REngineFormat::MapSkeletalMeshActor& SkeletalMeshActor = MapActors.SkeletalMeshActors.AddZeroed_GetRef();
+            CopyTransform(Transform, SkeletalMeshActor.Rotation, SkeletalMeshActor.Location, SkeletalMeshActor.Scale);
+            SkeletalMeshActor.MeshName = Strings.Add(ResourceName);
+            SkeletalMeshActor.AnimationName = Strings.Add(AnimationName);
+            SkeletalMeshActor.FirstMaterial = MapActors.ActorMaterials.Num();
 
+            // Bone names and inverse bind matrices written into the mesh come from the skeleton
+            const UObject* const SkeletalMeshDependencies[] = { Component->GetSkeletalMeshAsset()->GetSkeleton() };
             FString SaveSkeletalMeshPath = FPaths::ProjectSavedDir() + SKELETALMESH_PATH + ResourceName + SKELETAL_MESH_BINARY_FILE_POSTFIX;
-            ExportSkeletalMesh(Component->GetSkeletalMeshAsset(), SaveSkeletalMeshPath);
+            ExportCached(ExportCache, ExportQueue, Component->GetSkeletalMeshAsset(), SkeletalMeshDependencies, SaveSkeletalMeshPath,
+                [&](int64& OutSnapshotSize) { return PrepareSkeletalMeshExport(Component->GetSkeletalMeshAsset(), SaveSkeletalMeshPath, OutSnapshotSize); });
+
+            TArray<uint32>& ActorDependencies = SkeletalMeshActorDependencies.AddDefaulted_GetRef();
+            AddDependency(ActorDependencies, SaveSkeletalMeshPath);
 
             TArray<UMaterialInterface*> Materials = Component->GetMaterials();
 
@@ -934,30 +2286,152 @@ bool UObjectExporterBPLibrary::ExportMap(UObject* WorldContextObject, const FStr
                     FString MaterialPath, MaterialName;
                     MaterialFullName.Split(FString("."), &MaterialPath, &MaterialName);
 
-                    *FileWriter << MaterialName;
+                    MapActors.ActorMaterials.Add(Strings.Add(MaterialName));
 
                     FString SaveMaterialPath = FPaths::ProjectSavedDir() + MATERIAL_PATH + MaterialName + MATERIAL_BINARY_FILE_POSTFIX;
 
-                    ExportMaterialInstance(Instance, SaveMaterialPath);
+                    ExportMaterialCached(ExportCache, TextureRegistry, ExportQueue, Instance, SaveMaterialPath);
+                    AddDependency(ActorDependencies, SaveMaterialPath);
                 }
             }
 
+            SkeletalMeshActor.NumMaterials = MapActors.ActorMaterials.Num() - SkeletalMeshActor.FirstMaterial;
+
+            REngineFormat::MapActorLOD& SkeletalMeshActorLOD = MapActors.SkeletalMeshActorLODs.AddZeroed_GetRef();
+            SkeletalMeshActorLOD.ForcedLOD = Component->GetForcedLOD() - 1;
+            SkeletalMeshActorLOD.MinLOD = Component->bOverrideMinLod ? Component->MinLodModel : Component->GetSkeletalMeshAsset()->GetMinLod().Default;
+            MapActors.SkeletalMeshActorBounds.Add(MakeActorBounds(FBox3f(Component->Bounds.GetBox()), float(Component->Bounds.SphereRadius)));
+
             auto SkeletonFullName = Component->GetSkeletalMeshAsset()->GetSkeleton()->GetPathName();
 
             FString SkeletonPath, SkeletonName;
             SkeletonFullName.Split(FString("."), &SkeletonPath, &SkeletonName);
 
             FString SaveSkeletonPath = FPaths::ProjectSavedDir() + SKELETON_PATH + SkeletonName + SKELETON_BINARY_FILE_POSTFIX;
-            ExportSkeleton(Component->SkeletalMesh->GetSkeleton(), SaveSkeletonPath);
+            ExportCached(ExportCache, ExportQueue, Component->SkeletalMesh->GetSkeleton(), {}, SaveSkeletonPath,
+                [&](int64& OutSnapshotSize) { return PrepareSkeletonExport(Component->SkeletalMesh->GetSkeleton(), SaveSkeletonPath, OutSnapshotSize); });
+            AddDependency(ActorDependencies, SaveSkeletonPath);
  
             FString SaveAnimSequencePath = FPaths::ProjectSavedDir() + ANIMATION_PATH + AnimationName + ANIMSEQUENCE_BINARY_FILE_POSTFIX;
-            ExportAnimSequence(Cast<UAnimSequence>(Component->AnimationData.AnimToPlay), SaveAnimSequencePath);
+            const UAnimSequence* AnimSequence = Cast<UAnimSequence>(Component->AnimationData.AnimToPlay);
+            const UObject* const AnimSequenceDependencies[] = { AnimSequence != nullptr ? AnimSequence->GetSkeleton() : nullptr };
+            ExportCached(ExportCache, ExportQueue, AnimSequence, AnimSequenceDependencies, SaveAnimSequencePath,
+                [&](int64& OutSnapshotSize) { return PrepareAnimSequenceExport(AnimSequence, SaveAnimSequencePath, OutSnapshotSize); });
+            AddDependency(ActorDependencies, SaveAnimSequencePath);
+
+            if (Settings->AnimationTextureMode != EAnimationTextureMode::Disabled && AnimSequence != nullptr && AnimSequence->GetSkeleton() != nullptr)
+            {
+                const UObject* const AnimTextureDependencies[] = { Component->GetSkeletalMeshAsset()->GetSkeleton(), AnimSequence, AnimSequence->GetSkeleton() };
+                FString SaveAnimTexturePath = FPaths::ProjectSavedDir() + ANIMTEXTURE_PATH + ResourceName + TEXT("_") + AnimationName + ANIMTEXTURE_BINARY_FILE_POSTFIX;
+                ExportCached(ExportCache, ExportQueue, Component->GetSkeletalMeshAsset(), AnimTextureDependencies, SaveAnimTexturePath,
+                    [&](int64& OutSnapshotSize) { return PrepareAnimTextureExport(Component->GetSkeletalMeshAsset(), AnimSequence, SaveAnimTexturePath, OutSnapshotSize); });
+                AddDependency(ActorDependencies, SaveAnimTexturePath);
+            }
+        }
+
+        FileWriter.AddChunk(REngineFormat::ChunkId::Cameras, 0, REngineFormat::EElementFormat::Struct, Cameras);
+        FileWriter.AddChunk(REngineFormat::ChunkId::DirectionalLights, 0, REngineFormat::EElementFormat::Struct, DirectionalLights);
+        FileWriter.AddChunk(REngineFormat::ChunkId::PointLights, 0, REngineFormat::EElementFormat::Struct, PointLights);
+
+        const FMapExportOptions MapOptions = GetMapExportOptions();
+        TArray<FString> CellFileNames;
+        if (bPartitionMap)
+        {
+            // The .map keeps the cell bounds, the cell files hold the actors and name the files they need
+            TArray<FMapPartitionCell> Cells;
+            PartitionMap(MapActors.StaticMeshActorBounds, MapActors.SkeletalMeshActorBounds, Settings->MapPartitionMode == EMapPartitionMode::Quadtree,
+                Settings->MapCellSize, Settings->MaxActorsPerMapCell, Cells);
+
+            TArray<REngineFormat::MapStreamingCell> StreamingCells;
+            for (int32 CellIndex = 0; CellIndex < Cells.Num(); CellIndex++)
+            {
+                const FMapPartitionCell& Cell = Cells[CellIndex];
+                const FString CellFileName = FPaths::GetBaseFilename(FullFilePathName) + FString::Printf(TEXT("_%d"), CellIndex) + MAP_CELL_BINARY_FILE_POSTFIX;
+                CellFileNames.Add(CellFileName);
+
+                REngineFormat::MapStreamingCell& StreamingCell = StreamingCells.AddZeroed_GetRef();
+                StreamingCell.Bounds = MakeActorBounds(Cell.Box, Cell.Box.GetExtent().Size());
+                StreamingCell.FileName = Strings.Add(CellFileName);
+                StreamingCell.NumStaticMeshActors = uint32(Cell.StaticMeshActors.Num());
+                StreamingCell.NumSkeletalMeshActors = uint32(Cell.SkeletalMeshActors.Num());
+                StreamingCell.LoadDistance = Settings->MapCellLoadDistance;
+
+                FMapActorSet CellActors;
+                GetMapCellActors(MapActors, Cell, CellActors);
+
+                TArray<uint32> CellDependencies;
+                for (int32 ActorIndex : Cell.StaticMeshActors)
+                {
+                    for (uint32 Dependency : StaticMeshActorDependencies[ActorIndex])
+                    {
+                        CellDependencies.AddUnique(Dependency);
+                    }
+                }
+                for (int32 ActorIndex : Cell.SkeletalMeshActors)
+                {
+                    for (uint32 Dependency : SkeletalMeshActorDependencies[ActorIndex])
+                    {
+                        CellDependencies.AddUnique(Dependency);
+                    }
+                }
+                CellDependencies.Sort();
+
+                const int64 SnapshotSize = CellActors.GetAllocatedSize() + CellDependencies.GetAllocatedSize();
+                FExportTask CellTask = [CellFilePathName = FPaths::GetPath(FullFilePathName) / CellFileName, CellActors = MoveTemp(CellActors),
+                    CellDependencies = MoveTemp(CellDependencies), &MergeMeshes, MapOptions]()
+                {
+                    FExportFileWriter CellWriter(CellFilePathName, REngineFormat::EFileType::MapCell);
+                    AddMapActorChunks(CellWriter, CellActors, MergeMeshes, MapOptions, FPaths::GetCleanFilename(CellFilePathName));
+                    CellWriter.AddChunk(REngineFormat::ChunkId::CellDependencies, 0, REngineFormat::EElementFormat::UInt32, CellDependencies);
+
+                    return CellWriter.Commit();
+                };
+                ExportQueue.Add(MoveTemp(CellTask), SnapshotSize, [&bCellsSucceeded](bool bSucceeded) { bCellsSucceeded &= bSucceeded; });
+            }
+
+            UE_LOG(ObjectExporterBPLibraryLog, Log, TEXT("ExportMap: %d actors in %d streaming cells, %.1f actors per cell."),
+                MapActors.StaticMeshActors.Num() + MapActors.SkeletalMeshActors.Num(), Cells.Num(),
+                float(MapActors.StaticMeshActors.Num() + MapActors.SkeletalMeshActors.Num()) / FMath::Max(Cells.Num(), 1));
+
+            FileWriter.AddChunk(REngineFormat::ChunkId::StreamingCells, 0, REngineFormat::EElementFormat::Struct, StreamingCells);
+        }
+        else
+        {
+            AddMapActorChunks(FileWriter, MapActors, MergeMeshes, MapOptions, TEXT("ExportMap"));
+        }
+
+        FileWriter.AddStringTableChunk(REngineFormat::ChunkId::Strings, 0, Strings.GetStrings());
+
+        ExportQueue.Flush();
+
+        ExportCache.LogStats(TEXT("ExportMap"));
+        if (!ExportCache.Save())
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportMap: could not save the export manifest."));
+        }
+
+        TextureRegistry.LogStats(TEXT("ExportMap"));
+        if (!TextureRegistry.Save())
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportMap: could not save the texture registry."));
+        }
+
+        if (!bCellsSucceeded)
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportMap: could not write every streaming cell."));
+
+            return false;
         }
 
+        // Cells of an earlier export with more cells, or with partitioning since disabled, would otherwise stay beside the .map
+        DeleteStaleMapCells(FullFilePathName, CellFileNames);
 
-        FileWriter->Close();
-        delete FileWriter;
-        FileWriter = nullptr;
+        if (!FileWriter.Commit())
+        {
+            UE_LOG(ObjectExporterBPLibraryLog, Warning, TEXT("ExportMap: failed."));
+
+            return false;
+        }
 
         if (CopyToPath)
         {
@@ -0,0 +1,848 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ObjectExporterBPLibrary.h"
+#include "BVHBuilder.h"
+#include "ExportFileWriter.h"
+#include "TextureExporter.h"
+#include "EngineUtils.h"
+#include "Engine/Texture.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Misc/FileHelper.h"
+#include "Math/RandomStream.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include "REngineReader.h"
+#include "REngineAnimSampler.h"
+#include "REngineBVH.h"
+#if PLATFORM_WINDOWS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+/*
+*   Editor console benchmarks for the exporters.
+*   Run from the editor console or with -ExecCmds, results go to the log.
+*/
+
+#define BENCHMARK_PATH "ObjectExporterBenchmark/"
+#define STATICMESH_EXPORT_PATH "REngine/StaticMesh/"
+#define EXPORT_PATH "REngine/"
+#define ANIMATION_EXPORT_PATH "REngine/SkeletalMesh/Animation/"
+
+DECLARE_LOG_CATEGORY_CLASS(ObjectExporterBenchmarksLog, Log, All);
+
+// Reference path: every element goes through FArchive::operator<< straight into the file writer
+static int64 ExportStaticMeshPerElement(const UStaticMesh* StaticMesh, const FString& FullFilePathName)
+{
+    FArchive* FileWriter = IFileManager::Get().CreateFileWriter(*FullFilePathName);
+    if (nullptr == FileWriter)
+    {
+        return 0;
+    }
+
+    const FStaticMeshLODResources& CurLOD = StaticMesh->GetRenderData()->LODResources[0];
+    const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.VertexBuffers.PositionVertexBuffer;
+    const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.VertexBuffers.StaticMeshVertexBuffer;
+    int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+
+    *FileWriter << NumVertices;
+
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        FVector3f Position = PositionVertexBuffer.VertexPosition(iVertex);
+        FVector4f Normal = StaticMeshVertexBuffer.VertexTangentZ(iVertex);
+        FVector4f TangentX = StaticMeshVertexBuffer.VertexTangentX(iVertex);
+        FVector3f Tangent = FVector3f(TangentX.X, TangentX.Y, TangentX.Z);
+        FVector2f UV = StaticMeshVertexBuffer.GetVertexUV(iVertex, 0);
+
+        *FileWriter << Position;
+        *FileWriter << Normal;
+        *FileWriter << Tangent;
+        *FileWriter << UV;
+    }
+
+    FIndexArrayView Indices = CurLOD.IndexBuffer.GetArrayView();
+    int32 NumIndices = Indices.Num();
+
+    *FileWriter << NumIndices;
+
+    for (int32 iIndex = 0; iIndex < NumIndices; iIndex++)
+    {
+        uint32 Index = Indices[iIndex];
+        *FileWriter << Index;
+    }
+
+    const int64 Size = FileWriter->Tell();
+    FileWriter->Close();
+    delete FileWriter;
+
+    return Size;
+}
+
+// LOD 0 vertex in the layout of the reference path, FVector4f would pad it
+struct FBenchmarkVertex
+{
+    FVector3f Position;
+    FVector3f Normal;
+    float BinormalSign;
+    FVector3f Tangent;
+    FVector2f UV;
+};
+static_assert(sizeof(FBenchmarkVertex) == 48, "FBenchmarkVertex must match the per element layout.");
+
+// Buffered path on the same data: the streams are built in preallocated arrays and go through FExportFileWriter uncompressed,
+// so the comparison measures the writer and not the extra LODs, meshlets or settings of ExportStaticMesh
+static int64 ExportStaticMeshBuffered(const UStaticMesh* StaticMesh, const FString& FullFilePathName)
+{
+    const FStaticMeshLODResources& CurLOD = StaticMesh->GetRenderData()->LODResources[0];
+    const FPositionVertexBuffer& PositionVertexBuffer = CurLOD.VertexBuffers.PositionVertexBuffer;
+    const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = CurLOD.VertexBuffers.StaticMeshVertexBuffer;
+    const int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+
+    TArray<FBenchmarkVertex> Vertices;
+    Vertices.SetNumUninitialized(NumVertices);
+    for (int32 iVertex = 0; iVertex < NumVertices; iVertex++)
+    {
+        const FVector4f Normal = StaticMeshVertexBuffer.VertexTangentZ(iVertex);
+        const FVector4f TangentX = StaticMeshVertexBuffer.VertexTangentX(iVertex);
+
+        FBenchmarkVertex& Vertex = Vertices[iVertex];
+        Vertex.Position = PositionVertexBuffer.VertexPosition(iVertex);
+        Vertex.Normal = FVector3f(Normal.X, Normal.Y, Normal.Z);
+        Vertex.BinormalSign = Normal.W;
+        Vertex.Tangent = FVector3f(TangentX.X, TangentX.Y, TangentX.Z);
+        Vertex.UV = StaticMeshVertexBuffer.GetVertexUV(iVertex, 0);
+    }
+
+    TArray<uint32> Indices;
+    CurLOD.IndexBuffer.GetCopy(Indices);
+
+    FExportFileWriter FileWriter(FullFilePathName, REngineFormat::EFileType::StaticMesh);
+    FileWriter.SetCompression(false);
+    FileWriter.AddChunk(REngineFormat::ChunkId::Vertices, 0, REngineFormat::EElementFormat::Struct, Vertices);
+    FileWriter.AddChunk(REngineFormat::ChunkId::Indices, 0, REngineFormat::EElementFormat::UInt32, Indices);
+    if (!FileWriter.Commit())
+    {
+        return 0;
+    }
+
+    return IFileManager::Get().FileSize(*FullFilePathName);
+}
+
+static void BenchmarkExport(const TArray<FString>& Args)
+{
+    if (Args.Num() < 1)
+    {
+        UE_LOG(ObjectExporterBenchmarksLog, Warning, TEXT("Usage: ObjectExporter.BenchmarkExport <StaticMeshPath> [Iterations]"));
+
+        return;
+    }
+
+    const UStaticMesh* StaticMesh = LoadObject<UStaticMesh>(nullptr, *Args[0]);
+    if (StaticMesh == nullptr || StaticMesh->GetRenderData() == nullptr)
+    {
+        UE_LOG(ObjectExporterBenchmarksLog, Warning, TEXT("BenchmarkExport: can not load %s."), *Args[0]);
+
+        return;
+    }
+
+    const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 5;
+    const FString SavePath = FPaths::ProjectIntermediateDir() + BENCHMARK_PATH;
+    const FString PerElementFilePathName = SavePath + StaticMesh->GetName() + "_PerElement.stm";
+    const FString BufferedFilePathName = SavePath + StaticMesh->GetName() + ".stm";
+
+    double PerElementSeconds = 0.0;
+    int64 PerElementSize = 0;
+    for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        PerElementSize = ExportStaticMeshPerElement(StaticMesh, PerElementFilePathName);
+        PerElementSeconds += FPlatformTime::Seconds() - StartTime;
+    }
+
+    double BufferedSeconds = 0.0;
+    int64 BufferedSize = 0;
+    for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        BufferedSize = ExportStaticMeshBuffered(StaticMesh, BufferedFilePathName);
+        BufferedSeconds += FPlatformTime::Seconds() - StartTime;
+    }
+
+    const double PerElementMBs = PerElementSize * Iterations / (1024.0 * 1024.0) / FMath::Max(PerElementSeconds, SMALL_NUMBER);
+    const double BufferedMBs = BufferedSize * Iterations / (1024.0 * 1024.0) / FMath::Max(BufferedSeconds, SMALL_NUMBER);
+
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkExport: %s, %d iterations. Per element: %.1f MB/s. Buffered: %.1f MB/s (%.2fx)."),
+        *StaticMesh->GetName(), Iterations, PerElementMBs, BufferedMBs, BufferedMBs / FMath::Max(PerElementMBs, SMALL_NUMBER));
+
+    IFileManager::Get().Delete(*PerElementFilePathName);
+    IFileManager::Get().Delete(*BufferedFilePathName);
+}
+
+static FAutoConsoleCommand BenchmarkExportCommand(
+    TEXT("ObjectExporter.BenchmarkExport"),
+    TEXT("Compare per element FArchive export against buffered export of the LOD 0 streams of a static mesh. Usage: ObjectExporter.BenchmarkExport <StaticMeshPath> [Iterations]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkExport));
+
+// Inward facing side and near planes of a 90 degree view, a sphere is outside when it is fully behind one plane
+struct FCullingView
+{
+    FVector3f Position;
+    FVector3f PlaneNormals[5];
+    float PlaneDistances[5];
+};
+
+static FCullingView MakeCullingView(const FVector3f& Position, const FVector3f& Target, float NearDistance)
+{
+    const FVector3f Forward = (Target - Position).GetSafeNormal();
+    FVector3f Right = FVector3f::CrossProduct(FVector3f(0.0f, 0.0f, 1.0f), Forward).GetSafeNormal();
+    if (Right.IsNearlyZero())
+    {
+        Right = FVector3f(0.0f, 1.0f, 0.0f);
+    }
+    const FVector3f Up = FVector3f::CrossProduct(Forward, Right);
+    const float HalfAngleSinCos = UE_INV_SQRT_2;
+
+    FCullingView View;
+    View.Position = Position;
+    View.PlaneNormals[0] = (Forward - Right) * HalfAngleSinCos;
+    View.PlaneNormals[1] = (Forward + Right) * HalfAngleSinCos;
+    View.PlaneNormals[2] = (Forward - Up) * HalfAngleSinCos;
+    View.PlaneNormals[3] = (Forward + Up) * HalfAngleSinCos;
+    View.PlaneNormals[4] = Forward;
+    for (int32 iPlane = 0; iPlane < 5; iPlane++)
+    {
+        View.PlaneDistances[iPlane] = FVector3f::DotProduct(View.PlaneNormals[iPlane], Position);
+    }
+    View.PlaneDistances[4] += NearDistance;
+
+    return View;
+}
+
+static void BenchmarkMeshletCulling(const TArray<FString>& Args)
+{
+    using namespace REngineFormat;
+
+    const int32 NumViews = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 256;
+    const FString ExportPath = Args.Num() > 1 ? Args[1] : FPaths::ProjectSavedDir() + STATICMESH_EXPORT_PATH;
+
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *(ExportPath / TEXT("*.stm")), true, false);
+
+    int64 TotalTested = 0;
+    int64 TotalVisible = 0;
+    double TotalSeconds = 0.0;
+    for (const FString& FileName : FileNames)
+    {
+        TArray<uint8> FileData;
+        FileReader Reader;
+        if (!FFileHelper::LoadFileToArray(FileData, *(ExportPath / FileName)) || !Reader.OpenMemory(FileData.GetData(), FileData.Num()))
+        {
+            continue;
+        }
+
+        const Span<Meshlet> Meshlets = Reader.GetChunk<Meshlet>(ChunkId::Meshlets, 0);
+        if (Meshlets.empty())
+        {
+            UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkMeshletCulling: %s has no meshlets, export with meshlets enabled."), *FileName);
+
+            continue;
+        }
+
+        FBox3f Bounds(ForceInit);
+        uint32 NumTriangles = 0;
+        for (const Meshlet& Cluster : Meshlets)
+        {
+            const FVector3f Center(Cluster.Center[0], Cluster.Center[1], Cluster.Center[2]);
+            Bounds += Center - FVector3f(Cluster.Radius);
+            Bounds += Center + FVector3f(Cluster.Radius);
+            NumTriangles += Cluster.TriangleCount;
+        }
+        const FVector3f MeshCenter = Bounds.GetCenter();
+        const float MeshRadius = FMath::Max(Bounds.GetExtent().Size(), 1.0f);
+
+        // Orbit cameras looking at random points around the mesh so both tests get to cull
+        FRandomStream RandomStream(NumViews);
+        TArray<FCullingView> Views;
+        for (int32 iView = 0; iView < NumViews; iView++)
+        {
+            const FVector3f Position = MeshCenter + FVector3f(RandomStream.GetUnitVector()) * (MeshRadius * RandomStream.FRandRange(1.5f, 3.0f));
+            const FVector3f Target = MeshCenter + FVector3f(RandomStream.GetUnitVector()) * (MeshRadius * RandomStream.FRand());
+            Views.Add(MakeCullingView(Position, Target, MeshRadius * 0.01f));
+        }
+
+        int64 NumFrustumCulled = 0;
+        int64 NumConeCulled = 0;
+        int64 NumVisibleTriangles = 0;
+        const double StartTime = FPlatformTime::Seconds();
+        for (const FCullingView& View : Views)
+        {
+            for (const Meshlet& Cluster : Meshlets)
+            {
+                const FVector3f Center(Cluster.Center[0], Cluster.Center[1], Cluster.Center[2]);
+
+                bool bOutside = false;
+                for (int32 iPlane = 0; iPlane < 5 && !bOutside; iPlane++)
+                {
+                    bOutside = FVector3f::DotProduct(View.PlaneNormals[iPlane], Center) - View.PlaneDistances[iPlane] < -Cluster.Radius;
+                }
+                if (bOutside)
+                {
+                    NumFrustumCulled++;
+                    continue;
+                }
+
+                const FVector3f Apex(Cluster.ConeApex[0], Cluster.ConeApex[1], Cluster.ConeApex[2]);
+                const FVector3f Axis(Cluster.ConeAxis[0], Cluster.ConeAxis[1], Cluster.ConeAxis[2]);
+                if (FVector3f::DotProduct((Apex - View.Position).GetSafeNormal(), Axis) >= Cluster.ConeCutoff)
+                {
+                    NumConeCulled++;
+                    continue;
+                }
+
+                NumVisibleTriangles += Cluster.TriangleCount;
+            }
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+        const int64 NumTested = int64(Meshlets.size()) * NumViews;
+        TotalTested += NumTested;
+        TotalVisible += NumTested - NumFrustumCulled - NumConeCulled;
+        TotalSeconds += Seconds;
+
+        UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkMeshletCulling: %s, %d meshlets, %d views. %.1f ns per meshlet. Frustum culled %.1f%%, cone culled %.1f%%, triangles kept %.1f%%."),
+            *FileName, int32(Meshlets.size()), NumViews, Seconds * 1e9 / FMath::Max<int64>(NumTested, 1),
+            100.0 * NumFrustumCulled / NumTested, 100.0 * NumConeCulled / NumTested, 100.0 * NumVisibleTriangles / (double(NumTriangles) * NumViews));
+    }
+
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkMeshletCulling: %d files, %lld meshlet tests, %.1f M meshlets/s, %.1f%% visible."),
+        FileNames.Num(), TotalTested, TotalTested / 1e6 / FMath::Max(TotalSeconds, double(SMALL_NUMBER)), 100.0 * TotalVisible / FMath::Max<int64>(TotalTested, 1));
+}
+
+static FAutoConsoleCommand BenchmarkMeshletCullingCommand(
+    TEXT("ObjectExporter.BenchmarkMeshletCulling"),
+    TEXT("Frustum and normal cone cull the meshlets of every exported static mesh on one core. Usage: ObjectExporter.BenchmarkMeshletCulling [Views] [ExportPath]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkMeshletCulling));
+
+struct FCodecBenchmarkChunk
+{
+    REngineFormat::ChunkEntry Entry;
+    TArray<uint8> Payload;
+};
+
+struct FCodecBenchmarkAsset
+{
+    FString FileName;
+    TArray<FCodecBenchmarkChunk> Chunks;
+    uint64 DecodedSize = 0;
+    uint64 StoredSize = 0;
+};
+
+static void DecodeBenchmarkChunk(const FCodecBenchmarkChunk& Chunk, TArray<uint8>& Output, std::vector<uint8_t>& Scratch)
+{
+    Output.SetNumUninitialized(int32(REngineFormat::GetDecodedChunkSize(Chunk.Entry)), false);
+    const bool bDecoded = REngineFormat::DecodeChunkPayload(Chunk.Entry, Chunk.Payload.GetData(), Output.GetData(), Scratch);
+    check(bDecoded);
+}
+
+static void BenchmarkCodec(const TArray<FString>& Args)
+{
+    using namespace REngineFormat;
+
+    const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10;
+    const FString ExportPath = Args.Num() > 1 ? Args[1] : FPaths::ProjectSavedDir() + EXPORT_PATH;
+
+    TArray<FString> FilePathNames;
+    for (const TCHAR* Extension : { TEXT("*.stm"), TEXT("*.skm"), TEXT("*.skt"), TEXT("*.anm") })
+    {
+        IFileManager::Get().FindFilesRecursive(FilePathNames, *ExportPath, Extension, true, false, false);
+    }
+
+    // Gather the numeric chunks of every asset, compressing the ones that were exported raw
+    TArray<FCodecBenchmarkAsset> Assets;
+    for (const FString& FilePathName : FilePathNames)
+    {
+        TArray<uint8> FileData;
+        FileReader Reader;
+        if (!FFileHelper::LoadFileToArray(FileData, *FilePathName) || !Reader.OpenMemory(FileData.GetData(), FileData.Num()))
+        {
+            continue;
+        }
+
+        FCodecBenchmarkAsset& Asset = Assets.AddDefaulted_GetRef();
+        Asset.FileName = FPaths::GetCleanFilename(FilePathName);
+        for (const ChunkEntry& Entry : Reader.GetChunkTable())
+        {
+            if (Entry.Format == uint32(EElementFormat::Bytes) || Entry.Format >= uint32(EElementFormat::String))
+            {
+                continue;
+            }
+
+            FCodecBenchmarkChunk Chunk;
+            Chunk.Entry = Entry;
+            Chunk.Payload.Append(Reader.GetPayload(Entry), int32(Entry.Size));
+            if (!IsChunkCompressed(Chunk.Entry))
+            {
+                FExportFileWriter::CompressChunk(Chunk.Entry, Chunk.Payload);
+            }
+
+            Asset.DecodedSize += GetDecodedChunkSize(Chunk.Entry);
+            Asset.StoredSize += Chunk.Entry.Size;
+            Asset.Chunks.Add(MoveTemp(Chunk));
+        }
+    }
+
+    // One core, asset by asset
+    uint64 TotalDecodedSize = 0;
+    uint64 TotalStoredSize = 0;
+    double TotalSeconds = 0.0;
+    TArray<uint8> Output;
+    std::vector<uint8_t> Scratch;
+    for (const FCodecBenchmarkAsset& Asset : Assets)
+    {
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+        {
+            for (const FCodecBenchmarkChunk& Chunk : Asset.Chunks)
+            {
+                DecodeBenchmarkChunk(Chunk, Output, Scratch);
+            }
+        }
+        const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+        TotalDecodedSize += Asset.DecodedSize;
+        TotalStoredSize += Asset.StoredSize;
+        TotalSeconds += Seconds;
+
+        UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkCodec: %s, %.2f MB -> %.2f MB, ratio %.2f, decode %.2f GB/s."),
+            *Asset.FileName, Asset.DecodedSize / (1024.0 * 1024.0), Asset.StoredSize / (1024.0 * 1024.0),
+            double(Asset.DecodedSize) / FMath::Max<uint64>(Asset.StoredSize, 1), Asset.DecodedSize * double(Iterations) / 1e9 / FMath::Max(Seconds, double(SMALL_NUMBER)));
+    }
+
+    // Every core, one task per chunk
+    TArray<const FCodecBenchmarkChunk*> AllChunks;
+    for (const FCodecBenchmarkAsset& Asset : Assets)
+    {
+        for (const FCodecBenchmarkChunk& Chunk : Asset.Chunks)
+        {
+            AllChunks.Add(&Chunk);
+        }
+    }
+
+    const double ParallelStartTime = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+    {
+        ParallelFor(AllChunks.Num(), [&AllChunks](int32 ChunkIndex)
+        {
+            TArray<uint8> TaskOutput;
+            std::vector<uint8_t> TaskScratch;
+            DecodeBenchmarkChunk(*AllChunks[ChunkIndex], TaskOutput, TaskScratch);
+        });
+    }
+    const double ParallelSeconds = FPlatformTime::Seconds() - ParallelStartTime;
+
+    // Loading compressed wins while storage is slower than DecodeSpeed * (1 - Stored / Decoded)
+    const double SingleCoreGBs = TotalDecodedSize * double(Iterations) / 1e9 / FMath::Max(TotalSeconds, double(SMALL_NUMBER));
+    const double ParallelGBs = TotalDecodedSize * double(Iterations) / 1e9 / FMath::Max(ParallelSeconds, double(SMALL_NUMBER));
+    const double SavedFraction = 1.0 - double(TotalStoredSize) / FMath::Max<uint64>(TotalDecodedSize, 1);
+
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkCodec: %d files, %.2f MB -> %.2f MB, ratio %.2f. Decode %.2f GB/s on one core, %.2f GB/s on %d workers. Loads faster below %.2f GB/s storage on one core."),
+        Assets.Num(), TotalDecodedSize / (1024.0 * 1024.0), TotalStoredSize / (1024.0 * 1024.0), double(TotalDecodedSize) / FMath::Max<uint64>(TotalStoredSize, 1),
+        SingleCoreGBs, ParallelGBs, FTaskGraphInterface::Get().GetNumWorkerThreads(), SingleCoreGBs * SavedFraction);
+}
+
+static FAutoConsoleCommand BenchmarkCodecCommand(
+    TEXT("ObjectExporter.BenchmarkCodec"),
+    TEXT("Compression ratio and decode speed of the geometry codec over every exported mesh, skeleton and animation, raw exports are compressed in memory first. Usage: ObjectExporter.BenchmarkCodec [Iterations] [ExportPath]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkCodec));
+
+static double GetMipChainMegaPixels(const FTextureSnapshot& Snapshot)
+{
+    double Pixels = 0.0;
+    for (int32 MipIndex = 0; MipIndex < Snapshot.NumMips; MipIndex++)
+    {
+        Pixels += double(FMath::Max(Snapshot.SizeX >> MipIndex, 1)) * FMath::Max(Snapshot.SizeY >> MipIndex, 1);
+    }
+
+    return Pixels / 1e6;
+}
+
+static void BenchmarkTextures(const TArray<FString>& Args)
+{
+    const int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 3;
+    const FString ContentPath = Args.Num() > 1 ? Args[1] : TEXT("/Game/REngine/Texture");
+
+    TArray<UObject*> Objects;
+    EngineUtils::FindOrLoadAssetsByPath(ContentPath, Objects, EngineUtils::ATL_Regular);
+
+    TArray<FTextureSnapshot> Snapshots;
+    for (const UObject* Object : Objects)
+    {
+        const UTexture* Texture = Cast<UTexture>(Object);
+        FTextureSnapshot Snapshot;
+        if (Texture != nullptr && SnapshotTexture(Texture, FTextureExportOptions(), Snapshot))
+        {
+            Snapshots.Add(MoveTemp(Snapshot));
+        }
+    }
+
+    if (Snapshots.Num() == 0)
+    {
+        UE_LOG(ObjectExporterBenchmarksLog, Warning, TEXT("BenchmarkTextures: no 2D textures in %s."), *ContentPath);
+
+        return;
+    }
+
+    // One core, every LDR texture in every LDR format and the HDR ones in BC6H
+    static const EBCFormat LDRFormats[] = { EBCFormat::BC1, EBCFormat::BC3, EBCFormat::BC4, EBCFormat::BC5, EBCFormat::BC7 };
+    double FormatMegaPixels[6] = {};
+    double FormatSeconds[6] = {};
+    TArray64<uint8> Data;
+    for (FTextureSnapshot& Snapshot : Snapshots)
+    {
+        const EBCFormat ExportFormat = Snapshot.Format;
+        const TArrayView<const EBCFormat> Formats = ExportFormat == EBCFormat::BC6H ? TArrayView<const EBCFormat>(&ExportFormat, 1) : TArrayView<const EBCFormat>(LDRFormats);
+
+        for (EBCFormat Format : Formats)
+        {
+            Snapshot.Format = Format;
+
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+            {
+                EncodeTextureDDS(Snapshot, Data, EParallelForFlags::ForceSingleThread);
+            }
+
+            FormatSeconds[int32(Format)] += FPlatformTime::Seconds() - StartTime;
+            FormatMegaPixels[int32(Format)] += GetMipChainMegaPixels(Snapshot) * Iterations;
+        }
+
+        Snapshot.Format = ExportFormat;
+    }
+
+    for (int32 Format = 0; Format < UE_ARRAY_COUNT(FormatSeconds); Format++)
+    {
+        if (FormatMegaPixels[Format] > 0.0)
+        {
+            UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkTextures: %s %.1f MPix/s on one core."),
+                GetBCFormatName(EBCFormat(Format)), FormatMegaPixels[Format] / FMath::Max(FormatSeconds[Format], double(SMALL_NUMBER)));
+        }
+    }
+
+    // Every core, all textures in their export format, as ExportMap runs them
+    double MegaPixels = 0.0;
+    for (const FTextureSnapshot& Snapshot : Snapshots)
+    {
+        MegaPixels += GetMipChainMegaPixels(Snapshot) * Iterations;
+    }
+
+    const double ParallelStartTime = FPlatformTime::Seconds();
+    for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+    {
+        ParallelFor(Snapshots.Num(), [&Snapshots](int32 SnapshotIndex)
+        {
+            TArray64<uint8> TaskData;
+            EncodeTextureDDS(Snapshots[SnapshotIndex], TaskData);
+        });
+    }
+    const double ParallelSeconds = FPlatformTime::Seconds() - ParallelStartTime;
+
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkTextures: %d textures, %.1f MPix with mips, %.1f MPix/s on %d workers, %.2f s per export."),
+        Snapshots.Num(), MegaPixels / Iterations, MegaPixels / FMath::Max(ParallelSeconds, double(SMALL_NUMBER)), FTaskGraphInterface::Get().GetNumWorkerThreads(),
+        ParallelSeconds / Iterations);
+}
+
+static FAutoConsoleCommand BenchmarkTexturesCommand(
+    TEXT("ObjectExporter.BenchmarkTextures"),
+    TEXT("BC compression speed per format on one core and of all textures on every core. Usage: ObjectExporter.BenchmarkTextures [Iterations] [ContentPath]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTextures));
+
+struct FAnimSamplingAsset
+{
+    FString FileName;
+    REngineFormat::AnimSequenceInfo Info;
+    // Empty for sequences exported frame major
+    std::vector<REngineFormat::AnimTrack> Tracks;
+    std::vector<float> PosKeys;
+    std::vector<float> RotKeys;
+    std::vector<float> ScaleKeys;
+    REngineFormat::AnimBlockLayout Layout;
+    std::vector<float> Blocks;
+
+    REngineFormat::AnimTrackKeys GetTrackKeys() const
+    {
+        return { Tracks.data(), uint32_t(Tracks.size()), PosKeys.data(), RotKeys.data(), ScaleKeys.data() };
+    }
+};
+
+/** Frames of a crowd, every character at its own time of the sequence */
+static float GetCrowdFrame(int32 Character, uint32 NumFrames)
+{
+    return FMath::Fractional(Character * 0.6180339887f) * float(NumFrames - 1);
+}
+
+static void BenchmarkAnimSampling(const TArray<FString>& Args)
+{
+    using namespace REngineFormat;
+
+    const int32 NumPoses = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+    const uint32 FramesPerBlock = Args.Num() > 1 ? uint32(FMath::Max(1, FCString::Atoi(*Args[1]))) : 16;
+    const FString ExportPath = Args.Num() > 2 ? Args[2] : FPaths::ProjectSavedDir() + ANIMATION_EXPORT_PATH;
+
+    TArray<FString> FilePathNames;
+    IFileManager::Get().FindFilesRecursive(FilePathNames, *ExportPath, TEXT("*.anm"), true, false, false);
+
+    // Sequences in the track layout are also laid out frame major in memory, frame major exports are sampled as they are
+    TArray<FAnimSamplingAsset> Assets;
+    for (const FString& FilePathName : FilePathNames)
+    {
+        TArray<uint8> FileData;
+        FileReader Reader;
+        if (!FFileHelper::LoadFileToArray(FileData, *FilePathName) || !Reader.OpenMemory(FileData.GetData(), FileData.Num()))
+        {
+            continue;
+        }
+
+        const AnimSequenceInfo* Info = Reader.GetStruct<AnimSequenceInfo>(ChunkId::AnimInfo);
+        if (Info == nullptr)
+        {
+            continue;
+        }
+
+        FAnimSamplingAsset Asset;
+        Asset.FileName = FPaths::GetCleanFilename(FilePathName);
+        Asset.Info = *Info;
+        if (Reader.DecodeChunk(ChunkId::AnimTracks, 0, Asset.Tracks) && Reader.DecodeChunk(ChunkId::PosKeys, 0, Asset.PosKeys)
+            && Reader.DecodeChunk(ChunkId::RotKeys, 0, Asset.RotKeys) && Reader.DecodeChunk(ChunkId::ScaleKeys, 0, Asset.ScaleKeys))
+        {
+            Asset.Layout = MakeAnimBlockLayout(Info->NumFrames, uint32(Asset.Tracks.size()), FramesPerBlock);
+
+            std::vector<int32_t> LaneBones(Asset.Layout.NumLanes);
+            Asset.Blocks.resize(GetAnimBlocksFloats(Asset.Layout));
+            BuildAnimBlocks(Asset.Layout, Asset.GetTrackKeys(), LaneBones.data(), Asset.Blocks.data());
+        }
+        else if (const AnimBlockLayout* Layout = Reader.GetStruct<AnimBlockLayout>(ChunkId::AnimBlockLayout))
+        {
+            Asset.Tracks.clear();
+            Asset.Layout = *Layout;
+            if (!Reader.DecodeChunk(ChunkId::AnimBlocks, 0, Asset.Blocks))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkAnimSampling: %s has compressed tracks, export without compression to sample it."), *Asset.FileName);
+
+            continue;
+        }
+
+        Assets.Add(MoveTemp(Asset));
+    }
+
+    if (Assets.Num() == 0)
+    {
+        UE_LOG(ObjectExporterBenchmarksLog, Warning, TEXT("BenchmarkAnimSampling: no sequences in %s."), *ExportPath);
+
+        return;
+    }
+
+    // One core, a crowd of NumPoses characters per sequence in both layouts
+    double TotalBlockSeconds = 0.0;
+    int64 TotalBlockPoses = 0;
+    std::vector<float> TrackPose, BlockPose;
+    for (const FAnimSamplingAsset& Asset : Assets)
+    {
+        const uint32 NumLanes = Asset.Layout.NumLanes;
+        TrackPose.resize(GetAnimPoseFloats(NumLanes));
+        BlockPose.resize(GetAnimPoseFloats(NumLanes));
+
+        double TrackSeconds = 0.0;
+        float MaxDifference = 0.0f;
+        if (!Asset.Tracks.empty())
+        {
+            const AnimTrackKeys Keys = Asset.GetTrackKeys();
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 Character = 0; Character < NumPoses; Character++)
+            {
+                SampleTrackPose(Keys, GetCrowdFrame(Character, Asset.Layout.NumFrames), NumLanes, TrackPose.data());
+            }
+            TrackSeconds = FPlatformTime::Seconds() - StartTime;
+
+            // Both samplers give the same pose, rotations up to their sign
+            for (int32 Character = 0; Character < FMath::Min(NumPoses, 1024); Character++)
+            {
+                const float Frame = GetCrowdFrame(Character, Asset.Layout.NumFrames);
+                SampleTrackPose(Keys, Frame, NumLanes, TrackPose.data());
+                SampleBlockPose(Asset.Layout, Asset.Blocks.data(), Frame, BlockPose.data());
+                for (uint32 Lane = 0; Lane < NumLanes; Lane++)
+                {
+                    float Dot = 0.0f;
+                    for (uint32 Component = 0; Component < 4; Component++)
+                    {
+                        Dot += TrackPose[Component * NumLanes + Lane] * BlockPose[Component * NumLanes + Lane];
+                    }
+                    MaxDifference = FMath::Max(MaxDifference, 1.0f - FMath::Abs(Dot));
+                    for (uint32 Stream = 4; Stream < AnimFrameStreams; Stream++)
+                    {
+                        MaxDifference = FMath::Max(MaxDifference, FMath::Abs(TrackPose[Stream * NumLanes + Lane] - BlockPose[Stream * NumLanes + Lane]));
+                    }
+                }
+            }
+        }
+
+        const double StartTime = FPlatformTime::Seconds();
+        for (int32 Character = 0; Character < NumPoses; Character++)
+        {
+            SampleBlockPose(Asset.Layout, Asset.Blocks.data(), GetCrowdFrame(Character, Asset.Layout.NumFrames), BlockPose.data());
+        }
+        const double BlockSeconds = FPlatformTime::Seconds() - StartTime;
+
+        TotalBlockSeconds += BlockSeconds;
+        TotalBlockPoses += NumPoses;
+
+        const double TrackPosesPerSecond = NumPoses / FMath::Max(TrackSeconds, double(SMALL_NUMBER));
+        const double BlockPosesPerSecond = NumPoses / FMath::Max(BlockSeconds, double(SMALL_NUMBER));
+        if (Asset.Tracks.empty())
+        {
+            UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkAnimSampling: %s, %u lanes, %u frames. Frame major %.2f M poses/s."),
+                *Asset.FileName, NumLanes, Asset.Layout.NumFrames, BlockPosesPerSecond / 1e6);
+        }
+        else
+        {
+            UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkAnimSampling: %s, %d tracks, %u frames. Tracks %.2f M poses/s, frame major %.2f M poses/s (%.2fx), max difference %g."),
+                *Asset.FileName, int32(Asset.Tracks.size()), Asset.Layout.NumFrames, TrackPosesPerSecond / 1e6, BlockPosesPerSecond / 1e6,
+                BlockPosesPerSecond / TrackPosesPerSecond, MaxDifference);
+        }
+    }
+
+    // Every core, the crowds of all sequences at once
+    const int32 NumWorkers = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+    const double ParallelStartTime = FPlatformTime::Seconds();
+    ParallelFor(NumWorkers, [&Assets, NumPoses, NumWorkers](int32 Worker)
+    {
+        std::vector<float> Pose;
+        for (const FAnimSamplingAsset& Asset : Assets)
+        {
+            Pose.resize(GetAnimPoseFloats(Asset.Layout.NumLanes));
+            for (int32 Character = Worker; Character < NumPoses; Character += NumWorkers)
+            {
+                SampleBlockPose(Asset.Layout, Asset.Blocks.data(), GetCrowdFrame(Character, Asset.Layout.NumFrames), Pose.data());
+            }
+        }
+    });
+    const double ParallelSeconds = FPlatformTime::Seconds() - ParallelStartTime;
+
+    const double SingleCorePosesPerSecond = TotalBlockPoses / FMath::Max(TotalBlockSeconds, double(SMALL_NUMBER));
+    const double ParallelPosesPerSecond = TotalBlockPoses / FMath::Max(ParallelSeconds, double(SMALL_NUMBER));
+
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkAnimSampling: %d sequences, %u frames per block. Frame major %.2f M poses/s on one core, %.2f M poses/s on %d workers, %.0f characters per ms of one core."),
+        Assets.Num(), FramesPerBlock, SingleCorePosesPerSecond / 1e6, ParallelPosesPerSecond / 1e6, NumWorkers, SingleCorePosesPerSecond / 1000.0);
+}
+
+static FAutoConsoleCommand BenchmarkAnimSamplingCommand(
+    TEXT("ObjectExporter.BenchmarkAnimSampling"),
+    TEXT("Pose sampling speed of every exported animation sequence in the track and the frame major layout, a crowd of characters at different times per sequence. Usage: ObjectExporter.BenchmarkAnimSampling [Poses] [FramesPerBlock] [ExportPath]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkAnimSampling));
+
+/** Planes of a culling view and a far plane, so a view into a large scene only sees part of it */
+static REngineFormat::CullingPlanes MakeCullingPlanes(const FCullingView& View, float FarDistance)
+{
+    REngineFormat::CullingPlanes Planes = {};
+    for (int32 iPlane = 0; iPlane < 5; iPlane++)
+    {
+        Planes.Normals[iPlane][0] = View.PlaneNormals[iPlane].X;
+        Planes.Normals[iPlane][1] = View.PlaneNormals[iPlane].Y;
+        Planes.Normals[iPlane][2] = View.PlaneNormals[iPlane].Z;
+        Planes.Distances[iPlane] = View.PlaneDistances[iPlane];
+    }
+
+    const FVector3f& Forward = View.PlaneNormals[4];
+    Planes.Normals[5][0] = -Forward.X;
+    Planes.Normals[5][1] = -Forward.Y;
+    Planes.Normals[5][2] = -Forward.Z;
+    Planes.Distances[5] = -FVector3f::DotProduct(Forward, View.Position) - FarDistance;
+    Planes.NumPlanes = 6;
+
+    return Planes;
+}
+
+static void BenchmarkSceneCulling(const TArray<FString>& Args)
+{
+    using namespace REngineFormat;
+
+    const int32 NumActors = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 100000;
+    const int32 NumViews = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 256;
+    const int32 MaxLeafActors = Args.Num() > 2 ? FMath::Max(1, FCString::Atoi(*Args[2])) : 4;
+
+    // A city of one square km per 1000 actors, props around buildings in blocks, and views at eye height
+    const float WorldSize = FMath::Sqrt(float(NumActors) / 1000.0f) * 100000.0f;
+    FRandomStream RandomStream(NumActors);
+    TArray<MapActorBounds> Bounds;
+    for (int32 iActor = 0; iActor < NumActors; iActor++)
+    {
+        const float Size = iActor % 10 == 0 ? RandomStream.FRandRange(500.0f, 3000.0f) : RandomStream.FRandRange(20.0f, 300.0f);
+        const FVector3f Extent(Size, Size * RandomStream.FRandRange(0.5f, 1.5f), Size * RandomStream.FRandRange(0.5f, 2.0f));
+        const FVector3f Center(RandomStream.FRand() * WorldSize, RandomStream.FRand() * WorldSize, Extent.Z);
+        Bounds.Add(MakeActorBounds(FBox3f(Center - Extent, Center + Extent), Extent.Size()));
+    }
+
+    TArray<MapBVHNode> Nodes;
+    TArray<uint32> Items;
+    FBVHBuildReport Report;
+    const double BuildStartTime = FPlatformTime::Seconds();
+    BuildBVH(Bounds, MaxLeafActors, Nodes, Items, Report);
+    const double BuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+
+    TArray<CullingPlanes> Views;
+    for (int32 iView = 0; iView < NumViews; iView++)
+    {
+        const FVector3f Position(RandomStream.FRand() * WorldSize, RandomStream.FRand() * WorldSize, 170.0f);
+        const FVector3f Target = Position + FVector3f(RandomStream.FRandRange(-1.0f, 1.0f), RandomStream.FRandRange(-1.0f, 1.0f), RandomStream.FRandRange(-0.1f, 0.1f));
+        Views.Add(MakeCullingPlanes(MakeCullingView(Position, Target, 10.0f), 50000.0f));
+    }
+
+    // Every actor against the planes, the visible set the runtime gets without a spatial index
+    int64 NumBruteForceVisible = 0;
+    const double BruteForceStartTime = FPlatformTime::Seconds();
+    for (const CullingPlanes& Planes : Views)
+    {
+        for (const MapActorBounds& ActorBounds : Bounds)
+        {
+            NumBruteForceVisible += CullBox(Planes, ActorBounds.Center, ActorBounds.Extent) != ECullResult::Outside ? 1 : 0;
+        }
+    }
+    const double BruteForceSeconds = FPlatformTime::Seconds() - BruteForceStartTime;
+
+    int64 NumVisible = 0;
+    const double StartTime = FPlatformTime::Seconds();
+    for (const CullingPlanes& Planes : Views)
+    {
+        CullBVH(Nodes.GetData(), uint32(Nodes.Num()), Items.GetData(), uint32(Items.Num()), Bounds.GetData(), Planes, [&NumVisible](uint32 Actor) { NumVisible++; });
+    }
+    const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+    if (NumVisible != NumBruteForceVisible)
+    {
+        UE_LOG(ObjectExporterBenchmarksLog, Warning, TEXT("BenchmarkSceneCulling: the BVH found %lld visible actors, brute force %lld."), NumVisible, NumBruteForceVisible);
+    }
+
+    const double QueriesPerMs = NumViews / FMath::Max(Seconds * 1000.0, double(SMALL_NUMBER));
+    const double BruteForceQueriesPerMs = NumViews / FMath::Max(BruteForceSeconds * 1000.0, double(SMALL_NUMBER));
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkSceneCulling: %d actors, %d nodes, %d leaves, depth %d, built in %.1f ms. %.1f%% visible per view."),
+        NumActors, Nodes.Num(), Report.NumLeaves, Report.MaxDepth, BuildSeconds * 1000.0, 100.0 * NumVisible / (double(NumActors) * NumViews));
+    UE_LOG(ObjectExporterBenchmarksLog, Log, TEXT("BenchmarkSceneCulling: %d views. BVH %.2f queries/ms, brute force %.2f queries/ms (%.1fx)."),
+        NumViews, QueriesPerMs, BruteForceQueriesPerMs, QueriesPerMs / FMath::Max(BruteForceQueriesPerMs, double(SMALL_NUMBER)));
+}
+
+static FAutoConsoleCommand BenchmarkSceneCullingCommand(
+    TEXT("ObjectExporter.BenchmarkSceneCulling"),
+    TEXT("Frustum cull a synthetic city of actors through the map BVH and against every actor on one core. Usage: ObjectExporter.BenchmarkSceneCulling [Actors] [Views] [MaxLeafActors]"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkSceneCulling));
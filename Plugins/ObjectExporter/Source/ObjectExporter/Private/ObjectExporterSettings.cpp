@@ -0,0 +1,39 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "ObjectExporterSettings.h"
+
+UObjectExporterSettings::UObjectExporterSettings()
+    : bCompactVertexFormat(false)
+    , bOptimizeMeshes(false)
+    , bExportMeshlets(false)
+    , bCompressGeometry(false)
+    , MaxBonesPerSection(256)
+    , MaxBoneInfluences(4)
+    , bHighQualityTextures(false)
+    , bPreserveAlphaCoverage(false)
+    , AlphaCoverageThreshold(0.5f)
+    , bCompressAnimations(false)
+    , AnimationErrorTolerance(0.1f)
+    , AnimationShellDistance(3.0f)
+    , bFrameMajorAnimations(false)
+    , AnimationFramesPerBlock(16)
+    , AnimationTextureMode(EAnimationTextureMode::Disabled)
+    , AnimationTextureFrameRate(30.0f)
+    , bFullPrecisionAnimationTextures(false)
+    , bAnimationTextureNormals(true)
+    , AnimationTextureWidth(2048)
+    , bInstanceStaticMeshes(true)
+    , MaxInstancesPerBatch(256)
+    , bMergeSmallStaticMeshes(false)
+    , MergeCellSize(5000.0f)
+    , MergeMaxActorRadius(200.0f)
+    , MergeMaxTriangles(2000)
+    , MapPartitionMode(EMapPartitionMode::Disabled)
+    , MapCellSize(10000.0f)
+    , MaxActorsPerMapCell(256)
+    , MapCellLoadDistance(20000.0f)
+    , bForceFullExport(false)
+    , ExportMemoryBudgetMB(2048)
+{
+
+}
@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SkeletonBuilder.h"
+
+#define BONE_MASK_WORD_BITS 32
+
+void SortBonesParentsFirst(const TArray<int32>& Parents, TArray<int32>& OutOrder)
+{
+    enum EBoneState : uint8
+    {
+        Unvisited,
+        InChain,
+        Ordered
+    };
+
+    TArray<uint8> States;
+    States.SetNumZeroed(Parents.Num());
+    OutOrder.Reset(Parents.Num());
+
+    // Climb from every bone to its first ordered ancestor, then order the chain top down
+    TArray<int32> Chain;
+    for (int32 BoneIndex = 0; BoneIndex < Parents.Num(); BoneIndex++)
+    {
+        Chain.Reset();
+        int32 Current = BoneIndex;
+        while (Current != INDEX_NONE && States[Current] == Unvisited)
+        {
+            States[Current] = InChain;
+            Chain.Add(Current);
+            Current = Parents.IsValidIndex(Parents[Current]) ? Parents[Current] : INDEX_NONE;
+        }
+
+        for (int32 ChainIndex = Chain.Num() - 1; ChainIndex >= 0; ChainIndex--)
+        {
+            States[Chain[ChainIndex]] = Ordered;
+            OutOrder.Add(Chain[ChainIndex]);
+        }
+    }
+}
+
+void BuildExportSkeleton(const TArray<int32>& Parents, const TArray<FTransform3f>& LocalPose, FExportSkeleton& OutSkeleton)
+{
+    check(Parents.Num() == LocalPose.Num());
+
+    const int32 NumBones = Parents.Num();
+    SortBonesParentsFirst(Parents, OutSkeleton.SourceBones);
+
+    OutSkeleton.ExportBones.SetNumUninitialized(NumBones);
+    for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+    {
+        OutSkeleton.ExportBones[OutSkeleton.SourceBones[BoneIndex]] = BoneIndex;
+    }
+
+    OutSkeleton.Parents.SetNumUninitialized(NumBones);
+    OutSkeleton.LocalPose.SetNumUninitialized(NumBones);
+    OutSkeleton.BindPose.SetNumUninitialized(NumBones);
+    OutSkeleton.InverseBindMatrices.SetNumUninitialized(NumBones);
+    for (int32 BoneIndex = 0; BoneIndex < NumBones; BoneIndex++)
+    {
+        const int32 SourceBone = OutSkeleton.SourceBones[BoneIndex];
+        const int32 SourceParent = Parents[SourceBone];
+
+        // A parent ordered after its child closed a cycle, the child is a root
+        int32 ParentIndex = Parents.IsValidIndex(SourceParent) ? OutSkeleton.ExportBones[SourceParent] : INDEX_NONE;
+        if (ParentIndex >= BoneIndex)
+        {
+            ParentIndex = INDEX_NONE;
+        }
+
+        OutSkeleton.Parents[BoneIndex] = ParentIndex;
+        OutSkeleton.LocalPose[BoneIndex] = LocalPose[SourceBone];
+        OutSkeleton.BindPose[BoneIndex] = ParentIndex != INDEX_NONE ? LocalPose[SourceBone] * OutSkeleton.BindPose[ParentIndex] : LocalPose[SourceBone];
+        OutSkeleton.InverseBindMatrices[BoneIndex] = OutSkeleton.BindPose[BoneIndex].ToMatrixWithScale().Inverse();
+    }
+}
+
+void BuildBoneLODMask(const TArray<int32>& Parents, const TArray<int32>& RequiredBones, TArray<uint32>& OutMask)
+{
+    OutMask.Reset();
+    OutMask.SetNumZeroed((Parents.Num() + BONE_MASK_WORD_BITS - 1) / BONE_MASK_WORD_BITS);
+
+    for (int32 RequiredBone : RequiredBones)
+    {
+        // Stop at the first ancestor already in the mask, its own ancestors are too
+        int32 Current = RequiredBone;
+        while (Parents.IsValidIndex(Current))
+        {
+            uint32& Word = OutMask[Current / BONE_MASK_WORD_BITS];
+            const uint32 Bit = 1u << (Current % BONE_MASK_WORD_BITS);
+            if (Word & Bit)
+            {
+                break;
+            }
+
+            Word |= Bit;
+            Current = Parents[Current];
+        }
+    }
+}
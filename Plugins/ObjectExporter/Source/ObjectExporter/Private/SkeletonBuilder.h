@@ -0,0 +1,32 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Bones of a skeleton in export order, where every parent comes before its children, with the bind pose precomputed */
+struct FExportSkeleton
+{
+    /** Source bone of every exported bone */
+    TArray<int32> SourceBones;
+    /** Exported bone of every source bone */
+    TArray<int32> ExportBones;
+    /** Exported parent of every exported bone, INDEX_NONE for roots */
+    TArray<int32> Parents;
+    TArray<FTransform3f> LocalPose;
+    /** Component space bind pose, its inverse matrices take bind pose positions to bone space */
+    TArray<FTransform3f> BindPose;
+    TArray<FMatrix44f> InverseBindMatrices;
+};
+
+/**
+*   Order the bones so every parent comes before its children, keeping the source order where it already does.
+*   A bone whose parent is out of range is a root, a bone closing a parent cycle becomes one.
+*/
+void SortBonesParentsFirst(const TArray<int32>& Parents, TArray<int32>& OutOrder);
+
+/** Reorder the bones of a skeleton parents first and compute its bind pose with a single pass over the bones */
+void BuildExportSkeleton(const TArray<int32>& Parents, const TArray<FTransform3f>& LocalPose, FExportSkeleton& OutSkeleton);
+
+/** Bit per exported bone in UInt32 words, set for the required bones and all their ancestors */
+void BuildBoneLODMask(const TArray<int32>& Parents, const TArray<int32>& RequiredBones, TArray<uint32>& OutMask);
@@ -0,0 +1,328 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "SkinPalette.h"
+#include "MeshOptimization.h"
+#include "Algo/BinarySearch.h"
+
+// The most a byte slot can address
+#define MAX_BONES_PER_SECTION 256
+
+void QuantizeInfluences(const uint16* Bones, const float* Weights, int32 NumInfluences, int32 MaxInfluences, FVertexInfluences& OutInfluences)
+{
+    MaxInfluences = FMath::Clamp(MaxInfluences, 1, MAX_EXPORT_BONE_INFLUENCES);
+
+    TArray<int32, TInlineAllocator<16>> Order;
+    for (int32 iInfluence = 0; iInfluence < NumInfluences; iInfluence++)
+    {
+        if (Weights[iInfluence] > 0.0f)
+        {
+            Order.Add(iInfluence);
+        }
+    }
+    Order.StableSort([Weights](int32 A, int32 B) { return Weights[A] > Weights[B]; });
+    Order.SetNum(FMath::Min(Order.Num(), MaxInfluences));
+
+    if (Order.Num() == 0)
+    {
+        // Unweighted vertices follow their first bone
+        FMemory::Memzero(OutInfluences);
+        for (uint16& Bone : OutInfluences.Bones)
+        {
+            Bone = NumInfluences > 0 ? Bones[0] : 0;
+        }
+        OutInfluences.Weights[0] = 255;
+        OutInfluences.NumInfluences = 1;
+
+        return;
+    }
+
+    float Sum = 0.0f;
+    for (int32 iInfluence : Order)
+    {
+        Sum += Weights[iInfluence];
+    }
+
+    // Round down, then give the missing units to the largest remainders
+    float Remainders[MAX_EXPORT_BONE_INFLUENCES] = {};
+    int32 Total = 0;
+    OutInfluences.NumInfluences = uint8(Order.Num());
+    for (int32 iSlot = 0; iSlot < MAX_EXPORT_BONE_INFLUENCES; iSlot++)
+    {
+        if (iSlot < Order.Num())
+        {
+            const float Scaled = Weights[Order[iSlot]] / Sum * 255.0f;
+            const int32 Weight = FMath::Min(FMath::FloorToInt32(Scaled), 255);
+            OutInfluences.Bones[iSlot] = Bones[Order[iSlot]];
+            OutInfluences.Weights[iSlot] = uint8(Weight);
+            Remainders[iSlot] = Scaled - Weight;
+            Total += Weight;
+        }
+        else
+        {
+            // Unused slots point at a bone the palette has anyway
+            OutInfluences.Bones[iSlot] = OutInfluences.Bones[0];
+            OutInfluences.Weights[iSlot] = 0;
+        }
+    }
+
+    for (; Total < 255; Total++)
+    {
+        int32 BestSlot = 0;
+        for (int32 iSlot = 1; iSlot < Order.Num(); iSlot++)
+        {
+            if (Remainders[iSlot] > Remainders[BestSlot])
+            {
+                BestSlot = iSlot;
+            }
+        }
+
+        OutInfluences.Weights[BestSlot]++;
+        Remainders[BestSlot] -= 1.0f;
+    }
+
+    // Rounding up may pass the weight before, restore the order
+    for (int32 iSlot = 1; iSlot < Order.Num(); iSlot++)
+    {
+        for (int32 iPrevious = iSlot; iPrevious > 0 && OutInfluences.Weights[iPrevious] > OutInfluences.Weights[iPrevious - 1]; iPrevious--)
+        {
+            Swap(OutInfluences.Weights[iPrevious], OutInfluences.Weights[iPrevious - 1]);
+            Swap(OutInfluences.Bones[iPrevious], OutInfluences.Bones[iPrevious - 1]);
+        }
+    }
+
+    // Influences rounded to nothing are dropped
+    while (OutInfluences.NumInfluences > 1 && OutInfluences.Weights[OutInfluences.NumInfluences - 1] == 0)
+    {
+        OutInfluences.Bones[OutInfluences.NumInfluences - 1] = OutInfluences.Bones[0];
+        OutInfluences.NumInfluences--;
+    }
+}
+
+/** Bones with weight of the three vertices of a triangle, without duplicates */
+static void GetTriangleBones(const TArray<FVertexInfluences>& Influences, const uint32* TriangleIndices, TArray<uint16, TInlineAllocator<3 * MAX_EXPORT_BONE_INFLUENCES>>& OutBones)
+{
+    OutBones.Reset();
+    for (int32 iCorner = 0; iCorner < 3; iCorner++)
+    {
+        const FVertexInfluences& VertexInfluences = Influences[TriangleIndices[iCorner]];
+        for (int32 iSlot = 0; iSlot < VertexInfluences.NumInfluences; iSlot++)
+        {
+            if (VertexInfluences.Weights[iSlot] > 0)
+            {
+                OutBones.AddUnique(VertexInfluences.Bones[iSlot]);
+            }
+        }
+    }
+}
+
+void BuildSkinSections(const TArray<REngineFormat::SkeletalMeshVertex>& Vertices, const TArray<FVertexInfluences>& Influences, const TArray<uint32>& Indices,
+    const TArray<REngineFormat::SkeletalMeshSection>& Sections, int32 MaxBonesPerSection, TArray<REngineFormat::SkeletalMeshVertex>& OutVertices,
+    TArray<FVertexInfluences>& OutInfluences, TArray<uint32>& OutIndices, TArray<REngineFormat::SkeletalMeshSection>& OutSections, TArray<uint16>& OutBonePalette,
+    FSkinSectionReport& OutReport)
+{
+    check(Vertices.Num() == Influences.Num());
+
+    // Every triangle has to fit in one palette
+    int32 MaxVertexInfluences = 1;
+    for (const FVertexInfluences& VertexInfluences : Influences)
+    {
+        MaxVertexInfluences = FMath::Max(MaxVertexInfluences, int32(VertexInfluences.NumInfluences));
+    }
+    const int32 MaxBones = FMath::Clamp(MaxBonesPerSection, 3 * MaxVertexInfluences, MAX_BONES_PER_SECTION);
+
+    OutVertices.Reset(Vertices.Num());
+    OutInfluences.Reset(Vertices.Num());
+    OutIndices.Reset(Indices.Num());
+    OutSections.Reset(Sections.Num());
+    OutBonePalette.Reset();
+    OutReport = FSkinSectionReport();
+    OutReport.NumSourceSections = Sections.Num();
+
+    // New index of a source vertex in the part being written, and whether an earlier part wrote it already
+    TArray<int32> PartVertices;
+    PartVertices.Init(INDEX_NONE, Vertices.Num());
+    TBitArray<> WrittenVertices(false, Vertices.Num());
+    TArray<int32> PartSourceVertices;
+
+    auto AddPart = [&](const REngineFormat::SkeletalMeshSection& Section, uint32 FirstIndex, uint32 LastIndex, TArray<uint16>& PartBones)
+    {
+        PartBones.Sort();
+
+        REngineFormat::SkeletalMeshSection& OutSection = OutSections.AddDefaulted_GetRef();
+        OutSection.MaterialIndex = Section.MaterialIndex;
+        OutSection.BaseIndex = uint32(OutIndices.Num());
+        OutSection.NumTriangles = (LastIndex - FirstIndex) / 3;
+        OutSection.BaseVertexIndex = uint32(OutVertices.Num());
+        OutSection.FirstPaletteBone = uint32(OutBonePalette.Num());
+        OutSection.NumPaletteBones = uint32(PartBones.Num());
+        OutBonePalette.Append(PartBones);
+
+        for (uint32 iIndex = FirstIndex; iIndex < LastIndex; iIndex++)
+        {
+            const uint32 SourceVertex = Indices[iIndex];
+            if (PartVertices[SourceVertex] == INDEX_NONE)
+            {
+                PartVertices[SourceVertex] = OutVertices.Num();
+                PartSourceVertices.Add(SourceVertex);
+
+                if (WrittenVertices[SourceVertex])
+                {
+                    OutReport.NumDuplicatedVertices++;
+                }
+                WrittenVertices[SourceVertex] = true;
+
+                FVertexInfluences& VertexInfluences = OutInfluences.Add_GetRef(Influences[SourceVertex]);
+                for (int32 iSlot = 0; iSlot < MAX_EXPORT_BONE_INFLUENCES; iSlot++)
+                {
+                    const int32 PaletteSlot = Algo::BinarySearch(PartBones, VertexInfluences.Bones[iSlot]);
+                    check(PaletteSlot != INDEX_NONE);
+                    VertexInfluences.Bones[iSlot] = uint16(PaletteSlot);
+                }
+
+                REngineFormat::SkeletalMeshVertex& Vertex = OutVertices.Add_GetRef(Vertices[SourceVertex]);
+                for (int32 iSlot = 0; iSlot < VERTEX_BONE_INFLUENCES; iSlot++)
+                {
+                    Vertex.BoneIndices[iSlot] = uint8(VertexInfluences.Bones[iSlot]);
+                    Vertex.BoneWeights[iSlot] = VertexInfluences.Weights[iSlot];
+                }
+            }
+
+            OutIndices.Add(uint32(PartVertices[SourceVertex]));
+        }
+
+        OutSection.NumVertices = uint32(OutVertices.Num()) - OutSection.BaseVertexIndex;
+        OutReport.MaxPaletteBones = FMath::Max(OutReport.MaxPaletteBones, PartBones.Num());
+
+        for (int32 SourceVertex : PartSourceVertices)
+        {
+            PartVertices[SourceVertex] = INDEX_NONE;
+        }
+        PartSourceVertices.Reset();
+        PartBones.Reset();
+    };
+
+    TArray<uint16> PartBones;
+    TArray<uint16, TInlineAllocator<3 * MAX_EXPORT_BONE_INFLUENCES>> TriangleBones;
+    for (const REngineFormat::SkeletalMeshSection& Section : Sections)
+    {
+        const uint32 LastIndex = Section.BaseIndex + Section.NumTriangles * 3;
+        uint32 PartFirstIndex = Section.BaseIndex;
+
+        // Triangles are taken in their original order, which keeps neighbours and so their bones together
+        for (uint32 iIndex = Section.BaseIndex; iIndex < LastIndex; iIndex += 3)
+        {
+            GetTriangleBones(Influences, &Indices[iIndex], TriangleBones);
+
+            int32 NumNewBones = 0;
+            for (uint16 Bone : TriangleBones)
+            {
+                NumNewBones += PartBones.Contains(Bone) ? 0 : 1;
+            }
+
+            if (PartBones.Num() + NumNewBones > MaxBones)
+            {
+                AddPart(Section, PartFirstIndex, iIndex, PartBones);
+                PartFirstIndex = iIndex;
+            }
+
+            for (uint16 Bone : TriangleBones)
+            {
+                PartBones.AddUnique(Bone);
+            }
+        }
+
+        AddPart(Section, PartFirstIndex, LastIndex, PartBones);
+    }
+
+    OutReport.NumSections = OutSections.Num();
+}
+
+int32 GetInfluenceBucketSize(int32 NumInfluences)
+{
+    static const int32 BucketSizes[] = { 1, 2, 4, 8, 12 };
+
+    // Unused slots of a larger bucket hold zero weights
+    for (int32 Size : BucketSizes)
+    {
+        if (Size >= NumInfluences)
+        {
+            return Size;
+        }
+    }
+
+    return MAX_EXPORT_BONE_INFLUENCES;
+}
+
+void SortSkinVerticesByInfluences(TArray<REngineFormat::SkeletalMeshVertex>& Vertices, TArray<FVertexInfluences>& Influences, TArray<uint32>& Indices,
+    const TArray<REngineFormat::SkeletalMeshSection>& Sections, TArray<REngineFormat::SkinInfluenceBucket>& OutBuckets,
+    TArray<uint8>& OutExtraInfluences)
+{
+    check(Vertices.Num() == Influences.Num());
+
+    OutBuckets.Reset();
+    OutExtraInfluences.Reset();
+
+    // Vertices outside of every section keep their place
+    TArray<uint32> VertexRemap;
+    VertexRemap.SetNumUninitialized(Vertices.Num());
+    for (int32 iVertex = 0; iVertex < Vertices.Num(); iVertex++)
+    {
+        VertexRemap[iVertex] = uint32(iVertex);
+    }
+
+    TArray<int32> BucketSizes;
+    for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); SectionIndex++)
+    {
+        const REngineFormat::SkeletalMeshSection& Section = Sections[SectionIndex];
+
+        BucketSizes.SetNumUninitialized(Section.NumVertices);
+        for (uint32 iVertex = 0; iVertex < Section.NumVertices; iVertex++)
+        {
+            BucketSizes[iVertex] = GetInfluenceBucketSize(Influences[Section.BaseVertexIndex + iVertex].NumInfluences);
+        }
+
+        uint32 NextVertex = Section.BaseVertexIndex;
+        for (int32 BucketSize = 1; BucketSize <= MAX_EXPORT_BONE_INFLUENCES; BucketSize++)
+        {
+            REngineFormat::SkinInfluenceBucket Bucket = {};
+            Bucket.SectionIndex = uint32(SectionIndex);
+            Bucket.NumInfluences = uint32(BucketSize);
+            Bucket.FirstVertex = NextVertex;
+            Bucket.FirstExtraInfluence = uint32(OutExtraInfluences.Num());
+
+            const int32 NumExtraInfluences = FMath::Max(BucketSize - VERTEX_BONE_INFLUENCES, 0);
+            for (uint32 iVertex = 0; iVertex < Section.NumVertices; iVertex++)
+            {
+                if (BucketSizes[iVertex] != BucketSize)
+                {
+                    continue;
+                }
+
+                const FVertexInfluences& VertexInfluences = Influences[Section.BaseVertexIndex + iVertex];
+                for (int32 iSlot = 0; iSlot < NumExtraInfluences; iSlot++)
+                {
+                    OutExtraInfluences.Add(uint8(VertexInfluences.Bones[VERTEX_BONE_INFLUENCES + iSlot]));
+                }
+                for (int32 iSlot = 0; iSlot < NumExtraInfluences; iSlot++)
+                {
+                    OutExtraInfluences.Add(VertexInfluences.Weights[VERTEX_BONE_INFLUENCES + iSlot]);
+                }
+
+                VertexRemap[Section.BaseVertexIndex + iVertex] = NextVertex++;
+            }
+
+            Bucket.NumVertices = NextVertex - Bucket.FirstVertex;
+            if (Bucket.NumVertices > 0)
+            {
+                OutBuckets.Add(Bucket);
+            }
+        }
+    }
+
+    RemapVertices(Vertices, VertexRemap);
+    RemapVertices(Influences, VertexRemap);
+    for (uint32& Index : Indices)
+    {
+        Index = VertexRemap[Index];
+    }
+}
@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+// Influences one vertex may keep, the vertex stream holds the first VERTEX_BONE_INFLUENCES and the extra influences chunk the others
+#define MAX_EXPORT_BONE_INFLUENCES 12
+#define VERTEX_BONE_INFLUENCES 4
+
+/** Influences of one vertex with bones of the reference skeleton, or palette slots once the sections are built. The weights sum to 255 and the largest comes first */
+struct FVertexInfluences
+{
+    uint16 Bones[MAX_EXPORT_BONE_INFLUENCES];
+    uint8 Weights[MAX_EXPORT_BONE_INFLUENCES];
+    uint8 NumInfluences;
+};
+
+struct FSkinSectionReport
+{
+    int32 NumSourceSections = 0;
+    int32 NumSections = 0;
+    int32 NumDuplicatedVertices = 0;
+    int32 MaxPaletteBones = 0;
+};
+
+/** Keep the MaxInfluences largest of NumInfluences weights of any scale and round them to bytes summing to exactly 255 */
+void QuantizeInfluences(const uint16* Bones, const float* Weights, int32 NumInfluences, int32 MaxInfluences, FVertexInfluences& OutInfluences);
+
+/**
+*   Give every section a palette of at most MaxBonesPerSection bones and write the influences of its vertices as palette slots.
+*   A section needing more bones is split between triangles, vertices used by several parts are duplicated.
+*   Every output section owns a disjoint vertex range with its vertices in order of first use.
+*   OutInfluences holds the palette slots of all influences of every output vertex, the vertices get the first four.
+*/
+void BuildSkinSections(const TArray<REngineFormat::SkeletalMeshVertex>& Vertices, const TArray<FVertexInfluences>& Influences, const TArray<uint32>& Indices,
+    const TArray<REngineFormat::SkeletalMeshSection>& Sections, int32 MaxBonesPerSection, TArray<REngineFormat::SkeletalMeshVertex>& OutVertices,
+    TArray<FVertexInfluences>& OutInfluences, TArray<uint32>& OutIndices, TArray<REngineFormat::SkeletalMeshSection>& OutSections, TArray<uint16>& OutBonePalette,
+    FSkinSectionReport& OutReport);
+
+/** Influence count of the skinning kernel for a vertex with NumInfluences influences, the smallest of 1, 2, 4, 8 or 12 holding them */
+int32 GetInfluenceBucketSize(int32 NumInfluences);
+
+/**
+*   Order the vertices of every section by bucket size, stable within a bucket, and record one SkinInfluenceBucket per non empty bucket.
+*   Influences past the fourth go to OutExtraInfluences, NumInfluences - 4 slots then NumInfluences - 4 weights per vertex of a bucket.
+*/
+void SortSkinVerticesByInfluences(TArray<REngineFormat::SkeletalMeshVertex>& Vertices, TArray<FVertexInfluences>& Influences, TArray<uint32>& Indices,
+    const TArray<REngineFormat::SkeletalMeshSection>& Sections, TArray<REngineFormat::SkinInfluenceBucket>& OutBuckets,
+    TArray<uint8>& OutExtraInfluences);
@@ -0,0 +1,157 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "StaticMeshMerger.h"
+#include "BVHBuilder.h"
+#include "Async/ParallelFor.h"
+
+static FVector3f TransformDirection(const FMatrix44f& Matrix, const float Direction[3])
+{
+    return Matrix.TransformVector(FVector3f(Direction[0], Direction[1], Direction[2])).GetSafeNormal();
+}
+
+/** Append the triangles of one section of an actor to the cell, with the vertices of its range in world space */
+static void AppendActorSection(const FMergeMeshSource& Mesh, const REngineFormat::StaticMeshSection& Section, const FTransform3f& Transform, FMergedCell& Cell)
+{
+    const FMatrix44f Matrix = Transform.ToMatrixWithScale();
+    // Normals take the inverse transpose, it keeps them perpendicular under non uniform scale
+    const FMatrix44f NormalMatrix = Matrix.Inverse().GetTransposed();
+    const bool bMirrored = Matrix.Determinant() < 0.0f;
+
+    const uint32 BaseVertex = uint32(Cell.Vertices.Num());
+    for (uint32 VertexIndex = Section.MinVertexIndex; VertexIndex <= Section.MaxVertexIndex; VertexIndex++)
+    {
+        const REngineFormat::StaticMeshVertex& Source = Mesh.Vertices[VertexIndex];
+        REngineFormat::StaticMeshVertex& Vertex = Cell.Vertices.Add_GetRef(Source);
+
+        const FVector3f Position = Matrix.TransformPosition(FVector3f(Source.Position[0], Source.Position[1], Source.Position[2]));
+        const FVector3f Normal = TransformDirection(NormalMatrix, Source.Normal);
+        const FVector3f Tangent = TransformDirection(Matrix, Source.Tangent);
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            Vertex.Position[Axis] = Position[Axis];
+            Vertex.Normal[Axis] = Normal[Axis];
+            Vertex.Tangent[Axis] = Tangent[Axis];
+        }
+
+        // A mirror flips the handedness of the tangent basis
+        Vertex.Normal[3] = bMirrored ? -Source.Normal[3] : Source.Normal[3];
+    }
+
+    for (uint32 Triangle = 0; Triangle < Section.NumTriangles; Triangle++)
+    {
+        const uint32* Corners = &Mesh.Indices[Section.FirstIndex + Triangle * 3];
+        // A mirror also flips the winding
+        Cell.Indices.Add(BaseVertex + Corners[0] - Section.MinVertexIndex);
+        Cell.Indices.Add(BaseVertex + Corners[bMirrored ? 2 : 1] - Section.MinVertexIndex);
+        Cell.Indices.Add(BaseVertex + Corners[bMirrored ? 1 : 2] - Section.MinVertexIndex);
+    }
+}
+
+static void BuildCell(const TArray<FMergeMeshSource>& Meshes, const TArray<FMergeActor>& Actors, const TArray<int32>& CellActors, FMergedCell& OutCell)
+{
+    // Materials in order of first use, every one becomes a slot and a section with the triangles of all actors using it
+    TArray<uint32>& Materials = OutCell.Materials;
+    for (int32 ActorIndex : CellActors)
+    {
+        const FMergeActor& Actor = Actors[ActorIndex];
+        for (const REngineFormat::StaticMeshSection& Section : Meshes[Actor.MeshSource].Sections)
+        {
+            if (Section.NumTriangles > 0)
+            {
+                Materials.AddUnique(Actor.SlotMaterials[Section.MaterialIndex]);
+            }
+        }
+
+        OutCell.Actors.Add(Actor.ActorIndex);
+    }
+
+    for (int32 Slot = 0; Slot < Materials.Num(); Slot++)
+    {
+        const uint32 Material = Materials[Slot];
+        REngineFormat::StaticMeshSection& MergedSection = OutCell.Sections.AddZeroed_GetRef();
+        MergedSection.MaterialIndex = Slot;
+        MergedSection.FirstIndex = uint32(OutCell.Indices.Num());
+        MergedSection.MinVertexIndex = uint32(OutCell.Vertices.Num());
+
+        for (int32 ActorIndex : CellActors)
+        {
+            const FMergeActor& Actor = Actors[ActorIndex];
+            for (const REngineFormat::StaticMeshSection& Section : Meshes[Actor.MeshSource].Sections)
+            {
+                if (Actor.SlotMaterials[Section.MaterialIndex] == Material && Section.NumTriangles > 0)
+                {
+                    AppendActorSection(Meshes[Actor.MeshSource], Section, Actor.Transform, OutCell);
+                }
+            }
+        }
+
+        MergedSection.NumTriangles = (uint32(OutCell.Indices.Num()) - MergedSection.FirstIndex) / 3;
+        MergedSection.MaxVertexIndex = uint32(OutCell.Vertices.Num()) - 1;
+    }
+
+    FBox3f Box(ForceInit);
+    for (const REngineFormat::StaticMeshVertex& Vertex : OutCell.Vertices)
+    {
+        Box += FVector3f(Vertex.Position[0], Vertex.Position[1], Vertex.Position[2]);
+    }
+
+    OutCell.Info.Bounds = MakeActorBounds(Box, Box.IsValid ? Box.GetExtent().Size() : 0.0f);
+    OutCell.Info.NumActors = uint32(OutCell.Actors.Num());
+    OutCell.Info.NumSections = uint32(OutCell.Sections.Num());
+    OutCell.Info.NumVertices = uint32(OutCell.Vertices.Num());
+}
+
+void MergeStaticMeshes(const TArray<FMergeMeshSource>& Meshes, const TArray<FMergeActor>& Actors, float CellSize, TArray<FMergedCell>& OutCells,
+    FMeshMergeReport& OutReport)
+{
+    OutCells.Reset();
+    OutReport = FMeshMergeReport();
+
+    // Cells are created in order of their first actor, which keeps the output independent of the hashing
+    TMap<FIntVector, int32> CellIndices;
+    TArray<TArray<int32>> CellActors;
+    const float InvCellSize = 1.0f / FMath::Max(CellSize, 1.0f);
+    for (int32 ActorIndex = 0; ActorIndex < Actors.Num(); ActorIndex++)
+    {
+        const FVector3f& Center = Actors[ActorIndex].Center;
+        const FIntVector Key(FMath::FloorToInt32(Center.X * InvCellSize), FMath::FloorToInt32(Center.Y * InvCellSize), FMath::FloorToInt32(Center.Z * InvCellSize));
+        int32& CellIndex = CellIndices.FindOrAdd(Key, CellActors.Num());
+        if (CellIndex == CellActors.Num())
+        {
+            CellActors.AddDefaulted();
+        }
+
+        CellActors[CellIndex].Add(ActorIndex);
+    }
+
+    OutCells.SetNum(CellActors.Num());
+    ParallelFor(CellActors.Num(), [&](int32 CellIndex)
+    {
+        OutCells[CellIndex].Info = {};
+        BuildCell(Meshes, Actors, CellActors[CellIndex], OutCells[CellIndex]);
+    });
+
+    TBitArray<> UsedMeshes(false, Meshes.Num());
+    uint32 FirstActor = 0;
+    for (FMergedCell& Cell : OutCells)
+    {
+        Cell.Info.FirstActor = FirstActor;
+        FirstActor += Cell.Info.NumActors;
+
+        OutReport.NumMergedDraws += Cell.Sections.Num();
+        OutReport.MergedBytes += Cell.Vertices.Num() * sizeof(REngineFormat::StaticMeshVertex) + Cell.Indices.Num() * sizeof(uint32);
+    }
+
+    for (const FMergeActor& Actor : Actors)
+    {
+        const FMergeMeshSource& Mesh = Meshes[Actor.MeshSource];
+        OutReport.NumSourceDraws += Mesh.Sections.Num();
+        if (!UsedMeshes[Actor.MeshSource])
+        {
+            UsedMeshes[Actor.MeshSource] = true;
+            OutReport.SourceBytes += Mesh.Vertices.Num() * sizeof(REngineFormat::StaticMeshVertex) + Mesh.Indices.Num() * sizeof(uint32);
+        }
+    }
+
+    OutReport.NumActors = Actors.Num();
+}
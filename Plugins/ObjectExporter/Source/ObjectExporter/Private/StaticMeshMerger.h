@@ -0,0 +1,56 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** LOD 0 of a static mesh, snapshotted once for every merged actor using it */
+struct FMergeMeshSource
+{
+    TArray<REngineFormat::StaticMeshVertex> Vertices;
+    TArray<uint32> Indices;
+    TArray<REngineFormat::StaticMeshSection> Sections;
+};
+
+struct FMergeActor
+{
+    /** Static mesh actor index of the map */
+    uint32 ActorIndex;
+    int32 MeshSource;
+    FTransform3f Transform;
+    /** Strings index of the material name of every material slot of the mesh */
+    TArray<uint32> SlotMaterials;
+    /** World space bounds center, picks the cell */
+    FVector3f Center;
+};
+
+/** World space geometry of one cell, the MaterialIndex of a section is a slot of Materials */
+struct FMergedCell
+{
+    REngineFormat::MapMergedCell Info;
+    TArray<uint32> Actors;
+    /** Strings index of the material name of every slot */
+    TArray<uint32> Materials;
+    TArray<REngineFormat::StaticMeshVertex> Vertices;
+    TArray<uint32> Indices;
+    TArray<REngineFormat::StaticMeshSection> Sections;
+};
+
+struct FMeshMergeReport
+{
+    int32 NumActors = 0;
+    /** Sections drawn by the merged actors on their own, and by the cells instead */
+    int32 NumSourceDraws = 0;
+    int32 NumMergedDraws = 0;
+    /** Vertex and index bytes of the source meshes, each counted once, and of the cells */
+    int64 SourceBytes = 0;
+    int64 MergedBytes = 0;
+};
+
+/**
+*   Merge the actors into one vertex and index buffer per grid cell of CellSize, transformed to world space, with a section per
+*   material. The cells are built in parallel and ordered by their first actor. Info.FirstActor counts the actors of earlier cells.
+*/
+void MergeStaticMeshes(const TArray<FMergeMeshSource>& Meshes, const TArray<FMergeActor>& Actors, float CellSize, TArray<FMergedCell>& OutCells,
+    FMeshMergeReport& OutReport);
@@ -0,0 +1,455 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TextureExporter.h"
+#include "Engine/Texture2D.h"
+#include "Hash/CityHash.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "ImageCore.h"
+#include "TextureMips.h"
+#include <type_traits>
+
+#define TEMP_FILE_POSTFIX ".tmp"
+// Bump when the encoders or mip filters produce different blocks from the same texels
+#define TEXTURE_ENCODER_VERSION 1
+// CityHash takes 32 bit sizes
+#define CONTENT_HASH_BLOCK_SIZE (int64(1) << 30)
+
+DECLARE_LOG_CATEGORY_CLASS(TextureExporterLog, Log, All);
+
+/*
+*   .dds layout: magic, DDS_HEADER with the DX10 four cc, DDS_HEADER_DXT10, then every mip top down.
+*/
+static const uint32 DDSMagic = 0x20534444; // "DDS "
+static const uint32 DDSFourCCDX10 = 0x30315844; // "DX10"
+
+static const uint32 DDSDCaps = 0x1;
+static const uint32 DDSDHeight = 0x2;
+static const uint32 DDSDWidth = 0x4;
+static const uint32 DDSDPixelFormat = 0x1000;
+static const uint32 DDSDMipMapCount = 0x20000;
+static const uint32 DDSDLinearSize = 0x80000;
+static const uint32 DDPFFourCC = 0x4;
+static const uint32 DDSCapsComplex = 0x8;
+static const uint32 DDSCapsTexture = 0x1000;
+static const uint32 DDSCapsMipMap = 0x400000;
+static const uint32 D3D10ResourceDimensionTexture2D = 3;
+
+struct FDDSPixelFormat
+{
+    uint32 Size;
+    uint32 Flags;
+    uint32 FourCC;
+    uint32 RGBBitCount;
+    uint32 RBitMask;
+    uint32 GBitMask;
+    uint32 BBitMask;
+    uint32 ABitMask;
+};
+
+struct FDDSHeader
+{
+    uint32 Size;
+    uint32 Flags;
+    uint32 Height;
+    uint32 Width;
+    uint32 PitchOrLinearSize;
+    uint32 Depth;
+    uint32 MipMapCount;
+    uint32 Reserved1[11];
+    FDDSPixelFormat PixelFormat;
+    uint32 Caps;
+    uint32 Caps2;
+    uint32 Caps3;
+    uint32 Caps4;
+    uint32 Reserved2;
+};
+
+struct FDDSHeaderDX10
+{
+    uint32 DXGIFormat;
+    uint32 ResourceDimension;
+    uint32 MiscFlag;
+    uint32 ArraySize;
+    uint32 MiscFlags2;
+};
+
+static_assert(sizeof(FDDSHeader) == 124, "DDS_HEADER is 124 bytes.");
+static_assert(sizeof(FDDSHeaderDX10) == 20, "DDS_HEADER_DXT10 is 20 bytes.");
+
+static uint32 GetDXGIFormat(EBCFormat Format, bool bSRGB)
+{
+    switch (Format)
+    {
+    case EBCFormat::BC1:
+        return bSRGB ? 72 : 71;
+    case EBCFormat::BC3:
+        return bSRGB ? 78 : 77;
+    case EBCFormat::BC4:
+        return 80;
+    case EBCFormat::BC5:
+        return 83;
+    case EBCFormat::BC6H:
+        return 95;
+    case EBCFormat::BC7:
+        return bSRGB ? 99 : 98;
+    }
+
+    return 0;
+}
+
+const TCHAR* GetBCFormatName(EBCFormat Format)
+{
+    switch (Format)
+    {
+    case EBCFormat::BC1:
+        return TEXT("BC1");
+    case EBCFormat::BC3:
+        return TEXT("BC3");
+    case EBCFormat::BC4:
+        return TEXT("BC4");
+    case EBCFormat::BC5:
+        return TEXT("BC5");
+    case EBCFormat::BC6H:
+        return TEXT("BC6H");
+    case EBCFormat::BC7:
+        return TEXT("BC7");
+    }
+
+    return TEXT("Unknown");
+}
+
+/** Color textures without alpha are BC1, SnapshotTexture switches them to BC3 when a texel is not opaque */
+static EBCFormat ChooseBCFormat(const UTexture* Texture, bool bHDRSource, bool bHighQuality, int32& OutBC4Channel)
+{
+    OutBC4Channel = 0;
+
+    switch (Texture->CompressionSettings)
+    {
+    case TC_Normalmap:
+        return EBCFormat::BC5;
+    case TC_Grayscale:
+    case TC_Displacementmap:
+    case TC_DistanceFieldFont:
+        return bHDRSource ? EBCFormat::BC6H : EBCFormat::BC4;
+    case TC_Alpha:
+        OutBC4Channel = 3;
+        return EBCFormat::BC4;
+    case TC_HDR:
+    case TC_HDR_Compressed:
+    case TC_HalfFloat:
+        return EBCFormat::BC6H;
+    case TC_Masks:
+    case TC_BC7:
+    case TC_VectorDisplacementmap:
+        return EBCFormat::BC7;
+    default:
+        break;
+    }
+
+    if (bHDRSource)
+    {
+        return EBCFormat::BC6H;
+    }
+
+    return bHighQuality ? EBCFormat::BC7 : EBCFormat::BC1;
+}
+
+bool SnapshotTexture(const UTexture* Texture, const FTextureExportOptions& Options, FTextureSnapshot& OutSnapshot)
+{
+    if (nullptr == Cast<UTexture2D>(Texture) || !Texture->Source.IsValid())
+    {
+        UE_LOG(TextureExporterLog, Warning, TEXT("SnapshotTexture: %s is not a 2D texture with source data."), *GetNameSafe(Texture));
+
+        return false;
+    }
+
+    // Reading a mip locks the bulk data, it does not modify the source
+    FImage SourceImage;
+    if (!const_cast<FTextureSource&>(Texture->Source).GetMipImage(SourceImage, 0, 0, 0))
+    {
+        UE_LOG(TextureExporterLog, Warning, TEXT("SnapshotTexture: GetMipImage failed on %s."), *Texture->GetName());
+
+        return false;
+    }
+
+    OutSnapshot.Name = Texture->GetName();
+    OutSnapshot.Format = ChooseBCFormat(Texture, Texture->HasHDRSource(), Options.bHighQuality, OutSnapshot.BC4Channel);
+    // BC4, BC5 and BC6H have no sRGB variant, their texels are converted to linear
+    OutSnapshot.bSRGB = Texture->SRGB && (OutSnapshot.Format == EBCFormat::BC1 || OutSnapshot.Format == EBCFormat::BC7);
+    OutSnapshot.bNormalMap = Texture->CompressionSettings == TC_Normalmap;
+    OutSnapshot.AlphaCoverageThreshold = Texture->bDoScaleMipsForAlphaCoverage ? float(Texture->AlphaCoverageThresholds.W) : Options.AlphaCoverageThreshold;
+    OutSnapshot.SizeX = SourceImage.SizeX;
+    OutSnapshot.SizeY = SourceImage.SizeY;
+    OutSnapshot.NumMips = Texture->MipGenSettings == TMGS_NoMipmaps ? 1 : FMath::FloorLog2(FMath::Max(SourceImage.SizeX, SourceImage.SizeY)) + 1;
+
+    FImage Image;
+    if (OutSnapshot.Format == EBCFormat::BC6H)
+    {
+        SourceImage.CopyTo(Image, ERawImageFormat::RGBA16F, EGammaSpace::Linear);
+
+        const TArrayView64<FFloat16Color> Texels = Image.AsRGBA16F();
+        OutSnapshot.HDRTexels.Append(Texels.GetData(), Texels.Num());
+    }
+    else
+    {
+        SourceImage.CopyTo(Image, ERawImageFormat::BGRA8, OutSnapshot.bSRGB ? EGammaSpace::sRGB : EGammaSpace::Linear);
+
+        const TArrayView64<FColor> Texels = Image.AsBGRA8();
+        OutSnapshot.Texels.Append(Texels.GetData(), Texels.Num());
+
+        if (OutSnapshot.Format == EBCFormat::BC1 && !Texture->CompressionNoAlpha)
+        {
+            for (const FColor& Texel : OutSnapshot.Texels)
+            {
+                if (Texel.A != 255)
+                {
+                    OutSnapshot.Format = EBCFormat::BC3;
+                    break;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static void EncodeLDRBlock(const FTextureSnapshot& Snapshot, const uint8 Texels[16][4], uint8* OutBlock)
+{
+    switch (Snapshot.Format)
+    {
+    case EBCFormat::BC1:
+        EncodeBC1Block(Texels, OutBlock);
+        break;
+    case EBCFormat::BC3:
+        EncodeBC3Block(Texels, OutBlock);
+        break;
+    case EBCFormat::BC4:
+        EncodeBC4Block(Texels, Snapshot.BC4Channel, OutBlock);
+        break;
+    case EBCFormat::BC5:
+        EncodeBC5Block(Texels, OutBlock);
+        break;
+    case EBCFormat::BC7:
+        EncodeBC7Block(Texels, OutBlock);
+        break;
+    default:
+        checkNoEntry();
+        break;
+    }
+}
+
+/** Blocks of one mip in row order, edge blocks repeat the last texels */
+template<typename TexelType>
+static void EncodeMip(const FTextureSnapshot& Snapshot, const TArray64<TexelType>& Mip, int32 MipX, int32 MipY, uint8* OutBlocks, EParallelForFlags Flags)
+{
+    const int32 NumBlocksX = (MipX + 3) / 4;
+    const int32 NumBlocksY = (MipY + 3) / 4;
+    const int32 BlockSize = GetBCBlockSize(Snapshot.Format);
+
+    ParallelFor(NumBlocksY, [&](int32 BlockY)
+    {
+        for (int32 BlockX = 0; BlockX < NumBlocksX; BlockX++)
+        {
+            uint8* OutBlock = OutBlocks + (int64(BlockY) * NumBlocksX + BlockX) * BlockSize;
+
+            if constexpr (std::is_same_v<TexelType, FColor>)
+            {
+                uint8 Texels[16][4];
+                for (int32 iTexel = 0; iTexel < 16; iTexel++)
+                {
+                    const int32 X = FMath::Min(BlockX * 4 + (iTexel & 3), MipX - 1);
+                    const int32 Y = FMath::Min(BlockY * 4 + (iTexel >> 2), MipY - 1);
+                    const FColor& Texel = Mip[int64(Y) * MipX + X];
+
+                    Texels[iTexel][0] = Texel.R;
+                    Texels[iTexel][1] = Texel.G;
+                    Texels[iTexel][2] = Texel.B;
+                    Texels[iTexel][3] = Texel.A;
+                }
+
+                EncodeLDRBlock(Snapshot, Texels, OutBlock);
+            }
+            else
+            {
+                uint16 HalfTexels[16][3];
+                for (int32 iTexel = 0; iTexel < 16; iTexel++)
+                {
+                    const int32 X = FMath::Min(BlockX * 4 + (iTexel & 3), MipX - 1);
+                    const int32 Y = FMath::Min(BlockY * 4 + (iTexel >> 2), MipY - 1);
+                    const FFloat16Color& Texel = Mip[int64(Y) * MipX + X];
+
+                    HalfTexels[iTexel][0] = Texel.R.Encoded;
+                    HalfTexels[iTexel][1] = Texel.G.Encoded;
+                    HalfTexels[iTexel][2] = Texel.B.Encoded;
+                }
+
+                EncodeBC6HBlock(HalfTexels, OutBlock);
+            }
+        }
+    }, Flags);
+}
+
+static int64 GetMipDataSize(EBCFormat Format, int32 MipX, int32 MipY)
+{
+    return int64((MipX + 3) / 4) * ((MipY + 3) / 4) * GetBCBlockSize(Format);
+}
+
+/** The top mip is encoded as stored, the ones below are filtered as floats and quantized again */
+template<typename TexelType>
+static void EncodeMipChain(const FTextureSnapshot& Snapshot, const TArray64<TexelType>& TopMip, uint8* OutData, EParallelForFlags Flags)
+{
+    EncodeMip(Snapshot, TopMip, Snapshot.SizeX, Snapshot.SizeY, OutData, Flags);
+    OutData += GetMipDataSize(Snapshot.Format, Snapshot.SizeX, Snapshot.SizeY);
+
+    FMipFilterSettings FilterSettings;
+    FilterSettings.bSRGB = Snapshot.bSRGB;
+    FilterSettings.bNormalMap = Snapshot.bNormalMap;
+    FilterSettings.AlphaCoverageThreshold = Snapshot.AlphaCoverageThreshold;
+
+    float TargetCoverage = 0.0f;
+    if constexpr (std::is_same_v<TexelType, FColor>)
+    {
+        if (FilterSettings.AlphaCoverageThreshold > 0.0f && Snapshot.NumMips > 1)
+        {
+            TargetCoverage = ComputeAlphaCoverage(TopMip.GetData(), TopMip.Num(), FilterSettings.AlphaCoverageThreshold);
+        }
+    }
+
+    TArray64<FLinearColor> Mips[2];
+    TArray64<TexelType> MipTexels;
+    int32 MipX = Snapshot.SizeX;
+    int32 MipY = Snapshot.SizeY;
+
+    for (int32 MipIndex = 1; MipIndex < Snapshot.NumMips; MipIndex++)
+    {
+        TArray64<FLinearColor>& Mip = Mips[MipIndex & 1];
+        if (MipIndex == 1)
+        {
+            DownsampleMip(TopMip.GetData(), MipX, MipY, FilterSettings, Mip, Flags);
+        }
+        else
+        {
+            DownsampleMip(Mips[(MipIndex - 1) & 1].GetData(), MipX, MipY, FilterSettings, Mip, Flags);
+        }
+
+        MipX = FMath::Max(MipX >> 1, 1);
+        MipY = FMath::Max(MipY >> 1, 1);
+
+        const float AlphaScale = TargetCoverage > 0.0f ? FindAlphaCoverageScale(Mip, FilterSettings.AlphaCoverageThreshold, TargetCoverage) : 1.0f;
+        QuantizeMip(Mip, FilterSettings, AlphaScale, MipTexels, Flags);
+
+        EncodeMip(Snapshot, MipTexels, MipX, MipY, OutData, Flags);
+        OutData += GetMipDataSize(Snapshot.Format, MipX, MipY);
+    }
+}
+
+static uint64 HashTexels(const void* Data, int64 Size, uint64 Hash)
+{
+    for (int64 Offset = 0; Offset < Size; Offset += CONTENT_HASH_BLOCK_SIZE)
+    {
+        Hash = CityHash64WithSeed(static_cast<const char*>(Data) + Offset, uint32(FMath::Min(Size - Offset, CONTENT_HASH_BLOCK_SIZE)), Hash);
+    }
+
+    return Hash;
+}
+
+uint64 GetTextureContentId(const FTextureSnapshot& Snapshot)
+{
+    const uint32 Parameters[] = { TEXTURE_ENCODER_VERSION, uint32(Snapshot.Format), uint32(Snapshot.BC4Channel), uint32(Snapshot.bSRGB), uint32(Snapshot.bNormalMap),
+        *reinterpret_cast<const uint32*>(&Snapshot.AlphaCoverageThreshold), uint32(Snapshot.SizeX), uint32(Snapshot.SizeY), uint32(Snapshot.NumMips) };
+
+    uint64 Hash = CityHash64(reinterpret_cast<const char*>(Parameters), sizeof(Parameters));
+    Hash = HashTexels(Snapshot.Texels.GetData(), Snapshot.Texels.Num() * sizeof(FColor), Hash);
+    Hash = HashTexels(Snapshot.HDRTexels.GetData(), Snapshot.HDRTexels.Num() * sizeof(FFloat16Color), Hash);
+
+    // 0 means no texture
+    return Hash != 0 ? Hash : 1;
+}
+
+void EncodeTextureDDS(const FTextureSnapshot& Snapshot, TArray64<uint8>& OutData, EParallelForFlags Flags)
+{
+    int64 DataSize = 0;
+    for (int32 MipIndex = 0; MipIndex < Snapshot.NumMips; MipIndex++)
+    {
+        DataSize += GetMipDataSize(Snapshot.Format, FMath::Max(Snapshot.SizeX >> MipIndex, 1), FMath::Max(Snapshot.SizeY >> MipIndex, 1));
+    }
+
+    FDDSHeader Header;
+    FMemory::Memzero(Header);
+    Header.Size = sizeof(FDDSHeader);
+    Header.Flags = DDSDCaps | DDSDHeight | DDSDWidth | DDSDPixelFormat | DDSDLinearSize | (Snapshot.NumMips > 1 ? DDSDMipMapCount : 0);
+    Header.Height = Snapshot.SizeY;
+    Header.Width = Snapshot.SizeX;
+    Header.PitchOrLinearSize = uint32(GetMipDataSize(Snapshot.Format, Snapshot.SizeX, Snapshot.SizeY));
+    Header.MipMapCount = Snapshot.NumMips;
+    Header.PixelFormat.Size = sizeof(FDDSPixelFormat);
+    Header.PixelFormat.Flags = DDPFFourCC;
+    Header.PixelFormat.FourCC = DDSFourCCDX10;
+    Header.Caps = DDSCapsTexture | (Snapshot.NumMips > 1 ? DDSCapsComplex | DDSCapsMipMap : 0);
+
+    FDDSHeaderDX10 HeaderDX10;
+    FMemory::Memzero(HeaderDX10);
+    HeaderDX10.DXGIFormat = GetDXGIFormat(Snapshot.Format, Snapshot.bSRGB);
+    HeaderDX10.ResourceDimension = D3D10ResourceDimensionTexture2D;
+    HeaderDX10.ArraySize = 1;
+
+    const int64 HeaderSize = sizeof(DDSMagic) + sizeof(Header) + sizeof(HeaderDX10);
+    OutData.SetNumUninitialized(HeaderSize + DataSize);
+
+    uint8* Output = OutData.GetData();
+    FMemory::Memcpy(Output, &DDSMagic, sizeof(DDSMagic));
+    FMemory::Memcpy(Output + sizeof(DDSMagic), &Header, sizeof(Header));
+    FMemory::Memcpy(Output + sizeof(DDSMagic) + sizeof(Header), &HeaderDX10, sizeof(HeaderDX10));
+
+    if (Snapshot.Format == EBCFormat::BC6H)
+    {
+        EncodeMipChain(Snapshot, Snapshot.HDRTexels, Output + HeaderSize, Flags);
+    }
+    else
+    {
+        EncodeMipChain(Snapshot, Snapshot.Texels, Output + HeaderSize, Flags);
+    }
+}
+
+bool WriteTextureDDS(const FTextureSnapshot& Snapshot, const FString& FullFilePathName)
+{
+    const double StartTime = FPlatformTime::Seconds();
+
+    TArray64<uint8> Data;
+    EncodeTextureDDS(Snapshot, Data);
+
+    const double EncodeSeconds = FPlatformTime::Seconds() - StartTime;
+
+    IFileManager& FileManager = IFileManager::Get();
+    const FString TempFilePathName = FullFilePathName + TEMP_FILE_POSTFIX;
+
+    FArchive* FileWriter = FileManager.CreateFileWriter(*TempFilePathName);
+    if (nullptr == FileWriter)
+    {
+        UE_LOG(TextureExporterLog, Warning, TEXT("WriteTextureDDS: CreateFileWriter failed. %s"), *TempFilePathName);
+
+        return false;
+    }
+
+    FileWriter->Serialize(Data.GetData(), Data.Num());
+
+    const bool bWriteSucceeded = FileWriter->Close();
+    delete FileWriter;
+    FileWriter = nullptr;
+
+    if (!bWriteSucceeded || !FileManager.Move(*FullFilePathName, *TempFilePathName, true, true))
+    {
+        UE_LOG(TextureExporterLog, Warning, TEXT("WriteTextureDDS: write failed. %s"), *FullFilePathName);
+        FileManager.Delete(*TempFilePathName, false, true, true);
+
+        return false;
+    }
+
+    const double MegaPixels = double(Snapshot.SizeX) * Snapshot.SizeY / 1e6;
+    UE_LOG(TextureExporterLog, Log, TEXT("WriteTextureDDS: %s %dx%d %s, %d mips, %.2f MB, encode %.2f ms, %.1f MPix/s."),
+        *FPaths::GetCleanFilename(FullFilePathName), Snapshot.SizeX, Snapshot.SizeY, GetBCFormatName(Snapshot.Format), Snapshot.NumMips,
+        Data.Num() / (1024.0 * 1024.0), EncodeSeconds * 1000.0, MegaPixels / FMath::Max(EncodeSeconds, double(SMALL_NUMBER)));
+
+    return true;
+}
@@ -0,0 +1,61 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+#include "BCEncoder.h"
+
+class UTexture;
+
+struct FTextureExportOptions
+{
+    /** BC7 instead of BC1 or BC3 for color */
+    bool bHighQuality = false;
+    /** Alpha coverage threshold of the textures that do not set their own, 0 turns it off */
+    float AlphaCoverageThreshold = 0.0f;
+};
+
+/** Top mip of a texture source with the block format it is exported to */
+struct FTextureSnapshot
+{
+    FString Name;
+    EBCFormat Format = EBCFormat::BC1;
+    /** Channel of BC4 textures, 0 red to 3 alpha */
+    int32 BC4Channel = 0;
+    bool bSRGB = false;
+    bool bNormalMap = false;
+    /** Alpha test threshold whose coverage the mips keep, 0 turns it off */
+    float AlphaCoverageThreshold = 0.0f;
+    int32 SizeX = 0;
+    int32 SizeY = 0;
+    int32 NumMips = 1;
+    /** BGRA8 texels of the LDR formats, in the gamma space of the texture */
+    TArray64<FColor> Texels;
+    /** Linear half float texels of BC6H */
+    TArray64<FFloat16Color> HDRTexels;
+
+    int64 GetAllocatedSize() const { return Texels.GetAllocatedSize() + HDRTexels.GetAllocatedSize(); }
+};
+
+/*
+*   In process texture export to .dds.
+*   The source image is copied on the game thread, mips and BC blocks are built from the copy on any thread, block
+*   rows in parallel, with the mips filtered as in TextureMips.h. The block format follows the compression settings of the
+*   texture: normal maps BC5, grayscale and alpha BC4, HDR BC6H, masks BC7, color BC1 or BC3 with alpha, or BC7 in high
+*   quality.
+*/
+
+/** Copy the top mip of a 2D texture source, false for other texture types or missing source data */
+bool SnapshotTexture(const UTexture* Texture, const FTextureExportOptions& Options, FTextureSnapshot& OutSnapshot);
+
+/** Hash of everything the .dds is built from, texels, format and filter settings, never 0 */
+uint64 GetTextureContentId(const FTextureSnapshot& Snapshot);
+
+/** Full mip chain of the snapshot as a .dds file with a DX10 header */
+void EncodeTextureDDS(const FTextureSnapshot& Snapshot, TArray64<uint8>& OutData, EParallelForFlags Flags = EParallelForFlags::None);
+
+/** Encode and write to a temp file renamed over the target */
+bool WriteTextureDDS(const FTextureSnapshot& Snapshot, const FString& FullFilePathName);
+
+const TCHAR* GetBCFormatName(EBCFormat Format);
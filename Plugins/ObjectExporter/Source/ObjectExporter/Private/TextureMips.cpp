@@ -0,0 +1,211 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TextureMips.h"
+#include <type_traits>
+
+// Output rows filtered by one parallel task
+#define MIP_ROWS_PER_TASK 16
+#define QUANTIZE_TEXELS_PER_TASK 4096
+#define ALPHA_COVERAGE_SEARCH_STEPS 12
+#define ALPHA_COVERAGE_MAX_SCALE 4.0f
+
+static FLinearColor DecodeTexel(const FColor& Texel, const FMipFilterSettings& Settings)
+{
+    if (Settings.bNormalMap)
+    {
+        return FLinearColor(Texel.R / 127.5f - 1.0f, Texel.G / 127.5f - 1.0f, Texel.B / 127.5f - 1.0f, Texel.A / 255.0f);
+    }
+
+    return Settings.bSRGB ? FLinearColor::FromSRGBColor(Texel) : Texel.ReinterpretAsLinear();
+}
+
+static FLinearColor DecodeTexel(const FFloat16Color& Texel, const FMipFilterSettings& Settings)
+{
+    return FLinearColor(Texel.R.GetFloat(), Texel.G.GetFloat(), Texel.B.GetFloat(), Texel.A.GetFloat());
+}
+
+/** 2x2 box filter of two source rows, normals are renormalized */
+static void FilterRow(const FLinearColor* Row0, const FLinearColor* Row1, int32 SourceX, bool bNormalMap, FLinearColor* OutRow, int32 MipX)
+{
+    const VectorRegister4Float Quarter = VectorSetFloat1(0.25f);
+    const VectorRegister4Float MinLengthSquared = VectorSetFloat1(1.e-12f);
+
+    for (int32 X = 0; X < MipX; X++)
+    {
+        const int32 X0 = FMath::Min(X * 2, SourceX - 1);
+        const int32 X1 = FMath::Min(X * 2 + 1, SourceX - 1);
+
+        const VectorRegister4Float Sum0 = VectorAdd(VectorLoad(&Row0[X0].R), VectorLoad(&Row0[X1].R));
+        const VectorRegister4Float Sum1 = VectorAdd(VectorLoad(&Row1[X0].R), VectorLoad(&Row1[X1].R));
+        VectorRegister4Float Average = VectorMultiply(VectorAdd(Sum0, Sum1), Quarter);
+
+        if (bNormalMap)
+        {
+            const VectorRegister4Float LengthSquared = VectorMax(VectorDot3(Average, Average), MinLengthSquared);
+            const VectorRegister4Float Normalized = VectorMultiply(Average, VectorReciprocalSqrtAccurate(LengthSquared));
+            Average = VectorSelect(GlobalVectorConstants::XYZMask(), Normalized, Average);
+        }
+
+        VectorStore(Average, &OutRow[X].R);
+    }
+}
+
+template<typename TexelType>
+static void DownsampleMipRows(const TexelType* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip,
+    EParallelForFlags Flags)
+{
+    const int32 MipX = FMath::Max(SourceX >> 1, 1);
+    const int32 MipY = FMath::Max(SourceY >> 1, 1);
+    OutMip.SetNumUninitialized(int64(MipX) * MipY);
+
+    const int32 NumTasks = FMath::DivideAndRoundUp(MipY, MIP_ROWS_PER_TASK);
+    ParallelFor(NumTasks, [&](int32 TaskIndex)
+    {
+        // Stored texels are decoded two source rows at a time, float mips are read in place
+        TArray<FLinearColor> DecodedRows;
+        if constexpr (!std::is_same_v<TexelType, FLinearColor>)
+        {
+            DecodedRows.SetNumUninitialized(SourceX * 2);
+        }
+
+        const int32 LastY = FMath::Min((TaskIndex + 1) * MIP_ROWS_PER_TASK, MipY);
+        for (int32 Y = TaskIndex * MIP_ROWS_PER_TASK; Y < LastY; Y++)
+        {
+            const TexelType* SourceRow0 = Source + int64(FMath::Min(Y * 2, SourceY - 1)) * SourceX;
+            const TexelType* SourceRow1 = Source + int64(FMath::Min(Y * 2 + 1, SourceY - 1)) * SourceX;
+            FLinearColor* OutRow = OutMip.GetData() + int64(Y) * MipX;
+
+            if constexpr (std::is_same_v<TexelType, FLinearColor>)
+            {
+                FilterRow(SourceRow0, SourceRow1, SourceX, Settings.bNormalMap, OutRow, MipX);
+            }
+            else
+            {
+                for (int32 X = 0; X < SourceX; X++)
+                {
+                    DecodedRows[X] = DecodeTexel(SourceRow0[X], Settings);
+                    DecodedRows[SourceX + X] = DecodeTexel(SourceRow1[X], Settings);
+                }
+
+                FilterRow(DecodedRows.GetData(), DecodedRows.GetData() + SourceX, SourceX, Settings.bNormalMap, OutRow, MipX);
+            }
+        }
+    }, Flags);
+}
+
+void DownsampleMip(const FColor* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip, EParallelForFlags Flags)
+{
+    DownsampleMipRows(Source, SourceX, SourceY, Settings, OutMip, Flags);
+}
+
+void DownsampleMip(const FFloat16Color* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip, EParallelForFlags Flags)
+{
+    DownsampleMipRows(Source, SourceX, SourceY, Settings, OutMip, Flags);
+}
+
+void DownsampleMip(const FLinearColor* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip, EParallelForFlags Flags)
+{
+    DownsampleMipRows(Source, SourceX, SourceY, Settings, OutMip, Flags);
+}
+
+float ComputeAlphaCoverage(const FColor* Texels, int64 NumTexels, float Threshold)
+{
+    int64 NumCovered = 0;
+    for (int64 iTexel = 0; iTexel < NumTexels; iTexel++)
+    {
+        NumCovered += Texels[iTexel].A / 255.0f > Threshold ? 1 : 0;
+    }
+
+    return NumTexels > 0 ? float(double(NumCovered) / NumTexels) : 0.0f;
+}
+
+float ComputeAlphaCoverage(const FLinearColor* Texels, int64 NumTexels, float Threshold, float AlphaScale)
+{
+    int64 NumCovered = 0;
+    for (int64 iTexel = 0; iTexel < NumTexels; iTexel++)
+    {
+        NumCovered += FMath::Min(Texels[iTexel].A * AlphaScale, 1.0f) > Threshold ? 1 : 0;
+    }
+
+    return NumTexels > 0 ? float(double(NumCovered) / NumTexels) : 0.0f;
+}
+
+float FindAlphaCoverageScale(const TArray64<FLinearColor>& Mip, float Threshold, float TargetCoverage)
+{
+    // Coverage only grows with the scale, bisect for the closest one
+    float MinScale = 0.0f;
+    float MaxScale = ALPHA_COVERAGE_MAX_SCALE;
+    float BestScale = 1.0f;
+    float BestError = FMath::Abs(ComputeAlphaCoverage(Mip.GetData(), Mip.Num(), Threshold) - TargetCoverage);
+
+    for (int32 Step = 0; Step < ALPHA_COVERAGE_SEARCH_STEPS && BestError > 0.0f; Step++)
+    {
+        const float Scale = (MinScale + MaxScale) * 0.5f;
+        const float Coverage = ComputeAlphaCoverage(Mip.GetData(), Mip.Num(), Threshold, Scale);
+        const float Error = FMath::Abs(Coverage - TargetCoverage);
+
+        if (Error < BestError)
+        {
+            BestError = Error;
+            BestScale = Scale;
+        }
+
+        if (Coverage < TargetCoverage)
+        {
+            MinScale = Scale;
+        }
+        else
+        {
+            MaxScale = Scale;
+        }
+    }
+
+    return BestScale;
+}
+
+static void EncodeTexel(const FLinearColor& Texel, const FMipFilterSettings& Settings, FColor& OutTexel)
+{
+    if (Settings.bNormalMap)
+    {
+        OutTexel = FLinearColor(Texel.R * 0.5f + 0.5f, Texel.G * 0.5f + 0.5f, Texel.B * 0.5f + 0.5f, Texel.A).QuantizeRound();
+    }
+    else
+    {
+        OutTexel = Settings.bSRGB ? Texel.ToFColorSRGB() : Texel.QuantizeRound();
+    }
+}
+
+static void EncodeTexel(const FLinearColor& Texel, const FMipFilterSettings& Settings, FFloat16Color& OutTexel)
+{
+    OutTexel = FFloat16Color(Texel);
+}
+
+template<typename TexelType>
+static void QuantizeMipTexels(const TArray64<FLinearColor>& Mip, const FMipFilterSettings& Settings, float AlphaScale, TArray64<TexelType>& OutTexels,
+    EParallelForFlags Flags)
+{
+    OutTexels.SetNumUninitialized(Mip.Num());
+
+    const int32 NumTasks = int32(FMath::DivideAndRoundUp(Mip.Num(), int64(QUANTIZE_TEXELS_PER_TASK)));
+    ParallelFor(NumTasks, [&](int32 TaskIndex)
+    {
+        const int64 LastTexel = FMath::Min(int64(TaskIndex + 1) * QUANTIZE_TEXELS_PER_TASK, Mip.Num());
+        for (int64 iTexel = int64(TaskIndex) * QUANTIZE_TEXELS_PER_TASK; iTexel < LastTexel; iTexel++)
+        {
+            FLinearColor Texel = Mip[iTexel];
+            Texel.A = FMath::Min(Texel.A * AlphaScale, 1.0f);
+
+            EncodeTexel(Texel, Settings, OutTexels[iTexel]);
+        }
+    }, Flags);
+}
+
+void QuantizeMip(const TArray64<FLinearColor>& Mip, const FMipFilterSettings& Settings, float AlphaScale, TArray64<FColor>& OutTexels, EParallelForFlags Flags)
+{
+    QuantizeMipTexels(Mip, Settings, AlphaScale, OutTexels, Flags);
+}
+
+void QuantizeMip(const TArray64<FLinearColor>& Mip, const FMipFilterSettings& Settings, float AlphaScale, TArray64<FFloat16Color>& OutTexels, EParallelForFlags Flags)
+{
+    QuantizeMipTexels(Mip, Settings, AlphaScale, OutTexels, Flags);
+}
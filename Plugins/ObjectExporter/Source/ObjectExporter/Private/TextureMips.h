@@ -0,0 +1,47 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/ParallelFor.h"
+
+/** How the mips of a texture are filtered */
+struct FMipFilterSettings
+{
+    /** Color is stored in sRGB, it is filtered in linear space */
+    bool bSRGB = false;
+    /** Texels are tangent space normals, filtered vectors are renormalized */
+    bool bNormalMap = false;
+    /** Alpha test threshold whose coverage every mip keeps, 0 turns it off */
+    float AlphaCoverageThreshold = 0.0f;
+};
+
+/*
+*   Mip chain filtering.
+*   Mips below the top one are kept as linear floats: 8 bit texels are decoded (sRGB to linear, normals to -1..1) a row at
+*   a time while the first mip is built, every further mip is filtered from the float mip above it. The 2x2 box filter
+*   runs on vector registers, SSE or NEON with the scalar fallback of the platform, and on rows in parallel.
+*/
+
+/** Next mip of the top mip, the last row and column are repeated on odd sizes */
+void DownsampleMip(const FColor* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip,
+    EParallelForFlags Flags = EParallelForFlags::None);
+void DownsampleMip(const FFloat16Color* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip,
+    EParallelForFlags Flags = EParallelForFlags::None);
+
+/** Next mip of a float mip */
+void DownsampleMip(const FLinearColor* Source, int32 SourceX, int32 SourceY, const FMipFilterSettings& Settings, TArray64<FLinearColor>& OutMip,
+    EParallelForFlags Flags = EParallelForFlags::None);
+
+/** Fraction of texels whose alpha passes the threshold */
+float ComputeAlphaCoverage(const FColor* Texels, int64 NumTexels, float Threshold);
+float ComputeAlphaCoverage(const FLinearColor* Texels, int64 NumTexels, float Threshold, float AlphaScale = 1.0f);
+
+/** Alpha scale that gives a mip the coverage of the top mip, so alpha tested textures do not thin out with distance */
+float FindAlphaCoverageScale(const TArray64<FLinearColor>& Mip, float Threshold, float TargetCoverage);
+
+/** Float mip back to the stored texels, alpha is multiplied by AlphaScale */
+void QuantizeMip(const TArray64<FLinearColor>& Mip, const FMipFilterSettings& Settings, float AlphaScale, TArray64<FColor>& OutTexels,
+    EParallelForFlags Flags = EParallelForFlags::None);
+void QuantizeMip(const TArray64<FLinearColor>& Mip, const FMipFilterSettings& Settings, float AlphaScale, TArray64<FFloat16Color>& OutTexels,
+    EParallelForFlags Flags = EParallelForFlags::None);
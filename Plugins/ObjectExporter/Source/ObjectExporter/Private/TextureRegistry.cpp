@@ -0,0 +1,185 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TextureRegistry.h"
+#include "ExportJsonWriter.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#define REGISTRY_FILE_VERSION 1
+#define TEXTURE_FILE_POSTFIX ".dds"
+
+DECLARE_LOG_CATEGORY_CLASS(TextureRegistryLog, Log, All);
+
+FTextureRegistry::FTextureRegistry(const FString& InRegistryFilePathName, const FString& InTextureDirectory)
+    : RegistryFilePathName(InRegistryFilePathName)
+    , TextureDirectory(InTextureDirectory)
+    , bReuseFiles(false)
+    , Unchanged(0)
+    , Converted(0)
+    , Duplicates(0)
+    , Failures(0)
+{
+    IFileManager::Get().MakeDirectory(*TextureDirectory, true);
+}
+
+void FTextureRegistry::Load()
+{
+    Entries.Reset();
+    bReuseFiles = true;
+
+    FString JsonContent;
+    if (!FFileHelper::LoadFileToString(JsonContent, *RegistryFilePathName))
+    {
+        return;
+    }
+
+    TSharedPtr<FJsonObject> JsonRootObject;
+    TSharedRef<TJsonReader<>> JsonReader = TJsonReaderFactory<>::Create(JsonContent);
+    if (!FJsonSerializer::Deserialize(JsonReader, JsonRootObject) || !JsonRootObject.IsValid()
+        || JsonRootObject->GetIntegerField(TEXT("FileVersion")) != REGISTRY_FILE_VERSION)
+    {
+        UE_LOG(TextureRegistryLog, Warning, TEXT("Load: ignoring unreadable registry %s"), *RegistryFilePathName);
+
+        return;
+    }
+
+    for (const TSharedPtr<FJsonValue>& JsonValue : JsonRootObject->GetArrayField(TEXT("Textures")))
+    {
+        const TSharedPtr<FJsonObject>* JsonEntry = nullptr;
+        if (JsonValue->TryGetObject(JsonEntry))
+        {
+            FEntry Entry;
+            Entry.SourceHash = FParse::HexNumber64(*(*JsonEntry)->GetStringField(TEXT("Source")));
+            Entry.ContentId = FParse::HexNumber64(*(*JsonEntry)->GetStringField(TEXT("Id")));
+            Entries.Add((*JsonEntry)->GetStringField(TEXT("Texture")), Entry);
+        }
+    }
+
+    UE_LOG(TextureRegistryLog, Log, TEXT("Load: %d textures from %s"), Entries.Num(), *RegistryFilePathName);
+}
+
+bool FTextureRegistry::Save()
+{
+    FExportJsonWriter JsonFile(RegistryFilePathName);
+    if (!JsonFile.IsValid())
+    {
+        return false;
+    }
+
+    // Sorted so that the registry diffs cleanly between runs
+    Entries.KeySort(TLess<FString>());
+
+    FExportJsonWriter::FWriter& JsonWriter = JsonFile.Get();
+    JsonWriter.WriteObjectStart();
+    JsonWriter.WriteValue(TEXT("FileVersion"), REGISTRY_FILE_VERSION);
+    JsonWriter.WriteArrayStart(TEXT("Textures"));
+    for (const TPair<FString, FEntry>& Entry : Entries)
+    {
+        JsonWriter.WriteObjectStart();
+        JsonWriter.WriteValue(TEXT("Texture"), Entry.Key);
+        JsonWriter.WriteValue(TEXT("Source"), FString::Printf(TEXT("%016llx"), Entry.Value.SourceHash));
+        JsonWriter.WriteValue(TEXT("Id"), GetFileName(Entry.Value.ContentId));
+        JsonWriter.WriteObjectEnd();
+    }
+    JsonWriter.WriteArrayEnd();
+    JsonWriter.WriteObjectEnd();
+
+    return JsonFile.Commit();
+}
+
+uint64 FTextureRegistry::FindId(const FString& TexturePathName, uint64 SourceHash)
+{
+    if (const uint64* ContentId = ResolvedThisRun.Find(TexturePathName))
+    {
+        return *ContentId;
+    }
+
+    const FEntry* Entry = Entries.Find(TexturePathName);
+    if (bReuseFiles && SourceHash != 0 && Entry != nullptr && Entry->SourceHash == SourceHash && IFileManager::Get().FileExists(*GetFilePathName(Entry->ContentId)))
+    {
+        ResolvedThisRun.Add(TexturePathName, Entry->ContentId);
+        ContentOwners.FindOrAdd(Entry->ContentId, TexturePathName);
+        Unchanged++;
+
+        return Entry->ContentId;
+    }
+
+    return 0;
+}
+
+bool FTextureRegistry::Register(const FString& TexturePathName, uint64 SourceHash, uint64 ContentId)
+{
+    ResolvedThisRun.Add(TexturePathName, ContentId);
+
+    // Unhashable sources are read again on the next run
+    if (SourceHash != 0)
+    {
+        Entries.Add(TexturePathName, { SourceHash, ContentId });
+    }
+    else
+    {
+        Entries.Remove(TexturePathName);
+    }
+
+    if (const FString* Owner = ContentOwners.Find(ContentId))
+    {
+        UE_LOG(TextureRegistryLog, Log, TEXT("Register: %s is identical to %s, both use %s."), *TexturePathName, **Owner, *GetFileName(ContentId));
+        Duplicates++;
+
+        return false;
+    }
+
+    ContentOwners.Add(ContentId, TexturePathName);
+
+    // Files are named by content, an existing one is already up to date
+    if (bReuseFiles && IFileManager::Get().FileExists(*GetFilePathName(ContentId)))
+    {
+        Unchanged++;
+
+        return false;
+    }
+
+    Converted++;
+
+    return true;
+}
+
+void FTextureRegistry::MarkFailed(uint64 ContentId)
+{
+    UE_LOG(TextureRegistryLog, Warning, TEXT("MarkFailed: %s could not be written."), *GetFilePathName(ContentId));
+    Failures++;
+
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It->Value.ContentId == ContentId)
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+uint64 FTextureRegistry::GetId(const FString& TexturePathName) const
+{
+    const uint64* ContentId = ResolvedThisRun.Find(TexturePathName);
+
+    return ContentId != nullptr ? *ContentId : 0;
+}
+
+FString FTextureRegistry::GetFileName(uint64 ContentId) const
+{
+    return FString::Printf(TEXT("%016llx"), ContentId);
+}
+
+FString FTextureRegistry::GetFilePathName(uint64 ContentId) const
+{
+    return TextureDirectory / GetFileName(ContentId) + TEXTURE_FILE_POSTFIX;
+}
+
+void FTextureRegistry::LogStats(const TCHAR* Context) const
+{
+    UE_LOG(TextureRegistryLog, Log, TEXT("%s: %d textures, %d unique, %d converted (%d failed), %d unchanged, %d identical to another texture."),
+        Context, ResolvedThisRun.Num(), ContentOwners.Num(), Converted, Failures, Unchanged, Duplicates);
+}
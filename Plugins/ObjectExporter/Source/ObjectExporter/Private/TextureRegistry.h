@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+*   Exported textures, keyed by texture path and source hash.
+*   A texture is written to <TextureDirectory>/<Id>.dds where the id is the hash of its converted content, so textures
+*   with identical content share one file and one id however they are named, and materials reference them by id. The
+*   path to id table is saved between runs, an unchanged texture is then resolved without reading its source.
+*/
+class FTextureRegistry
+{
+public:
+    FTextureRegistry(const FString& InRegistryFilePathName, const FString& InTextureDirectory);
+
+    /** Read the table of the last run and reuse the files on disk, without it every texture is converted again */
+    void Load();
+
+    /** Write the table with the textures of this and earlier runs */
+    bool Save();
+
+    /** Id of a texture resolved earlier in this run, or in an earlier run from the same source hash with its file still on disk, 0 otherwise */
+    uint64 FindId(const FString& TexturePathName, uint64 SourceHash);
+
+    /** Add the content id of a texture, true when the content is new in this run and its file has to be written by the caller */
+    bool Register(const FString& TexturePathName, uint64 SourceHash, uint64 ContentId);
+
+    /** Forget a texture whose file could not be written, the next run converts it again */
+    void MarkFailed(uint64 ContentId);
+
+    /** Id of a texture resolved in this run, 0 if it was not */
+    uint64 GetId(const FString& TexturePathName) const;
+
+    FString GetFileName(uint64 ContentId) const;
+    FString GetFilePathName(uint64 ContentId) const;
+
+    /** Log the texture, conversion and duplicate counts of this run */
+    void LogStats(const TCHAR* Context) const;
+
+private:
+    struct FEntry
+    {
+        uint64 SourceHash = 0;
+        uint64 ContentId = 0;
+    };
+
+    FString RegistryFilePathName;
+    FString TextureDirectory;
+    bool bReuseFiles;
+    TMap<FString, FEntry> Entries;
+    TMap<FString, uint64> ResolvedThisRun;
+    /** First texture of this run with each content */
+    TMap<uint64, FString> ContentOwners;
+    int32 Unchanged;
+    int32 Converted;
+    int32 Duplicates;
+    int32 Failures;
+};
@@ -0,0 +1,174 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "VertexQuantization.h"
+#include "Math/Float16.h"
+
+static float SignNotZero(float Value)
+{
+    return Value >= 0.0f ? 1.0f : -1.0f;
+}
+
+static int16 QuantizeSNorm16(float Value)
+{
+    return (int16)FMath::RoundToInt(FMath::Clamp(Value, -1.0f, 1.0f) * 32767.0f);
+}
+
+static float DequantizeSNorm16(int16 Value)
+{
+    return FMath::Max(Value / 32767.0f, -1.0f);
+}
+
+static uint16 QuantizeUNorm16(float Value)
+{
+    return (uint16)FMath::RoundToInt(FMath::Clamp(Value, 0.0f, 1.0f) * 65535.0f);
+}
+
+static float AngleDegrees(const FVector3f& A, const FVector3f& B)
+{
+    const float CosAngle = FMath::Clamp(FVector3f::DotProduct(A.GetSafeNormal(), B.GetSafeNormal()), -1.0f, 1.0f);
+
+    return FMath::RadiansToDegrees(FMath::Acos(CosAngle));
+}
+
+static void AddAttribute(REngineFormat::VertexFormat& Format, REngineFormat::EVertexSemantic Semantic, REngineFormat::EVertexAttributeFormat AttributeFormat, uint32 Offset)
+{
+    check(Format.AttributeCount < REngineFormat::MaxVertexAttributes);
+
+    REngineFormat::VertexAttribute& Attribute = Format.Attributes[Format.AttributeCount++];
+    Attribute.Semantic = uint32(Semantic);
+    Attribute.Format = uint32(AttributeFormat);
+    Attribute.Offset = Offset;
+}
+
+FVector2f OctahedronEncode(const FVector3f& Vector)
+{
+    const float L1Norm = FMath::Abs(Vector.X) + FMath::Abs(Vector.Y) + FMath::Abs(Vector.Z);
+    if (L1Norm <= SMALL_NUMBER)
+    {
+        return FVector2f(0.0f, 0.0f);
+    }
+
+    FVector2f Encoded(Vector.X / L1Norm, Vector.Y / L1Norm);
+    if (Vector.Z < 0.0f)
+    {
+        // Fold the lower hemisphere over the diagonals
+        Encoded = FVector2f((1.0f - FMath::Abs(Encoded.Y)) * SignNotZero(Encoded.X), (1.0f - FMath::Abs(Encoded.X)) * SignNotZero(Encoded.Y));
+    }
+
+    return Encoded;
+}
+
+FVector3f OctahedronDecode(const FVector2f& Encoded)
+{
+    FVector3f Vector(Encoded.X, Encoded.Y, 1.0f - FMath::Abs(Encoded.X) - FMath::Abs(Encoded.Y));
+    if (Vector.Z < 0.0f)
+    {
+        Vector.X = (1.0f - FMath::Abs(Encoded.Y)) * SignNotZero(Encoded.X);
+        Vector.Y = (1.0f - FMath::Abs(Encoded.X)) * SignNotZero(Encoded.Y);
+    }
+
+    return Vector.GetSafeNormal();
+}
+
+REngineFormat::VertexFormat GetStaticMeshVertexFormat()
+{
+    using namespace REngineFormat;
+
+    VertexFormat Format = {};
+    Format.Stride = sizeof(StaticMeshVertex);
+    AddAttribute(Format, EVertexSemantic::Position, EVertexAttributeFormat::Float3, offsetof(StaticMeshVertex, Position));
+    AddAttribute(Format, EVertexSemantic::Normal, EVertexAttributeFormat::Float4, offsetof(StaticMeshVertex, Normal));
+    AddAttribute(Format, EVertexSemantic::Tangent, EVertexAttributeFormat::Float3, offsetof(StaticMeshVertex, Tangent));
+    AddAttribute(Format, EVertexSemantic::UV0, EVertexAttributeFormat::Float2, offsetof(StaticMeshVertex, UV));
+
+    return Format;
+}
+
+REngineFormat::VertexFormat GetSkeletalMeshVertexFormat()
+{
+    using namespace REngineFormat;
+
+    VertexFormat Format = {};
+    Format.Stride = sizeof(SkeletalMeshVertex);
+    AddAttribute(Format, EVertexSemantic::Position, EVertexAttributeFormat::Float3, offsetof(SkeletalMeshVertex, Position));
+    AddAttribute(Format, EVertexSemantic::Normal, EVertexAttributeFormat::Float4, offsetof(SkeletalMeshVertex, Normal));
+    AddAttribute(Format, EVertexSemantic::Tangent, EVertexAttributeFormat::Float3, offsetof(SkeletalMeshVertex, Tangent));
+    AddAttribute(Format, EVertexSemantic::UV0, EVertexAttributeFormat::Float2, offsetof(SkeletalMeshVertex, UV));
+    AddAttribute(Format, EVertexSemantic::BoneIndices, EVertexAttributeFormat::UInt8x4, offsetof(SkeletalMeshVertex, BoneIndices));
+    AddAttribute(Format, EVertexSemantic::BoneWeights, EVertexAttributeFormat::UNorm8x4, offsetof(SkeletalMeshVertex, BoneWeights));
+
+    return Format;
+}
+
+void CompactStaticMeshVertices(const TArray<REngineFormat::StaticMeshVertex>& Vertices, TArray<REngineFormat::CompactStaticMeshVertex>& OutVertices,
+    REngineFormat::VertexFormat& OutFormat, FVertexQuantizationReport& OutReport)
+{
+    using namespace REngineFormat;
+
+    FBox3f Bounds(ForceInit);
+    for (const StaticMeshVertex& Vertex : Vertices)
+    {
+        Bounds += FVector3f(Vertex.Position[0], Vertex.Position[1], Vertex.Position[2]);
+    }
+    const FVector3f PositionMin = Vertices.Num() > 0 ? Bounds.Min : FVector3f::ZeroVector;
+    const FVector3f PositionExtent = Vertices.Num() > 0 ? Bounds.Max - Bounds.Min : FVector3f::ZeroVector;
+
+    OutFormat = {};
+    OutFormat.Stride = sizeof(CompactStaticMeshVertex);
+    for (int32 Axis = 0; Axis < 3; Axis++)
+    {
+        OutFormat.PositionMin[Axis] = PositionMin[Axis];
+        OutFormat.PositionExtent[Axis] = PositionExtent[Axis];
+    }
+    AddAttribute(OutFormat, EVertexSemantic::Position, EVertexAttributeFormat::UNorm16x3, offsetof(CompactStaticMeshVertex, Position));
+    AddAttribute(OutFormat, EVertexSemantic::TangentSign, EVertexAttributeFormat::SNorm16, offsetof(CompactStaticMeshVertex, TangentSign));
+    AddAttribute(OutFormat, EVertexSemantic::Normal, EVertexAttributeFormat::OctSNorm16x2, offsetof(CompactStaticMeshVertex, Normal));
+    AddAttribute(OutFormat, EVertexSemantic::Tangent, EVertexAttributeFormat::OctSNorm16x2, offsetof(CompactStaticMeshVertex, Tangent));
+    AddAttribute(OutFormat, EVertexSemantic::UV0, EVertexAttributeFormat::Half2, offsetof(CompactStaticMeshVertex, UV));
+
+    OutReport = FVertexQuantizationReport();
+    OutVertices.SetNumUninitialized(Vertices.Num());
+
+    for (int32 iVertex = 0; iVertex < Vertices.Num(); iVertex++)
+    {
+        const StaticMeshVertex& Vertex = Vertices[iVertex];
+        CompactStaticMeshVertex& CompactVertex = OutVertices[iVertex];
+
+        const FVector3f Position(Vertex.Position[0], Vertex.Position[1], Vertex.Position[2]);
+        const FVector3f Normal(Vertex.Normal[0], Vertex.Normal[1], Vertex.Normal[2]);
+        const FVector3f Tangent(Vertex.Tangent[0], Vertex.Tangent[1], Vertex.Tangent[2]);
+
+        // Encode
+        FVector3f DecodedPosition;
+        for (int32 Axis = 0; Axis < 3; Axis++)
+        {
+            const float Normalized = PositionExtent[Axis] > 0.0f ? (Position[Axis] - PositionMin[Axis]) / PositionExtent[Axis] : 0.0f;
+            CompactVertex.Position[Axis] = QuantizeUNorm16(Normalized);
+            DecodedPosition[Axis] = PositionMin[Axis] + CompactVertex.Position[Axis] / 65535.0f * PositionExtent[Axis];
+        }
+
+        CompactVertex.TangentSign = Vertex.Normal[3] < 0.0f ? -32767 : 32767;
+
+        const FVector2f EncodedNormal = OctahedronEncode(Normal);
+        CompactVertex.Normal[0] = QuantizeSNorm16(EncodedNormal.X);
+        CompactVertex.Normal[1] = QuantizeSNorm16(EncodedNormal.Y);
+
+        const FVector2f EncodedTangent = OctahedronEncode(Tangent);
+        CompactVertex.Tangent[0] = QuantizeSNorm16(EncodedTangent.X);
+        CompactVertex.Tangent[1] = QuantizeSNorm16(EncodedTangent.Y);
+
+        const FFloat16 U(Vertex.UV[0]);
+        const FFloat16 V(Vertex.UV[1]);
+        CompactVertex.UV[0] = U.Encoded;
+        CompactVertex.UV[1] = V.Encoded;
+
+        // Measure the round trip
+        const FVector3f DecodedNormal = OctahedronDecode(FVector2f(DequantizeSNorm16(CompactVertex.Normal[0]), DequantizeSNorm16(CompactVertex.Normal[1])));
+        const FVector3f DecodedTangent = OctahedronDecode(FVector2f(DequantizeSNorm16(CompactVertex.Tangent[0]), DequantizeSNorm16(CompactVertex.Tangent[1])));
+
+        OutReport.MaxPositionError = FMath::Max(OutReport.MaxPositionError, FVector3f::Distance(Position, DecodedPosition));
+        OutReport.MaxNormalErrorDegrees = FMath::Max(OutReport.MaxNormalErrorDegrees, AngleDegrees(Normal, DecodedNormal));
+        OutReport.MaxTangentErrorDegrees = FMath::Max(OutReport.MaxTangentErrorDegrees, AngleDegrees(Tangent, DecodedTangent));
+        OutReport.MaxUVError = FMath::Max(OutReport.MaxUVError, FMath::Max(FMath::Abs(U.GetFloat() - Vertex.UV[0]), FMath::Abs(V.GetFloat() - Vertex.UV[1])));
+    }
+}
@@ -0,0 +1,27 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "REngineFormat.h"
+
+/** Largest differences between the source vertices and the decoded compact vertices of one LOD */
+struct FVertexQuantizationReport
+{
+    float MaxPositionError = 0.0f;
+    float MaxNormalErrorDegrees = 0.0f;
+    float MaxTangentErrorDegrees = 0.0f;
+    float MaxUVError = 0.0f;
+};
+
+/** Map a unit vector to the [-1, 1] square of the octahedral parameterization and back */
+FVector2f OctahedronEncode(const FVector3f& Vector);
+FVector3f OctahedronDecode(const FVector2f& Encoded);
+
+/** Descriptors of the plain float layouts */
+REngineFormat::VertexFormat GetStaticMeshVertexFormat();
+REngineFormat::VertexFormat GetSkeletalMeshVertexFormat();
+
+/** Quantize a LOD to the compact layout, fill its descriptor and measure the error of the round trip */
+void CompactStaticMeshVertices(const TArray<REngineFormat::StaticMeshVertex>& Vertices, TArray<REngineFormat::CompactStaticMeshVertex>& OutVertices,
+    REngineFormat::VertexFormat& OutFormat, FVertexQuantizationReport& OutReport);
@@ -39,6 +39,10 @@ class UObjectExporterBPLibrary : public UBlueprintFunctionLibrary
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "Export AnimSequence", Keywords = "Export AnimSequence"), Category = "UObjectExporter")
     static bool ExportAnimSequence(const UAnimSequence* AnimSequence, const FString& FullFilePathName);
 
+    /** Bake the sequence playing on the mesh into a .vat animation texture, in the mode of the project settings and bone matrices when they disable it */
+    UFUNCTION(BlueprintCallable, meta = (DisplayName = "Export Animation Texture", Keywords = "Export Animation Texture VAT"), Category = "UObjectExporter")
+    static bool ExportAnimTexture(const USkeletalMesh* SkeletalMesh, const UAnimSequence* AnimSequence, const FString& FullFilePathName);
+
     UFUNCTION(BlueprintCallable, meta = (DisplayName = "Export Camera", Keywords = "Export Camera"), Category = "UObjectExporter")
     static bool ExportCamera(const UCameraComponent* Camera, const FString& FullFilePathName);
 
@@ -0,0 +1,168 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Engine/DeveloperSettings.h"
+#include "ObjectExporterSettings.generated.h"
+
+/** What ExportMap bakes into an animation texture for every skeletal mesh actor and its animation */
+UENUM()
+enum class EAnimationTextureMode : uint8
+{
+    Disabled,
+    /** Skinning matrix of every bone per frame, the mesh is still skinned in the vertex shader but no pose is evaluated on the CPU */
+    BoneMatrices,
+    /** Skinned position and normal of every vertex per frame, the vertex shader only reads them. Grows with the vertex count */
+    VertexPositions,
+};
+
+/** How ExportMap splits a map into cells streamed in by camera distance */
+UENUM()
+enum class EMapPartitionMode : uint8
+{
+    /** Every actor in the .map */
+    Disabled,
+    /** Square cells of MapCellSize */
+    UniformGrid,
+    /** Cells split into quadrants while they hold more than MaxActorsPerMapCell actors, dense areas get small cells */
+    Quadtree,
+};
+
+/*
+*   Project settings of the exporter, shown under Plugins > Object Exporter.
+*   Every format option is off by default so the exported files keep their plain layout unless a project opts in.
+*/
+UCLASS(config = ObjectExporter, defaultconfig, meta = (DisplayName = "Object Exporter"))
+class UObjectExporterSettings : public UDeveloperSettings
+{
+    GENERATED_BODY()
+
+public:
+    UObjectExporterSettings();
+
+    virtual FName GetCategoryName() const override { return FName("Plugins"); }
+
+    /** Write static mesh vertices as 16 bit bounds relative positions, octahedral normal and tangent, half UVs, and use 16 bit indices when possible */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh")
+    bool bCompactVertexFormat;
+
+    /** Reorder mesh triangles for the post transform vertex cache and front to back drawing, then vertices in order of first use */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh")
+    bool bOptimizeMeshes;
+
+    /** Split static mesh sections into meshlets with a bounding sphere and normal cone for cluster culling */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh")
+    bool bExportMeshlets;
+
+    /** Store the vertex, index, skeleton and animation streams filtered and LZ4 compressed, readers decode them with REngineCodec.h */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh")
+    bool bCompressGeometry;
+
+    /** Bones one skeletal mesh section may use, the size of the bone matrix array of the skinning shader. Sections with more bones are split, never below three times MaxBoneInfluences */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh", meta = (ClampMin = "12", ClampMax = "256"))
+    int32 MaxBonesPerSection;
+
+    /** Influences a skeletal mesh vertex may keep. Above 4 the vertices are sorted into 1, 2, 4, 8 and 12 influence buckets per section and the influences past the fourth are written beside the vertices */
+    UPROPERTY(config, EditAnywhere, Category = "Mesh", meta = (ClampMin = "4", ClampMax = "12"))
+    int32 MaxBoneInfluences;
+
+    /** Compress color textures to BC7 instead of BC1 or BC3 */
+    UPROPERTY(config, EditAnywhere, Category = "Texture")
+    bool bHighQualityTextures;
+
+    /** Scale the alpha of every mip so as many texels pass AlphaCoverageThreshold as in the top mip, for alpha tested foliage and hair. Textures with Scale Mips For Alpha Coverage use their own threshold */
+    UPROPERTY(config, EditAnywhere, Category = "Texture")
+    bool bPreserveAlphaCoverage;
+
+    /** Alpha below which an alpha tested texel is clipped, usually the opacity mask clip value of the materials */
+    UPROPERTY(config, EditAnywhere, Category = "Texture", meta = (ClampMin = "0", ClampMax = "1", EditCondition = "bPreserveAlphaCoverage"))
+    float AlphaCoverageThreshold;
+
+    /** Strip constant tracks, reduce keys and quantize them to 16 bits in exported animation sequences */
+    UPROPERTY(config, EditAnywhere, Category = "Animation")
+    bool bCompressAnimations;
+
+    /** Largest distance a skinned vertex may move compared to the raw animation, measured in component space */
+    UPROPERTY(config, EditAnywhere, Category = "Animation", meta = (ClampMin = "0", Units = "cm", EditCondition = "bCompressAnimations"))
+    float AnimationErrorTolerance;
+
+    /** Distance from every bone of the virtual vertices the error is measured on, about the thickness of the skin around the bones */
+    UPROPERTY(config, EditAnywhere, Category = "Animation", meta = (ClampMin = "0", Units = "cm", EditCondition = "bCompressAnimations"))
+    float AnimationShellDistance;
+
+    /** Write animation sequences frame major, every frame holds all bones as structure of arrays in blocks of AnimationFramesPerBlock frames. Used instead of bCompressAnimations */
+    UPROPERTY(config, EditAnywhere, Category = "Animation")
+    bool bFrameMajorAnimations;
+
+    /** Frames in one block of a frame major sequence, the unit a runtime streams or decompresses */
+    UPROPERTY(config, EditAnywhere, Category = "Animation", meta = (ClampMin = "1", ClampMax = "256", EditCondition = "bFrameMajorAnimations"))
+    int32 AnimationFramesPerBlock;
+
+    /** Bake the animation of every skeletal mesh actor into a texture played back in the vertex shader, for background crowds */
+    UPROPERTY(config, EditAnywhere, Category = "Animation Texture")
+    EAnimationTextureMode AnimationTextureMode;
+
+    /** Frames per second the sequence is sampled at, the texture height grows with it */
+    UPROPERTY(config, EditAnywhere, Category = "Animation Texture", meta = (ClampMin = "1", ClampMax = "120", EditCondition = "AnimationTextureMode != EAnimationTextureMode::Disabled"))
+    float AnimationTextureFrameRate;
+
+    /** Store 32 bit floats instead of halfs, twice the size. Halfs keep about 1/2048 of a value, 0.1 cm at 2 m from the origin */
+    UPROPERTY(config, EditAnywhere, Category = "Animation Texture", meta = (EditCondition = "AnimationTextureMode != EAnimationTextureMode::Disabled"))
+    bool bFullPrecisionAnimationTextures;
+
+    /** Keep a normal per vertex and frame in vertex animation textures, without it the shader lights the bind pose normals */
+    UPROPERTY(config, EditAnywhere, Category = "Animation Texture", meta = (EditCondition = "AnimationTextureMode == EAnimationTextureMode::VertexPositions"))
+    bool bAnimationTextureNormals;
+
+    /** Widest texture row, frames with more texels wrap to the next rows */
+    UPROPERTY(config, EditAnywhere, Category = "Animation Texture", meta = (ClampMin = "64", ClampMax = "16384", EditCondition = "AnimationTextureMode != EAnimationTextureMode::Disabled"))
+    int32 AnimationTextureWidth;
+
+    /** Group static mesh actors sharing mesh, materials and LOD settings into instance batches, drawn with one call per batch section */
+    UPROPERTY(config, EditAnywhere, Category = "Map")
+    bool bInstanceStaticMeshes;
+
+    /** Most instances of a batch, larger groups are split into batches of nearby actors so they can still be culled */
+    UPROPERTY(config, EditAnywhere, Category = "Map", meta = (ClampMin = "1", ClampMax = "65536", EditCondition = "bInstanceStaticMeshes"))
+    int32 MaxInstancesPerBatch;
+
+    /** Merge small static mesh actors into world space geometry per grid cell and material, drawn with one call per cell section instead of per actor */
+    UPROPERTY(config, EditAnywhere, Category = "Map")
+    bool bMergeSmallStaticMeshes;
+
+    /** Edge of the grid cells merged geometry is grouped by, larger cells save more draws and cull coarser */
+    UPROPERTY(config, EditAnywhere, Category = "Map", meta = (ClampMin = "100", Units = "cm", EditCondition = "bMergeSmallStaticMeshes"))
+    float MergeCellSize;
+
+    /** Largest bounding sphere radius of a merged actor */
+    UPROPERTY(config, EditAnywhere, Category = "Map", meta = (ClampMin = "0", Units = "cm", EditCondition = "bMergeSmallStaticMeshes"))
+    float MergeMaxActorRadius;
+
+    /** Most triangles of the LOD 0 of a merged actor, every copy of a merged mesh costs its full geometry */
+    UPROPERTY(config, EditAnywhere, Category = "Map", meta = (ClampMin = "1", EditCondition = "bMergeSmallStaticMeshes"))
+    int32 MergeMaxTriangles;
+
+    /** Write the actors to cell files next to the .map, which only keeps the cell bounds, so a runtime loads the cells and their assets near the camera */
+    UPROPERTY(config, EditAnywhere, Category = "Map Streaming")
+    EMapPartitionMode MapPartitionMode;
+
+    /** Edge of a uniform grid cell, or the smallest quadtree cell */
+    UPROPERTY(config, EditAnywhere, Category = "Map Streaming", meta = (ClampMin = "100", Units = "cm", EditCondition = "MapPartitionMode != EMapPartitionMode::Disabled"))
+    float MapCellSize;
+
+    /** Quadtree cells with more actors are split */
+    UPROPERTY(config, EditAnywhere, Category = "Map Streaming", meta = (ClampMin = "1", EditCondition = "MapPartitionMode == EMapPartitionMode::Quadtree"))
+    int32 MaxActorsPerMapCell;
+
+    /** Distance from the camera to the bounds of a cell below which a runtime keeps it loaded */
+    UPROPERTY(config, EditAnywhere, Category = "Map Streaming", meta = (ClampMin = "0", Units = "cm", EditCondition = "MapPartitionMode != EMapPartitionMode::Disabled"))
+    float MapCellLoadDistance;
+
+    /** Ignore the export manifest and rewrite every file ExportMap references, assets are still exported once per run */
+    UPROPERTY(config, EditAnywhere, Category = "Export")
+    bool bForceFullExport;
+
+    /** Memory for asset snapshots waiting for or in ExportMap worker tasks, the game thread stops snapshotting above it. 0 exports on the game thread */
+    UPROPERTY(config, EditAnywhere, Category = "Export", meta = (ClampMin = "0", Units = "MB"))
+    int32 ExportMemoryBudgetMB;
+};
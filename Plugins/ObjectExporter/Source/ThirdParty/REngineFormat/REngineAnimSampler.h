@@ -0,0 +1,312 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "REngineFormat.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+// Define RENGINE_ANIM_SAMPLER_SSE to 0 to build the scalar sampler where SSE is available, the tests build both
+#ifndef RENGINE_ANIM_SAMPLER_SSE
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define RENGINE_ANIM_SAMPLER_SSE 1
+#else
+#define RENGINE_ANIM_SAMPLER_SSE 0
+#endif
+#endif
+
+#if RENGINE_ANIM_SAMPLER_SSE
+#include <emmintrin.h>
+#endif
+
+/*
+*   Pose sampling of exported animation sequences.
+*   A pose is AnimFrameStreams arrays of NumLanes floats, the same layout as one frame of a frame major sequence, so
+*   sampling a block is a lerp between two frames over all bones at once.
+*
+*   AnimBlockLayout Layout = MakeAnimBlockLayout(Info.NumFrames, Tracks.size(), 16);
+*   BuildAnimBlocks(Layout, Keys, LaneBones.data(), Blocks.data());
+*   SampleBlockPose(Layout, Blocks.data(), Time * Layout.NumFrames / Info.SequenceLength, Pose.data());
+*
+*   SampleTrackPose samples the track layout with the same result and is the reference the block sampler is checked against.
+*/
+namespace REngineFormat
+{
+    /** Tracks and key streams of a sequence in the track layout, keys are float3 and float4 as in the PosKeys, RotKeys and ScaleKeys chunks */
+    struct AnimTrackKeys
+    {
+        const AnimTrack* Tracks;
+        uint32_t NumTracks;
+        const float* PosKeys;
+        const float* RotKeys;
+        const float* ScaleKeys;
+    };
+
+    inline size_t GetAnimPoseFloats(uint32_t NumLanes)
+    {
+        return size_t(AnimFrameStreams) * NumLanes;
+    }
+
+    inline size_t GetAnimBlockFloats(const AnimBlockLayout& Layout)
+    {
+        return size_t(Layout.FramesPerBlock + 1) * GetAnimPoseFloats(Layout.NumLanes);
+    }
+
+    inline size_t GetAnimBlocksFloats(const AnimBlockLayout& Layout)
+    {
+        return size_t(Layout.NumBlocks) * GetAnimBlockFloats(Layout);
+    }
+
+    inline AnimBlockLayout MakeAnimBlockLayout(uint32_t NumFrames, uint32_t NumTracks, uint32_t FramesPerBlock)
+    {
+        AnimBlockLayout Layout;
+        Layout.NumFrames = NumFrames > 0 ? NumFrames : 1;
+        Layout.FramesPerBlock = FramesPerBlock > 0 ? FramesPerBlock : 1;
+        Layout.NumBlocks = Layout.NumFrames > 1 ? (Layout.NumFrames - 1 + Layout.FramesPerBlock - 1) / Layout.FramesPerBlock : 1;
+        Layout.NumLanes = (NumTracks + AnimLaneWidth - 1) / AnimLaneWidth * AnimLaneWidth;
+
+        return Layout;
+    }
+
+    /** Bone transform of one lane of a pose */
+    inline BoneTransform GetPoseTransform(const float* Pose, uint32_t NumLanes, uint32_t Lane)
+    {
+        BoneTransform Transform;
+        for (uint32_t Component = 0; Component < 4; Component++)
+        {
+            Transform.Rotation[Component] = Pose[Component * NumLanes + Lane];
+        }
+        for (uint32_t Component = 0; Component < 3; Component++)
+        {
+            Transform.Translation[Component] = Pose[(4 + Component) * NumLanes + Lane];
+            Transform.Scale[Component] = Pose[(7 + Component) * NumLanes + Lane];
+        }
+
+        return Transform;
+    }
+
+    namespace AnimSamplerDetail
+    {
+        /** Keys around a frame of a channel with one key per frame, or its only key */
+        inline void FindKeys(uint32_t NumKeys, float Frame, uint32_t& OutKey0, uint32_t& OutKey1, float& OutAlpha)
+        {
+            const float LastKey = float(NumKeys - 1);
+            const float Clamped = Frame < 0.0f ? 0.0f : (Frame > LastKey ? LastKey : Frame);
+            OutKey0 = uint32_t(Clamped);
+            OutKey1 = OutKey0 + 1 < NumKeys ? OutKey0 + 1 : OutKey0;
+            OutAlpha = Clamped - float(OutKey0);
+        }
+
+        inline void SampleVectorChannel(const float* Keys, uint32_t FirstKey, uint32_t NumKeys, float Frame, float Default, float* OutPose, uint32_t NumLanes, uint32_t Lane)
+        {
+            if (NumKeys == 0)
+            {
+                for (uint32_t Component = 0; Component < 3; Component++)
+                {
+                    OutPose[Component * NumLanes + Lane] = Default;
+                }
+                return;
+            }
+
+            uint32_t Key0, Key1;
+            float Alpha;
+            FindKeys(NumKeys, Frame, Key0, Key1, Alpha);
+            const float* Value0 = Keys + size_t(FirstKey + Key0) * 3;
+            const float* Value1 = Keys + size_t(FirstKey + Key1) * 3;
+            for (uint32_t Component = 0; Component < 3; Component++)
+            {
+                OutPose[Component * NumLanes + Lane] = Value0[Component] + (Value1[Component] - Value0[Component]) * Alpha;
+            }
+        }
+
+        inline void SetIdentity(float* OutPose, uint32_t NumLanes, uint32_t Lane)
+        {
+            static const float Identity[AnimFrameStreams] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+            for (uint32_t Stream = 0; Stream < AnimFrameStreams; Stream++)
+            {
+                OutPose[Stream * NumLanes + Lane] = Identity[Stream];
+            }
+        }
+    }
+
+    /**
+    *   Reference sampler of the track layout, one bone after the other. Lane i is track i, lanes past the tracks get the identity.
+    *   Channels without keys give the identity, a single key holds for the whole sequence. Rotations are a normalized lerp along the shortest path.
+    */
+    inline void SampleTrackPose(const AnimTrackKeys& Keys, float Frame, uint32_t NumLanes, float* OutPose)
+    {
+        using namespace AnimSamplerDetail;
+
+        for (uint32_t Lane = 0; Lane < NumLanes; Lane++)
+        {
+            if (Lane >= Keys.NumTracks)
+            {
+                SetIdentity(OutPose, NumLanes, Lane);
+                continue;
+            }
+
+            const AnimTrack& Track = Keys.Tracks[Lane];
+            if (Track.NumRotKeys == 0)
+            {
+                for (uint32_t Component = 0; Component < 4; Component++)
+                {
+                    OutPose[Component * NumLanes + Lane] = Component == 3 ? 1.0f : 0.0f;
+                }
+            }
+            else
+            {
+                uint32_t Key0, Key1;
+                float Alpha;
+                FindKeys(Track.NumRotKeys, Frame, Key0, Key1, Alpha);
+                const float* Rotation0 = Keys.RotKeys + size_t(Track.FirstRotKey + Key0) * 4;
+                const float* Rotation1 = Keys.RotKeys + size_t(Track.FirstRotKey + Key1) * 4;
+
+                const float Dot = Rotation0[0] * Rotation1[0] + Rotation0[1] * Rotation1[1] + Rotation0[2] * Rotation1[2] + Rotation0[3] * Rotation1[3];
+                const float Sign = Dot < 0.0f ? -1.0f : 1.0f;
+                float Rotation[4];
+                float LengthSquared = 0.0f;
+                for (uint32_t Component = 0; Component < 4; Component++)
+                {
+                    Rotation[Component] = Rotation0[Component] + (Rotation1[Component] * Sign - Rotation0[Component]) * Alpha;
+                    LengthSquared += Rotation[Component] * Rotation[Component];
+                }
+
+                const float InvLength = LengthSquared > 0.0f ? 1.0f / std::sqrt(LengthSquared) : 0.0f;
+                for (uint32_t Component = 0; Component < 4; Component++)
+                {
+                    OutPose[Component * NumLanes + Lane] = Rotation[Component] * InvLength;
+                }
+            }
+
+            SampleVectorChannel(Keys.PosKeys, Track.FirstPosKey, Track.NumPosKeys, Frame, 0.0f, OutPose + 4 * NumLanes, NumLanes, Lane);
+            SampleVectorChannel(Keys.ScaleKeys, Track.FirstScaleKey, Track.NumScaleKeys, Frame, 1.0f, OutPose + 7 * NumLanes, NumLanes, Lane);
+        }
+    }
+
+    /**
+    *   Fill the lane bones (NumLanes Int32) and the blocks (GetAnimBlocksFloats floats) of a frame major sequence from the track layout.
+    *   Every frame is sampled with SampleTrackPose, then its rotations are flipped into the hemisphere of the previous frame.
+    */
+    inline void BuildAnimBlocks(const AnimBlockLayout& Layout, const AnimTrackKeys& Keys, int32_t* OutLaneBones, float* OutBlocks)
+    {
+        const uint32_t NumLanes = Layout.NumLanes;
+        const size_t PoseFloats = GetAnimPoseFloats(NumLanes);
+        const size_t BlockFloats = GetAnimBlockFloats(Layout);
+
+        for (uint32_t Lane = 0; Lane < NumLanes; Lane++)
+        {
+            OutLaneBones[Lane] = Lane < Keys.NumTracks ? Keys.Tracks[Lane].BoneIndex : -1;
+        }
+
+        const float* Previous = nullptr;
+        for (uint32_t Block = 0; Block < Layout.NumBlocks; Block++)
+        {
+            for (uint32_t BlockFrame = 0; BlockFrame <= Layout.FramesPerBlock; BlockFrame++)
+            {
+                float* Pose = OutBlocks + Block * BlockFloats + BlockFrame * PoseFloats;
+
+                // The first frame of a block is the last of the previous one
+                if (BlockFrame == 0 && Previous != nullptr)
+                {
+                    memcpy(Pose, Previous, PoseFloats * sizeof(float));
+                    continue;
+                }
+
+                const uint32_t Frame = Block * Layout.FramesPerBlock + BlockFrame;
+                SampleTrackPose(Keys, float(Frame < Layout.NumFrames ? Frame : Layout.NumFrames - 1), NumLanes, Pose);
+
+                if (Previous != nullptr)
+                {
+                    for (uint32_t Lane = 0; Lane < NumLanes; Lane++)
+                    {
+                        float Dot = 0.0f;
+                        for (uint32_t Component = 0; Component < 4; Component++)
+                        {
+                            Dot += Pose[Component * NumLanes + Lane] * Previous[Component * NumLanes + Lane];
+                        }
+                        if (Dot < 0.0f)
+                        {
+                            for (uint32_t Component = 0; Component < 4; Component++)
+                            {
+                                Pose[Component * NumLanes + Lane] = -Pose[Component * NumLanes + Lane];
+                            }
+                        }
+                    }
+                }
+                Previous = Pose;
+            }
+        }
+    }
+
+    /** Pose of a frame major sequence at a frame, fractional frames interpolate, AnimLaneWidth bones per instruction where SSE is available */
+    inline void SampleBlockPose(const AnimBlockLayout& Layout, const float* Blocks, float Frame, float* OutPose)
+    {
+        const uint32_t NumLanes = Layout.NumLanes;
+        const float LastFrame = float(Layout.NumFrames - 1);
+        const float Clamped = Frame < 0.0f ? 0.0f : (Frame > LastFrame ? LastFrame : Frame);
+
+        uint32_t Block = uint32_t(Clamped) / Layout.FramesPerBlock;
+        Block = Block < Layout.NumBlocks ? Block : Layout.NumBlocks - 1;
+        const float BlockFrame = Clamped - float(Block * Layout.FramesPerBlock);
+        uint32_t Frame0 = uint32_t(BlockFrame);
+        Frame0 = Frame0 < Layout.FramesPerBlock ? Frame0 : Layout.FramesPerBlock - 1;
+        const float Alpha = BlockFrame - float(Frame0);
+
+        const size_t PoseFloats = GetAnimPoseFloats(NumLanes);
+        const float* Pose0 = Blocks + Block * GetAnimBlockFloats(Layout) + Frame0 * PoseFloats;
+        const float* Pose1 = Pose0 + PoseFloats;
+
+#if RENGINE_ANIM_SAMPLER_SSE
+        const __m128 AlphaV = _mm_set1_ps(Alpha);
+        const __m128 One = _mm_set1_ps(1.0f);
+        for (uint32_t Lane = 0; Lane < NumLanes; Lane += AnimLaneWidth)
+        {
+            __m128 Rotation[4];
+            __m128 LengthSquared = _mm_setzero_ps();
+            for (uint32_t Component = 0; Component < 4; Component++)
+            {
+                const size_t Offset = Component * NumLanes + Lane;
+                const __m128 Value0 = _mm_loadu_ps(Pose0 + Offset);
+                const __m128 Value1 = _mm_loadu_ps(Pose1 + Offset);
+                Rotation[Component] = _mm_add_ps(Value0, _mm_mul_ps(_mm_sub_ps(Value1, Value0), AlphaV));
+                LengthSquared = _mm_add_ps(LengthSquared, _mm_mul_ps(Rotation[Component], Rotation[Component]));
+            }
+
+            const __m128 InvLength = _mm_div_ps(One, _mm_sqrt_ps(LengthSquared));
+            for (uint32_t Component = 0; Component < 4; Component++)
+            {
+                _mm_storeu_ps(OutPose + Component * NumLanes + Lane, _mm_mul_ps(Rotation[Component], InvLength));
+            }
+
+            for (uint32_t Stream = 4; Stream < AnimFrameStreams; Stream++)
+            {
+                const size_t Offset = Stream * NumLanes + Lane;
+                const __m128 Value0 = _mm_loadu_ps(Pose0 + Offset);
+                const __m128 Value1 = _mm_loadu_ps(Pose1 + Offset);
+                _mm_storeu_ps(OutPose + Offset, _mm_add_ps(Value0, _mm_mul_ps(_mm_sub_ps(Value1, Value0), AlphaV)));
+            }
+        }
+#else
+        for (size_t Index = 0; Index < PoseFloats; Index++)
+        {
+            OutPose[Index] = Pose0[Index] + (Pose1[Index] - Pose0[Index]) * Alpha;
+        }
+        for (uint32_t Lane = 0; Lane < NumLanes; Lane++)
+        {
+            float LengthSquared = 0.0f;
+            for (uint32_t Component = 0; Component < 4; Component++)
+            {
+                LengthSquared += OutPose[Component * NumLanes + Lane] * OutPose[Component * NumLanes + Lane];
+            }
+
+            const float InvLength = 1.0f / std::sqrt(LengthSquared);
+            for (uint32_t Component = 0; Component < 4; Component++)
+            {
+                OutPose[Component * NumLanes + Lane] *= InvLength;
+            }
+        }
+#endif
+    }
+}
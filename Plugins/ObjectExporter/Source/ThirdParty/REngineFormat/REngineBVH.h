@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "REngineFormat.h"
+
+#include <cmath>
+#include <cstdint>
+
+/*
+*   Frustum culling of the actors of an exported map through its BVHNodes and BVHItems chunks.
+*   The nodes are walked front to back without a stack: an outside node jumps to its Skip node, a node fully inside
+*   hands out all items of its subtree without testing them, and only the items of leaves crossing a plane are tested.
+*
+*   CullBVH(Nodes.data(), Nodes.size(), Items.data(), Items.size(), Bounds.data(), Planes, [&](uint32_t Actor) { Draw(Actor); });
+*/
+namespace REngineFormat
+{
+    constexpr uint32_t MaxCullingPlanes = 6;
+
+    /** Planes facing into the view volume, a point P is inside when dot(Normal, P) >= Distance for every plane */
+    struct CullingPlanes
+    {
+        float Normals[MaxCullingPlanes][3];
+        float Distances[MaxCullingPlanes];
+        uint32_t NumPlanes;
+    };
+
+    enum class ECullResult : uint32_t
+    {
+        Outside = 0,
+        Intersecting,
+        Inside,
+    };
+
+    inline ECullResult CullBox(const CullingPlanes& Planes, const float Center[3], const float Extent[3])
+    {
+        ECullResult Result = ECullResult::Inside;
+        for (uint32_t Plane = 0; Plane < Planes.NumPlanes; Plane++)
+        {
+            const float* Normal = Planes.Normals[Plane];
+            const float Distance = Normal[0] * Center[0] + Normal[1] * Center[1] + Normal[2] * Center[2] - Planes.Distances[Plane];
+            const float Radius = std::fabs(Normal[0]) * Extent[0] + std::fabs(Normal[1]) * Extent[1] + std::fabs(Normal[2]) * Extent[2];
+            if (Distance < -Radius)
+            {
+                return ECullResult::Outside;
+            }
+            if (Distance < Radius)
+            {
+                Result = ECullResult::Intersecting;
+            }
+        }
+
+        return Result;
+    }
+
+    /** Call Visit with every item whose box is not fully outside the planes, ItemBounds are indexed by item */
+    template<typename VisitorType>
+    inline void CullBVH(const MapBVHNode* Nodes, uint32_t NumNodes, const uint32_t* Items, uint32_t NumItems, const MapActorBounds* ItemBounds,
+        const CullingPlanes& Planes, VisitorType&& Visit)
+    {
+        uint32_t NodeIndex = 0;
+        while (NodeIndex < NumNodes)
+        {
+            const MapBVHNode& Node = Nodes[NodeIndex];
+            const ECullResult Result = CullBox(Planes, Node.Center, Node.Extent);
+            if (Result == ECullResult::Outside)
+            {
+                NodeIndex = Node.Skip;
+                continue;
+            }
+
+            const bool bLeaf = Node.Skip == NodeIndex + 1;
+            if (Result == ECullResult::Inside || bLeaf)
+            {
+                const uint32_t EndItem = Node.Skip < NumNodes ? Nodes[Node.Skip].FirstItem : NumItems;
+                for (uint32_t ItemIndex = Node.FirstItem; ItemIndex < EndItem; ItemIndex++)
+                {
+                    const uint32_t Item = Items[ItemIndex];
+                    if (Result == ECullResult::Inside || CullBox(Planes, ItemBounds[Item].Center, ItemBounds[Item].Extent) != ECullResult::Outside)
+                    {
+                        Visit(Item);
+                    }
+                }
+
+                NodeIndex = Node.Skip;
+            }
+            else
+            {
+                NodeIndex++;
+            }
+        }
+    }
+}
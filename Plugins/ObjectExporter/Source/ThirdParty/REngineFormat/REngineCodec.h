@@ -0,0 +1,294 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "REngineFormat.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/*
+*   Codec of compressed chunk payloads (ChunkFlags::Compressed).
+*   The writer filters the elements so that similar bytes line up, then compresses them as one LZ4 block.
+*   Decoding is a plain LZ4 block decode followed by one pass that undoes the filter, both run at memory
+*   speed so compressed files load faster than raw ones from any storage slower than RAM.
+*/
+namespace REngineFormat
+{
+    inline bool IsChunkCompressed(const ChunkEntry& Chunk)
+    {
+        return (Chunk.Flags & ChunkFlags::Compressed) != 0;
+    }
+
+    inline EChunkFilter GetChunkFilter(const ChunkEntry& Chunk)
+    {
+        return EChunkFilter((Chunk.Flags & ChunkFlags::FilterMask) >> ChunkFlags::FilterShift);
+    }
+
+    inline bool IsChunkFilterSupported(EChunkFilter Filter, uint32_t ElementSize)
+    {
+        switch (Filter)
+        {
+        case EChunkFilter::None:
+            return true;
+        case EChunkFilter::IndexDelta:
+            return ElementSize == 2 || ElementSize == 4;
+        case EChunkFilter::BytePlaneDelta:
+            return ElementSize > 0;
+        default:
+            return false;
+        }
+    }
+
+    namespace CodecDetail
+    {
+        template<typename IndexType>
+        inline void EncodeIndexDelta(const uint8_t* In, uint8_t* Out, size_t Count)
+        {
+            constexpr uint32_t Bits = sizeof(IndexType) * 8;
+
+            IndexType Previous = 0;
+            for (size_t Element = 0; Element < Count; Element++)
+            {
+                IndexType Value;
+                memcpy(&Value, In + Element * sizeof(IndexType), sizeof(IndexType));
+
+                // Zigzag keeps small negative deltas small
+                const IndexType Delta = IndexType(Value - Previous);
+                const IndexType ZigZag = IndexType((Delta << 1) ^ (0 - (Delta >> (Bits - 1))));
+                Previous = Value;
+
+                for (size_t Byte = 0; Byte < sizeof(IndexType); Byte++)
+                {
+                    Out[Byte * Count + Element] = uint8_t(ZigZag >> (Byte * 8));
+                }
+            }
+        }
+
+        template<typename IndexType>
+        inline void DecodeIndexDelta(const uint8_t* In, uint8_t* Out, size_t Count)
+        {
+            IndexType Previous = 0;
+            for (size_t Element = 0; Element < Count; Element++)
+            {
+                IndexType ZigZag = 0;
+                for (size_t Byte = 0; Byte < sizeof(IndexType); Byte++)
+                {
+                    ZigZag |= IndexType(IndexType(In[Byte * Count + Element]) << (Byte * 8));
+                }
+
+                Previous = IndexType(Previous + IndexType((ZigZag >> 1) ^ (0 - (ZigZag & 1))));
+                memcpy(Out + Element * sizeof(IndexType), &Previous, sizeof(IndexType));
+            }
+        }
+
+        inline size_t ReadLength(const uint8_t*& Input, const uint8_t* InputEnd, size_t Length, bool& bValid)
+        {
+            if (Length == 15)
+            {
+                uint8_t Byte;
+                do
+                {
+                    if (Input >= InputEnd)
+                    {
+                        bValid = false;
+                        return 0;
+                    }
+                    Byte = *Input++;
+                    Length += Byte;
+                } while (Byte == 255);
+            }
+            return Length;
+        }
+    }
+
+    /** Apply the filter to Count elements, In and Out must not overlap */
+    inline void EncodeChunkFilter(EChunkFilter Filter, const uint8_t* In, uint8_t* Out, size_t Count, uint32_t ElementSize)
+    {
+        if (Filter == EChunkFilter::IndexDelta && ElementSize == 2)
+        {
+            CodecDetail::EncodeIndexDelta<uint16_t>(In, Out, Count);
+        }
+        else if (Filter == EChunkFilter::IndexDelta && ElementSize == 4)
+        {
+            CodecDetail::EncodeIndexDelta<uint32_t>(In, Out, Count);
+        }
+        else if (Filter == EChunkFilter::BytePlaneDelta)
+        {
+            for (uint32_t Byte = 0; Byte < ElementSize; Byte++)
+            {
+                uint8_t* Plane = Out + Byte * Count;
+                uint8_t Previous = 0;
+                for (size_t Element = 0; Element < Count; Element++)
+                {
+                    const uint8_t Value = In[Element * ElementSize + Byte];
+                    Plane[Element] = uint8_t(Value - Previous);
+                    Previous = Value;
+                }
+            }
+        }
+        else
+        {
+            memcpy(Out, In, Count * ElementSize);
+        }
+    }
+
+    /** Undo EncodeChunkFilter, In and Out must not overlap */
+    inline void DecodeChunkFilter(EChunkFilter Filter, const uint8_t* In, uint8_t* Out, size_t Count, uint32_t ElementSize)
+    {
+        if (Filter == EChunkFilter::IndexDelta && ElementSize == 2)
+        {
+            CodecDetail::DecodeIndexDelta<uint16_t>(In, Out, Count);
+        }
+        else if (Filter == EChunkFilter::IndexDelta && ElementSize == 4)
+        {
+            CodecDetail::DecodeIndexDelta<uint32_t>(In, Out, Count);
+        }
+        else if (Filter == EChunkFilter::BytePlaneDelta)
+        {
+            for (uint32_t Byte = 0; Byte < ElementSize; Byte++)
+            {
+                const uint8_t* Plane = In + Byte * Count;
+                uint8_t Previous = 0;
+                for (size_t Element = 0; Element < Count; Element++)
+                {
+                    Previous = uint8_t(Previous + Plane[Element]);
+                    Out[Element * ElementSize + Byte] = Previous;
+                }
+            }
+        }
+        else
+        {
+            memcpy(Out, In, Count * ElementSize);
+        }
+    }
+
+    /** Decode one LZ4 block, fails unless the block decodes to exactly OutputSize bytes */
+    inline bool DecompressLZ4Block(const uint8_t* Input, size_t InputSize, uint8_t* Output, size_t OutputSize)
+    {
+        const uint8_t* InputEnd = Input + InputSize;
+        uint8_t* const OutputStart = Output;
+        uint8_t* const OutputEnd = Output + OutputSize;
+        bool bValid = true;
+
+        while (Input < InputEnd)
+        {
+            const uint32_t Token = *Input++;
+
+            // Literals, short runs far from both ends are copied with one fixed size copy
+            const size_t LiteralLength = CodecDetail::ReadLength(Input, InputEnd, Token >> 4, bValid);
+            if (!bValid || LiteralLength > size_t(InputEnd - Input) || LiteralLength > size_t(OutputEnd - Output))
+            {
+                return false;
+            }
+            if (LiteralLength <= 16 && InputEnd - Input >= 16 && OutputEnd - Output >= 16)
+            {
+                memcpy(Output, Input, 16);
+            }
+            else
+            {
+                memcpy(Output, Input, LiteralLength);
+            }
+            Output += LiteralLength;
+            Input += LiteralLength;
+
+            // The last sequence has no match
+            if (Input == InputEnd)
+            {
+                break;
+            }
+
+            // Match
+            if (InputEnd - Input < 2)
+            {
+                return false;
+            }
+            const size_t Offset = size_t(Input[0]) | (size_t(Input[1]) << 8);
+            Input += 2;
+
+            const size_t MatchLength = CodecDetail::ReadLength(Input, InputEnd, Token & 15, bValid) + 4;
+            if (!bValid || Offset == 0 || Offset > size_t(Output - OutputStart) || MatchLength > size_t(OutputEnd - Output))
+            {
+                return false;
+            }
+
+            const uint8_t* Match = Output - Offset;
+            if (Offset >= 16 && size_t(OutputEnd - Output) >= MatchLength + 16)
+            {
+                // Each 16 byte step reads bytes that are already written and may run past the match into free output
+                for (size_t Copied = 0; Copied < MatchLength; Copied += 16)
+                {
+                    memcpy(Output + Copied, Match + Copied, 16);
+                }
+            }
+            else if (Offset >= MatchLength)
+            {
+                memcpy(Output, Match, MatchLength);
+            }
+            else if (Offset >= 8)
+            {
+                // Every 8 byte step reads bytes that are already written
+                size_t Copied = 0;
+                for (; Copied + 8 <= MatchLength; Copied += 8)
+                {
+                    memcpy(Output + Copied, Match + Copied, 8);
+                }
+                for (; Copied < MatchLength; Copied++)
+                {
+                    Output[Copied] = Match[Copied];
+                }
+            }
+            else
+            {
+                for (size_t Copied = 0; Copied < MatchLength; Copied++)
+                {
+                    Output[Copied] = Match[Copied];
+                }
+            }
+            Output += MatchLength;
+        }
+
+        return Output == OutputEnd;
+    }
+
+    /** Size of the decoded payload of a chunk */
+    inline uint64_t GetDecodedChunkSize(const ChunkEntry& Chunk)
+    {
+        return IsChunkCompressed(Chunk) ? Chunk.ElementCount * Chunk.ElementSize : Chunk.Size;
+    }
+
+    /**
+    *   Decode a chunk payload into Output, which holds GetDecodedChunkSize bytes.
+    *   Filtered chunks go through Scratch, reuse it across calls to avoid allocations.
+    */
+    inline bool DecodeChunkPayload(const ChunkEntry& Chunk, const uint8_t* Payload, uint8_t* Output, std::vector<uint8_t>& Scratch)
+    {
+        if (!IsChunkCompressed(Chunk))
+        {
+            memcpy(Output, Payload, size_t(Chunk.Size));
+            return true;
+        }
+
+        const EChunkFilter Filter = GetChunkFilter(Chunk);
+        if (!IsChunkFilterSupported(Filter, Chunk.ElementSize))
+        {
+            return false;
+        }
+
+        const size_t DecodedSize = size_t(Chunk.ElementCount * Chunk.ElementSize);
+        if (Filter == EChunkFilter::None)
+        {
+            return DecompressLZ4Block(Payload, size_t(Chunk.Size), Output, DecodedSize);
+        }
+
+        Scratch.resize(DecodedSize);
+        if (!DecompressLZ4Block(Payload, size_t(Chunk.Size), Scratch.data(), DecodedSize))
+        {
+            return false;
+        }
+        DecodeChunkFilter(Filter, Scratch.data(), Output, size_t(Chunk.ElementCount), Chunk.ElementSize);
+
+        return true;
+    }
+}
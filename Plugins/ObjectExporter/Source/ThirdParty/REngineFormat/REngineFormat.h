@@ -0,0 +1,694 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include <cstdint>
+
+/*
+*   Binary container layout shared by the ObjectExporter plugin and the runtime.
+*   This header has no engine dependency so the reader side can be built standalone.
+*
+*   A file is a FileHeader, followed by a table of ChunkEntry, followed by the chunk payloads.
+*   Every payload starts at an offset that is a multiple of its chunk alignment (16 or 64 bytes), so a
+*   memory mapped file can hand out typed pointers into the payloads without any copy.
+*   All values are little endian.
+*/
+namespace REngineFormat
+{
+    constexpr uint32_t MakeFourCC(char A, char B, char C, char D)
+    {
+        return uint32_t(uint8_t(A)) | (uint32_t(uint8_t(B)) << 8) | (uint32_t(uint8_t(C)) << 16) | (uint32_t(uint8_t(D)) << 24);
+    }
+
+    constexpr uint32_t FileMagic = MakeFourCC('R', 'E', 'N', 'G');
+
+    // Major changes break old readers, minor changes only add chunks or change what a chunk refers to.
+    // Readers reject chunks with ChunkFlags bits they do not know, so a file using a new flag fails to load instead of being misread.
+    // 1.4 added Compressed before readers did this, 1.0 to 1.3 readers misread compressed 1.4 files
+    // 2.12: TextureParameters name textures by content id instead of by texture name
+    // 3.0: compressed and frame major animations no longer carry AnimTracks, PosKeys, RotKeys and ScaleKeys
+    // 3.1: the MaterialIndex of a merged cell section is a slot of MergedCellMaterials, 3.0 files hold a Strings index there
+    constexpr uint16_t VersionMajor = 3;
+    constexpr uint16_t VersionMinor = 1;
+
+    constexpr uint32_t DefaultAlignment = 16;
+    constexpr uint32_t StreamAlignment = 64;
+
+    // Limits of one meshlet, local indices fit in a byte and the counts match common mesh shader group sizes
+    constexpr uint32_t MaxMeshletVertices = 64;
+    constexpr uint32_t MaxMeshletTriangles = 124;
+
+    enum class EFileType : uint32_t
+    {
+        StaticMesh = MakeFourCC('S', 'T', 'M', ' '),
+        SkeletalMesh = MakeFourCC('S', 'K', 'M', ' '),
+        Skeleton = MakeFourCC('S', 'K', 'T', ' '),
+        AnimSequence = MakeFourCC('A', 'N', 'M', ' '),
+        AnimTexture = MakeFourCC('V', 'A', 'T', ' '),
+        Material = MakeFourCC('M', 'T', 'L', ' '),
+        Map = MakeFourCC('M', 'A', 'P', ' '),
+        MapCell = MakeFourCC('M', 'C', 'L', ' '),
+    };
+
+    enum class EElementFormat : uint32_t
+    {
+        Bytes = 0,
+        UInt8,
+        UInt16,
+        UInt32,
+        Int32,
+        Float,
+        Float2,
+        Float3,
+        Float4,
+        // One of the structs below, identified by the chunk id
+        Struct,
+        // Utf8 text without terminator, one element per byte
+        String,
+        // uint32 Count, uint32 Offsets[Count + 1], then the utf8 text of all strings
+        StringTable,
+        UInt64,
+    };
+
+    // Optional codec of a chunk payload, see REngineCodec.h. A compressed payload is an LZ4 block of the
+    // filtered elements, it decodes to ElementCount * ElementSize bytes.
+    namespace ChunkFlags
+    {
+        constexpr uint32_t Compressed = 1u << 0;
+        // Bits 8 to 15 hold the EChunkFilter of a compressed chunk
+        constexpr uint32_t FilterShift = 8;
+        constexpr uint32_t FilterMask = 0xffu << FilterShift;
+        // Every bit a reader of this version understands
+        constexpr uint32_t KnownMask = Compressed | FilterMask;
+    }
+
+    enum class EChunkFilter : uint32_t
+    {
+        None = 0,
+        // 16 or 32 bit elements, zigzag delta to the previous element, then split into byte planes
+        IndexDelta,
+        // Elements split into byte planes, each byte stored as the delta to the same byte of the previous element
+        BytePlaneDelta,
+    };
+
+    namespace ChunkId
+    {
+        // Meshes, the chunk index is the LOD index
+        constexpr uint32_t MeshInfo = MakeFourCC('M', 'E', 'S', 'H');
+        // One MeshLOD per LOD, chunk index 0
+        constexpr uint32_t LODs = MakeFourCC('L', 'O', 'D', 'S');
+        // VertexFormat describing the Vertices chunk of the same LOD
+        constexpr uint32_t VertexFormat = MakeFourCC('V', 'F', 'M', 'T');
+        constexpr uint32_t Vertices = MakeFourCC('V', 'E', 'R', 'T');
+        // UInt32, or UInt16 for compact meshes with at most 65536 vertices
+        constexpr uint32_t Indices = MakeFourCC('I', 'N', 'D', 'X');
+        constexpr uint32_t Sections = MakeFourCC('S', 'E', 'C', 'T');
+        constexpr uint32_t SkeletonName = MakeFourCC('S', 'K', 'E', 'L');
+        // UInt16 bone indices of the source skeleton, the ones BoneSourceIndices of the .skt and the animation tracks use. Each
+        // SkeletalMeshSection owns FirstPaletteBone/NumPaletteBones of them and the bone indices of its vertices are slots of that range
+        constexpr uint32_t BonePalette = MakeFourCC('B', 'P', 'A', 'L');
+        // Optional, written when vertices keep more than four influences. SkinInfluenceBuckets of the vertices
+        // sorted by influence count within each section, and UInt8 ExtraInfluences the buckets above four address
+        constexpr uint32_t InfluenceBuckets = MakeFourCC('I', 'N', 'F', 'B');
+        constexpr uint32_t ExtraInfluences = MakeFourCC('I', 'N', 'F', 'X');
+        // Optional clusters of a LOD, each Meshlet addresses MeshletVertices (UInt32 mesh vertex indices)
+        // and MeshletTriangles (UInt8 meshlet local vertex indices, three per triangle, TriangleOffset counts indices) of the same LOD
+        constexpr uint32_t Meshlets = MakeFourCC('M', 'L', 'E', 'T');
+        constexpr uint32_t MeshletVertices = MakeFourCC('M', 'L', 'V', 'X');
+        constexpr uint32_t MeshletTriangles = MakeFourCC('M', 'L', 'T', 'R');
+        // UInt32 words of a bit per skeleton bone, set for the bones a LOD needs. Bits index the bones of the .skt
+        constexpr uint32_t BoneLODMask = MakeFourCC('B', 'M', 'S', 'K');
+        // MeshBounds of a LOD and one per section in the order of its Sections chunk, in mesh space
+        constexpr uint32_t LODBounds = MakeFourCC('L', 'B', 'N', 'D');
+        constexpr uint32_t SectionBounds = MakeFourCC('S', 'B', 'N', 'D');
+        // MeshBounds per bone of the .skt around the LOD vertices it weights, in the space of the bone. The box around them
+        // moved by the current bone matrices encloses the skinned mesh, bones weighting no vertex have a negative Radius
+        constexpr uint32_t BoneBounds = MakeFourCC('B', 'B', 'O', 'X');
+
+        // Skeleton
+        constexpr uint32_t BoneNames = MakeFourCC('B', 'N', 'A', 'M');
+        constexpr uint32_t BoneParents = MakeFourCC('B', 'P', 'A', 'R');
+        constexpr uint32_t BoneRefPose = MakeFourCC('B', 'P', 'O', 'S');
+        // Bones are written with every parent before its children. Int32 index of each bone in the source skeleton,
+        // which the bone indices of animations and mesh palettes refer to
+        constexpr uint32_t BoneSourceIndices = MakeFourCC('B', 'S', 'R', 'C');
+        // Component space bind pose of every bone as BoneTransform, and its inverse as BoneMatrix
+        constexpr uint32_t BoneBindPose = MakeFourCC('B', 'B', 'N', 'D');
+        constexpr uint32_t BoneInverseBindMatrices = MakeFourCC('B', 'I', 'N', 'V');
+
+        // Animation
+        constexpr uint32_t AnimInfo = MakeFourCC('A', 'N', 'I', 'M');
+        constexpr uint32_t AnimTracks = MakeFourCC('T', 'R', 'A', 'K');
+        constexpr uint32_t PosKeys = MakeFourCC('K', 'P', 'O', 'S');
+        constexpr uint32_t RotKeys = MakeFourCC('K', 'R', 'O', 'T');
+        constexpr uint32_t ScaleKeys = MakeFourCC('K', 'S', 'C', 'L');
+        // Compressed sequences have CompressedAnimTracks and the three UInt16 key streams below instead of AnimTracks and the float keys
+        constexpr uint32_t CompressedAnimTracks = MakeFourCC('C', 'T', 'R', 'K');
+        constexpr uint32_t CompressedRotKeys = MakeFourCC('C', 'R', 'O', 'T');
+        constexpr uint32_t CompressedPosKeys = MakeFourCC('C', 'P', 'O', 'S');
+        constexpr uint32_t CompressedScaleKeys = MakeFourCC('C', 'S', 'C', 'L');
+        // Frame major sequences have an AnimBlockLayout, the Int32 bone index of every lane (-1 for padding) and the Float
+        // frames of all blocks instead of the tracks, see REngineAnimSampler.h
+        constexpr uint32_t AnimBlockLayout = MakeFourCC('A', 'B', 'L', 'K');
+        constexpr uint32_t AnimLaneBones = MakeFourCC('A', 'B', 'O', 'N');
+        constexpr uint32_t AnimBlocks = MakeFourCC('A', 'B', 'D', 'T');
+
+        // Animation texture, an AnimTextureInfo and the texels, UInt16 halfs or Float by its format. Vertex animation textures
+        // also carry the LOD 0 mesh they animate as VertexFormat, Vertices (StaticMeshVertex), Indices and Sections (StaticMeshSection)
+        constexpr uint32_t AnimTextureInfo = MakeFourCC('V', 'A', 'T', 'I');
+        constexpr uint32_t AnimTexels = MakeFourCC('V', 'A', 'T', 'X');
+
+        // Material
+        constexpr uint32_t MaterialInfo = MakeFourCC('M', 'A', 'T', 'L');
+        constexpr uint32_t ScalarParameters = MakeFourCC('P', 'S', 'C', 'L');
+        constexpr uint32_t VectorParameters = MakeFourCC('P', 'V', 'E', 'C');
+        // Pairs of parameter name and texture id, 16 hex digits naming the texture file Texture/<id>.dds, textures with identical content share an id.
+        // Files before 2.12 hold the texture name instead
+        constexpr uint32_t TextureParameters = MakeFourCC('P', 'T', 'E', 'X');
+        // Every parameter of the material as a MaterialParameter sorted by name hash, with the names in the same order.
+        // Scalar and vector values are Float ParameterValues, textures UInt64 ParameterTextureIds
+        constexpr uint32_t ParameterTable = MakeFourCC('P', 'T', 'A', 'B');
+        constexpr uint32_t ParameterNames = MakeFourCC('P', 'N', 'A', 'M');
+        constexpr uint32_t ParameterValues = MakeFourCC('P', 'V', 'A', 'L');
+        constexpr uint32_t ParameterTextureIds = MakeFourCC('P', 'T', 'I', 'D');
+        constexpr uint32_t MaterialState = MakeFourCC('M', 'S', 'T', 'A');
+
+        // Map
+        constexpr uint32_t Strings = MakeFourCC('S', 'T', 'R', 'S');
+        constexpr uint32_t Cameras = MakeFourCC('C', 'A', 'M', 'S');
+        constexpr uint32_t DirectionalLights = MakeFourCC('D', 'L', 'I', 'T');
+        constexpr uint32_t PointLights = MakeFourCC('P', 'L', 'I', 'T');
+        constexpr uint32_t StaticMeshActors = MakeFourCC('S', 'M', 'A', 'C');
+        constexpr uint32_t SkeletalMeshActors = MakeFourCC('S', 'K', 'A', 'C');
+        // String indices of the actor materials, addressed by FirstMaterial/NumMaterials of the actors
+        constexpr uint32_t ActorMaterials = MakeFourCC('A', 'M', 'A', 'T');
+        // One MapActorLOD per actor, chunk index 0 for static mesh actors and 1 for skeletal mesh actors
+        constexpr uint32_t ActorLODs = MakeFourCC('A', 'L', 'O', 'D');
+        // One MapActorBounds per actor in world space, chunk index 0 for static mesh actors and 1 for skeletal mesh actors
+        constexpr uint32_t ActorBounds = MakeFourCC('A', 'B', 'N', 'D');
+        // Bounding volume hierarchy of the static mesh actors, MapBVHNode in depth first order and the UInt32 static mesh
+        // actor indices its leaves address, see REngineBVH.h
+        constexpr uint32_t BVHNodes = MakeFourCC('B', 'V', 'H', 'N');
+        constexpr uint32_t BVHItems = MakeFourCC('B', 'V', 'H', 'I');
+        // Static mesh actors grouped into MapInstanceBatch, the instances of all batches are InstanceTransform, MapActorBounds
+        // and the UInt32 index of the static mesh actor of every instance
+        constexpr uint32_t InstanceBatches = MakeFourCC('I', 'B', 'A', 'T');
+        constexpr uint32_t InstanceTransforms = MakeFourCC('I', 'T', 'R', 'N');
+        constexpr uint32_t InstanceBounds = MakeFourCC('I', 'B', 'N', 'D');
+        constexpr uint32_t InstanceActors = MakeFourCC('I', 'A', 'C', 'T');
+        // Small static mesh actors merged into world space geometry per grid cell, a MapMergedCell per cell and the UInt32
+        // static mesh actor indices they contain. The geometry of cell N is the VertexFormat, Vertices (StaticMeshVertex),
+        // Indices (UInt32), Sections and MergedCellMaterials chunks of index N. MergedCellMaterials holds the UInt32 Strings
+        // index of the material name of every slot, the MaterialIndex of a section is one of these slots as in a static mesh
+        constexpr uint32_t MergedCells = MakeFourCC('M', 'C', 'E', 'L');
+        constexpr uint32_t MergedCellActors = MakeFourCC('M', 'A', 'C', 'T');
+        constexpr uint32_t MergedCellMaterials = MakeFourCC('M', 'M', 'A', 'T');
+
+        // Streaming cells of a partitioned map. The .map keeps a MapStreamingCell per cell, every cell file holds the actor chunks
+        // above for its actors and the UInt32 indices of the files they need, all string indices refer to the Strings of the .map
+        constexpr uint32_t StreamingCells = MakeFourCC('S', 'C', 'E', 'L');
+        constexpr uint32_t CellDependencies = MakeFourCC('C', 'D', 'E', 'P');
+    }
+
+    struct FileHeader
+    {
+        uint32_t Magic;
+        uint16_t VersionMajor;
+        uint16_t VersionMinor;
+        uint32_t FileType;
+        uint32_t ChunkCount;
+        uint64_t ChunkTableOffset;
+        uint64_t FileSize;
+        uint32_t Reserved[8];
+    };
+    static_assert(sizeof(FileHeader) == 64, "FileHeader layout changed.");
+
+    struct ChunkEntry
+    {
+        uint32_t Id;
+        uint32_t Index;
+        uint32_t Format;
+        uint32_t ElementSize;
+        uint64_t Offset;
+        uint64_t Size;
+        uint64_t ElementCount;
+        uint32_t Alignment;
+        uint32_t Flags;
+    };
+    static_assert(sizeof(ChunkEntry) == 48, "ChunkEntry layout changed.");
+
+    // Mesh
+
+    struct MeshInfo
+    {
+        uint32_t LODCount;
+        uint32_t Reserved[3];
+    };
+
+    // ScreenSize is the projected screen size below which the next LOD is used
+    struct MeshLOD
+    {
+        float ScreenSize;
+        uint32_t NumVertices;
+        uint32_t NumIndices;
+        uint32_t NumSections;
+    };
+    static_assert(sizeof(MeshLOD) == 16, "MeshLOD layout changed.");
+
+    // Axis aligned box and a bounding sphere around its center
+    struct MeshBounds
+    {
+        float Center[3];
+        float Radius;
+        float Extent[3];
+        uint32_t Reserved;
+    };
+    static_assert(sizeof(MeshBounds) == 32, "MeshBounds layout changed.");
+
+    enum class EVertexSemantic : uint32_t
+    {
+        Position = 0,
+        Normal,
+        Tangent,
+        TangentSign,
+        UV0,
+        BoneIndices,
+        BoneWeights,
+    };
+
+    enum class EVertexAttributeFormat : uint32_t
+    {
+        Float2 = 0,
+        Float3,
+        Float4,
+        // Unsigned normalized, mapped to PositionMin + Value * PositionExtent
+        UNorm16x3,
+        // Octahedral encoded unit vector, two signed normalized components
+        OctSNorm16x2,
+        // -1 or +1
+        SNorm16,
+        Half2,
+        UInt16x4,
+        UNorm8x4,
+        UInt8x4,
+    };
+
+    struct VertexAttribute
+    {
+        uint32_t Semantic;
+        uint32_t Format;
+        uint32_t Offset;
+        uint32_t Reserved;
+    };
+
+    constexpr uint32_t MaxVertexAttributes = 8;
+
+    struct VertexFormat
+    {
+        uint32_t Stride;
+        uint32_t AttributeCount;
+        uint32_t Reserved[2];
+        float PositionMin[4];
+        float PositionExtent[4];
+        VertexAttribute Attributes[MaxVertexAttributes];
+    };
+    static_assert(sizeof(VertexFormat) == 176, "VertexFormat layout changed.");
+
+    struct StaticMeshVertex
+    {
+        float Position[3];
+        float Normal[4];
+        float Tangent[3];
+        float UV[2];
+    };
+    static_assert(sizeof(StaticMeshVertex) == 48, "StaticMeshVertex layout changed.");
+
+    struct CompactStaticMeshVertex
+    {
+        uint16_t Position[3];
+        int16_t TangentSign;
+        int16_t Normal[2];
+        int16_t Tangent[2];
+        uint16_t UV[2];
+    };
+    static_assert(sizeof(CompactStaticMeshVertex) == 20, "CompactStaticMeshVertex layout changed.");
+
+    struct SkeletalMeshVertex
+    {
+        float Position[3];
+        float Normal[4];
+        float Tangent[3];
+        float UV[2];
+        // Slots of the section bone palette, weights sum to 255
+        uint8_t BoneIndices[4];
+        uint8_t BoneWeights[4];
+    };
+    static_assert(sizeof(SkeletalMeshVertex) == 56, "SkeletalMeshVertex layout changed.");
+
+    struct StaticMeshSection
+    {
+        int32_t MaterialIndex;
+        uint32_t FirstIndex;
+        uint32_t NumTriangles;
+        uint32_t MinVertexIndex;
+        uint32_t MaxVertexIndex;
+    };
+    static_assert(sizeof(StaticMeshSection) == 20, "StaticMeshSection layout changed.");
+
+    struct SkeletalMeshSection
+    {
+        int32_t MaterialIndex;
+        uint32_t BaseIndex;
+        uint32_t NumTriangles;
+        uint32_t BaseVertexIndex;
+        uint32_t NumVertices;
+        uint32_t FirstPaletteBone;
+        uint32_t NumPaletteBones;
+    };
+    static_assert(sizeof(SkeletalMeshSection) == 28, "SkeletalMeshSection layout changed.");
+
+    // Vertices of one section skinned by the same kernel, NumInfluences is 1, 2, 4, 8 or 12 and unused vertex slots weigh 0.
+    // Above four, every vertex of the bucket has NumInfluences - 4 more palette slots followed by as many weights in
+    // ExtraInfluences, starting at byte FirstExtraInfluence. The weights of all influences of a vertex sum to 255
+    struct SkinInfluenceBucket
+    {
+        uint32_t SectionIndex;
+        uint32_t NumInfluences;
+        uint32_t FirstVertex;
+        uint32_t NumVertices;
+        uint32_t FirstExtraInfluence;
+        uint32_t Reserved[3];
+    };
+    static_assert(sizeof(SkinInfluenceBucket) == 32, "SkinInfluenceBucket layout changed.");
+
+    // The cone culls the meshlet when dot(normalize(ConeApex - CameraPosition), ConeAxis) >= ConeCutoff,
+    // ConeCutoff is 1 when the triangle normals are too spread out for the test
+    struct Meshlet
+    {
+        uint32_t VertexOffset;
+        uint32_t TriangleOffset;
+        uint32_t VertexCount;
+        uint32_t TriangleCount;
+        float Center[3];
+        float Radius;
+        float ConeApex[3];
+        float ConeCutoff;
+        float ConeAxis[3];
+        uint32_t SectionIndex;
+    };
+    static_assert(sizeof(Meshlet) == 64, "Meshlet layout changed.");
+
+    // Skeleton
+
+    struct BoneTransform
+    {
+        float Rotation[4];
+        float Translation[3];
+        float Scale[3];
+    };
+    static_assert(sizeof(BoneTransform) == 40, "BoneTransform layout changed.");
+
+    // Row vectors, a position P transforms as P * M and the translation is M[3]
+    struct BoneMatrix
+    {
+        float M[4][4];
+    };
+    static_assert(sizeof(BoneMatrix) == 64, "BoneMatrix layout changed.");
+
+    // Animation
+
+    struct AnimSequenceInfo
+    {
+        uint32_t NumFrames;
+        float SequenceLength;
+        uint32_t NumTracks;
+        uint32_t Reserved;
+    };
+
+    // Key ranges index the PosKeys (float3), RotKeys (float4) and ScaleKeys (float3) chunks
+    struct AnimTrack
+    {
+        int32_t BoneIndex;
+        uint32_t FirstPosKey;
+        uint32_t NumPosKeys;
+        uint32_t FirstRotKey;
+        uint32_t NumRotKeys;
+        uint32_t FirstScaleKey;
+        uint32_t NumScaleKeys;
+        uint32_t Reserved;
+    };
+    static_assert(sizeof(AnimTrack) == 32, "AnimTrack layout changed.");
+
+    // A compressed key is four uint16, the frame of the key in the low 14 bits of the first then the value. A channel is interpolated
+    // linearly between its keys, rotations as a normalized lerp along the shortest path. A channel without keys keeps the reference
+    // pose, a single key holds for the whole sequence, and bones without a track keep the reference pose.
+    // Rotations are smallest three: the components other than the largest one in X, Y, Z, W order, each 16 bits mapping
+    // [-1/sqrt(2), 1/sqrt(2)] to [0, 65535]. The top 2 bits of the first uint16 hold the index of the largest component,
+    // which is positive and restored from the unit length.
+    // Translations and scales are range quantized, a value decodes to Min + Value / 65535 * Extent.
+    struct CompressedAnimTrack
+    {
+        int32_t BoneIndex;
+        uint32_t FirstRotKey;
+        uint32_t NumRotKeys;
+        uint32_t FirstPosKey;
+        uint32_t NumPosKeys;
+        uint32_t FirstScaleKey;
+        uint32_t NumScaleKeys;
+        uint32_t Reserved;
+        float PosMin[3];
+        float PosExtent[3];
+        float ScaleMin[3];
+        float ScaleExtent[3];
+    };
+    static_assert(sizeof(CompressedAnimTrack) == 80, "CompressedAnimTrack layout changed.");
+
+    // Bones are sampled AnimLaneWidth at a time, the lane count of a frame major sequence is a multiple of it
+    constexpr uint32_t AnimLaneWidth = 4;
+    // Float streams of a frame: rotation X, Y, Z, W, translation X, Y, Z and scale X, Y, Z, each NumLanes floats
+    constexpr uint32_t AnimFrameStreams = 10;
+
+    // A frame major sequence is NumBlocks blocks of FramesPerBlock + 1 frames, the last frame of a block repeats as the first
+    // of the next so every block samples on its own. Frames past the end repeat the last frame. Rotations are in the
+    // hemisphere of the previous frame, a normalized lerp between neighbours needs no sign check.
+    struct AnimBlockLayout
+    {
+        uint32_t NumFrames;
+        uint32_t FramesPerBlock;
+        uint32_t NumBlocks;
+        uint32_t NumLanes;
+    };
+    static_assert(sizeof(AnimBlockLayout) == 16, "AnimBlockLayout layout changed.");
+
+    enum class EAnimTextureMode : uint32_t
+    {
+        // Three texels per bone, the rows of the 3x4 matrix taking a bind pose position to the animated component space:
+        // Skinned.x = dot(Row0, float4(Position, 1)) and so on. Elements are the bones of the mesh reference skeleton
+        BoneMatrices = 0,
+        // One texel per vertex, the offset of the animated position from the bind pose position, then one with the
+        // animated normal when TexelsPerElement is 2. Elements are the vertices of the mesh in the file
+        VertexPositions,
+    };
+
+    enum class EAnimTextureFormat : uint32_t
+    {
+        Float16x4 = 0,
+        Float32x4,
+    };
+
+    // The texels of element E of frame F start at texel I = F * TexelsPerFrame + E * TexelsPerElement, which is
+    // at column I % Width and row I / Width. Frame F plays at F / FrameRate seconds, the last frame at the sequence length
+    struct AnimTextureInfo
+    {
+        uint32_t Mode;
+        uint32_t Format;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t NumFrames;
+        float FrameRate;
+        float SequenceLength;
+        uint32_t NumElements;
+        uint32_t TexelsPerElement;
+        uint32_t TexelsPerFrame;
+        uint32_t Reserved[2];
+    };
+    static_assert(sizeof(AnimTextureInfo) == 48, "AnimTextureInfo layout changed.");
+
+    // Material
+
+    struct MaterialInfo
+    {
+        int32_t BlendMode;
+        int32_t ShadingModel;
+        uint32_t TwoSided;
+        uint32_t Reserved;
+    };
+
+    // FNV-1a of the lower case name, parameter names are case insensitive
+    constexpr uint32_t HashParameterName(const char* Name)
+    {
+        uint32_t Hash = 2166136261u;
+        for (; *Name != 0; Name++)
+        {
+            const char Char = *Name >= 'A' && *Name <= 'Z' ? char(*Name - 'A' + 'a') : *Name;
+            Hash = (Hash ^ uint8_t(Char)) * 16777619u;
+        }
+
+        return Hash;
+    }
+
+    enum class EMaterialParameterType : uint32_t
+    {
+        // One float at ParameterValues[ValueIndex]
+        Scalar = 0,
+        // Four floats, linear RGBA, from ParameterValues[ValueIndex]
+        Vector,
+        // Texture id at ParameterTextureIds[ValueIndex], the file is Texture/<16 hex digits of the id>.dds
+        Texture
+    };
+
+    struct MaterialParameter
+    {
+        uint32_t NameHash;
+        uint32_t Type;
+        uint32_t ValueIndex;
+        uint32_t Reserved;
+    };
+    static_assert(sizeof(MaterialParameter) == 16, "MaterialParameter layout changed.");
+
+    // Draws sorted by ascending SortKey change the most expensive state least often. From the top bit down:
+    // 4 bits blend mode, 6 bits shading model, 1 bit two sided, 21 bits of the base material hash and 32 bits of the texture set hash.
+    // Opaque and masked materials come before translucent ones, which the runtime still orders by depth
+    struct MaterialState
+    {
+        uint64_t SortKey;
+        // Hash of the texture ids of all texture parameters, equal for materials binding the same textures
+        uint32_t TextureSetHash;
+        // Hash of the path of the base material, equal for materials sharing shaders
+        uint32_t BaseMaterialHash;
+    };
+    static_assert(sizeof(MaterialState) == 16, "MaterialState layout changed.");
+
+    // Map, names are indices into the Strings chunk
+
+    struct MapCamera
+    {
+        float Location[3];
+        float Target[3];
+        float FOV;
+        float AspectRatio;
+    };
+
+    struct MapDirectionalLight
+    {
+        float Color[4];
+        float Direction[3];
+        float Intensity;
+        float ShadowDistance;
+        float ShadowBias;
+    };
+
+    struct MapPointLight
+    {
+        float Color[4];
+        float Location[3];
+        float Intensity;
+        float AttenuationRadius;
+        float LightFalloffExponent;
+    };
+
+    struct MapStaticMeshActor
+    {
+        float Rotation[4];
+        float Location[3];
+        float Scale[3];
+        uint32_t MeshName;
+        uint32_t FirstMaterial;
+        uint32_t NumMaterials;
+    };
+
+    struct MapSkeletalMeshActor
+    {
+        float Rotation[4];
+        float Location[3];
+        float Scale[3];
+        uint32_t MeshName;
+        uint32_t AnimationName;
+        uint32_t FirstMaterial;
+        uint32_t NumMaterials;
+    };
+
+    // ForcedLOD is -1 when the LOD is chosen by screen size, MinLOD is the first LOD the actor may use
+    struct MapActorLOD
+    {
+        int32_t ForcedLOD;
+        int32_t MinLOD;
+    };
+
+    // Axis aligned box and the bounding sphere around the same center
+    struct MapActorBounds
+    {
+        float Center[3];
+        float Radius;
+        float Extent[3];
+        uint32_t Reserved;
+    };
+    static_assert(sizeof(MapActorBounds) == 32, "MapActorBounds layout changed.");
+
+    // The first child of an inner node is the next node. Skip is the node after the subtree, so a node is a leaf when Skip
+    // is its own index + 1. The items of a subtree are contiguous, from FirstItem up to the FirstItem of the Skip node
+    struct MapBVHNode
+    {
+        float Center[3];
+        uint32_t FirstItem;
+        float Extent[3];
+        uint32_t Skip;
+    };
+    static_assert(sizeof(MapBVHNode) == 32, "MapBVHNode layout changed.");
+
+    // Static mesh actors with the same mesh, materials and LOD settings close to each other, drawn with one instanced draw
+    // per section. The instances are FirstInstance to FirstInstance + NumInstances, Bounds holds all of them
+    struct MapInstanceBatch
+    {
+        uint32_t MeshName;
+        uint32_t FirstMaterial;
+        uint32_t NumMaterials;
+        int32_t ForcedLOD;
+        int32_t MinLOD;
+        uint32_t FirstInstance;
+        uint32_t NumInstances;
+        uint32_t Reserved;
+        MapActorBounds Bounds;
+    };
+    static_assert(sizeof(MapInstanceBatch) == 64, "MapInstanceBatch layout changed.");
+
+    // Rows of the 3x4 local to world matrix, World.x = dot(Rows[0], float4(Local, 1)) and so on
+    struct InstanceTransform
+    {
+        float Rows[3][4];
+    };
+    static_assert(sizeof(InstanceTransform) == 48, "InstanceTransform layout changed.");
+
+    // The actors FirstActor to FirstActor + NumActors of MergedCellActors are drawn by the cell, not on their own
+    struct MapMergedCell
+    {
+        MapActorBounds Bounds;
+        uint32_t FirstActor;
+        uint32_t NumActors;
+        uint32_t NumSections;
+        uint32_t NumVertices;
+    };
+    static_assert(sizeof(MapMergedCell) == 48, "MapMergedCell layout changed.");
+
+    // FileName is the cell file next to the .map, a runtime loads the cell while the camera is within LoadDistance of Bounds.
+    // Dependencies are paths below the export root, textures are found through the materials
+    struct MapStreamingCell
+    {
+        MapActorBounds Bounds;
+        uint32_t FileName;
+        uint32_t NumStaticMeshActors;
+        uint32_t NumSkeletalMeshActors;
+        float LoadDistance;
+    };
+    static_assert(sizeof(MapStreamingCell) == 48, "MapStreamingCell layout changed.");
+}
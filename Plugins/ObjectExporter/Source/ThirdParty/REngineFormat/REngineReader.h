@@ -0,0 +1,397 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "REngineFormat.h"
+#include "REngineCodec.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+*   Zero copy reader for files written by the ObjectExporter plugin.
+*   The file is memory mapped once, validated, and chunks are handed out as typed spans that point straight
+*   into the mapping. Spans stay valid as long as the FileReader is alive.
+*
+*   REngineFormat::FileReader Reader;
+*   if (Reader.Open("SM_Dragon.stm", &Error))
+*   {
+*       Span<StaticMeshVertex> Vertices = Reader.GetChunk<StaticMeshVertex>(ChunkId::Vertices);
+*   }
+*
+*   Compressed chunks can not be viewed in place, DecodeChunk copies raw and compressed chunks alike.
+*/
+namespace REngineFormat
+{
+    template<typename ElementType>
+    class Span
+    {
+    public:
+        Span() : Elements(nullptr), Count(0) {}
+        Span(const ElementType* InElements, size_t InCount) : Elements(InElements), Count(InCount) {}
+
+        const ElementType* data() const { return Elements; }
+        size_t size() const { return Count; }
+        bool empty() const { return Count == 0; }
+        const ElementType* begin() const { return Elements; }
+        const ElementType* end() const { return Elements + Count; }
+        const ElementType& operator[](size_t Index) const { return Elements[Index]; }
+
+    private:
+        const ElementType* Elements;
+        size_t Count;
+    };
+
+    class StringTable
+    {
+    public:
+        StringTable() : Offsets(nullptr), Text(nullptr), Count(0) {}
+        StringTable(const uint32_t* InOffsets, const char* InText, uint32_t InCount) : Offsets(InOffsets), Text(InText), Count(InCount) {}
+
+        uint32_t size() const { return Count; }
+        bool empty() const { return Count == 0; }
+        std::string_view operator[](uint32_t Index) const { return std::string_view(Text + Offsets[Index], Offsets[Index + 1] - Offsets[Index]); }
+
+    private:
+        const uint32_t* Offsets;
+        const char* Text;
+        uint32_t Count;
+    };
+
+    /** Read only memory mapping of a whole file */
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& Other) noexcept { *this = std::move(Other); }
+        MappedFile& operator=(MappedFile&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                Close();
+                std::swap(Data, Other.Data);
+                std::swap(Size, Other.Size);
+#if defined(_WIN32)
+                std::swap(FileHandle, Other.FileHandle);
+                std::swap(MappingHandle, Other.MappingHandle);
+#endif
+            }
+            return *this;
+        }
+        ~MappedFile() { Close(); }
+
+        bool Open(const char* Path)
+        {
+            Close();
+#if defined(_WIN32)
+            FileHandle = CreateFileA(Path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (FileHandle == INVALID_HANDLE_VALUE)
+            {
+                FileHandle = nullptr;
+                return false;
+            }
+            LARGE_INTEGER FileSize;
+            if (!GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0)
+            {
+                Close();
+                return false;
+            }
+            MappingHandle = CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (MappingHandle == nullptr)
+            {
+                Close();
+                return false;
+            }
+            Data = static_cast<const uint8_t*>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+            Size = size_t(FileSize.QuadPart);
+#else
+            const int FileDescriptor = ::open(Path, O_RDONLY);
+            if (FileDescriptor < 0)
+            {
+                return false;
+            }
+            struct stat FileStat;
+            if (fstat(FileDescriptor, &FileStat) != 0 || FileStat.st_size == 0)
+            {
+                ::close(FileDescriptor);
+                return false;
+            }
+            void* Mapping = mmap(nullptr, size_t(FileStat.st_size), PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+            ::close(FileDescriptor);
+            if (Mapping == MAP_FAILED)
+            {
+                return false;
+            }
+            Data = static_cast<const uint8_t*>(Mapping);
+            Size = size_t(FileStat.st_size);
+#endif
+            if (Data == nullptr)
+            {
+                Close();
+                return false;
+            }
+            return true;
+        }
+
+        void Close()
+        {
+#if defined(_WIN32)
+            if (Data != nullptr)
+            {
+                UnmapViewOfFile(Data);
+            }
+            if (MappingHandle != nullptr)
+            {
+                CloseHandle(MappingHandle);
+            }
+            if (FileHandle != nullptr)
+            {
+                CloseHandle(FileHandle);
+            }
+            MappingHandle = nullptr;
+            FileHandle = nullptr;
+#else
+            if (Data != nullptr)
+            {
+                munmap(const_cast<uint8_t*>(Data), Size);
+            }
+#endif
+            Data = nullptr;
+            Size = 0;
+        }
+
+        const uint8_t* GetData() const { return Data; }
+        size_t GetSize() const { return Size; }
+
+    private:
+        const uint8_t* Data = nullptr;
+        size_t Size = 0;
+#if defined(_WIN32)
+        HANDLE FileHandle = nullptr;
+        HANDLE MappingHandle = nullptr;
+#endif
+    };
+
+    class FileReader
+    {
+    public:
+        /** Map and validate a file */
+        bool Open(const char* Path, std::string* OutError = nullptr)
+        {
+            if (!File.Open(Path))
+            {
+                return Fail(OutError, std::string("can not map ") + Path);
+            }
+            return OpenMemory(File.GetData(), File.GetSize(), OutError);
+        }
+
+        /** Validate a file that is already in memory, the memory must outlive the reader */
+        bool OpenMemory(const void* InData, size_t InSize, std::string* OutError = nullptr)
+        {
+            Data = static_cast<const uint8_t*>(InData);
+            Size = InSize;
+            Header = nullptr;
+            Chunks = nullptr;
+
+            if (Data == nullptr || Size < sizeof(FileHeader))
+            {
+                return Fail(OutError, "file is too small");
+            }
+
+            const FileHeader* CandidateHeader = reinterpret_cast<const FileHeader*>(Data);
+            if (CandidateHeader->Magic != FileMagic)
+            {
+                return Fail(OutError, "bad magic");
+            }
+            if (CandidateHeader->VersionMajor != VersionMajor)
+            {
+                return Fail(OutError, "unsupported major version " + std::to_string(CandidateHeader->VersionMajor));
+            }
+            if (CandidateHeader->FileSize != Size)
+            {
+                return Fail(OutError, "file size does not match header");
+            }
+            const uint64_t TableSize = uint64_t(CandidateHeader->ChunkCount) * sizeof(ChunkEntry);
+            if (CandidateHeader->ChunkTableOffset % alignof(ChunkEntry) != 0 || !IsInside(CandidateHeader->ChunkTableOffset, TableSize))
+            {
+                return Fail(OutError, "chunk table out of bounds");
+            }
+
+            const ChunkEntry* CandidateChunks = reinterpret_cast<const ChunkEntry*>(Data + CandidateHeader->ChunkTableOffset);
+            for (uint32_t ChunkIndex = 0; ChunkIndex < CandidateHeader->ChunkCount; ChunkIndex++)
+            {
+                const ChunkEntry& Chunk = CandidateChunks[ChunkIndex];
+                if (!IsInside(Chunk.Offset, Chunk.Size))
+                {
+                    return Fail(OutError, "chunk " + std::to_string(ChunkIndex) + " out of bounds");
+                }
+                if (Chunk.Alignment == 0 || Chunk.Offset % Chunk.Alignment != 0)
+                {
+                    return Fail(OutError, "chunk " + std::to_string(ChunkIndex) + " is misaligned");
+                }
+                if ((Chunk.Flags & ~ChunkFlags::KnownMask) != 0 || (!IsChunkCompressed(Chunk) && (Chunk.Flags & ChunkFlags::FilterMask) != 0))
+                {
+                    return Fail(OutError, "chunk " + std::to_string(ChunkIndex) + " has unknown flags");
+                }
+                if (IsChunkCompressed(Chunk))
+                {
+                    if (!IsChunkFilterSupported(GetChunkFilter(Chunk), Chunk.ElementSize))
+                    {
+                        return Fail(OutError, "chunk " + std::to_string(ChunkIndex) + " has an unknown codec");
+                    }
+                }
+                else if (Chunk.ElementSize != 0 && Chunk.ElementCount * Chunk.ElementSize != Chunk.Size)
+                {
+                    return Fail(OutError, "chunk " + std::to_string(ChunkIndex) + " has inconsistent size");
+                }
+            }
+
+            Header = CandidateHeader;
+            Chunks = CandidateChunks;
+            return true;
+        }
+
+        bool IsValid() const { return Header != nullptr; }
+        const FileHeader& GetHeader() const { return *Header; }
+        EFileType GetFileType() const { return EFileType(Header->FileType); }
+        Span<ChunkEntry> GetChunkTable() const { return Span<ChunkEntry>(Chunks, Header != nullptr ? Header->ChunkCount : 0); }
+
+        const ChunkEntry* FindChunk(uint32_t Id, uint32_t Index = 0) const
+        {
+            for (const ChunkEntry& Chunk : GetChunkTable())
+            {
+                if (Chunk.Id == Id && Chunk.Index == Index)
+                {
+                    return &Chunk;
+                }
+            }
+            return nullptr;
+        }
+
+        /** Typed view of a chunk, empty if the chunk is missing, compressed or its element size does not match */
+        template<typename ElementType>
+        Span<ElementType> GetChunk(uint32_t Id, uint32_t Index = 0) const
+        {
+            const ChunkEntry* Chunk = FindChunk(Id, Index);
+            if (Chunk == nullptr || IsChunkCompressed(*Chunk) || Chunk->ElementSize != sizeof(ElementType) || Chunk->Offset % alignof(ElementType) != 0)
+            {
+                return Span<ElementType>();
+            }
+            return Span<ElementType>(reinterpret_cast<const ElementType*>(Data + Chunk->Offset), size_t(Chunk->ElementCount));
+        }
+
+        /** Decoded copy of a raw or compressed chunk, false if the chunk is missing, does not decode or its element size does not match */
+        template<typename ElementType>
+        bool DecodeChunk(uint32_t Id, uint32_t Index, std::vector<ElementType>& OutElements, std::vector<uint8_t>& Scratch) const
+        {
+            const ChunkEntry* Chunk = FindChunk(Id, Index);
+            if (Chunk == nullptr || Chunk->ElementSize != sizeof(ElementType))
+            {
+                return false;
+            }
+            OutElements.resize(size_t(Chunk->ElementCount));
+            return DecodeChunkPayload(*Chunk, Data + Chunk->Offset, reinterpret_cast<uint8_t*>(OutElements.data()), Scratch);
+        }
+
+        template<typename ElementType>
+        bool DecodeChunk(uint32_t Id, uint32_t Index, std::vector<ElementType>& OutElements) const
+        {
+            std::vector<uint8_t> Scratch;
+            return DecodeChunk(Id, Index, OutElements, Scratch);
+        }
+
+        /** Start of the stored payload of a chunk */
+        const uint8_t* GetPayload(const ChunkEntry& Chunk) const { return Data + Chunk.Offset; }
+
+        /** First element of a single struct chunk, nullptr if missing */
+        template<typename ElementType>
+        const ElementType* GetStruct(uint32_t Id, uint32_t Index = 0) const
+        {
+            Span<ElementType> Elements = GetChunk<ElementType>(Id, Index);
+            return Elements.empty() ? nullptr : Elements.data();
+        }
+
+        Span<uint8_t> GetBytes(uint32_t Id, uint32_t Index = 0) const
+        {
+            const ChunkEntry* Chunk = FindChunk(Id, Index);
+            return Chunk != nullptr ? Span<uint8_t>(Data + Chunk->Offset, size_t(Chunk->Size)) : Span<uint8_t>();
+        }
+
+        std::string_view GetString(uint32_t Id, uint32_t Index = 0) const
+        {
+            const ChunkEntry* Chunk = FindChunk(Id, Index);
+            if (Chunk == nullptr || Chunk->Format != uint32_t(EElementFormat::String))
+            {
+                return std::string_view();
+            }
+            return std::string_view(reinterpret_cast<const char*>(Data + Chunk->Offset), size_t(Chunk->Size));
+        }
+
+        StringTable GetStringTable(uint32_t Id, uint32_t Index = 0) const
+        {
+            const ChunkEntry* Chunk = FindChunk(Id, Index);
+            if (Chunk == nullptr || Chunk->Format != uint32_t(EElementFormat::StringTable) || Chunk->Size < sizeof(uint32_t))
+            {
+                return StringTable();
+            }
+
+            const uint32_t* Words = reinterpret_cast<const uint32_t*>(Data + Chunk->Offset);
+            const uint32_t Count = Words[0];
+            const uint64_t TextOffset = (uint64_t(Count) + 2) * sizeof(uint32_t);
+            if (TextOffset > Chunk->Size)
+            {
+                return StringTable();
+            }
+            const uint32_t* Offsets = Words + 1;
+            if (Offsets[Count] > Chunk->Size - TextOffset)
+            {
+                return StringTable();
+            }
+            return StringTable(Offsets, reinterpret_cast<const char*>(Data + Chunk->Offset + TextOffset), Count);
+        }
+
+    private:
+        bool IsInside(uint64_t Offset, uint64_t Length) const
+        {
+            return Offset <= Size && Length <= Size - Offset;
+        }
+
+        bool Fail(std::string* OutError, const std::string& Message)
+        {
+            Header = nullptr;
+            Chunks = nullptr;
+            if (OutError != nullptr)
+            {
+                *OutError = Message;
+            }
+            return false;
+        }
+
+        MappedFile File;
+        const uint8_t* Data = nullptr;
+        size_t Size = 0;
+        const FileHeader* Header = nullptr;
+        const ChunkEntry* Chunks = nullptr;
+    };
+}
@@ -0,0 +1,822 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "REngineReader.h"
+#include "REngineAnimSampler.h"
+#include "REngineBVH.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+*   Tests of the standalone REngineFormat headers. Files are built in memory the way FExportFileWriter lays them out,
+*   compressed payloads come from a small greedy LZ4 block encoder below. CMake builds this file twice, the second
+*   time with the scalar animation sampler.
+*/
+using namespace REngineFormat;
+
+static int NumFailures = 0;
+
+#define CHECK(Condition) \
+    do \
+    { \
+        if (!(Condition)) \
+        { \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); \
+            NumFailures++; \
+        } \
+    } while (0)
+
+struct TestChunk
+{
+    uint32_t Id;
+    uint32_t Index;
+    EElementFormat Format;
+    uint32_t ElementSize;
+    uint64_t ElementCount;
+    std::vector<uint8_t> Payload;
+    uint32_t Flags = 0;
+};
+
+static uint64_t AlignUp(uint64_t Value, uint64_t Alignment)
+{
+    return (Value + Alignment - 1) / Alignment * Alignment;
+}
+
+/** Header, chunk table and payloads aligned to DefaultAlignment */
+static std::vector<uint8_t> BuildFile(const std::vector<TestChunk>& Chunks, EFileType FileType = EFileType::StaticMesh)
+{
+    const uint64_t TableOffset = sizeof(FileHeader);
+    uint64_t Offset = AlignUp(TableOffset + Chunks.size() * sizeof(ChunkEntry), DefaultAlignment);
+
+    std::vector<ChunkEntry> Entries;
+    for (const TestChunk& Chunk : Chunks)
+    {
+        ChunkEntry Entry = {};
+        Entry.Id = Chunk.Id;
+        Entry.Index = Chunk.Index;
+        Entry.Format = uint32_t(Chunk.Format);
+        Entry.ElementSize = Chunk.ElementSize;
+        Entry.Offset = Offset;
+        Entry.Size = Chunk.Payload.size();
+        Entry.ElementCount = Chunk.ElementCount;
+        Entry.Alignment = DefaultAlignment;
+        Entry.Flags = Chunk.Flags;
+        Entries.push_back(Entry);
+        Offset = AlignUp(Offset + Entry.Size, DefaultAlignment);
+    }
+
+    std::vector<uint8_t> File(size_t(Offset), 0);
+    FileHeader Header = {};
+    Header.Magic = FileMagic;
+    Header.VersionMajor = VersionMajor;
+    Header.VersionMinor = VersionMinor;
+    Header.FileType = uint32_t(FileType);
+    Header.ChunkCount = uint32_t(Chunks.size());
+    Header.ChunkTableOffset = TableOffset;
+    Header.FileSize = File.size();
+    memcpy(File.data(), &Header, sizeof(Header));
+    if (!Entries.empty())
+    {
+        memcpy(File.data() + TableOffset, Entries.data(), Entries.size() * sizeof(ChunkEntry));
+    }
+    for (size_t ChunkIndex = 0; ChunkIndex < Chunks.size(); ChunkIndex++)
+    {
+        if (!Chunks[ChunkIndex].Payload.empty())
+        {
+            memcpy(File.data() + Entries[ChunkIndex].Offset, Chunks[ChunkIndex].Payload.data(), Chunks[ChunkIndex].Payload.size());
+        }
+    }
+
+    return File;
+}
+
+template<typename ElementType>
+static TestChunk MakeChunk(uint32_t Id, uint32_t Index, EElementFormat Format, const std::vector<ElementType>& Elements)
+{
+    TestChunk Chunk{ Id, Index, Format, uint32_t(sizeof(ElementType)), Elements.size(), std::vector<uint8_t>(Elements.size() * sizeof(ElementType)) };
+    if (!Elements.empty())
+    {
+        memcpy(Chunk.Payload.data(), Elements.data(), Chunk.Payload.size());
+    }
+    return Chunk;
+}
+
+static TestChunk MakeStringTableChunk(uint32_t Id, const std::vector<std::string>& Strings)
+{
+    std::vector<uint32_t> Words(1, uint32_t(Strings.size()));
+    std::string Text;
+    for (const std::string& String : Strings)
+    {
+        Words.push_back(uint32_t(Text.size()));
+        Text += String;
+    }
+    Words.push_back(uint32_t(Text.size()));
+
+    TestChunk Chunk{ Id, 0, EElementFormat::StringTable, 1, 0, std::vector<uint8_t>(Words.size() * sizeof(uint32_t) + Text.size()) };
+    memcpy(Chunk.Payload.data(), Words.data(), Words.size() * sizeof(uint32_t));
+    memcpy(Chunk.Payload.data() + Words.size() * sizeof(uint32_t), Text.data(), Text.size());
+    Chunk.ElementCount = Chunk.Payload.size();
+    return Chunk;
+}
+
+static void WriteLength(std::vector<uint8_t>& Out, size_t Length)
+{
+    for (; Length >= 255; Length -= 255)
+    {
+        Out.push_back(255);
+    }
+    Out.push_back(uint8_t(Length));
+}
+
+/** Greedy LZ4 block encoder, keeps the end of block rules (last 5 bytes literal, no match starting in the last 12) */
+static std::vector<uint8_t> CompressLZ4Block(const uint8_t* In, size_t Size)
+{
+    std::vector<uint8_t> Out;
+    std::vector<size_t> Table(4096, size_t(-1));
+    size_t Anchor = 0;
+    size_t Position = 0;
+    while (Size >= 13 && Position + 12 < Size)
+    {
+        uint32_t Sequence;
+        memcpy(&Sequence, In + Position, 4);
+        const size_t Slot = (Sequence * 2654435761u) >> 20;
+        const size_t Candidate = Table[Slot];
+        Table[Slot] = Position;
+        if (Candidate == size_t(-1) || Position - Candidate > 65535 || memcmp(In + Candidate, In + Position, 4) != 0)
+        {
+            Position++;
+            continue;
+        }
+
+        size_t MatchLength = 4;
+        while (Position + MatchLength + 5 < Size && In[Candidate + MatchLength] == In[Position + MatchLength])
+        {
+            MatchLength++;
+        }
+
+        const size_t LiteralLength = Position - Anchor;
+        Out.push_back(uint8_t((LiteralLength >= 15 ? 15 : LiteralLength) << 4 | (MatchLength - 4 >= 15 ? 15 : MatchLength - 4)));
+        if (LiteralLength >= 15)
+        {
+            WriteLength(Out, LiteralLength - 15);
+        }
+        Out.insert(Out.end(), In + Anchor, In + Position);
+        const size_t Offset = Position - Candidate;
+        Out.push_back(uint8_t(Offset));
+        Out.push_back(uint8_t(Offset >> 8));
+        if (MatchLength - 4 >= 15)
+        {
+            WriteLength(Out, MatchLength - 4 - 15);
+        }
+
+        Position += MatchLength;
+        Anchor = Position;
+    }
+
+    const size_t LiteralLength = Size - Anchor;
+    Out.push_back(uint8_t((LiteralLength >= 15 ? 15 : LiteralLength) << 4));
+    if (LiteralLength >= 15)
+    {
+        WriteLength(Out, LiteralLength - 15);
+    }
+    Out.insert(Out.end(), In + Anchor, In + Size);
+
+    return Out;
+}
+
+/** Filter and compress elements the way the exporter does */
+static TestChunk MakeCompressedChunk(uint32_t Id, EChunkFilter Filter, const std::vector<uint8_t>& Raw, uint32_t ElementSize)
+{
+    const size_t Count = Raw.size() / ElementSize;
+    std::vector<uint8_t> Filtered(Raw.size());
+    EncodeChunkFilter(Filter, Raw.data(), Filtered.data(), Count, ElementSize);
+
+    TestChunk Chunk{ Id, 0, EElementFormat::Bytes, ElementSize, Count, CompressLZ4Block(Filtered.data(), Filtered.size()) };
+    Chunk.Flags = ChunkFlags::Compressed | (uint32_t(Filter) << ChunkFlags::FilterShift);
+    return Chunk;
+}
+
+static ChunkEntry* GetEntries(std::vector<uint8_t>& File)
+{
+    return reinterpret_cast<ChunkEntry*>(File.data() + sizeof(FileHeader));
+}
+
+static FileHeader* GetHeader(std::vector<uint8_t>& File)
+{
+    return reinterpret_cast<FileHeader*>(File.data());
+}
+
+static bool Opens(const std::vector<uint8_t>& File, std::string* OutError = nullptr)
+{
+    FileReader Reader;
+    return Reader.OpenMemory(File.data(), File.size(), OutError);
+}
+
+static void TestRejectsBadInput()
+{
+    const std::vector<uint32_t> Indices = { 0, 1, 2, 2, 1, 3 };
+    const std::vector<uint8_t> Valid = BuildFile({ MakeChunk(ChunkId::Indices, 0, EElementFormat::UInt32, Indices) });
+    std::string Error;
+    CHECK(Opens(Valid, &Error));
+
+    CHECK(!Opens(std::vector<uint8_t>(16, 0)));
+    FileReader NullReader;
+    CHECK(!NullReader.OpenMemory(nullptr, 0));
+
+    std::vector<uint8_t> File = Valid;
+    GetHeader(File)->Magic = MakeFourCC('N', 'O', 'P', 'E');
+    CHECK(!Opens(File, &Error) && Error == "bad magic");
+
+    File = Valid;
+    GetHeader(File)->VersionMajor = VersionMajor + 1;
+    CHECK(!Opens(File, &Error) && Error.find("major version") != std::string::npos);
+
+    // A newer minor version only adds chunks and still opens
+    File = Valid;
+    GetHeader(File)->VersionMinor = VersionMinor + 1;
+    CHECK(Opens(File));
+
+    File = Valid;
+    GetHeader(File)->FileSize = File.size() + 16;
+    CHECK(!Opens(File, &Error) && Error == "file size does not match header");
+    File = Valid;
+    File.resize(File.size() - 16);
+    CHECK(!Opens(File));
+
+    File = Valid;
+    GetHeader(File)->ChunkCount = 1000;
+    CHECK(!Opens(File, &Error) && Error == "chunk table out of bounds");
+    File = Valid;
+    GetHeader(File)->ChunkTableOffset = 4;
+    CHECK(!Opens(File, &Error) && Error == "chunk table out of bounds");
+
+    File = Valid;
+    GetEntries(File)[0].Offset = File.size() - 8;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 out of bounds");
+    File = Valid;
+    GetEntries(File)[0].Size = ~uint64_t(0);
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 out of bounds");
+
+    File = Valid;
+    GetEntries(File)[0].Offset += 4;
+    GetEntries(File)[0].Size -= 4;
+    GetEntries(File)[0].ElementCount -= 1;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 is misaligned");
+    File = Valid;
+    GetEntries(File)[0].Alignment = 0;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 is misaligned");
+
+    File = Valid;
+    GetEntries(File)[0].ElementCount += 1;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 has inconsistent size");
+
+    File = Valid;
+    GetEntries(File)[0].Flags = ChunkFlags::Compressed | (7u << ChunkFlags::FilterShift);
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 has an unknown codec");
+
+    // Flags of a newer writer, and a filter without compression
+    File = Valid;
+    GetEntries(File)[0].Flags = 1u << 16;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 has unknown flags");
+    File = Valid;
+    GetEntries(File)[0].Flags = uint32_t(EChunkFilter::IndexDelta) << ChunkFlags::FilterShift;
+    CHECK(!Opens(File, &Error) && Error == "chunk 0 has unknown flags");
+
+    // A failed open leaves the reader invalid, even after a good one
+    FileReader Reader;
+    CHECK(Reader.OpenMemory(Valid.data(), Valid.size()));
+    File = Valid;
+    GetHeader(File)->Magic = 0;
+    CHECK(!Reader.OpenMemory(File.data(), File.size()));
+    CHECK(!Reader.IsValid());
+    CHECK(Reader.GetChunkTable().empty());
+}
+
+static void TestTypedChunks()
+{
+    const std::vector<StaticMeshVertex> Vertices(3, StaticMeshVertex{ { 1.0f, 2.0f, 3.0f }, { 0.0f, 0.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.5f, 0.25f } });
+    const std::vector<uint16_t> Indices = { 0, 1, 2 };
+    const std::vector<uint8_t> File = BuildFile({
+        MakeChunk(ChunkId::Vertices, 0, EElementFormat::Struct, Vertices),
+        MakeChunk(ChunkId::Indices, 0, EElementFormat::UInt16, Indices),
+        MakeChunk(ChunkId::Indices, 1, EElementFormat::UInt16, std::vector<uint16_t>()),
+        MakeChunk(ChunkId::MeshInfo, 0, EElementFormat::Struct, std::vector<MeshInfo>(1, MeshInfo{ 2, { 0, 0, 0 } })),
+        MakeStringTableChunk(ChunkId::Strings, { "Alpha", "", "Gamma" }),
+    });
+
+    FileReader Reader;
+    std::string Error;
+    CHECK(Reader.OpenMemory(File.data(), File.size(), &Error));
+    CHECK(Reader.GetFileType() == EFileType::StaticMesh);
+    CHECK(Reader.GetChunkTable().size() == 5);
+
+    const Span<StaticMeshVertex> VertexSpan = Reader.GetChunk<StaticMeshVertex>(ChunkId::Vertices);
+    CHECK(VertexSpan.size() == 3);
+    CHECK(reinterpret_cast<uintptr_t>(VertexSpan.data()) % DefaultAlignment == reinterpret_cast<uintptr_t>(File.data()) % DefaultAlignment);
+    CHECK(VertexSpan.size() == 3 && VertexSpan[2].Position[2] == 3.0f && VertexSpan[1].UV[1] == 0.25f);
+
+    const Span<uint16_t> IndexSpan = Reader.GetChunk<uint16_t>(ChunkId::Indices);
+    CHECK(IndexSpan.size() == 3 && IndexSpan[2] == 2);
+    CHECK(Reader.GetChunk<uint16_t>(ChunkId::Indices, 1).empty());
+
+    // Wrong element size, missing chunk
+    CHECK(Reader.GetChunk<uint32_t>(ChunkId::Indices).empty());
+    CHECK(Reader.GetChunk<uint16_t>(ChunkId::Sections).empty());
+    CHECK(Reader.GetChunk<uint16_t>(ChunkId::Indices, 7).empty());
+
+    const MeshInfo* Info = Reader.GetStruct<MeshInfo>(ChunkId::MeshInfo);
+    CHECK(Info != nullptr && Info->LODCount == 2);
+
+    const StringTable Strings = Reader.GetStringTable(ChunkId::Strings);
+    CHECK(Strings.size() == 3);
+    CHECK(Strings.size() == 3 && Strings[0] == "Alpha" && Strings[1].empty() && Strings[2] == "Gamma");
+    CHECK(Reader.GetStringTable(ChunkId::Indices).empty());
+
+    std::vector<uint16_t> Decoded;
+    CHECK(Reader.DecodeChunk(ChunkId::Indices, 0, Decoded) && Decoded == Indices);
+}
+
+static void TestStringTableBounds()
+{
+    // Count claims more offsets than the chunk holds
+    TestChunk Chunk = MakeStringTableChunk(ChunkId::Strings, { "A", "B" });
+    uint32_t Count = 1000;
+    memcpy(Chunk.Payload.data(), &Count, sizeof(Count));
+    std::vector<uint8_t> File = BuildFile({ Chunk });
+    FileReader Reader;
+    CHECK(Reader.OpenMemory(File.data(), File.size()));
+    CHECK(Reader.GetStringTable(ChunkId::Strings).empty());
+
+    // Last offset past the text
+    Chunk = MakeStringTableChunk(ChunkId::Strings, { "A", "B" });
+    uint32_t End = 100;
+    memcpy(Chunk.Payload.data() + 3 * sizeof(uint32_t), &End, sizeof(End));
+    File = BuildFile({ Chunk });
+    CHECK(Reader.OpenMemory(File.data(), File.size()));
+    CHECK(Reader.GetStringTable(ChunkId::Strings).empty());
+}
+
+static std::vector<uint8_t> MakeTestStream(uint32_t ElementSize, size_t Count)
+{
+    // Slowly changing values with repeats, like positions or indices
+    std::vector<uint8_t> Raw(ElementSize * Count);
+    uint32_t State = 12345;
+    for (size_t Element = 0; Element < Count; Element++)
+    {
+        State = State * 1103515245u + 12345u;
+        for (uint32_t Byte = 0; Byte < ElementSize; Byte++)
+        {
+            Raw[Element * ElementSize + Byte] = uint8_t(Byte == 0 ? Element + (State >> 28) : (Element / 64 + Byte) * ((State >> 30) != 0));
+        }
+    }
+    return Raw;
+}
+
+static void TestCodecRoundTrip()
+{
+    struct FilterCase
+    {
+        EChunkFilter Filter;
+        uint32_t ElementSize;
+    };
+    const FilterCase Cases[] = {
+        { EChunkFilter::None, 1 }, { EChunkFilter::None, 12 },
+        { EChunkFilter::IndexDelta, 2 }, { EChunkFilter::IndexDelta, 4 },
+        { EChunkFilter::BytePlaneDelta, 4 }, { EChunkFilter::BytePlaneDelta, 48 },
+    };
+
+    for (const FilterCase& Case : Cases)
+    {
+        for (size_t Count : { size_t(1), size_t(7), size_t(1000), size_t(40000) })
+        {
+            const std::vector<uint8_t> Raw = MakeTestStream(Case.ElementSize, Count);
+
+            std::vector<uint8_t> Filtered(Raw.size());
+            std::vector<uint8_t> Unfiltered(Raw.size());
+            EncodeChunkFilter(Case.Filter, Raw.data(), Filtered.data(), Count, Case.ElementSize);
+            DecodeChunkFilter(Case.Filter, Filtered.data(), Unfiltered.data(), Count, Case.ElementSize);
+            CHECK(Unfiltered == Raw);
+
+            const TestChunk Chunk = MakeCompressedChunk(ChunkId::Vertices, Case.Filter, Raw, Case.ElementSize);
+            const std::vector<uint8_t> File = BuildFile({ Chunk });
+            FileReader Reader;
+            CHECK(Reader.OpenMemory(File.data(), File.size()));
+            CHECK(Reader.GetBytes(ChunkId::Vertices).size() == Chunk.Payload.size());
+
+            // Compressed chunks are not viewable in place
+            CHECK(Reader.GetChunk<uint8_t>(ChunkId::Vertices).empty());
+
+            const ChunkEntry* Entry = Reader.FindChunk(ChunkId::Vertices);
+            CHECK(Entry != nullptr && GetDecodedChunkSize(*Entry) == Raw.size());
+
+            std::vector<uint8_t> Decoded(Raw.size());
+            std::vector<uint8_t> Scratch;
+            CHECK(Entry != nullptr && DecodeChunkPayload(*Entry, Reader.GetPayload(*Entry), Decoded.data(), Scratch));
+            CHECK(Decoded == Raw);
+        }
+    }
+
+    // Typed decode of a compressed index stream
+    std::vector<uint32_t> Indices;
+    for (uint32_t Index = 0; Index < 3000; Index++)
+    {
+        Indices.push_back(Index / 3 + Index % 3);
+    }
+    std::vector<uint8_t> Raw(Indices.size() * sizeof(uint32_t));
+    memcpy(Raw.data(), Indices.data(), Raw.size());
+    const std::vector<uint8_t> File = BuildFile({ MakeCompressedChunk(ChunkId::Indices, EChunkFilter::IndexDelta, Raw, 4) });
+    FileReader Reader;
+    CHECK(Reader.OpenMemory(File.data(), File.size()));
+    std::vector<uint32_t> Decoded;
+    CHECK(Reader.DecodeChunk(ChunkId::Indices, 0, Decoded) && Decoded == Indices);
+    std::vector<uint16_t> WrongSize;
+    CHECK(!Reader.DecodeChunk(ChunkId::Indices, 0, WrongSize));
+}
+
+static void TestCorruptLZ4()
+{
+    const std::vector<uint8_t> Raw = MakeTestStream(4, 2000);
+    const std::vector<uint8_t> Block = CompressLZ4Block(Raw.data(), Raw.size());
+    CHECK(Block.size() < Raw.size());
+
+    std::vector<uint8_t> Output(Raw.size());
+    CHECK(DecompressLZ4Block(Block.data(), Block.size(), Output.data(), Output.size()) && Output == Raw);
+
+    // Truncated anywhere, the block must not decode to the full size
+    for (size_t Size : { size_t(0), size_t(1), Block.size() / 3, Block.size() / 2, Block.size() - 1 })
+    {
+        std::vector<uint8_t> Truncated(Block.begin(), Block.begin() + Size);
+        CHECK(!DecompressLZ4Block(Truncated.data(), Truncated.size(), Output.data(), Output.size()));
+    }
+
+    // Decodes to more or less than the expected size
+    std::vector<uint8_t> Small(Raw.size() - 1);
+    CHECK(!DecompressLZ4Block(Block.data(), Block.size(), Small.data(), Small.size()));
+    std::vector<uint8_t> Large(Raw.size() + 1);
+    CHECK(!DecompressLZ4Block(Block.data(), Block.size(), Large.data(), Large.size()));
+
+    // Literal run longer than the output
+    const uint8_t LongLiterals[] = { 0xF0, 40, 'a', 'b', 'c' };
+    uint8_t Tiny[8];
+    CHECK(!DecompressLZ4Block(LongLiterals, sizeof(LongLiterals), Tiny, sizeof(Tiny)));
+
+    // Length continuation bytes running off the end of the input
+    const uint8_t EndlessLength[] = { 0xF0, 255, 255 };
+    CHECK(!DecompressLZ4Block(EndlessLength, sizeof(EndlessLength), Tiny, sizeof(Tiny)));
+
+    // Match offset before the start of the output, zero offset, match past the end of the output
+    const uint8_t FarMatch[] = { 0x10, 'a', 0x05, 0x00, 0x00 };
+    CHECK(!DecompressLZ4Block(FarMatch, sizeof(FarMatch), Tiny, sizeof(Tiny)));
+    const uint8_t ZeroOffset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+    CHECK(!DecompressLZ4Block(ZeroOffset, sizeof(ZeroOffset), Tiny, sizeof(Tiny)));
+    const uint8_t LongMatch[] = { 0x1F, 'a', 0x01, 0x00, 20, 0x00 };
+    CHECK(!DecompressLZ4Block(LongMatch, sizeof(LongMatch), Tiny, sizeof(Tiny)));
+
+    // The same overlapping match that fits decodes to a run
+    const uint8_t Run[] = { 0x13, 'a', 0x01, 0x00, 0x00 };
+    CHECK(DecompressLZ4Block(Run, sizeof(Run), Tiny, sizeof(Tiny)) && Tiny[0] == 'a' && Tiny[7] == 'a');
+
+    // Corrupt payload behind a valid chunk table decodes with an error instead of overrunning
+    TestChunk Chunk = MakeCompressedChunk(ChunkId::Vertices, EChunkFilter::BytePlaneDelta, Raw, 4);
+    Chunk.Payload.resize(Chunk.Payload.size() / 2);
+    const std::vector<uint8_t> File = BuildFile({ Chunk });
+    FileReader Reader;
+    CHECK(Reader.OpenMemory(File.data(), File.size()));
+    std::vector<uint32_t> Decoded;
+    CHECK(!Reader.DecodeChunk(ChunkId::Vertices, 0, Decoded));
+}
+
+struct TestAnimation
+{
+    std::vector<AnimTrack> Tracks;
+    std::vector<float> PosKeys;
+    std::vector<float> RotKeys;
+    std::vector<float> ScaleKeys;
+
+    AnimTrackKeys GetKeys() const
+    {
+        return { Tracks.data(), uint32_t(Tracks.size()), PosKeys.data(), RotKeys.data(), ScaleKeys.data() };
+    }
+};
+
+/** Tracks turning about different axes with keys in alternating hemispheres, a track with one key and one without any */
+static TestAnimation MakeTestAnimation(uint32_t NumFrames)
+{
+    TestAnimation Animation;
+    for (int32_t Bone = 0; Bone < 5; Bone++)
+    {
+        AnimTrack Track = {};
+        Track.BoneIndex = Bone * 2 + 1;
+        Track.FirstPosKey = uint32_t(Animation.PosKeys.size() / 3);
+        Track.FirstRotKey = uint32_t(Animation.RotKeys.size() / 4);
+        Track.FirstScaleKey = uint32_t(Animation.ScaleKeys.size() / 3);
+        Track.NumRotKeys = Bone == 3 ? 1 : (Bone == 4 ? 0 : NumFrames);
+        Track.NumPosKeys = Bone == 4 ? 0 : NumFrames;
+        Track.NumScaleKeys = Bone == 2 ? 1 : 0;
+
+        const float Axis[3] = { Bone == 0 ? 1.0f : 0.6f, Bone == 1 ? 1.0f : 0.0f, Bone == 2 ? 1.0f : 0.8f };
+        const float AxisLength = std::sqrt(Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2]);
+        for (uint32_t Key = 0; Key < Track.NumRotKeys; Key++)
+        {
+            const float HalfAngle = 0.5f * (0.4f * float(Key) + 0.3f * float(Bone));
+            const float Sign = (Key + uint32_t(Bone)) % 3 == 0 ? -1.0f : 1.0f;
+            for (uint32_t Component = 0; Component < 3; Component++)
+            {
+                Animation.RotKeys.push_back(Sign * std::sin(HalfAngle) * Axis[Component] / AxisLength);
+            }
+            Animation.RotKeys.push_back(Sign * std::cos(HalfAngle));
+        }
+        for (uint32_t Key = 0; Key < Track.NumPosKeys; Key++)
+        {
+            Animation.PosKeys.insert(Animation.PosKeys.end(), { float(Key), float(Bone) * 10.0f, std::sin(float(Key)) });
+        }
+        for (uint32_t Key = 0; Key < Track.NumScaleKeys; Key++)
+        {
+            Animation.ScaleKeys.insert(Animation.ScaleKeys.end(), { 2.0f, 3.0f, 4.0f });
+        }
+
+        Animation.Tracks.push_back(Track);
+    }
+
+    return Animation;
+}
+
+/** Shortest path nlerp of a track written independently of the sampler, identity without keys */
+static void ReferenceRotation(const TestAnimation& Animation, const AnimTrack& Track, float Frame, float* OutRotation)
+{
+    if (Track.NumRotKeys == 0)
+    {
+        OutRotation[0] = OutRotation[1] = OutRotation[2] = 0.0f;
+        OutRotation[3] = 1.0f;
+        return;
+    }
+
+    const float Clamped = std::fmin(std::fmax(Frame, 0.0f), float(Track.NumRotKeys - 1));
+    const uint32_t Key0 = uint32_t(std::floor(Clamped));
+    const uint32_t Key1 = std::min(Key0 + 1, Track.NumRotKeys - 1);
+    const float Alpha = Clamped - float(Key0);
+    const float* Rotation0 = &Animation.RotKeys[(Track.FirstRotKey + Key0) * 4];
+    const float* Rotation1 = &Animation.RotKeys[(Track.FirstRotKey + Key1) * 4];
+
+    float Dot = 0.0f;
+    for (uint32_t Component = 0; Component < 4; Component++)
+    {
+        Dot += Rotation0[Component] * Rotation1[Component];
+    }
+
+    float Length = 0.0f;
+    for (uint32_t Component = 0; Component < 4; Component++)
+    {
+        OutRotation[Component] = (1.0f - Alpha) * Rotation0[Component] + Alpha * (Dot < 0.0f ? -Rotation1[Component] : Rotation1[Component]);
+        Length += OutRotation[Component] * OutRotation[Component];
+    }
+    for (uint32_t Component = 0; Component < 4; Component++)
+    {
+        OutRotation[Component] /= std::sqrt(Length);
+    }
+}
+
+/** Same rotation, q and -q are equal */
+static bool IsSameRotation(const float* A, const float* B)
+{
+    float Dot = 0.0f;
+    for (uint32_t Component = 0; Component < 4; Component++)
+    {
+        Dot += A[Component] * B[Component];
+    }
+    return std::fabs(std::fabs(Dot) - 1.0f) < 1e-5f;
+}
+
+static void TestAnimSampler()
+{
+    for (uint32_t NumFrames : { 1u, 2u, 5u, 17u, 33u })
+    {
+        for (uint32_t FramesPerBlock : { 1u, 4u, 16u })
+        {
+            const TestAnimation Animation = MakeTestAnimation(NumFrames);
+            const AnimTrackKeys Keys = Animation.GetKeys();
+            const AnimBlockLayout Layout = MakeAnimBlockLayout(NumFrames, Keys.NumTracks, FramesPerBlock);
+            CHECK(Layout.NumLanes == 8);
+            CHECK(uint64_t(Layout.NumBlocks) * Layout.FramesPerBlock + 1 >= NumFrames);
+
+            std::vector<int32_t> LaneBones(Layout.NumLanes);
+            std::vector<float> Blocks(GetAnimBlocksFloats(Layout));
+            BuildAnimBlocks(Layout, Keys, LaneBones.data(), Blocks.data());
+            CHECK(LaneBones[0] == 1 && LaneBones[4] == 9 && LaneBones[5] == -1 && LaneBones[7] == -1);
+
+            // Within every block each frame is in the hemisphere of the one before, so the lerp between them takes the short path
+            const size_t PoseFloats = GetAnimPoseFloats(Layout.NumLanes);
+            for (uint32_t Block = 0; Block < Layout.NumBlocks; Block++)
+            {
+                for (uint32_t BlockFrame = 0; BlockFrame < Layout.FramesPerBlock; BlockFrame++)
+                {
+                    const float* Pose0 = Blocks.data() + Block * GetAnimBlockFloats(Layout) + BlockFrame * PoseFloats;
+                    for (uint32_t Lane = 0; Lane < Layout.NumLanes; Lane++)
+                    {
+                        float Dot = 0.0f;
+                        for (uint32_t Component = 0; Component < 4; Component++)
+                        {
+                            Dot += Pose0[Component * Layout.NumLanes + Lane] * Pose0[PoseFloats + Component * Layout.NumLanes + Lane];
+                        }
+                        CHECK(Dot >= 0.0f);
+                    }
+                }
+            }
+
+            std::vector<float> BlockPose(PoseFloats);
+            std::vector<float> TrackPose(PoseFloats);
+            for (float Frame = -1.0f; Frame <= float(NumFrames) + 1.0f; Frame += 0.37f)
+            {
+                SampleBlockPose(Layout, Blocks.data(), Frame, BlockPose.data());
+                SampleTrackPose(Keys, Frame, Layout.NumLanes, TrackPose.data());
+
+                for (uint32_t Lane = 0; Lane < Layout.NumLanes; Lane++)
+                {
+                    const BoneTransform Sampled = GetPoseTransform(BlockPose.data(), Layout.NumLanes, Lane);
+                    const BoneTransform Track = GetPoseTransform(TrackPose.data(), Layout.NumLanes, Lane);
+
+                    float Reference[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                    if (Lane < Keys.NumTracks)
+                    {
+                        ReferenceRotation(Animation, Animation.Tracks[Lane], Frame, Reference);
+                    }
+                    CHECK(IsSameRotation(Sampled.Rotation, Reference));
+                    CHECK(IsSameRotation(Track.Rotation, Reference));
+
+                    for (uint32_t Component = 0; Component < 3; Component++)
+                    {
+                        CHECK(std::fabs(Sampled.Translation[Component] - Track.Translation[Component]) < 1e-4f);
+                        CHECK(std::fabs(Sampled.Scale[Component] - Track.Scale[Component]) < 1e-5f);
+                    }
+                }
+
+                // Translations are a plain lerp of the keys, scale holds its only key, missing channels are the identity
+                const float Clamped = std::fmin(std::fmax(Frame, 0.0f), float(NumFrames - 1));
+                CHECK(std::fabs(GetPoseTransform(BlockPose.data(), Layout.NumLanes, 0).Translation[0] - Clamped) < 1e-4f);
+                CHECK(GetPoseTransform(BlockPose.data(), Layout.NumLanes, 2).Scale[2] == 4.0f);
+                CHECK(GetPoseTransform(BlockPose.data(), Layout.NumLanes, 4).Translation[1] == 0.0f);
+                CHECK(GetPoseTransform(BlockPose.data(), Layout.NumLanes, 0).Scale[0] == 1.0f);
+            }
+        }
+    }
+}
+
+/** Node with the box around the items of FirstItem to EndItem */
+static MapBVHNode MakeBVHNode(const std::vector<uint32_t>& Items, const std::vector<MapActorBounds>& Bounds, uint32_t FirstItem, uint32_t EndItem, uint32_t Skip)
+{
+    float Min[3] = { 1e30f, 1e30f, 1e30f };
+    float Max[3] = { -1e30f, -1e30f, -1e30f };
+    for (uint32_t ItemIndex = FirstItem; ItemIndex < EndItem; ItemIndex++)
+    {
+        const MapActorBounds& ItemBounds = Bounds[Items[ItemIndex]];
+        for (uint32_t Axis = 0; Axis < 3; Axis++)
+        {
+            Min[Axis] = std::min(Min[Axis], ItemBounds.Center[Axis] - ItemBounds.Extent[Axis]);
+            Max[Axis] = std::max(Max[Axis], ItemBounds.Center[Axis] + ItemBounds.Extent[Axis]);
+        }
+    }
+
+    MapBVHNode Node = {};
+    for (uint32_t Axis = 0; Axis < 3; Axis++)
+    {
+        Node.Center[Axis] = 0.5f * (Min[Axis] + Max[Axis]);
+        Node.Extent[Axis] = 0.5f * (Max[Axis] - Min[Axis]);
+    }
+    Node.FirstItem = FirstItem;
+    Node.Skip = Skip;
+    return Node;
+}
+
+/** Items CullBVH hands out, sorted, against those whose own box is not outside */
+static void CheckCullBVH(const std::vector<MapBVHNode>& Nodes, const std::vector<uint32_t>& Items, const std::vector<MapActorBounds>& Bounds,
+    const CullingPlanes& Planes)
+{
+    std::vector<uint32_t> Visible;
+    CullBVH(Nodes.data(), uint32_t(Nodes.size()), Items.data(), uint32_t(Items.size()), Bounds.data(), Planes,
+        [&Visible](uint32_t Actor) { Visible.push_back(Actor); });
+    std::sort(Visible.begin(), Visible.end());
+
+    std::vector<uint32_t> BruteForce;
+    for (uint32_t Item : Items)
+    {
+        if (CullBox(Planes, Bounds[Item].Center, Bounds[Item].Extent) != ECullResult::Outside)
+        {
+            BruteForce.push_back(Item);
+        }
+    }
+    std::sort(BruteForce.begin(), BruteForce.end());
+
+    CHECK(Visible == BruteForce);
+}
+
+static CullingPlanes MakeAxisPlanes(std::initializer_list<std::pair<uint32_t, float>> AxisDistances, float Direction)
+{
+    CullingPlanes Planes = {};
+    for (const std::pair<uint32_t, float>& AxisDistance : AxisDistances)
+    {
+        Planes.Normals[Planes.NumPlanes][AxisDistance.first] = Direction;
+        Planes.Distances[Planes.NumPlanes] = Direction * AxisDistance.second;
+        Planes.NumPlanes++;
+    }
+    return Planes;
+}
+
+static void TestCullBVH()
+{
+    // Unit boxes on a slanted line, listed out of order the way BuildBVH sorts them into leaves
+    std::vector<MapActorBounds> Bounds(8);
+    for (uint32_t Actor = 0; Actor < 8; Actor++)
+    {
+        Bounds[Actor].Center[0] = float(Actor) * 3.0f;
+        Bounds[Actor].Center[1] = float(Actor % 3);
+        Bounds[Actor].Extent[0] = Bounds[Actor].Extent[1] = Bounds[Actor].Extent[2] = 1.0f;
+        Bounds[Actor].Radius = std::sqrt(3.0f);
+    }
+    const std::vector<uint32_t> Items = { 1, 0, 3, 2, 4, 5, 7, 6 };
+
+    // Depth first with skip pointers: 0 is the root, 1 and 4 inner nodes, 2, 3, 5 and 6 leaves with two items each
+    const std::vector<MapBVHNode> Tree = {
+        MakeBVHNode(Items, Bounds, 0, 8, 7),
+        MakeBVHNode(Items, Bounds, 0, 4, 4),
+        MakeBVHNode(Items, Bounds, 0, 2, 3),
+        MakeBVHNode(Items, Bounds, 2, 4, 4),
+        MakeBVHNode(Items, Bounds, 4, 8, 7),
+        MakeBVHNode(Items, Bounds, 4, 6, 6),
+        MakeBVHNode(Items, Bounds, 6, 8, 7),
+    };
+
+    // A single leaf holding every item, and a root leaf with an unbalanced inner node below it skipped to the end
+    const std::vector<MapBVHNode> SingleLeaf = { MakeBVHNode(Items, Bounds, 0, 8, 1) };
+    const std::vector<MapBVHNode> Unbalanced = {
+        MakeBVHNode(Items, Bounds, 0, 8, 4),
+        MakeBVHNode(Items, Bounds, 0, 1, 2),
+        MakeBVHNode(Items, Bounds, 1, 8, 4),
+        MakeBVHNode(Items, Bounds, 1, 8, 4),
+    };
+
+    std::vector<CullingPlanes> Views;
+    Views.push_back(CullingPlanes {});
+    for (float Distance = -2.0f; Distance <= 24.0f; Distance += 0.75f)
+    {
+        Views.push_back(MakeAxisPlanes({ { 0, Distance } }, 1.0f));
+        Views.push_back(MakeAxisPlanes({ { 0, Distance } }, -1.0f));
+        Views.push_back(MakeAxisPlanes({ { 0, Distance }, { 1, 0.5f } }, 1.0f));
+    }
+
+    // A box around part of the line and a diagonal plane crossing it
+    CullingPlanes Box = MakeAxisPlanes({ { 0, 5.0f }, { 1, -0.5f }, { 2, -2.0f } }, 1.0f);
+    const CullingPlanes Far = MakeAxisPlanes({ { 0, 14.0f }, { 1, 1.5f }, { 2, 2.0f } }, -1.0f);
+    for (uint32_t Plane = 0; Plane < Far.NumPlanes; Plane++)
+    {
+        std::memcpy(Box.Normals[Box.NumPlanes], Far.Normals[Plane], sizeof(Box.Normals[0]));
+        Box.Distances[Box.NumPlanes++] = Far.Distances[Plane];
+    }
+    Views.push_back(Box);
+    CullingPlanes Diagonal = {};
+    Diagonal.Normals[0][0] = 0.6f;
+    Diagonal.Normals[0][1] = -0.8f;
+    Diagonal.Distances[0] = 7.0f;
+    Diagonal.NumPlanes = 1;
+    Views.push_back(Diagonal);
+
+    for (const CullingPlanes& Planes : Views)
+    {
+        CheckCullBVH(Tree, Items, Bounds, Planes);
+        CheckCullBVH(SingleLeaf, Items, Bounds, Planes);
+        CheckCullBVH(Unbalanced, Items, Bounds, Planes);
+        CheckCullBVH({}, {}, Bounds, Planes);
+    }
+
+    // Every item exactly once with no planes, none with planes nothing is in front of
+    uint32_t NumVisited = 0;
+    CullBVH(Tree.data(), uint32_t(Tree.size()), Items.data(), uint32_t(Items.size()), Bounds.data(), Views[0], [&NumVisited](uint32_t) { NumVisited++; });
+    CHECK(NumVisited == 8);
+    NumVisited = 0;
+    CullBVH(Tree.data(), uint32_t(Tree.size()), Items.data(), uint32_t(Items.size()), Bounds.data(), MakeAxisPlanes({ { 0, 30.0f } }, 1.0f),
+        [&NumVisited](uint32_t) { NumVisited++; });
+    CHECK(NumVisited == 0);
+}
+
+int main()
+{
+    TestRejectsBadInput();
+    TestTypedChunks();
+    TestStringTableBounds();
+    TestCodecRoundTrip();
+    TestCorruptLZ4();
+    TestAnimSampler();
+    TestCullBVH();
+
+    if (NumFailures > 0)
+    {
+        std::printf("%d checks failed\n", NumFailures);
+        return 1;
+    }
+
+    std::printf("All REngineFormat tests passed\n");
+    return 0;
+}